@@ -41,7 +41,8 @@ def build_shader(task):
 	split = os.path.splitext(os.path.basename(src))
 	variableName = split[0] + split[1].upper()[1:]
 	
-	headerFile.write("const char *" + variableName + "String = \"")
+	# constant pointer, for internal linkage: several sources can include the same shader
+	headerFile.write("const char *const " + variableName + "String = \"")
 	for line in shaderFile:
 		# escape '\' and '"'
 		line = line.replace("\\", "\\\\")
@@ -31,23 +31,64 @@
 #include <engine/graphics/GraphicsEngine.hpp>
 #include <engine/script/ScriptEngine.hpp>
 #include <engine/sg/WorldManager.hpp>
+#include <engine/system/Atomic.hpp>
+#include <engine/system/JobQueue.hpp>
 #include <engine/system/Log.hpp>
+#include <engine/system/Thread.hpp>
 #include <engine/system/Time.hpp>
 
 namespace oak {
 
+Application::Application()
+{
+	this->renderPipelineDepth = 1;
+	this->screenWidth = 0;
+	this->screenHeight = 0;
+	this->simulationThread = NULL;
+	this->stopping = 0;
+	this->simulationFinished = 0;
+	
+	this->jobQueue = NULL;
+	this->worldManager = NULL;
+	this->input = NULL;
+	this->graphics = NULL;
+	this->script = NULL;
+}
+
+void Application::setRenderPipelineDepth(unsigned int depth)
+{
+	OAK_ASSERT(this->graphics == NULL, "The render pipeline depth must be set before initialization");
+	OAK_ASSERT(depth >= 1 && depth <= 3, "The render pipeline depth must be between 1 and 3");
+	
+	this->renderPipelineDepth = depth;
+}
+
+void Application::setScreenSize(unsigned int width, unsigned int height)
+{
+	this->screenWidth = width;
+	this->screenHeight = height;
+	
+	if (this->graphics)
+		this->graphics->setScreenSize(width, height);
+}
+
 void Application::initialize(const std::string &baseFolder)
 {
 	Log::info("Application::initialize");
 	
 	Time::reset();
 	
+	this->jobQueue = new JobQueue(JobQueue::getDefaultWorkerCount());
+	
 	this->worldManager = new WorldManager;
 	
 	this->input = new InputEngine;
 	this->input->addListener(this);
 	
-	this->graphics = new GraphicsEngine(this->worldManager);
+	this->graphics = new GraphicsEngine(this->worldManager, this->jobQueue, this->renderPipelineDepth);
+	this->graphics->setBaseFolder(baseFolder);
+	if (this->screenWidth > 0 && this->screenHeight > 0)
+		this->graphics->setScreenSize(this->screenWidth, this->screenHeight);
 	
 	this->script = new ScriptEngine(baseFolder);
 	this->script->initialize();
@@ -60,12 +101,34 @@ void Application::initialize(const std::string &baseFolder)
 	
 	this->script->startCall("initialize");
 	this->script->endCall();
+	
+	// from now on, scripts are only run by the simulation thread
+	if (this->renderPipelineDepth > 1)
+		this->simulationThread = new Thread(Application::simulationMain, this);
 }
 
 void Application::shutdown()
 {
 	Log::info("Application::shutdown");
 	
+	if (this->simulationThread)
+	{
+		Atomic::store(&this->stopping, 1);
+		
+		// keep consuming snapshots, the simulation thread may be waiting for a free one
+		while (!Atomic::load(&this->simulationFinished))
+		{
+			if (!this->graphics->discardFrame())
+				Thread::yield();
+		}
+		
+		delete this->simulationThread;
+		this->simulationThread = NULL;
+		
+		while (this->graphics->discardFrame())
+			;
+	}
+	
 	this->script->startCall("shutdown");
 	this->script->endCall();
 	
@@ -78,50 +141,128 @@ void Application::shutdown()
 	delete this->input;
 	
 	delete this->worldManager;
+	
+	delete this->jobQueue;
 }
 
 void Application::update()
 {
-	Time::frameStart();
-	
 	this->input->update();
 	
-	this->script->startCall("update");
-	this->script->appendParameter(Time::getElapsedTime());
-	this->script->endCall();
+	// when pipelined, the simulation runs ahead on its own thread and only
+	// what it recorded is replayed here
+	if (!this->simulationThread)
+		this->simulateFrame();
 	
-	this->graphics->renderFrame();
+	this->graphics->submitFrame();
 }
 
 void Application::pointerDown(unsigned int pointerId, unsigned int button, glm::vec2 position)
 {
-	this->script->startCall("pointerDown");
-	this->script->appendParameter((int)pointerId);
-	this->script->appendParameter((int)button);
-	this->script->appendParameter(position.x);
-	this->script->appendParameter(position.y);
-	this->script->endCall();
+	PointerEvent event;
+	event.type = PointerEvent::Down;
+	event.pointerId = pointerId;
+	event.button = button;
+	event.position = position;
+	
+	this->queuePointerEvent(event);
 }
 
 void Application::pointerUp(unsigned int pointerId, unsigned int button, glm::vec2 position)
 {
-	this->script->startCall("pointerUp");
-	this->script->appendParameter((int)pointerId);
-	this->script->appendParameter((int)button);
-	this->script->appendParameter(position.x);
-	this->script->appendParameter(position.y);
-	this->script->endCall();
+	PointerEvent event;
+	event.type = PointerEvent::Up;
+	event.pointerId = pointerId;
+	event.button = button;
+	event.position = position;
+	
+	this->queuePointerEvent(event);
 }
 
 void Application::pointerMove(unsigned int pointerId, glm::vec2 position, glm::vec2 movement)
 {
-	this->script->startCall("pointerMove");
-	this->script->appendParameter((int)pointerId);
-	this->script->appendParameter(position.x);
-	this->script->appendParameter(position.y);
-	this->script->appendParameter(movement.x);
-	this->script->appendParameter(movement.y);
+	PointerEvent event;
+	event.type = PointerEvent::Move;
+	event.pointerId = pointerId;
+	event.button = 0;
+	event.position = position;
+	event.movement = movement;
+	
+	this->queuePointerEvent(event);
+}
+
+void Application::simulateFrame()
+{
+	Time::frameStart();
+	
+	this->dispatchPointerEvents();
+	
+	this->script->startCall("update");
+	this->script->appendParameter(Time::getElapsedTime());
 	this->script->endCall();
+	
+	this->graphics->prepareFrame();
+}
+
+void Application::simulationMain(void *userData)
+{
+	Application *application = (Application *)userData;
+	
+	while (!Atomic::load(&application->stopping))
+		application->simulateFrame();
+	
+	Atomic::store(&application->simulationFinished, 1);
+}
+
+void Application::queuePointerEvent(const PointerEvent &event)
+{
+	MutexLock lock(&this->pointerEventMutex);
+	this->pointerEvents.push_back(event);
+}
+
+void Application::dispatchPointerEvents()
+{
+	// take the queued events at once, so that the driver thread is not blocked by scripts
+	PointerEventQueue events;
+	{
+		MutexLock lock(&this->pointerEventMutex);
+		events.swap(this->pointerEvents);
+	}
+	
+	for (PointerEventQueue::iterator it = events.begin(); it != events.end(); ++it)
+	{
+		const PointerEvent &event = *it;
+		switch (event.type)
+		{
+			case PointerEvent::Down:
+				this->script->startCall("pointerDown");
+				this->script->appendParameter((int)event.pointerId);
+				this->script->appendParameter((int)event.button);
+				this->script->appendParameter(event.position.x);
+				this->script->appendParameter(event.position.y);
+				this->script->endCall();
+				break;
+			
+			case PointerEvent::Up:
+				this->script->startCall("pointerUp");
+				this->script->appendParameter((int)event.pointerId);
+				this->script->appendParameter((int)event.button);
+				this->script->appendParameter(event.position.x);
+				this->script->appendParameter(event.position.y);
+				this->script->endCall();
+				break;
+			
+			case PointerEvent::Move:
+				this->script->startCall("pointerMove");
+				this->script->appendParameter((int)event.pointerId);
+				this->script->appendParameter(event.position.x);
+				this->script->appendParameter(event.position.y);
+				this->script->appendParameter(event.movement.x);
+				this->script->appendParameter(event.movement.y);
+				this->script->endCall();
+				break;
+		}
+	}
 }
 
 } // oak namespace
@@ -27,29 +27,83 @@
 
 #include <engine/input/InputListener.hpp>
 
+#include <engine/system/Mutex.hpp>
+
+#include <deque>
 #include <string>
 
 namespace oak {
 
 class InputEngine;
 class GraphicsEngine;
+class JobQueue;
 class ScriptEngine;
+class Thread;
 class WorldManager;
 
 class Application: public InputListener
 {
 	public:
+		Application();
+		
+		// number of frames in flight: 1 runs simulation and rendering in
+		// sequence, 2 or 3 run the simulation on a separate thread, one or two
+		// frames ahead of the rendering; must be set before initialize()
+		void setRenderPipelineDepth(unsigned int depth);
+		
+		// size of the screen in pixels, can be called before initialize() and on resizes
+		void setScreenSize(unsigned int width, unsigned int height);
+		
 		void initialize(const std::string &baseFolder);
 		void shutdown();
 		
+		// to be called from the thread owning the graphics context
 		void update();
 		
+		GraphicsEngine *getGraphicsEngine() const { return this->graphics; }
+		
 		// InputListener
 		virtual void pointerDown(unsigned int pointerId, unsigned int button, glm::vec2 position);
 		virtual void pointerUp(unsigned int pointerId, unsigned int button, glm::vec2 position);
 		virtual void pointerMove(unsigned int pointerId, glm::vec2 position, glm::vec2 movement);
 		
 	private:
+		void simulateFrame();
+		static void simulationMain(void *userData);
+		
+		// pointer events are received on the driver thread, and forwarded to
+		// scripts on the simulation thread
+		struct PointerEvent
+		{
+			enum Type
+			{
+				Down,
+				Up,
+				Move
+			};
+			
+			Type type;
+			unsigned int pointerId;
+			unsigned int button;
+			glm::vec2 position;
+			glm::vec2 movement;
+		};
+		void queuePointerEvent(const PointerEvent &event);
+		void dispatchPointerEvents();
+		
+		unsigned int renderPipelineDepth;
+		unsigned int screenWidth;
+		unsigned int screenHeight;
+		
+		Thread *simulationThread;
+		volatile int stopping;
+		volatile int simulationFinished;
+		
+		Mutex pointerEventMutex;
+		typedef std::deque<PointerEvent> PointerEventQueue;
+		PointerEventQueue pointerEvents;
+		
+		JobQueue *jobQueue;
 		WorldManager *worldManager;
 		InputEngine *input;
 		GraphicsEngine *graphics;
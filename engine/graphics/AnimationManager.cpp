@@ -0,0 +1,472 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/AnimationManager.hpp>
+
+#include <engine/system/File.hpp>
+#include <engine/system/Log.hpp>
+#include <engine/system/Simd.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace oak {
+
+namespace { // private section
+
+// Layout of the cooked files, written by tools/animation-cooker; integers and
+// floats are 32-bit little-endian values, keys 16-bit little-endian values:
+//
+//   skinned meshes:
+//   "OSKN", version, boneCount, vertexCount
+//   bounding sphere: center x, y, z, radius
+//   for each bone, parents first: parent index (-1 for the roots), rest
+//   translation x, y, z, rotation x, y, z, w, scale x, y, z, then the first
+//   three rows of the inverse bind matrix
+//   for each vertex: position, normal and uv floats, then 4 bone indices and
+//   4 weights summing to 255, as bytes
+//
+//   animations:
+//   "OANM", version, boneCount, frameCount, frameRate
+//   for each bone, a rotation, a translation and a scale track:
+//     keyCount, then the frame of each key, padded to 4 bytes
+//     rotations: x, y, z, w of each key, as signed values over 32767
+//     translations and scales: minimum x, y, z and extent x, y, z floats, then
+//     x, y, z of each key over 65535, padded to 4 bytes
+const char skinnedMeshMagic[4] = { 'O', 'S', 'K', 'N' };
+const char animationMagic[4] = { 'O', 'A', 'N', 'M' };
+const unsigned int animationVersion = 1;
+const unsigned int floatsPerVertex = 8;
+const unsigned int bytesPerVertex = floatsPerVertex * 4 + 8;
+
+// order of the rest transform components in skinned mesh files
+const Pose::Stream restStreams[10] =
+{
+	Pose::TranslationX, Pose::TranslationY, Pose::TranslationZ,
+	Pose::RotationX, Pose::RotationY, Pose::RotationZ, Pose::RotationW,
+	Pose::ScaleX, Pose::ScaleY, Pose::ScaleZ
+};
+
+// sequential reading of a file in memory, with bound checks
+class AnimationFileReader
+{
+	public:
+		AnimationFileReader(const std::vector<char> &content)
+			: content(content)
+			, offset(0)
+		{}
+		
+		bool readInteger(unsigned int *value)
+		{
+			const unsigned char *data = (const unsigned char *)this->read(4);
+			if (!data)
+				return false;
+			
+			*value = data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+			return true;
+		}
+		
+		bool readFloat(float *value)
+		{
+			unsigned int bits;
+			if (!this->readInteger(&bits))
+				return false;
+			
+			memcpy(value, &bits, sizeof(float));
+			return true;
+		}
+		
+		bool readFloats(float *values, unsigned int count)
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (!this->readFloat(&values[i]))
+					return false;
+			}
+			
+			return true;
+		}
+		
+		// count values, then the padding up to 4 bytes
+		bool readShorts(std::vector<unsigned short> *values, unsigned int count)
+		{
+			const unsigned char *data = (const unsigned char *)this->read((count * 2 + 3) & ~3u);
+			if (!data)
+				return false;
+			
+			for (unsigned int i = 0; i < count; i++)
+				values->push_back((unsigned short)(data[i * 2] | (data[i * 2 + 1] << 8)));
+			
+			return true;
+		}
+		
+		// returns NULL past the end of the file
+		const char *read(unsigned int size)
+		{
+			if (size > this->content.size() - this->offset)
+				return NULL;
+			
+			const char *data = &this->content[this->offset];
+			this->offset += size;
+			
+			return data;
+		}
+	
+	private:
+		const std::vector<char> &content;
+		unsigned int offset;
+};
+
+} // end of private section
+
+SkinnedMeshResource::SkinnedMeshResource(const std::string &path)
+	: path(path)
+	, failed(false)
+	, buffer(NULL)
+	, boundingCenter(0.0f)
+	, boundingRadius(0.0f)
+{
+}
+
+AnimationResource::AnimationResource(const std::string &path)
+	: path(path)
+	, failed(false)
+	, boneCount(0)
+	, frameCount(0)
+	, frameRate(0.0f)
+{
+}
+
+float AnimationResource::getDuration() const
+{
+	return (this->frameCount > 1) ? (float)(this->frameCount - 1) / this->frameRate : 0.0f;
+}
+
+void AnimationResource::sample(float time, Pose *pose) const
+{
+	OAK_ASSERT(pose->getBoneCount() == this->boneCount, "Sampling an animation with another skeleton");
+	if (this->failed)
+		return;
+	
+	float frame = glm::clamp(time * this->frameRate, 0.0f, (float)(this->frameCount - 1));
+	unsigned short frameIndex = (unsigned short)frame;
+	
+	// the keys around the frame are gathered for four bones, then decoded at once;
+	// padding lanes decode to the identity
+	static const unsigned int componentCounts[ChannelCount] = { 4, 3, 3 };
+	static const float identityRotation[4] = { 0.0f, 0.0f, 0.0f, 32767.0f };
+	for (unsigned int i = 0; i < pose->getPaddedBoneCount(); i += 4)
+	{
+		for (int channel = 0; channel < ChannelCount; channel++)
+		{
+			const KeyArrays &keys = this->channels[channel];
+			unsigned int componentCount = componentCounts[channel];
+			
+			float values0[4][4];
+			float values1[4][4];
+			float fractions[4];
+			for (unsigned int lane = 0; lane < 4; lane++)
+			{
+				unsigned int bone = i + lane;
+				fractions[lane] = 0.0f;
+				if (bone >= this->boneCount)
+				{
+					for (unsigned int j = 0; j < componentCount; j++)
+					{
+						values0[j][lane] = (channel == RotationChannel) ? identityRotation[j] : 0.0f;
+						values1[j][lane] = values0[j][lane];
+					}
+					continue;
+				}
+				
+				// last key at or before the frame, and the next one
+				const Track &track = keys.tracks[bone];
+				const unsigned short *firstFrame = &keys.frames[track.firstKey];
+				unsigned int key0 = (unsigned int)(std::upper_bound(firstFrame, firstFrame + track.keyCount, frameIndex) - firstFrame);
+				key0 = (key0 > 0) ? key0 - 1 : 0;
+				unsigned int key1 = std::min(key0 + 1, track.keyCount - 1);
+				if (key1 != key0)
+					fractions[lane] = glm::clamp((frame - (float)firstFrame[key0]) / (float)(firstFrame[key1] - firstFrame[key0]), 0.0f, 1.0f);
+				
+				const unsigned short *raw0 = &keys.values[(track.firstKey + key0) * componentCount];
+				const unsigned short *raw1 = &keys.values[(track.firstKey + key1) * componentCount];
+				for (unsigned int j = 0; j < componentCount; j++)
+				{
+					values0[j][lane] = (channel == RotationChannel) ? (float)(short)raw0[j] : (float)raw0[j];
+					values1[j][lane] = (channel == RotationChannel) ? (float)(short)raw1[j] : (float)raw1[j];
+				}
+			}
+			
+			Float4 fraction = Simd::load(fractions);
+			Float4 components[4];
+			for (unsigned int j = 0; j < componentCount; j++)
+			{
+				Float4 value0 = Simd::load(values0[j]);
+				components[j] = Simd::add(value0, Simd::mul(Simd::sub(Simd::load(values1[j]), value0), fraction));
+			}
+			
+			if (channel == RotationChannel)
+			{
+				// nlerp, the scale of the quantization goes away with the normalization
+				Float4 squaredLength = Simd::set(1e-12f);
+				for (unsigned int j = 0; j < 4; j++)
+					squaredLength = Simd::add(squaredLength, Simd::mul(components[j], components[j]));
+				Float4 inverseLength = Simd::div(Simd::set(1.0f), Simd::sqrt(squaredLength));
+				
+				for (unsigned int j = 0; j < 4; j++)
+					Simd::store(pose->getStream((Pose::Stream)(Pose::RotationX + j)) + i, Simd::mul(components[j], inverseLength));
+			}
+			else
+			{
+				Pose::Stream firstStream = (channel == TranslationChannel) ? Pose::TranslationX : Pose::ScaleX;
+				Float4 scale = Simd::set(1.0f / 65535.0f);
+				for (unsigned int j = 0; j < 3; j++)
+				{
+					Pose::Stream stream = (Pose::Stream)(firstStream + j);
+					Float4 minimum = Simd::load(this->minimums.getStream(stream) + i);
+					Float4 extent = Simd::load(this->extents.getStream(stream) + i);
+					Simd::store(pose->getStream(stream) + i, Simd::add(minimum, Simd::mul(extent, Simd::mul(components[j], scale))));
+				}
+			}
+		}
+	}
+}
+
+AnimationManager::AnimationManager(GraphicDriver *driver)
+	: driver(driver)
+{
+}
+
+AnimationManager::~AnimationManager()
+{
+	for (SkinnedMeshMap::iterator it = this->skinnedMeshes.begin(); it != this->skinnedMeshes.end(); ++it)
+	{
+		if (it->second->buffer)
+			this->driver->destroyVertexBuffer(it->second->buffer);
+		
+		delete it->second;
+	}
+	
+	for (AnimationMap::iterator it = this->animations.begin(); it != this->animations.end(); ++it)
+		delete it->second;
+}
+
+SkinnedMeshResource *AnimationManager::loadSkinnedMesh(const std::string &path)
+{
+	SkinnedMeshMap::iterator it = this->skinnedMeshes.find(path);
+	if (it != this->skinnedMeshes.end())
+		return it->second;
+	
+	SkinnedMeshResource *resource = new SkinnedMeshResource(path);
+	this->skinnedMeshes[path] = resource;
+	
+	if (!this->read(resource))
+	{
+		resource->failed = true;
+		resource->parents.clear();
+		resource->inverseBindMatrices.clear();
+		resource->restPose.resize(0);
+		resource->vertices.clear();
+	}
+	
+	return resource;
+}
+
+AnimationResource *AnimationManager::loadAnimation(const std::string &path)
+{
+	AnimationMap::iterator it = this->animations.find(path);
+	if (it != this->animations.end())
+		return it->second;
+	
+	AnimationResource *resource = new AnimationResource(path);
+	this->animations[path] = resource;
+	
+	if (!this->read(resource))
+		resource->failed = true;
+	
+	return resource;
+}
+
+bool AnimationManager::read(SkinnedMeshResource *resource)
+{
+	std::vector<char> content;
+	if (!File::read(resource->path, &content))
+	{
+		Log::error("Failed to open skinned mesh '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	AnimationFileReader reader(content);
+	
+	const char *magic = reader.read(4);
+	unsigned int version = 0;
+	unsigned int boneCount = 0;
+	unsigned int vertexCount = 0;
+	bool valid = (magic && memcmp(magic, skinnedMeshMagic, 4) == 0);
+	valid = valid && reader.readInteger(&version) && version == animationVersion;
+	valid = valid && reader.readInteger(&boneCount) && boneCount > 0 && boneCount <= 256;
+	valid = valid && reader.readInteger(&vertexCount) && vertexCount > 0 && vertexCount % 3 == 0;
+	valid = valid && reader.readFloat(&resource->boundingCenter.x) && reader.readFloat(&resource->boundingCenter.y) && reader.readFloat(&resource->boundingCenter.z);
+	valid = valid && reader.readFloat(&resource->boundingRadius);
+	
+	if (valid)
+		resource->restPose.resize(boneCount);
+	
+	for (unsigned int i = 0; valid && i < boneCount; i++)
+	{
+		unsigned int parent = 0;
+		float transform[10];
+		float rows[12];
+		valid = reader.readInteger(&parent) && reader.readFloats(transform, 10) && reader.readFloats(rows, 12);
+		
+		// parents first, so that the hierarchy is walked in order
+		valid = valid && (int)parent >= -1 && (int)parent < (int)i;
+		if (!valid)
+			break;
+		
+		resource->parents.push_back((int)parent);
+		for (int j = 0; j < 10; j++)
+			resource->restPose.getStream(restStreams[j])[i] = transform[j];
+		
+		glm::mat4 inverseBindMatrix(1.0f);
+		for (int row = 0; row < 3; row++)
+		{
+			for (int column = 0; column < 4; column++)
+				inverseBindMatrix[column][row] = rows[row * 4 + column];
+		}
+		resource->inverseBindMatrices.push_back(inverseBindMatrix);
+	}
+	
+	const char *data = valid ? reader.read(vertexCount * bytesPerVertex) : NULL;
+	valid = (data != NULL);
+	
+	if (!valid)
+	{
+		Log::error("Invalid skinned mesh file '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	resource->vertices.resize(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const char *vertexData = data + i * bytesPerVertex;
+		float values[floatsPerVertex];
+		memcpy(values, vertexData, sizeof(values));
+		
+		GraphicDriver::SkinnedVertex &vertex = resource->vertices[i];
+		vertex.position = glm::vec3(values[0], values[1], values[2]);
+		vertex.normal = glm::vec3(values[3], values[4], values[5]);
+		vertex.uv = glm::vec2(values[6], values[7]);
+		memcpy(vertex.bones, vertexData + sizeof(values), 4);
+		memcpy(vertex.weights, vertexData + sizeof(values) + 4, 4);
+		
+		// bones out of the skeleton would read past the shader constants
+		for (int j = 0; j < 4; j++)
+		{
+			if (vertex.bones[j] >= boneCount)
+			{
+				vertex.bones[j] = 0;
+				vertex.weights[j] = 0;
+			}
+		}
+	}
+	
+	resource->buffer = this->driver->createVertexBuffer(&resource->vertices[0], vertexCount);
+	
+	return true;
+}
+
+bool AnimationManager::read(AnimationResource *resource)
+{
+	std::vector<char> content;
+	if (!File::read(resource->path, &content))
+	{
+		Log::error("Failed to open animation '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	AnimationFileReader reader(content);
+	
+	const char *magic = reader.read(4);
+	unsigned int version = 0;
+	bool valid = (magic && memcmp(magic, animationMagic, 4) == 0);
+	valid = valid && reader.readInteger(&version) && version == animationVersion;
+	valid = valid && reader.readInteger(&resource->boneCount) && resource->boneCount > 0 && resource->boneCount <= 256;
+	valid = valid && reader.readInteger(&resource->frameCount) && resource->frameCount > 0 && resource->frameCount <= 65536;
+	valid = valid && reader.readFloat(&resource->frameRate) && resource->frameRate > 0.0f;
+	
+	if (valid)
+	{
+		resource->minimums.resize(resource->boneCount);
+		resource->extents.resize(resource->boneCount);
+	}
+	
+	for (unsigned int i = 0; valid && i < resource->boneCount; i++)
+	{
+		for (int channel = 0; valid && channel < AnimationResource::ChannelCount; channel++)
+		{
+			AnimationResource::KeyArrays &keys = resource->channels[channel];
+			
+			AnimationResource::Track track;
+			track.firstKey = (unsigned int)keys.frames.size();
+			valid = reader.readInteger(&track.keyCount) && track.keyCount > 0 && track.keyCount <= resource->frameCount;
+			valid = valid && reader.readShorts(&keys.frames, track.keyCount);
+			if (!valid)
+				break;
+			
+			// frames must increase, for the binary search
+			for (unsigned int j = 1; j < track.keyCount; j++)
+				valid = valid && keys.frames[track.firstKey + j - 1] < keys.frames[track.firstKey + j];
+			valid = valid && keys.frames.back() < resource->frameCount;
+			
+			if (valid && channel != AnimationResource::RotationChannel)
+			{
+				float range[6];
+				valid = reader.readFloats(range, 6);
+				
+				Pose::Stream firstStream = (channel == AnimationResource::TranslationChannel) ? Pose::TranslationX : Pose::ScaleX;
+				for (int j = 0; valid && j < 3; j++)
+				{
+					resource->minimums.getStream((Pose::Stream)(firstStream + j))[i] = range[j];
+					resource->extents.getStream((Pose::Stream)(firstStream + j))[i] = range[3 + j];
+				}
+			}
+			
+			unsigned int componentCount = (channel == AnimationResource::RotationChannel) ? 4 : 3;
+			valid = valid && reader.readShorts(&keys.values, track.keyCount * componentCount);
+			keys.tracks.push_back(track);
+		}
+	}
+	
+	if (!valid)
+	{
+		Log::error("Invalid animation file '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	return true;
+}
+
+} // oak namespace
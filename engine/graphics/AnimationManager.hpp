@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/Pose.hpp>
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace oak {
+
+class AnimationManager;
+
+/**
+ * Skinned mesh loaded by the animation manager: a skeleton and the triangles
+ * it deforms, each vertex bound to up to four bones.
+ */
+class SkinnedMeshResource
+{
+	public:
+		const std::string &getPath() const { return this->path; }
+		bool hasFailed() const { return this->failed; }
+		
+		// bones are ordered so that parents come before their children
+		unsigned int getBoneCount() const { return (unsigned int)this->parents.size(); }
+		const std::vector<int> &getParents() const { return this->parents; }
+		const std::vector<glm::mat4> &getInverseBindMatrices() const { return this->inverseBindMatrices; }
+		
+		// local transforms of the bones, for the weight no animation takes
+		const Pose &getRestPose() const { return this->restPose; }
+		
+		// triangle list, in the buffer and kept on the CPU for skinning without shader
+		VertexBuffer *getVertexBuffer() const { return this->buffer; }
+		const std::vector<GraphicDriver::SkinnedVertex> &getVertices() const { return this->vertices; }
+		
+		// bounding sphere of all the animation frames known when cooked, in local space
+		const glm::vec3 &getBoundingCenter() const { return this->boundingCenter; }
+		float getBoundingRadius() const { return this->boundingRadius; }
+	
+	private:
+		friend class AnimationManager;
+		
+		SkinnedMeshResource(const std::string &path);
+		
+		std::string path;
+		bool failed;
+		
+		std::vector<int> parents;
+		std::vector<glm::mat4> inverseBindMatrices;
+		Pose restPose;
+		
+		VertexBuffer *buffer;
+		std::vector<GraphicDriver::SkinnedVertex> vertices;
+		
+		glm::vec3 boundingCenter;
+		float boundingRadius;
+};
+
+/**
+ * Animation clip loaded by the animation manager, for the skeleton it was
+ * cooked with. Each bone has a track per transform component, holding the
+ * keyframes left after reduction, quantized on 16 bits; the frames between
+ * keys are interpolated linearly.
+ */
+class AnimationResource
+{
+	public:
+		const std::string &getPath() const { return this->path; }
+		bool hasFailed() const { return this->failed; }
+		
+		unsigned int getBoneCount() const { return this->boneCount; }
+		
+		// in seconds, from the first frame to the last one
+		float getDuration() const;
+		
+		// Decode the transforms at the given time, clamped to the clip, four bones
+		// at a time; the pose must be sized for the skeleton.
+		void sample(float time, Pose *pose) const;
+	
+	private:
+		friend class AnimationManager;
+		
+		AnimationResource(const std::string &path);
+		
+		enum Channel
+		{
+			RotationChannel, // quaternions, as signed values over 32767
+			TranslationChannel, // between a minimum and a maximum per bone, over 65535
+			ScaleChannel,
+			ChannelCount
+		};
+		
+		// keys of a bone in the arrays of its channel
+		struct Track
+		{
+			unsigned int firstKey;
+			unsigned int keyCount;
+		};
+		
+		// tracks of all bones, then the frame and the raw components of their keys
+		struct KeyArrays
+		{
+			std::vector<Track> tracks;
+			std::vector<unsigned short> frames;
+			std::vector<unsigned short> values;
+		};
+		
+		std::string path;
+		bool failed;
+		
+		unsigned int boneCount;
+		unsigned int frameCount;
+		float frameRate;
+		
+		KeyArrays channels[ChannelCount];
+		
+		// minimum and extent of each translation and scale component, in one array
+		// per component as the poses; padding bones get the identity
+		Pose minimums;
+		Pose extents;
+};
+
+/**
+ * Loads cooked skinned meshes (.oskin files) and animation clips (.oanim
+ * files), see tools/animation-cooker. Like meshes, they are read right away,
+ * when first requested.
+ */
+class AnimationManager
+{
+	public:
+		AnimationManager(GraphicDriver *driver);
+		~AnimationManager();
+		
+		// load a file, or return the resource already loaded from it
+		SkinnedMeshResource *loadSkinnedMesh(const std::string &path);
+		AnimationResource *loadAnimation(const std::string &path);
+	
+	private:
+		bool read(SkinnedMeshResource *resource);
+		bool read(AnimationResource *resource);
+		
+		GraphicDriver *driver;
+		
+		// all resources, by path
+		typedef std::map<std::string, SkinnedMeshResource *> SkinnedMeshMap;
+		SkinnedMeshMap skinnedMeshes;
+		typedef std::map<std::string, AnimationResource *> AnimationMap;
+		AnimationMap animations;
+};
+
+} // oak namespace
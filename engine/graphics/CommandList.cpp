@@ -0,0 +1,253 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/CommandList.hpp>
+
+#include <glm/gtc/type_ptr.hpp>
+
+namespace oak {
+
+void CommandList::clear()
+{
+	this->commands.clear();
+	this->data.clear();
+}
+
+void CommandList::bindShaderProgram(ShaderProgram *program)
+{
+	Command command;
+	command.type = BindShaderProgramCommand;
+	command.program = program;
+	command.arg0 = 0;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::bindVertexBuffer(VertexBuffer *buffer)
+{
+	Command command;
+	command.type = BindVertexBufferCommand;
+	command.buffer = buffer;
+	command.arg0 = 0;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::bindTexture(Texture *texture, unsigned int unit)
+{
+	Command command;
+	command.type = BindTextureCommand;
+	command.texture = texture;
+	command.arg0 = unit;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::bindRenderTarget(RenderTarget *target)
+{
+	Command command;
+	command.type = BindRenderTargetCommand;
+	command.renderTarget = target;
+	command.arg0 = 0;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::setViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	// floats hold these integers exactly
+	float area[] = { (float)x, (float)y, (float)width, (float)height };
+	this->pushConstant(SetViewportCommand, NULL, area, 4);
+}
+
+void CommandList::clearBuffers(const glm::vec3 &color, bool colorBuffer, bool depthBuffer)
+{
+	Command command;
+	command.type = ClearCommand;
+	command.name = NULL;
+	command.arg0 = (unsigned int)this->data.size();
+	command.arg1 = (colorBuffer ? 1 : 0) | (depthBuffer ? 2 : 0);
+	
+	this->data.insert(this->data.end(), glm::value_ptr(color), glm::value_ptr(color) + 3);
+	this->commands.push_back(command);
+}
+
+void CommandList::setShaderConstant(const char *name, int value)
+{
+	Command command;
+	command.type = SetIntConstantCommand;
+	command.name = name;
+	command.arg0 = (unsigned int)value;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::setShaderConstant(const char *name, float value)
+{
+	this->pushConstant(SetFloatConstantCommand, name, &value, 1);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::vec2 &value)
+{
+	this->pushConstant(SetVec2ConstantCommand, name, glm::value_ptr(value), 2);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::vec3 &value)
+{
+	this->pushConstant(SetVec3ConstantCommand, name, glm::value_ptr(value), 3);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::vec4 &value)
+{
+	this->pushConstant(SetVec4ConstantCommand, name, glm::value_ptr(value), 4);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::mat3 &value)
+{
+	this->pushConstant(SetMat3ConstantCommand, name, glm::value_ptr(value), 9);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::mat4 &value)
+{
+	this->pushConstant(SetMat4ConstantCommand, name, glm::value_ptr(value), 16);
+}
+
+void CommandList::setShaderConstant(const char *name, const glm::vec4 *values, unsigned int count)
+{
+	this->pushConstant(SetVec4ArrayConstantCommand, name, glm::value_ptr(values[0]), count * 4);
+}
+
+void CommandList::draw(GraphicDriver::PrimitiveType primitiveType, unsigned int startElement, unsigned int elementCount)
+{
+	Command command;
+	command.type = DrawCommand;
+	command.primitiveType = primitiveType;
+	command.arg0 = startElement;
+	command.arg1 = elementCount;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::setBlendMode(GraphicDriver::BlendMode mode)
+{
+	Command command;
+	command.type = SetBlendModeCommand;
+	command.blendMode = mode;
+	command.arg0 = 0;
+	command.arg1 = 0;
+	
+	this->commands.push_back(command);
+}
+
+void CommandList::execute(GraphicDriver *driver) const
+{
+	ShaderProgram *currentProgram = NULL;
+	VertexBuffer *currentBuffer = NULL;
+	
+	for (unsigned int i = 0; i < this->commands.size(); i++)
+	{
+		const Command &command = this->commands[i];
+		
+		switch (command.type)
+		{
+			case BindShaderProgramCommand:
+			{
+				if (command.program != currentProgram)
+				{
+					driver->bindShaderProgram(command.program);
+					currentProgram = command.program;
+					
+					// vertex attributes are bound to the current program
+					currentBuffer = NULL;
+				}
+				break;
+			}
+			
+			case BindVertexBufferCommand:
+			{
+				if (command.buffer != currentBuffer)
+				{
+					driver->bindVertexBuffer(command.buffer);
+					currentBuffer = command.buffer;
+				}
+				break;
+			}
+			
+			case BindTextureCommand: driver->bindTexture(command.texture, command.arg0); break;
+			case BindRenderTargetCommand: driver->bindRenderTarget(command.renderTarget); break;
+			
+			case SetViewportCommand:
+			{
+				const float *area = &this->data[command.arg0];
+				driver->setViewport((unsigned int)area[0], (unsigned int)area[1], (unsigned int)area[2], (unsigned int)area[3]);
+				break;
+			}
+			
+			case ClearCommand:
+			{
+				driver->setClearColor(glm::make_vec3(&this->data[command.arg0]));
+				driver->setClearDepth(1.0f);
+				driver->clear((command.arg1 & 1) != 0, (command.arg1 & 2) != 0);
+				break;
+			}
+			
+			case SetIntConstantCommand: driver->setShaderConstant(command.name, (int)command.arg0); break;
+			case SetFloatConstantCommand: driver->setShaderConstant(command.name, this->data[command.arg0]); break;
+			case SetVec2ConstantCommand: driver->setShaderConstant(command.name, glm::make_vec2(&this->data[command.arg0])); break;
+			case SetVec3ConstantCommand: driver->setShaderConstant(command.name, glm::make_vec3(&this->data[command.arg0])); break;
+			case SetVec4ConstantCommand: driver->setShaderConstant(command.name, glm::make_vec4(&this->data[command.arg0])); break;
+			case SetMat3ConstantCommand: driver->setShaderConstant(command.name, glm::make_mat3(&this->data[command.arg0])); break;
+			case SetMat4ConstantCommand: driver->setShaderConstant(command.name, glm::make_mat4(&this->data[command.arg0])); break;
+			case SetVec4ArrayConstantCommand: driver->setShaderConstant(command.name, (const glm::vec4 *)&this->data[command.arg0], command.arg1 / 4); break;
+			
+			case DrawCommand:
+			{
+				driver->draw(command.primitiveType, command.arg0, command.arg1);
+				break;
+			}
+			
+			case SetBlendModeCommand: driver->setBlendMode(command.blendMode); break;
+		}
+	}
+}
+
+void CommandList::pushConstant(CommandType type, const char *name, const float *values, unsigned int valueCount)
+{
+	Command command;
+	command.type = type;
+	command.name = name;
+	command.arg0 = (unsigned int)this->data.size();
+	command.arg1 = valueCount;
+	
+	this->data.insert(this->data.end(), values, values + valueCount);
+	this->commands.push_back(command);
+}
+
+} // oak namespace
@@ -0,0 +1,136 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+/**
+ * Backend-agnostic recording of GraphicDriver calls.
+ *
+ * Lists can be filled from any thread, since recording does not touch
+ * the driver. They are then replayed on the thread owning the driver.
+ * Shader constant names are stored as pointers and must outlive the list
+ * (string literals are expected).
+ */
+class CommandList
+{
+	public:
+		// forget recorded commands, but keep allocated memory for the next recording
+		void clear();
+		
+		bool isEmpty() const { return this->commands.empty(); }
+		unsigned int getCommandCount() const { return (unsigned int)this->commands.size(); }
+		
+		void bindShaderProgram(ShaderProgram *program);
+		void bindVertexBuffer(VertexBuffer *buffer);
+		void bindTexture(Texture *texture, unsigned int unit);
+		
+		// draw into a render target (NULL for the screen), in the given area of it
+		void bindRenderTarget(RenderTarget *target);
+		void setViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+		
+		// clear the viewport area of the current target, depth to the far plane
+		void clearBuffers(const glm::vec3 &color, bool colorBuffer, bool depthBuffer);
+		
+		void setShaderConstant(const char *name, int value);
+		void setShaderConstant(const char *name, float value);
+		void setShaderConstant(const char *name, const glm::vec2 &value);
+		void setShaderConstant(const char *name, const glm::vec3 &value);
+		void setShaderConstant(const char *name, const glm::vec4 &value);
+		void setShaderConstant(const char *name, const glm::mat3 &value);
+		void setShaderConstant(const char *name, const glm::mat4 &value);
+		void setShaderConstant(const char *name, const glm::vec4 *values, unsigned int count); // array, copied
+		
+		void draw(GraphicDriver::PrimitiveType primitiveType, unsigned int startElement, unsigned int elementCount);
+		
+		// stays set for the next lists, which expect opaque draws
+		void setBlendMode(GraphicDriver::BlendMode mode);
+		
+		// replay the recorded commands, skipping redundant bindings
+		void execute(GraphicDriver *driver) const;
+	
+	private:
+		enum CommandType
+		{
+			BindShaderProgramCommand,
+			BindVertexBufferCommand,
+			BindTextureCommand,
+			BindRenderTargetCommand,
+			SetViewportCommand,
+			ClearCommand,
+			SetIntConstantCommand,
+			SetFloatConstantCommand,
+			SetVec2ConstantCommand,
+			SetVec3ConstantCommand,
+			SetVec4ConstantCommand,
+			SetMat3ConstantCommand,
+			SetMat4ConstantCommand,
+			SetVec4ArrayConstantCommand,
+			DrawCommand,
+			SetBlendModeCommand
+		};
+		
+		struct Command
+		{
+			CommandType type;
+			
+			union
+			{
+				ShaderProgram *program;
+				VertexBuffer *buffer;
+				Texture *texture;
+				RenderTarget *renderTarget;
+				const char *name;
+				GraphicDriver::PrimitiveType primitiveType;
+				GraphicDriver::BlendMode blendMode;
+			};
+			
+			// constants: offset in the data array, or value of integers, then the
+			// number of values
+			// draws: start element and element count
+			// textures: unit
+			// viewports: offset of the area in the data array
+			// clears: offset of the color in the data array, and cleared buffers (1 for color, 2 for depth)
+			unsigned int arg0;
+			unsigned int arg1;
+		};
+		
+		void pushConstant(CommandType type, const char *name, const float *values, unsigned int valueCount);
+		
+		typedef std::vector<Command> CommandVector;
+		CommandVector commands;
+		
+		// shader constant values, referenced by commands
+		std::vector<float> data;
+};
+
+} // oak namespace
@@ -0,0 +1,243 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef OAK_DEBUG
+
+#include <engine/graphics/DebugDraw.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+#include <engine/graphics/TextLayoutCache.hpp>
+#include <engine/graphics/components/Camera.hpp>
+
+#include <engine/graphics/shaders/debug.vs.h>
+#include <engine/graphics/shaders/debug.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+const float twoPi = 6.28318530718f;
+
+// segments of each of the three circles drawn around a sphere
+const unsigned int sphereSegmentCount = 24;
+
+// height of the label glyphs, in pixels
+const unsigned int labelSize = 16;
+
+unsigned char toByte(float value)
+{
+	return (unsigned char)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+} // end of private section
+
+DebugDraw::DebugDraw(GraphicDriver *driver)
+	: driver(driver)
+{
+	this->shader = this->driver->createShaderProgram(debugVSString, debugFSString);
+}
+
+DebugDraw::~DebugDraw()
+{
+	this->driver->destroyShaderProgram(this->shader);
+}
+
+void DebugDraw::drawLine(const glm::vec3 &from, const glm::vec3 &to, const glm::vec3 &color)
+{
+	unsigned char bytes[4] = { toByte(color.x), toByte(color.y), toByte(color.z), 255 };
+	this->addLine(LinePrimitive, from, to, bytes);
+}
+
+void DebugDraw::drawBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &color)
+{
+	glm::vec3 corners[8];
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		corners[i].x = (i & 1) ? maxCorner.x : minCorner.x;
+		corners[i].y = (i & 2) ? maxCorner.y : minCorner.y;
+		corners[i].z = (i & 4) ? maxCorner.z : minCorner.z;
+	}
+	this->addEdges(BoxPrimitive, corners, color);
+}
+
+void DebugDraw::drawSphere(const glm::vec3 &center, float radius, const glm::vec3 &color)
+{
+	// a circle around each axis
+	unsigned char bytes[4] = { toByte(color.x), toByte(color.y), toByte(color.z), 255 };
+	for (unsigned int axis = 0; axis < 3; axis++)
+	{
+		glm::vec3 previous;
+		for (unsigned int i = 0; i <= sphereSegmentCount; i++)
+		{
+			float angle = twoPi * (float)i / (float)sphereSegmentCount;
+			glm::vec3 offset(0.0f, 0.0f, 0.0f);
+			offset[(axis + 1) % 3] = std::cos(angle) * radius;
+			offset[(axis + 2) % 3] = std::sin(angle) * radius;
+			
+			glm::vec3 point = center + offset;
+			if (i > 0)
+				this->addLine(SpherePrimitive, previous, point, bytes);
+			previous = point;
+		}
+	}
+}
+
+void DebugDraw::drawFrustum(const glm::mat4 &viewProjectionMatrix, const glm::vec3 &color)
+{
+	// corners of the clip space cube, back in world space
+	glm::mat4 inverseMatrix = glm::inverse(viewProjectionMatrix);
+	glm::vec3 corners[8];
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner(((i & 1) ? 1.0f : -1.0f), ((i & 2) ? 1.0f : -1.0f), ((i & 4) ? 1.0f : -1.0f), 1.0f);
+		corner = inverseMatrix * corner;
+		corners[i] = glm::vec3(corner) / corner.w;
+	}
+	this->addEdges(FrustumPrimitive, corners, color);
+}
+
+void DebugDraw::drawCameraFrustum(const Camera *camera, const glm::vec3 &color)
+{
+	OAK_ASSERT(camera->getEntity(), "Drawing the frustum of a camera without entity");
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	this->drawFrustum(camera->getProjectionMatrix() * glm::affineInverse(cameraTransform), color);
+}
+
+void DebugDraw::drawLabel(const glm::vec3 &position, const std::string &text, const glm::vec3 &color)
+{
+	Label label;
+	label.position = position;
+	label.color = color;
+	label.text = text;
+	label.layout = NULL;
+	this->labels.push_back(label);
+}
+
+bool DebugDraw::hasLines() const
+{
+	for (int i = 0; i < PrimitiveTypeCount; i++)
+	{
+		if (!this->vertices[i].empty())
+			return true;
+	}
+	
+	return false;
+}
+
+void DebugDraw::prepareLabels(TextLayoutCache *layoutCache)
+{
+	for (unsigned int i = 0; i < this->labels.size(); i++)
+	{
+		Label &label = this->labels[i];
+		if (!label.layout)
+			label.layout = layoutCache->acquire(label.text, labelSize);
+		layoutCache->useGlyphs(label.layout);
+	}
+}
+
+void DebugDraw::recordLines(CommandList *commandList, const glm::mat4 &viewProjectionMatrix, StreamBuffer *streamBuffer) const
+{
+	OAK_ASSERT(streamBuffer->getFormat() == GraphicDriver::SpriteVertexFormat, "Debug lines are streamed as sprite vertices");
+	
+	// lines of a type that do not fit in the stream buffer are skipped
+	bool bound = false;
+	for (int i = 0; i < PrimitiveTypeCount; i++)
+	{
+		const VertexVector &vertices = this->vertices[i];
+		if (vertices.empty())
+			continue;
+		
+		unsigned int startElement = 0;
+		GraphicDriver::SpriteVertex *streamed = (GraphicDriver::SpriteVertex *)streamBuffer->allocate((unsigned int)vertices.size(), &startElement);
+		if (!streamed)
+			continue;
+		std::copy(vertices.begin(), vertices.end(), streamed);
+		
+		if (!bound)
+		{
+			commandList->bindShaderProgram(this->shader);
+			commandList->setShaderConstant("viewProjectionMatrix", viewProjectionMatrix);
+			commandList->bindVertexBuffer(streamBuffer->getVertexBuffer());
+			bound = true;
+		}
+		commandList->draw(GraphicDriver::Lines, startElement, (unsigned int)vertices.size());
+	}
+}
+
+void DebugDraw::clear(TextLayoutCache *layoutCache)
+{
+	for (int i = 0; i < PrimitiveTypeCount; i++)
+		this->vertices[i].clear();
+	
+	for (unsigned int i = 0; i < this->labels.size(); i++)
+	{
+		if (this->labels[i].layout)
+			layoutCache->release(this->labels[i].layout);
+	}
+	this->labels.clear();
+}
+
+void DebugDraw::addEdges(PrimitiveType type, const glm::vec3 *corners, const glm::vec3 &color)
+{
+	// corners differing by one bit
+	unsigned char bytes[4] = { toByte(color.x), toByte(color.y), toByte(color.z), 255 };
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		for (unsigned int bit = 1; bit < 8; bit <<= 1)
+		{
+			if (!(i & bit))
+				this->addLine(type, corners[i], corners[i | bit], bytes);
+		}
+	}
+}
+
+void DebugDraw::addLine(PrimitiveType type, const glm::vec3 &from, const glm::vec3 &to, const unsigned char *color)
+{
+	GraphicDriver::SpriteVertex ends[2];
+	ends[0].position = from;
+	ends[1].position = to;
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		ends[i].uv = glm::vec2(0.0f, 0.0f);
+		std::copy(color, color + 4, ends[i].color);
+	}
+	
+	this->vertices[type].push_back(ends[0]);
+	this->vertices[type].push_back(ends[1]);
+}
+
+} // oak namespace
+
+#endif // OAK_DEBUG
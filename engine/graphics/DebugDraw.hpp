@@ -0,0 +1,143 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace oak {
+
+class Camera;
+class CommandList;
+struct ShaderProgram;
+class StreamBuffer;
+class TextLayoutCache;
+struct TextLayout;
+
+/**
+ * Lines, boxes, spheres, frustums and labels drawn over the views of a world
+ * for a frame, to debug culling, bounds or physics without creating entities.
+ *
+ * Primitives are added from the simulation thread, drawn by every view of the
+ * world when the next frame is prepared, then dropped: they are added again
+ * each frame they should be seen. Primitives are expanded into lines when
+ * added, in one array per type; each view streams every array and draws it at
+ * once, after its sprites, so a type costs one draw however many primitives
+ * it holds. Lines are hidden by the scene, but not fogged. Labels are centered
+ * on the projection of their anchor, and drawn in one draw after the texts.
+ *
+ * Like logging, debug drawing is compiled out without OAK_DEBUG: the methods
+ * are then empty and inline, and nothing is kept nor drawn.
+ */
+class DebugDraw
+{
+	public:
+		// text centered on a point, laid out when the frame is prepared
+		struct Label
+		{
+			glm::vec3 position;
+			glm::vec3 color;
+			std::string text;
+			TextLayout *layout;
+		};
+		typedef std::vector<Label> LabelVector;
+		
+		#ifdef OAK_DEBUG
+			DebugDraw(GraphicDriver *driver);
+			~DebugDraw();
+			
+			void drawLine(const glm::vec3 &from, const glm::vec3 &to, const glm::vec3 &color);
+			void drawBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &color);
+			void drawSphere(const glm::vec3 &center, float radius, const glm::vec3 &color);
+			
+			// volume seen through a view-projection matrix, or by a camera
+			void drawFrustum(const glm::mat4 &viewProjectionMatrix, const glm::vec3 &color);
+			void drawCameraFrustum(const Camera *camera, const glm::vec3 &color);
+			
+			void drawLabel(const glm::vec3 &position, const std::string &text, const glm::vec3 &color);
+			
+			bool hasLines() const;
+			bool hasLabels() const { return !this->labels.empty(); }
+			
+			// Lay out the labels and use their glyphs in the atlas, when the frame is
+			// prepared (before the atlas update).
+			void prepareLabels(TextLayoutCache *layoutCache);
+			const LabelVector &getLabels() const { return this->labels; }
+			
+			// record the lines, one draw per primitive type, with vertices allocated
+			// from the given stream buffer (sprite vertex format)
+			void recordLines(CommandList *commandList, const glm::mat4 &viewProjectionMatrix, StreamBuffer *streamBuffer) const;
+			
+			// drop the primitives, once the frame is recorded
+			void clear(TextLayoutCache *layoutCache);
+		#else
+			DebugDraw(GraphicDriver *driver) {}
+			~DebugDraw() {}
+			
+			void drawLine(const glm::vec3 &from, const glm::vec3 &to, const glm::vec3 &color) {}
+			void drawBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &color) {}
+			void drawSphere(const glm::vec3 &center, float radius, const glm::vec3 &color) {}
+			void drawFrustum(const glm::mat4 &viewProjectionMatrix, const glm::vec3 &color) {}
+			void drawCameraFrustum(const Camera *camera, const glm::vec3 &color) {}
+			void drawLabel(const glm::vec3 &position, const std::string &text, const glm::vec3 &color) {}
+			
+			bool hasLines() const { return false; }
+			bool hasLabels() const { return false; }
+			void prepareLabels(TextLayoutCache *layoutCache) {}
+			void clear(TextLayoutCache *layoutCache) {}
+		#endif // OAK_DEBUG
+	
+	#ifdef OAK_DEBUG
+		private:
+			enum PrimitiveType
+			{
+				LinePrimitive,
+				BoxPrimitive,
+				SpherePrimitive,
+				FrustumPrimitive,
+				PrimitiveTypeCount
+			};
+			
+			// the twelve edges of a box given by its corners, numbered by bits (x, y, z)
+			void addEdges(PrimitiveType type, const glm::vec3 *corners, const glm::vec3 &color);
+			void addLine(PrimitiveType type, const glm::vec3 &from, const glm::vec3 &to, const unsigned char *color);
+			
+			GraphicDriver *driver;
+			ShaderProgram *shader;
+			
+			// line ends of each type, in world space
+			typedef std::vector<GraphicDriver::SpriteVertex> VertexVector;
+			VertexVector vertices[PrimitiveTypeCount];
+			
+			LabelVector labels;
+	#endif // OAK_DEBUG
+};
+
+} // oak namespace
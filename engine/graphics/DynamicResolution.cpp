@@ -0,0 +1,148 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/DynamicResolution.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// frames left to the GPU and the averages to settle after a change
+const unsigned int settleFrameCount = 15;
+
+// weight of each new frame in the average
+const float averageWeight = 0.1f;
+
+// above the budget by this ratio, frames are too long; below it, there is room to grow
+const float overBudgetRatio = 1.05f;
+const float underBudgetRatio = 0.85f;
+
+// smallest change, to avoid tiny adjustments
+const float scaleStep = 0.05f;
+
+// frames between probes for headroom, at first and at most
+const unsigned int minProbeInterval = 120;
+const unsigned int maxProbeInterval = 3840;
+
+} // end of private section
+
+DynamicResolution::DynamicResolution()
+	: enabled(false)
+	, frameBudget(1.0f / 60.0f)
+	, scale(1.0f)
+	, minScale(0.5f)
+	, averageFrameTime(0.0f)
+	, frameCount(0)
+	, probeInterval(minProbeInterval)
+	, probing(false)
+{
+}
+
+void DynamicResolution::setEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	this->frameCount = 0;
+	this->probeInterval = minProbeInterval;
+	this->probing = false;
+}
+
+void DynamicResolution::setFrameBudget(float frameBudget)
+{
+	OAK_ASSERT(frameBudget > 0.0f, "The frame budget must be positive");
+	this->frameBudget = frameBudget;
+	this->frameCount = 0;
+}
+
+void DynamicResolution::setScale(float scale)
+{
+	this->changeScale(scale);
+	this->probing = false;
+}
+
+void DynamicResolution::setMinScale(float minScale)
+{
+	OAK_ASSERT(minScale > 0.0f && minScale <= 1.0f, "The minimum scale must be in ]0, 1]");
+	this->minScale = minScale;
+	this->changeScale(this->scale);
+}
+
+void DynamicResolution::update(float frameTime)
+{
+	if (!this->enabled)
+		return;
+	
+	this->averageFrameTime = (this->frameCount == 0) ? frameTime : this->averageFrameTime + (frameTime - this->averageFrameTime) * averageWeight;
+	this->frameCount++;
+	
+	if (this->frameCount < settleFrameCount)
+		return;
+	
+	bool wasProbing = this->probing;
+	this->probing = false;
+	
+	if (this->averageFrameTime > this->frameBudget * overBudgetRatio)
+	{
+		// the cost is mostly proportional to the pixel count
+		float scale = this->scale * std::sqrt(this->frameBudget / this->averageFrameTime);
+		this->changeScale(std::min(scale, this->scale - scaleStep));
+		
+		// wait longer before the next probe
+		if (wasProbing)
+			this->probeInterval = std::min(this->probeInterval * 2, maxProbeInterval);
+		
+		return;
+	}
+	
+	// the probe held, the next one can come early
+	if (wasProbing)
+		this->probeInterval = minProbeInterval;
+	
+	if (this->averageFrameTime < this->frameBudget * underBudgetRatio)
+	{
+		this->changeScale(this->scale + scaleStep);
+	}
+	else if (this->frameCount >= this->probeInterval && this->scale < 1.0f)
+	{
+		this->changeScale(this->scale + scaleStep);
+		this->probing = true;
+	}
+}
+
+void DynamicResolution::changeScale(float scale)
+{
+	scale = std::max(this->minScale, std::min(scale, 1.0f));
+	if (scale == this->scale)
+		return;
+	
+	this->scale = scale;
+	this->frameCount = 0;
+}
+
+} // oak namespace
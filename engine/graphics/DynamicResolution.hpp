@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+namespace oak {
+
+/**
+ * Picks the resolution the screen views are drawn at, to hold a frame budget.
+ *
+ * Frame times are averaged over a few frames after each change, then compared
+ * to the budget: over it, the scale drops right away, in proportion to the
+ * excess area; well under it, the scale rises a step at a time. When frames are
+ * capped (vertical sync), times stay at the budget whatever the load, so the
+ * scale is also raised from time to time to probe for headroom; probes that
+ * fail are retried less and less often.
+ */
+class DynamicResolution
+{
+	public:
+		DynamicResolution();
+		
+		// when disabled, the scale only changes by hand
+		bool isEnabled() const { return this->enabled; }
+		void setEnabled(bool enabled);
+		
+		// in seconds
+		float getFrameBudget() const { return this->frameBudget; }
+		void setFrameBudget(float frameBudget);
+		
+		// scale of the screen resolution, in both dimensions
+		float getScale() const { return this->scale; }
+		void setScale(float scale);
+		
+		float getMinScale() const { return this->minScale; }
+		void setMinScale(float minScale);
+		
+		// account for the duration of the last frame, in seconds, and adapt the scale
+		void update(float frameTime);
+	
+	private:
+		void changeScale(float scale);
+		
+		bool enabled;
+		float frameBudget;
+		float scale;
+		float minScale;
+		
+		// frame times since the last change
+		float averageFrameTime;
+		unsigned int frameCount;
+		
+		// frames between probes, and whether the last change was one
+		unsigned int probeInterval;
+		bool probing;
+};
+
+} // oak namespace
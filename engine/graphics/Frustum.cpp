@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/Frustum.hpp>
+
+namespace oak {
+
+Frustum::Frustum(const glm::mat4 &viewProjectionMatrix)
+{
+	// extract planes from the rows of the view-projection matrix
+	glm::vec4 row0(viewProjectionMatrix[0][0], viewProjectionMatrix[1][0], viewProjectionMatrix[2][0], viewProjectionMatrix[3][0]);
+	glm::vec4 row1(viewProjectionMatrix[0][1], viewProjectionMatrix[1][1], viewProjectionMatrix[2][1], viewProjectionMatrix[3][1]);
+	glm::vec4 row2(viewProjectionMatrix[0][2], viewProjectionMatrix[1][2], viewProjectionMatrix[2][2], viewProjectionMatrix[3][2]);
+	glm::vec4 row3(viewProjectionMatrix[0][3], viewProjectionMatrix[1][3], viewProjectionMatrix[2][3], viewProjectionMatrix[3][3]);
+	
+	this->planes[LeftPlane] = row3 + row0;
+	this->planes[RightPlane] = row3 - row0;
+	this->planes[BottomPlane] = row3 + row1;
+	this->planes[TopPlane] = row3 - row1;
+	this->planes[NearPlane] = row3 + row2;
+	this->planes[FarPlane] = row3 - row2;
+	
+	// normalize so that plane distances are actual distances
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		float length = glm::length(glm::vec3(this->planes[i]));
+		this->planes[i] /= length;
+	}
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 &center, float radius) const
+{
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		const glm::vec4 &plane = this->planes[i];
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	}
+	
+	return true;
+}
+
+bool Frustum::intersectsBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const
+{
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		const glm::vec4 &plane = this->planes[i];
+		
+		// test the corner the furthest along the plane normal
+		glm::vec3 corner(
+			(plane.x >= 0.0f) ? maxCorner.x : minCorner.x,
+			(plane.y >= 0.0f) ? maxCorner.y : minCorner.y,
+			(plane.z >= 0.0f) ? maxCorner.z : minCorner.z
+		);
+		
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	
+	return true;
+}
+
+} // oak namespace
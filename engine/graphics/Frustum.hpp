@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+/**
+ * View frustum, stored as six world-space planes pointing inwards.
+ */
+class Frustum
+{
+	public:
+		Frustum() {}
+		Frustum(const glm::mat4 &viewProjectionMatrix);
+		
+		bool intersectsSphere(const glm::vec3 &center, float radius) const;
+		bool intersectsBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const;
+		
+		enum PlaneIndex
+		{
+			LeftPlane,
+			RightPlane,
+			BottomPlane,
+			TopPlane,
+			NearPlane,
+			FarPlane,
+			
+			PlaneCount
+		};
+		
+		// plane equation: dot(plane.xyz, point) + plane.w >= 0 inside the frustum
+		const glm::vec4 &getPlane(PlaneIndex index) const { return this->planes[index]; }
+	
+	private:
+		glm::vec4 planes[PlaneCount];
+};
+
+} // oak namespace
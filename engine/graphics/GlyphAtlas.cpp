@@ -0,0 +1,485 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/GlyphAtlas.hpp>
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// width and height of the atlas texture, in texels
+const unsigned int atlasSize = 512;
+
+// empty texels after each glyph, so that filtering never reaches the next one
+const unsigned int cellPadding = 1;
+
+// Printable ASCII (from 32 to 126) in 8x8 cells, one byte per row from the
+// top, the lowest bit being the leftmost pixel. Public domain font derived
+// from the IBM PC BIOS one.
+const unsigned int firstCharacter = 32;
+const unsigned int lastCharacter = 126;
+const unsigned int fontCellSize = 8;
+const unsigned char font[][8] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+	{ 0x18, 0x3c, 0x3c, 0x18, 0x18, 0x00, 0x18, 0x00 }, // !
+	{ 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+	{ 0x36, 0x36, 0x7f, 0x36, 0x7f, 0x36, 0x36, 0x00 }, // #
+	{ 0x0c, 0x3e, 0x03, 0x1e, 0x30, 0x1f, 0x0c, 0x00 }, // $
+	{ 0x00, 0x63, 0x33, 0x18, 0x0c, 0x66, 0x63, 0x00 }, // %
+	{ 0x1c, 0x36, 0x1c, 0x6e, 0x3b, 0x33, 0x6e, 0x00 }, // &
+	{ 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+	{ 0x18, 0x0c, 0x06, 0x06, 0x06, 0x0c, 0x18, 0x00 }, // (
+	{ 0x06, 0x0c, 0x18, 0x18, 0x18, 0x0c, 0x06, 0x00 }, // )
+	{ 0x00, 0x66, 0x3c, 0xff, 0x3c, 0x66, 0x00, 0x00 }, // *
+	{ 0x00, 0x0c, 0x0c, 0x3f, 0x0c, 0x0c, 0x00, 0x00 }, // +
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x06 }, // ,
+	{ 0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x00 }, // -
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00 }, // .
+	{ 0x60, 0x30, 0x18, 0x0c, 0x06, 0x03, 0x01, 0x00 }, // /
+	{ 0x3e, 0x63, 0x73, 0x7b, 0x6f, 0x67, 0x3e, 0x00 }, // 0
+	{ 0x0c, 0x0e, 0x0c, 0x0c, 0x0c, 0x0c, 0x3f, 0x00 }, // 1
+	{ 0x1e, 0x33, 0x30, 0x1c, 0x06, 0x33, 0x3f, 0x00 }, // 2
+	{ 0x1e, 0x33, 0x30, 0x1c, 0x30, 0x33, 0x1e, 0x00 }, // 3
+	{ 0x38, 0x3c, 0x36, 0x33, 0x7f, 0x30, 0x78, 0x00 }, // 4
+	{ 0x3f, 0x03, 0x1f, 0x30, 0x30, 0x33, 0x1e, 0x00 }, // 5
+	{ 0x1c, 0x06, 0x03, 0x1f, 0x33, 0x33, 0x1e, 0x00 }, // 6
+	{ 0x3f, 0x33, 0x30, 0x18, 0x0c, 0x0c, 0x0c, 0x00 }, // 7
+	{ 0x1e, 0x33, 0x33, 0x1e, 0x33, 0x33, 0x1e, 0x00 }, // 8
+	{ 0x1e, 0x33, 0x33, 0x3e, 0x30, 0x18, 0x0e, 0x00 }, // 9
+	{ 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x0c, 0x0c, 0x00 }, // :
+	{ 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x0c, 0x0c, 0x06 }, // ;
+	{ 0x18, 0x0c, 0x06, 0x03, 0x06, 0x0c, 0x18, 0x00 }, // <
+	{ 0x00, 0x00, 0x3f, 0x00, 0x00, 0x3f, 0x00, 0x00 }, // =
+	{ 0x06, 0x0c, 0x18, 0x30, 0x18, 0x0c, 0x06, 0x00 }, // >
+	{ 0x1e, 0x33, 0x30, 0x18, 0x0c, 0x00, 0x0c, 0x00 }, // ?
+	{ 0x3e, 0x63, 0x7b, 0x7b, 0x7b, 0x03, 0x1e, 0x00 }, // @
+	{ 0x0c, 0x1e, 0x33, 0x33, 0x3f, 0x33, 0x33, 0x00 }, // A
+	{ 0x3f, 0x66, 0x66, 0x3e, 0x66, 0x66, 0x3f, 0x00 }, // B
+	{ 0x3c, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3c, 0x00 }, // C
+	{ 0x1f, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1f, 0x00 }, // D
+	{ 0x7f, 0x46, 0x16, 0x1e, 0x16, 0x46, 0x7f, 0x00 }, // E
+	{ 0x7f, 0x46, 0x16, 0x1e, 0x16, 0x06, 0x0f, 0x00 }, // F
+	{ 0x3c, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7c, 0x00 }, // G
+	{ 0x33, 0x33, 0x33, 0x3f, 0x33, 0x33, 0x33, 0x00 }, // H
+	{ 0x1e, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x1e, 0x00 }, // I
+	{ 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1e, 0x00 }, // J
+	{ 0x67, 0x66, 0x36, 0x1e, 0x36, 0x66, 0x67, 0x00 }, // K
+	{ 0x0f, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7f, 0x00 }, // L
+	{ 0x63, 0x77, 0x7f, 0x7f, 0x6b, 0x63, 0x63, 0x00 }, // M
+	{ 0x63, 0x67, 0x6f, 0x7b, 0x73, 0x63, 0x63, 0x00 }, // N
+	{ 0x1c, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1c, 0x00 }, // O
+	{ 0x3f, 0x66, 0x66, 0x3e, 0x06, 0x06, 0x0f, 0x00 }, // P
+	{ 0x1e, 0x33, 0x33, 0x33, 0x3b, 0x1e, 0x38, 0x00 }, // Q
+	{ 0x3f, 0x66, 0x66, 0x3e, 0x36, 0x66, 0x67, 0x00 }, // R
+	{ 0x1e, 0x33, 0x07, 0x0e, 0x38, 0x33, 0x1e, 0x00 }, // S
+	{ 0x3f, 0x2d, 0x0c, 0x0c, 0x0c, 0x0c, 0x1e, 0x00 }, // T
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3f, 0x00 }, // U
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x1e, 0x0c, 0x00 }, // V
+	{ 0x63, 0x63, 0x63, 0x6b, 0x7f, 0x77, 0x63, 0x00 }, // W
+	{ 0x63, 0x63, 0x36, 0x1c, 0x1c, 0x36, 0x63, 0x00 }, // X
+	{ 0x33, 0x33, 0x33, 0x1e, 0x0c, 0x0c, 0x1e, 0x00 }, // Y
+	{ 0x7f, 0x63, 0x31, 0x18, 0x4c, 0x66, 0x7f, 0x00 }, // Z
+	{ 0x1e, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1e, 0x00 }, // [
+	{ 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0x40, 0x00 }, // backslash
+	{ 0x1e, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1e, 0x00 }, // ]
+	{ 0x08, 0x1c, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // ^
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff }, // _
+	{ 0x0c, 0x0c, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+	{ 0x00, 0x00, 0x1e, 0x30, 0x3e, 0x33, 0x6e, 0x00 }, // a
+	{ 0x07, 0x06, 0x06, 0x3e, 0x66, 0x66, 0x3b, 0x00 }, // b
+	{ 0x00, 0x00, 0x1e, 0x33, 0x03, 0x33, 0x1e, 0x00 }, // c
+	{ 0x38, 0x30, 0x30, 0x3e, 0x33, 0x33, 0x6e, 0x00 }, // d
+	{ 0x00, 0x00, 0x1e, 0x33, 0x3f, 0x03, 0x1e, 0x00 }, // e
+	{ 0x1c, 0x36, 0x06, 0x0f, 0x06, 0x06, 0x0f, 0x00 }, // f
+	{ 0x00, 0x00, 0x6e, 0x33, 0x33, 0x3e, 0x30, 0x1f }, // g
+	{ 0x07, 0x06, 0x36, 0x6e, 0x66, 0x66, 0x67, 0x00 }, // h
+	{ 0x0c, 0x00, 0x0e, 0x0c, 0x0c, 0x0c, 0x1e, 0x00 }, // i
+	{ 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1e }, // j
+	{ 0x07, 0x06, 0x66, 0x36, 0x1e, 0x36, 0x67, 0x00 }, // k
+	{ 0x0e, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x1e, 0x00 }, // l
+	{ 0x00, 0x00, 0x33, 0x7f, 0x7f, 0x6b, 0x63, 0x00 }, // m
+	{ 0x00, 0x00, 0x1f, 0x33, 0x33, 0x33, 0x33, 0x00 }, // n
+	{ 0x00, 0x00, 0x1e, 0x33, 0x33, 0x33, 0x1e, 0x00 }, // o
+	{ 0x00, 0x00, 0x3b, 0x66, 0x66, 0x3e, 0x06, 0x0f }, // p
+	{ 0x00, 0x00, 0x6e, 0x33, 0x33, 0x3e, 0x30, 0x78 }, // q
+	{ 0x00, 0x00, 0x3b, 0x6e, 0x66, 0x06, 0x0f, 0x00 }, // r
+	{ 0x00, 0x00, 0x3e, 0x03, 0x1e, 0x30, 0x1f, 0x00 }, // s
+	{ 0x08, 0x0c, 0x3e, 0x0c, 0x0c, 0x2c, 0x18, 0x00 }, // t
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6e, 0x00 }, // u
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x1e, 0x0c, 0x00 }, // v
+	{ 0x00, 0x00, 0x63, 0x6b, 0x7f, 0x7f, 0x36, 0x00 }, // w
+	{ 0x00, 0x00, 0x63, 0x36, 0x1c, 0x36, 0x63, 0x00 }, // x
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x3e, 0x30, 0x1f }, // y
+	{ 0x00, 0x00, 0x3f, 0x19, 0x0c, 0x26, 0x3f, 0x00 }, // z
+	{ 0x38, 0x0c, 0x0c, 0x07, 0x0c, 0x0c, 0x38, 0x00 }, // {
+	{ 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // |
+	{ 0x07, 0x0c, 0x0c, 0x38, 0x0c, 0x0c, 0x07, 0x00 }, // }
+	{ 0x6e, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } // ~
+};
+
+// blank characters advance by half a cell
+const unsigned int blankAdvance = 4;
+
+// leftmost and rightmost columns of a character, in font texels
+void getColumnRange(unsigned int character, unsigned int *first, unsigned int *last)
+{
+	unsigned int columns = 0;
+	for (unsigned int row = 0; row < fontCellSize; row++)
+		columns |= font[character - firstCharacter][row];
+	
+	*first = fontCellSize;
+	*last = 0;
+	for (unsigned int column = 0; column < fontCellSize; column++)
+	{
+		if (columns & (1 << column))
+		{
+			*first = std::min(*first, column);
+			*last = column;
+		}
+	}
+}
+
+// length of the intersection of two ranges
+float getOverlap(float start1, float end1, float start2, float end2)
+{
+	return std::max(std::min(end1, end2) - std::max(start1, start2), 0.0f);
+}
+
+unsigned int getCellSize(unsigned int size)
+{
+	return size + cellPadding;
+}
+
+} // end of private section
+
+const unsigned int GlyphAtlas::minSize;
+const unsigned int GlyphAtlas::maxSize;
+const unsigned int GlyphAtlas::invalidSlot;
+
+GlyphAtlas::GlyphAtlas(GraphicDriver *driver)
+	: driver(driver)
+	, shelfEnd(0)
+	, frame(1)
+	, fullReported(false)
+{
+	// white everywhere, so that filtering only blends the coverage
+	this->texels.resize(atlasSize * atlasSize * 4, 255);
+	for (unsigned int i = 0; i < atlasSize * atlasSize; i++)
+		this->texels[i * 4 + 3] = 0;
+	
+	this->texture = this->driver->createTexture();
+	this->driver->uploadTextureLevel(this->texture, GraphicDriver::RGBA8TextureFormat, 0, atlasSize, atlasSize, &this->texels[0]);
+	this->driver->setTextureLevelRange(this->texture, 0, 0);
+	this->driver->setTextureSampling(this->texture, true, false);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	this->driver->destroyTexture(this->texture);
+}
+
+unsigned int GlyphAtlas::clampSize(unsigned int size)
+{
+	return std::min(std::max(size, minSize), maxSize);
+}
+
+unsigned int GlyphAtlas::getCharacter(unsigned int character)
+{
+	return (character >= firstCharacter && character <= lastCharacter) ? character : '?';
+}
+
+float GlyphAtlas::getGlyphOffset(unsigned int character, unsigned int size)
+{
+	unsigned int first, last;
+	getColumnRange(GlyphAtlas::getCharacter(character), &first, &last);
+	if (first > last)
+		return 0.0f;
+	
+	return -(float)first * (float)GlyphAtlas::clampSize(size) / (float)fontCellSize;
+}
+
+float GlyphAtlas::getGlyphAdvance(unsigned int character, unsigned int size)
+{
+	unsigned int first, last;
+	getColumnRange(GlyphAtlas::getCharacter(character), &first, &last);
+	
+	// one empty column between glyphs
+	unsigned int columns = (first > last) ? blankAdvance : last - first + 2;
+	return (float)columns * (float)GlyphAtlas::clampSize(size) / (float)fontCellSize;
+}
+
+bool GlyphAtlas::isBlank(unsigned int character)
+{
+	unsigned int first, last;
+	getColumnRange(GlyphAtlas::getCharacter(character), &first, &last);
+	return first > last;
+}
+
+unsigned int GlyphAtlas::useGlyph(unsigned int key, unsigned int previousSlot)
+{
+	// most glyphs stay where they were the last time
+	unsigned int slot = previousSlot;
+	if (slot >= this->slots.size() || this->slots[slot].key != key)
+	{
+		GlyphMap::iterator it = this->glyphs.find(key);
+		if (it != this->glyphs.end())
+		{
+			slot = it->second;
+		}
+		else
+		{
+			slot = this->allocateSlot(getCellSize(key >> 8));
+			if (slot == invalidSlot)
+			{
+				if (!this->fullReported)
+					Log::warning("Glyph atlas full, some text is not drawn");
+				this->fullReported = true;
+				return invalidSlot;
+			}
+			
+			this->rasterize(slot, key);
+			this->glyphs[key] = slot;
+		}
+	}
+	
+	this->slots[slot].lastUsedFrame = this->frame;
+	return slot;
+}
+
+void GlyphAtlas::update()
+{
+	for (unsigned int i = 0; i < this->dirtySlots.size(); i++)
+	{
+		const Slot &slot = this->slots[this->dirtySlots[i]];
+		unsigned int cellSize = this->shelves[slot.shelf].cellSize;
+		
+		// rows of the cell, packed
+		this->uploadTexels.resize(cellSize * cellSize * 4);
+		for (unsigned int y = 0; y < cellSize; y++)
+		{
+			const unsigned char *row = &this->texels[((slot.y + y) * atlasSize + slot.x) * 4];
+			std::copy(row, row + cellSize * 4, &this->uploadTexels[y * cellSize * 4]);
+		}
+		
+		this->driver->uploadTextureRegion(this->texture, slot.x, slot.y, cellSize, cellSize, &this->uploadTexels[0]);
+	}
+	this->dirtySlots.clear();
+	
+	this->frame++;
+	this->statistics.glyphCount = (unsigned int)this->glyphs.size();
+}
+
+unsigned int GlyphAtlas::allocateSlot(unsigned int cellSize)
+{
+	// a free cell of the right size
+	for (unsigned int i = 0; i < this->shelves.size(); i++)
+	{
+		const Shelf &shelf = this->shelves[i];
+		if (shelf.cellSize != cellSize)
+			continue;
+		
+		for (unsigned int j = 0; j < shelf.slots.size(); j++)
+		{
+			if (this->slots[shelf.slots[j]].key == 0)
+				return shelf.slots[j];
+		}
+	}
+	
+	// a new shelf
+	if (this->shelfEnd + cellSize <= atlasSize)
+	{
+		this->addShelf(this->shelfEnd, cellSize, cellSize);
+		this->shelfEnd += cellSize;
+		return this->shelves.back().slots[0];
+	}
+	
+	// the least recently used glyph of the same size
+	unsigned int oldestSlot = invalidSlot;
+	for (unsigned int i = 0; i < this->shelves.size(); i++)
+	{
+		const Shelf &shelf = this->shelves[i];
+		if (shelf.cellSize != cellSize)
+			continue;
+		
+		for (unsigned int j = 0; j < shelf.slots.size(); j++)
+		{
+			const Slot &slot = this->slots[shelf.slots[j]];
+			if (slot.lastUsedFrame < this->frame && (oldestSlot == invalidSlot || slot.lastUsedFrame < this->slots[oldestSlot].lastUsedFrame))
+				oldestSlot = shelf.slots[j];
+		}
+	}
+	
+	if (oldestSlot != invalidSlot)
+	{
+		this->evict(oldestSlot);
+		return oldestSlot;
+	}
+	
+	// the least recently used shelf high enough, whose glyphs are all older than this frame
+	unsigned int oldestShelf = invalidSlot;
+	unsigned int oldestShelfFrame = this->frame;
+	for (unsigned int i = 0; i < this->shelves.size(); i++)
+	{
+		const Shelf &shelf = this->shelves[i];
+		if (shelf.height < cellSize)
+			continue;
+		
+		unsigned int lastUsedFrame = 0;
+		for (unsigned int j = 0; j < shelf.slots.size(); j++)
+			lastUsedFrame = std::max(lastUsedFrame, this->slots[shelf.slots[j]].lastUsedFrame);
+		
+		if (lastUsedFrame < oldestShelfFrame)
+		{
+			oldestShelf = i;
+			oldestShelfFrame = lastUsedFrame;
+		}
+	}
+	
+	if (oldestShelf == invalidSlot)
+		return invalidSlot;
+	
+	this->assignShelf(oldestShelf, cellSize);
+	return this->shelves[oldestShelf].slots[0];
+}
+
+void GlyphAtlas::addShelf(unsigned int y, unsigned int height, unsigned int cellSize)
+{
+	Shelf shelf;
+	shelf.y = y;
+	shelf.height = height;
+	shelf.cellSize = 0;
+	this->shelves.push_back(shelf);
+	
+	this->assignShelf((unsigned int)this->shelves.size() - 1, cellSize);
+}
+
+void GlyphAtlas::assignShelf(unsigned int shelfIndex, unsigned int cellSize)
+{
+	Shelf &shelf = this->shelves[shelfIndex];
+	for (unsigned int i = 0; i < shelf.slots.size(); i++)
+	{
+		if (this->slots[shelf.slots[i]].key != 0)
+			this->evict(shelf.slots[i]);
+	}
+	
+	// the slots of the shelf are kept, extra or missing ones go to or come from the spare ones
+	unsigned int cellCount = atlasSize / cellSize;
+	while (shelf.slots.size() > cellCount)
+	{
+		this->spareSlots.push_back(shelf.slots.back());
+		shelf.slots.pop_back();
+	}
+	while (shelf.slots.size() < cellCount)
+	{
+		if (this->spareSlots.empty())
+		{
+			shelf.slots.push_back((unsigned int)this->slots.size());
+			this->slots.push_back(Slot());
+		}
+		else
+		{
+			shelf.slots.push_back(this->spareSlots.back());
+			this->spareSlots.pop_back();
+		}
+	}
+	
+	for (unsigned int i = 0; i < shelf.slots.size(); i++)
+	{
+		Slot &slot = this->slots[shelf.slots[i]];
+		slot.key = 0;
+		slot.lastUsedFrame = 0;
+		slot.shelf = shelfIndex;
+		slot.x = i * cellSize;
+		slot.y = shelf.y;
+		
+		// the glyph, without its padding
+		float size = (float)(cellSize - cellPadding);
+		slot.region = glm::vec4((float)slot.x, (float)slot.y, (float)slot.x + size, (float)slot.y + size) / (float)atlasSize;
+	}
+	
+	shelf.cellSize = cellSize;
+}
+
+void GlyphAtlas::evict(unsigned int slot)
+{
+	this->glyphs.erase(this->slots[slot].key);
+	this->slots[slot].key = 0;
+	this->statistics.evictedGlyphCount++;
+}
+
+void GlyphAtlas::rasterize(unsigned int slotIndex, unsigned int key)
+{
+	Slot &slot = this->slots[slotIndex];
+	slot.key = key;
+	
+	unsigned int character = key & 0xff;
+	unsigned int size = key >> 8;
+	unsigned int cellSize = getCellSize(size);
+	const unsigned char *rows = font[character - firstCharacter];
+	
+	// each pixel covers a square of font texels, whose coverage is averaged
+	float texelsPerPixel = (float)fontCellSize / (float)size;
+	for (unsigned int y = 0; y < cellSize; y++)
+	{
+		float top = (float)y * texelsPerPixel;
+		float bottom = top + texelsPerPixel;
+		
+		for (unsigned int x = 0; x < cellSize; x++)
+		{
+			float left = (float)x * texelsPerPixel;
+			float right = left + texelsPerPixel;
+			
+			float coverage = 0.0f;
+			for (unsigned int row = (unsigned int)top; row < fontCellSize && (float)row < bottom; row++)
+			{
+				float height = getOverlap(top, bottom, (float)row, (float)row + 1.0f);
+				for (unsigned int column = (unsigned int)left; column < fontCellSize && (float)column < right; column++)
+				{
+					if (rows[row] & (1 << column))
+						coverage += height * getOverlap(left, right, (float)column, (float)column + 1.0f);
+				}
+			}
+			
+			// padding texels stay empty
+			if (x >= size || y >= size)
+				coverage = 0.0f;
+			
+			coverage /= texelsPerPixel * texelsPerPixel;
+			this->texels[((slot.y + y) * atlasSize + slot.x + x) * 4 + 3] = (unsigned char)(std::min(coverage, 1.0f) * 255.0f + 0.5f);
+		}
+	}
+	
+	this->dirtySlots.push_back(slotIndex);
+	this->statistics.rasterizedGlyphCount++;
+}
+
+} // oak namespace
@@ -0,0 +1,155 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
+
+namespace oak {
+
+class GraphicDriver;
+struct Texture;
+
+/**
+ * Texture holding the glyphs drawn by texts, rasterized on demand.
+ *
+ * Glyphs come from a built-in 8x8 bitmap font (printable ASCII), scaled to
+ * the requested pixel size with box filtering, so each size gets its own
+ * sharp copy. They are stored as white texels with coverage as alpha, to be
+ * tinted by the sprite shader.
+ *
+ * The atlas is split in shelves of square cells, one cell size per shelf.
+ * When full, the least recently used glyph of the same size is replaced, or
+ * a whole shelf not used in the current frame is given to the new size.
+ * Glyphs used during a frame are never evicted before the next one, since
+ * recorded quads still point at them.
+ */
+class GlyphAtlas
+{
+	public:
+		GlyphAtlas(GraphicDriver *driver);
+		~GlyphAtlas();
+		
+		// pixel sizes are clamped to this range
+		static const unsigned int minSize = 4;
+		static const unsigned int maxSize = 64;
+		static unsigned int clampSize(unsigned int size);
+		
+		// Horizontal metrics of a glyph, in pixels at the given size: the offset of
+		// its cell from the pen position, and the advance to the next glyph.
+		// Characters missing from the font are drawn as '?'.
+		static unsigned int getCharacter(unsigned int character);
+		static float getGlyphOffset(unsigned int character, unsigned int size);
+		static float getGlyphAdvance(unsigned int character, unsigned int size);
+		
+		// whether a character draws any texel
+		static bool isBlank(unsigned int character);
+		
+		// identifies a glyph at a size, never 0
+		static unsigned int getGlyphKey(unsigned int character, unsigned int size) { return (clampSize(size) << 8) | getCharacter(character); }
+		
+		// Mark a glyph as used in the current frame, rasterizing it if needed, and
+		// return its slot; the slot found last time for the same glyph is checked
+		// first. Returns invalidSlot when the atlas is full of glyphs used this frame.
+		static const unsigned int invalidSlot = ~0u;
+		unsigned int useGlyph(unsigned int key, unsigned int previousSlot);
+		
+		// texture coordinates of the cell of a slot (left, top, right, bottom), valid
+		// until the next frame; can be called concurrently while recording
+		const glm::vec4 &getRegion(unsigned int slot) const { return this->slots[slot].region; }
+		
+		Texture *getTexture() const { return this->texture; }
+		
+		// upload the glyphs rasterized since the last call, then start a new frame
+		// (once per recorded frame, after the glyphs of the frame are used)
+		void update();
+		
+		struct Statistics
+		{
+			unsigned int glyphCount; // in the atlas
+			unsigned int rasterizedGlyphCount; // since the atlas creation
+			unsigned int evictedGlyphCount;
+			
+			Statistics()
+				: glyphCount(0)
+				, rasterizedGlyphCount(0)
+				, evictedGlyphCount(0)
+			{}
+		};
+		const Statistics &getStatistics() const { return this->statistics; }
+	
+	private:
+		struct Slot
+		{
+			unsigned int key; // 0 while free
+			unsigned int lastUsedFrame;
+			unsigned int shelf;
+			unsigned int x;
+			unsigned int y;
+			glm::vec4 region;
+		};
+		
+		// row of cells of one size across the atlas
+		struct Shelf
+		{
+			unsigned int y;
+			unsigned int height;
+			unsigned int cellSize;
+			std::vector<unsigned int> slots;
+		};
+		
+		// find a slot for a glyph of the given cell size, evicting older glyphs if needed
+		unsigned int allocateSlot(unsigned int cellSize);
+		void addShelf(unsigned int y, unsigned int height, unsigned int cellSize);
+		void assignShelf(unsigned int shelf, unsigned int cellSize);
+		void evict(unsigned int slot);
+		
+		void rasterize(unsigned int slot, unsigned int key);
+		
+		GraphicDriver *driver;
+		Texture *texture;
+		
+		std::vector<Slot> slots;
+		std::vector<unsigned int> spareSlots; // not in any shelf, always free
+		std::vector<Shelf> shelves;
+		unsigned int shelfEnd; // first row not given to a shelf
+		
+		typedef std::map<unsigned int, unsigned int> GlyphMap;
+		GlyphMap glyphs; // slots by key
+		
+		// texels of the whole atlas, and the slots rasterized since the last upload
+		std::vector<unsigned char> texels;
+		std::vector<unsigned int> dirtySlots;
+		std::vector<unsigned char> uploadTexels;
+		
+		unsigned int frame;
+		bool fullReported;
+		Statistics statistics;
+};
+
+} // oak namespace
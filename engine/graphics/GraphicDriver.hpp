@@ -32,8 +32,10 @@
 namespace oak {
 
 struct GraphicDriverState;
+struct RenderTarget;
 struct VertexBuffer;
 struct ShaderProgram;
+struct Texture;
 
 class GraphicDriver
 {
@@ -43,7 +45,7 @@ class GraphicDriver
 		
 		void setClearColor(const glm::vec3 &color);
 		void setClearDepth(float depth);
-		void clear(bool colorBuffer, bool depthBuffer);
+		void clear(bool colorBuffer, bool depthBuffer); // limited to the viewport
 		
 		// pack vertex structure data
 		#pragma pack(push)
@@ -61,13 +63,33 @@ class GraphicDriver
 			glm::vec2 uv;
 		};
 		
+		// world space corner of a sprite, with its color and opacity as bytes
+		struct SpriteVertex
+		{
+			glm::vec3 position;
+			glm::vec2 uv;
+			unsigned char color[4];
+		};
+		
+		// standard vertex deformed by up to four bones, weights as bytes summing to 255
+		struct SkinnedVertex
+		{
+			glm::vec3 position;
+			glm::vec3 normal;
+			glm::vec2 uv;
+			unsigned char bones[4];
+			unsigned char weights[4];
+		};
+		
 		// end of vertex structures
 		#pragma pack(pop)
 		
 		enum VertexFormat
 		{
 			Simple2DVertexFormat,
-			Standard3DVertexFormat
+			Standard3DVertexFormat,
+			SpriteVertexFormat,
+			SkinnedVertexFormat
 		};
 		VertexBuffer *createVertexBuffer(void *data, unsigned int size, VertexFormat format, unsigned int elementCount);
 		void destroyVertexBuffer(VertexBuffer *buffer);
@@ -76,24 +98,163 @@ class GraphicDriver
 		// vertex buffer creation helpers
 		inline VertexBuffer *createVertexBuffer(Simple2DVertex *vertices, unsigned int elementCount);
 		inline VertexBuffer *createVertexBuffer(Standard3DVertex *vertices, unsigned int elementCount);
+		inline VertexBuffer *createVertexBuffer(SkinnedVertex *vertices, unsigned int elementCount);
+		
+		static inline unsigned int getVertexSize(VertexFormat format);
+		
+		// Streaming vertex buffers get new contents every frame. Their storage is split in
+		// regions of elementCount vertices, written in turn, so that a region can be filled
+		// while the GPU still reads the previous ones. Binding a streaming buffer binds the
+		// region written last, draws then index elements from the start of that region.
+		VertexBuffer *createStreamingVertexBuffer(VertexFormat format, unsigned int elementCount, unsigned int regionCount);
+		
+		// write the next region of a streaming buffer, without waiting for the draws using the
+		// other regions (unsynchronized mapping guarded by fences, or storage orphaning)
+		void streamVertexBuffer(VertexBuffer *buffer, const void *data, unsigned int elementCount);
+		
+		// block compressed formats are stored in 4x4 pixel blocks
+		enum TextureFormat
+		{
+			RGBA8TextureFormat,
+			BC1TextureFormat, // DXT1, RGB with 1-bit alpha
+			BC2TextureFormat, // DXT3, RGB with explicit 4-bit alpha
+			BC3TextureFormat, // DXT5, RGB with interpolated alpha
+			ETC1TextureFormat, // RGB
+			ETC2RGBTextureFormat,
+			ETC2RGBATextureFormat, // ETC2 RGB with EAC alpha
+			TextureFormatCount
+		};
+		
+		static inline bool isCompressedTextureFormat(TextureFormat format);
+		
+		// size in bytes of a mipmap level
+		static inline unsigned int getTextureLevelSize(TextureFormat format, unsigned int width, unsigned int height);
+		
+		// features detected on the GPU at startup, safe to read from any thread
+		struct Capabilities
+		{
+			// formats that can be uploaded as is, the others have to be decoded to RGBA8 first
+			bool textureFormats[TextureFormatCount];
+			
+			// sampling can be restricted to the mipmap levels uploaded so far
+			bool textureLevelRange;
+			
+			// vec4 shader constants available to vertex shaders (at least 128 on GLES2)
+			unsigned int vertexConstantVectors;
+		};
+		const Capabilities &getCapabilities() const;
+		
+		// Textures are created empty. Mipmap levels are then defined one by one,
+		// usually from the smallest one, and sampling uses the levels from
+		// baseLevel to maxLevel; all of these are resource operations.
+		Texture *createTexture();
+		void destroyTexture(Texture *texture);
+		void uploadTextureLevel(Texture *texture, TextureFormat format, unsigned int level, unsigned int width, unsigned int height, const void *data);
+		void setTextureLevelRange(Texture *texture, unsigned int baseLevel, unsigned int maxLevel);
+		
+		// replace a rectangle of the first level of an RGBA8 texture, already defined
+		void uploadTextureRegion(Texture *texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data);
+		
+		// Textures are filtered and repeated by default. Unfiltered ones return their
+		// nearest texel, to store data; on GLES2, textures whose size is not a power
+		// of two can only be sampled without repeat or mipmaps.
+		void setTextureSampling(Texture *texture, bool filtered, bool repeated);
+		
+		void bindTexture(Texture *texture, unsigned int unit);
+		
+		// Render targets are drawn into instead of the screen: an RGBA8 texture, owned
+		// by the target, with a depth buffer. They are created and destroyed by
+		// resource operations, like textures.
+		RenderTarget *createRenderTarget(unsigned int width, unsigned int height);
+		void destroyRenderTarget(RenderTarget *target);
+		Texture *getRenderTargetTexture(RenderTarget *target);
+		
+		// Draw into a render target, or back into the screen if NULL; the viewport
+		// then covers the whole target, or the screen area it had before. The target
+		// texture is unbound from all units, it cannot be sampled while drawn into.
+		void bindRenderTarget(RenderTarget *target);
+		void setViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
 		
 		ShaderProgram *createShaderProgram(const std::string &vertexCode, const std::string &fragmentCode);
 		void destroyShaderProgram(ShaderProgram *program);
 		void bindShaderProgram(ShaderProgram *program);
 		
+		void setShaderConstant(const std::string &name, int value); // also selects the unit of samplers
 		void setShaderConstant(const std::string &name, float value);
 		void setShaderConstant(const std::string &name, const glm::vec2 &value);
 		void setShaderConstant(const std::string &name, const glm::vec3 &value);
+		void setShaderConstant(const std::string &name, const glm::vec4 &value);
 		void setShaderConstant(const std::string &name, const glm::mat3 &value);
 		void setShaderConstant(const std::string &name, const glm::mat4 &value);
+		void setShaderConstant(const std::string &name, const glm::vec4 *values, unsigned int count); // array
 		
 		enum PrimitiveType
 		{
 			TriangleStrip,
-			Triangles
+			Triangles,
+			Lines // one pixel wide
 		};
 		void draw(PrimitiveType primitiveType, unsigned int startElement, unsigned int elementCount);
 		
+		// Blended modes mix the drawn colors with the target by their alpha, keep
+		// the alpha of the target, and test depth without writing it; draws are
+		// opaque until changed.
+		enum BlendMode
+		{
+			OpaqueBlend,
+			AlphaBlend,
+			AdditiveBlend
+		};
+		void setBlendMode(BlendMode mode);
+		
+		// Resource operations (creation and destruction of buffers and shaders) normally run
+		// immediately. In deferred mode, they may be called from any thread: they are queued,
+		// and only run on the driver thread by executeResourceOperations().
+		void setDeferredResourceOperations(bool deferred);
+		
+		// get a marker identifying the resource operations queued so far
+		unsigned int markResourceOperations();
+		
+		// run the queued resource operations, up to the given marker
+		void executeResourceOperations(unsigned int marker);
+		
+		// counters of the commands executed by the driver, since the last reset
+		struct Statistics
+		{
+			unsigned int clearCount;
+			unsigned int drawCount;
+			unsigned int drawnElementCount;
+			unsigned int shaderBindCount;
+			unsigned int vertexBufferBindCount;
+			unsigned int textureBindCount;
+			unsigned int renderTargetBindCount;
+			unsigned int shaderConstantCount;
+			unsigned int resourceOperationCount;
+			unsigned int streamedByteCount;
+			unsigned int streamStallCount; // streaming writes that had to wait for the GPU
+			unsigned int uploadedTextureByteCount;
+			
+			Statistics()
+				: clearCount(0)
+				, drawCount(0)
+				, drawnElementCount(0)
+				, shaderBindCount(0)
+				, vertexBufferBindCount(0)
+				, textureBindCount(0)
+				, renderTargetBindCount(0)
+				, shaderConstantCount(0)
+				, resourceOperationCount(0)
+				, streamedByteCount(0)
+				, streamStallCount(0)
+				, uploadedTextureByteCount(0)
+			{}
+		};
+		const Statistics &getStatistics() const;
+		void resetStatistics();
+		
+		// log every command with its arguments as it is executed (null driver only)
+		void setCommandTrace(bool enabled);
+	
 	private:
 		GraphicDriverState *state;
 };
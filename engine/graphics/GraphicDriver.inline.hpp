@@ -37,4 +37,46 @@ VertexBuffer *GraphicDriver::createVertexBuffer(Standard3DVertex *vertices, unsi
 	return this->createVertexBuffer(vertices, sizeof(Standard3DVertex) * elementCount, Standard3DVertexFormat, elementCount);
 }
 
+VertexBuffer *GraphicDriver::createVertexBuffer(SkinnedVertex *vertices, unsigned int elementCount)
+{
+	return this->createVertexBuffer(vertices, sizeof(SkinnedVertex) * elementCount, SkinnedVertexFormat, elementCount);
+}
+
+bool GraphicDriver::isCompressedTextureFormat(TextureFormat format)
+{
+	return format != RGBA8TextureFormat;
+}
+
+unsigned int GraphicDriver::getTextureLevelSize(TextureFormat format, unsigned int width, unsigned int height)
+{
+	unsigned int blockCount = ((width + 3) / 4) * ((height + 3) / 4);
+	
+	switch (format)
+	{
+		case RGBA8TextureFormat: return width * height * 4;
+		case BC1TextureFormat: return blockCount * 8;
+		case BC2TextureFormat: return blockCount * 16;
+		case BC3TextureFormat: return blockCount * 16;
+		case ETC1TextureFormat: return blockCount * 8;
+		case ETC2RGBTextureFormat: return blockCount * 8;
+		case ETC2RGBATextureFormat: return blockCount * 16;
+		case TextureFormatCount: break;
+	}
+	
+	return 0;
+}
+
+unsigned int GraphicDriver::getVertexSize(VertexFormat format)
+{
+	switch (format)
+	{
+		case Simple2DVertexFormat: return sizeof(Simple2DVertex);
+		case Standard3DVertexFormat: return sizeof(Standard3DVertex);
+		case SpriteVertexFormat: return sizeof(SpriteVertex);
+		case SkinnedVertexFormat: return sizeof(SkinnedVertex);
+	}
+	
+	return 0;
+}
+
 } // oak namespace
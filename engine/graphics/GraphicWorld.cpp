@@ -25,56 +25,1499 @@
 
 #include <engine/graphics/GraphicWorld.hpp>
 
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/DebugDraw.hpp>
+#include <engine/graphics/Frustum.hpp>
 #include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/LightClusters.hpp>
+#include <engine/graphics/OcclusionBuffer.hpp>
+#include <engine/graphics/ShadowMaps.hpp>
+#include <engine/graphics/TextureManager.hpp>
+#include <engine/graphics/components/Animator.hpp>
 #include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/ParticleEmitter.hpp>
+#include <engine/graphics/components/SkinnedMesh.hpp>
+#include <engine/graphics/components/Terrain.hpp>
+#include <engine/graphics/components/VoxelChunk.hpp>
 
 #include <engine/sg/Entity.hpp>
 
+#include <engine/system/Atomic.hpp>
+
 #include <engine/system/Log.hpp>
+#include <engine/system/RadixSort.hpp>
+#include <engine/system/Time.hpp>
 
 #include <glm/ext.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
 namespace oak {
 
-GraphicWorld::GraphicWorld(World *world)
+namespace { // private section
+
+// finest geometry, read back if it changes over time
+VertexBuffer *getBuffer(const GraphicWorld::Renderable &renderable)
+{
+	return renderable.geometry ? renderable.geometry->buffer : renderable.buffer;
+}
+
+// render state of a renderable, as sorted in the render lists
+GraphicWorld::RenderList::Item getRenderItem(const GraphicWorld::Renderable &renderable, GraphicWorld::RenderableHandle handle)
+{
+	GraphicWorld::RenderList::Item item;
+	item.handle = handle;
+	item.shader = renderable.shader;
+	item.texture = renderable.texture ? *renderable.texture : NULL;
+	item.buffer = getBuffer(renderable);
+	item.visible = false;
+	item.level = 0;
+	item.previousLevel = 0;
+	item.fade = 1.0f;
+	return item;
+}
+
+// order renderables so that render state changes are minimized
+struct RenderStateComparator
+{
+	bool operator() (const GraphicWorld::RenderList::Item &item1, const GraphicWorld::RenderList::Item &item2) const
+	{
+		if (item1.shader != item2.shader)
+			return item1.shader < item2.shader;
+		
+		if (item1.texture != item2.texture)
+			return item1.texture < item2.texture;
+		
+		return item1.buffer < item2.buffer;
+	}
+};
+
+// whether the render state of an item did not change
+bool hasRenderState(const GraphicWorld::RenderList::Item &item1, const GraphicWorld::RenderList::Item &item2)
+{
+	return item1.shader == item2.shader && item1.texture == item2.texture && item1.buffer == item2.buffer;
+}
+
+// opaque renderables per chunk of a render list: chunks are split in two above
+// twice as many, and merged with the next one while small
+const unsigned int renderChunkSize = 64;
+
+// chunks are in render state order, an item goes in the first one ending after it
+struct ChunkComparator
+{
+	bool operator() (const GraphicWorld::RenderList::Chunk *chunk, const GraphicWorld::RenderList::Item &item) const
+	{
+		return RenderStateComparator()(chunk->items.back(), item);
+	}
+};
+
+// frames in flight may still replay a list, it is reused later
+void retireCommandList(GraphicWorld::RenderList *renderList, CommandList *commandList)
+{
+	if (!commandList)
+		return;
+	
+	GraphicWorld::RenderList::RetiredList retired;
+	retired.commandList = commandList;
+	retired.update = renderList->updateCount;
+	renderList->retiredLists.push_back(retired);
+}
+
+// shadow casters all use the same shader, only buffer changes matter
+struct BufferComparator
+{
+	const GraphicWorld::Renderable *renderables;
+	
+	BufferComparator(const GraphicWorld::Renderable *renderables)
+		: renderables(renderables)
+	{}
+	
+	bool operator() (unsigned int index1, unsigned int index2) const
+	{
+		return getBuffer(this->renderables[index1]) < getBuffer(this->renderables[index2]);
+	}
+};
+
+// the largest axis scaling gives conservative world-space sizes
+float getLargestScale(const glm::mat4 &transform)
+{
+	return glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+}
+
+bool isVisible(const GraphicWorld::Renderable &renderable, const Frustum &frustum)
+{
+	if (renderable.geometry && renderable.geometry->elementCount == 0)
+		return false;
+	
+	if (renderable.boundingRadius <= 0.0f)
+		return true;
+	
+	const glm::mat4 &transform = *renderable.transform;
+	glm::vec3 center = glm::vec3(transform * glm::vec4(renderable.boundingCenter, 1.0f));
+	
+	return frustum.intersectsSphere(center, renderable.boundingRadius * getLargestScale(transform));
+}
+
+// blended over the opaque renderables, after them
+bool isTranslucent(const GraphicWorld::Renderable &renderable)
+{
+	return renderable.opacity && *renderable.opacity < 1.0f;
+}
+
+// translucent renderable in the view, by quantized depth
+struct TranslucentItem
+{
+	unsigned int key;
+	unsigned int index;
+};
+
+// Texture level whose texels are about the size of a pixel, at the nearest
+// point of the bounding sphere. The pixel scale is the size in pixels of a
+// unit long object at a unit distance.
+unsigned int getRequiredLevel(const GraphicWorld::Renderable &renderable, const TextureResource *texture, const glm::mat4 &viewMatrix, float pixelScale, float nearPlane)
+{
+	if (renderable.textureSpan <= 0.0f || renderable.boundingRadius <= 0.0f)
+		return 0;
+	
+	const glm::mat4 &transform = *renderable.transform;
+	float scale = getLargestScale(transform);
+	glm::vec3 center = glm::vec3(viewMatrix * transform * glm::vec4(renderable.boundingCenter, 1.0f));
+	float depth = glm::max(-center.z - renderable.boundingRadius * scale, nearPlane);
+	
+	float pixelCount = renderable.textureSpan * scale * pixelScale / depth;
+	float texelCount = (float)std::max(texture->getWidth(), texture->getHeight());
+	if (pixelCount >= texelCount)
+		return 0;
+	
+	unsigned int level = (unsigned int)(std::log(texelCount / pixelCount) / std::log(2.0f));
+	return std::min(level, texture->getLevelCount() - 1);
+}
+
+// switches happen this far past the screen size thresholds, so that objects
+// moving around a threshold do not pop back and forth
+const float lodHysteresis = 0.15f;
+
+// seconds spent cross-fading two levels
+const float lodFadeDuration = 0.3f;
+
+// skinned meshes posed by each animation job
+const unsigned int skinnedMeshesPerJob = 8;
+
+// animators advanced by each job, cheap enough to take many
+const unsigned int animatorsPerJob = 64;
+
+// projected size of the bounding sphere radius, over half the target height
+float getScreenSize(const GraphicWorld::Renderable &renderable, const glm::vec3 &cameraPosition, float projectionScale, float nearPlane)
+{
+	const glm::mat4 &transform = *renderable.transform;
+	glm::vec3 center = glm::vec3(transform * glm::vec4(renderable.boundingCenter, 1.0f));
+	float distance = glm::max(glm::distance(center, cameraPosition), nearPlane);
+	
+	return renderable.boundingRadius * getLargestScale(transform) * projectionScale / distance;
+}
+
+// Update the level of a renderable for its screen size, and return the progress
+// of the cross-fade from the previous level (1 once done).
+float updateLod(const GraphicWorld::Renderable &renderable, float screenSize, float time, GraphicWorld::LodState *state)
+{
+	unsigned int level = std::min((unsigned int)state->level, renderable.lodCount);
+	while (level < renderable.lodCount && screenSize < renderable.lods[level].screenSize * (1.0f - lodHysteresis))
+		level++;
+	while (level > 0 && screenSize > renderable.lods[level - 1].screenSize * (1.0f + lodHysteresis))
+		level--;
+	
+	// no fade the first time
+	if (!state->valid)
+	{
+		state->valid = true;
+		state->level = (unsigned char)level;
+		state->previousLevel = (unsigned char)level;
+		state->switchTime = time - lodFadeDuration;
+	}
+	else if (level != state->level)
+	{
+		state->previousLevel = state->level;
+		state->level = (unsigned char)level;
+		state->switchTime = time;
+	}
+	
+	if (!renderable.lodCrossFade)
+		return 1.0f;
+	
+	return glm::clamp((time - state->switchTime) / lodFadeDuration, 0.0f, 1.0f);
+}
+
+// Draw a level of a renderable. Cross-fading levels are drawn with complementary
+// dithering patterns: the shaders keep the fragments under a positive fade, or
+// above a negative one.
+void drawLod(CommandList *commandList, const GraphicWorld::Renderable &renderable, unsigned int level, float fade, VertexBuffer **currentBuffer, float *currentFade)
+{
+	VertexBuffer *buffer = renderable.buffer;
+	unsigned int startElement = renderable.startElement;
+	unsigned int elementCount = renderable.elementCount;
+	if (renderable.geometry)
+	{
+		buffer = renderable.geometry->buffer;
+		startElement = renderable.geometry->startElement;
+		elementCount = renderable.geometry->elementCount;
+	}
+	
+	if (level > 0)
+	{
+		const GraphicWorld::Lod &lod = renderable.lods[std::min(level, renderable.lodCount) - 1];
+		buffer = lod.buffer;
+		startElement = lod.startElement;
+		elementCount = lod.elementCount;
+	}
+	
+	if (buffer != *currentBuffer)
+	{
+		commandList->bindVertexBuffer(buffer);
+		*currentBuffer = buffer;
+	}
+	
+	if (fade != *currentFade)
+	{
+		commandList->setShaderConstant("lodFade", fade);
+		*currentFade = fade;
+	}
+	
+	commandList->draw(renderable.primitiveType, startElement, elementCount);
+}
+
+// what the chunks of a render list are culled for
+struct CullView
+{
+	const Frustum *frustum;
+	const OcclusionBuffer *occlusionBuffer;
+	glm::mat4 viewMatrix;
+	glm::vec3 cameraPosition;
+	float projectionScale;
+	float pixelScale;
+	float nearPlane;
+	float time;
+};
+
+// Cull the items of a chunk, select their levels of detail and request the
+// texture levels they need. The chunk is marked as changed if its draws differ.
+void cullChunk(const GraphicWorld *world, GraphicWorld::RenderList::Chunk *chunk, GraphicWorld::LodState *lodStates, const CullView &view)
+{
+	bool changed = chunk->dirty;
+	chunk->fading = false;
+	chunk->textures.clear();
+	for (unsigned int i = 0; i < chunk->items.size(); i++)
+	{
+		GraphicWorld::RenderList::Item &item = chunk->items[i];
+		const GraphicWorld::Renderable &renderable = world->getRenderable(item.handle);
+		
+		bool visible = isVisible(renderable, *view.frustum);
+		if (visible && renderable.boundingRadius > 0.0f)
+		{
+			const glm::mat4 &transform = *renderable.transform;
+			glm::vec3 center = glm::vec3(transform * glm::vec4(renderable.boundingCenter, 1.0f));
+			visible = view.occlusionBuffer->isVisible(center, renderable.boundingRadius * getLargestScale(transform));
+		}
+		
+		// level of detail, and the one fading out after a switch
+		unsigned int level = 0;
+		unsigned int previousLevel = 0;
+		float fade = 1.0f;
+		if (visible && renderable.lodCount > 0)
+		{
+			GraphicWorld::LodState *state = &lodStates[item.handle];
+			fade = updateLod(renderable, getScreenSize(renderable, view.cameraPosition, view.projectionScale, view.nearPlane), view.time, state);
+			level = state->level;
+			previousLevel = state->previousLevel;
+			if (fade < 1.0f)
+				chunk->fading = true;
+		}
+		
+		if (visible != item.visible || level != item.level || previousLevel != item.previousLevel || fade != item.fade)
+			changed = true;
+		item.visible = visible;
+		item.level = (unsigned char)level;
+		item.previousLevel = (unsigned char)previousLevel;
+		item.fade = fade;
+		
+		// one request per texture, for the finest level needed
+		TextureResource *resource = renderable.texture ? *renderable.texture : NULL;
+		if (!visible || !resource)
+			continue;
+		
+		unsigned int textureLevel = resource->isUsable() ? getRequiredLevel(renderable, resource, view.viewMatrix, view.pixelScale, view.nearPlane) : 0;
+		unsigned int use = 0;
+		while (use < chunk->textures.size() && chunk->textures[use].resource != resource)
+			use++;
+		
+		if (use < chunk->textures.size())
+			chunk->textures[use].level = std::min(chunk->textures[use].level, textureLevel);
+		else
+		{
+			GraphicWorld::RenderList::TextureUse textureUse;
+			textureUse.resource = resource;
+			textureUse.texture = resource->getTexture();
+			textureUse.level = textureLevel;
+			chunk->textures.push_back(textureUse);
+		}
+	}
+	
+	for (unsigned int i = 0; i < chunk->textures.size(); i++)
+	{
+		if (chunk->textures[i].resource->isUsable())
+			chunk->textures[i].resource->requestLevel(chunk->textures[i].level);
+	}
+	
+	if (changed)
+		chunk->changed = true;
+	chunk->dirty = false;
+}
+
+// static renderables are merged when they share all of these
+struct BatchKey
+{
+	ShaderProgram *shader;
+	bool hasTexture;
+	TextureResource *texture;
+	bool hasColor;
+	glm::vec3 color;
+	bool castsShadows;
+	glm::ivec3 cell;
+	
+	bool operator < (const BatchKey &other) const
+	{
+		if (this->shader != other.shader) return this->shader < other.shader;
+		if (this->castsShadows != other.castsShadows) return this->castsShadows < other.castsShadows;
+		if (this->hasTexture != other.hasTexture) return this->hasTexture < other.hasTexture;
+		if (this->texture != other.texture) return this->texture < other.texture;
+		if (this->hasColor != other.hasColor) return this->hasColor < other.hasColor;
+		for (int i = 0; i < 3; i++)
+		{
+			if (this->color[i] != other.color[i]) return this->color[i] < other.color[i];
+			if (this->cell[i] != other.cell[i]) return this->cell[i] < other.cell[i];
+		}
+		
+		return false;
+	}
+};
+
+bool isBatchable(const GraphicWorld::Renderable &renderable)
+{
+	return renderable.entity && renderable.entity->isStatic() && renderable.vertices && renderable.primitiveType == GraphicDriver::Triangles && renderable.lodCount == 0 && !isTranslucent(renderable);
+}
+
+} // end of private section
+
+GraphicWorld::GraphicWorld(World *world, GraphicDriver *driver, Texture *defaultTexture)
 	: world(world)
+	, driver(driver)
+	, defaultTexture(defaultTexture)
+	, batchCount(0)
+	, staticVersion(0)
+	, batchCellSize(0.0f)
+	, staticBatchesChanged(false)
+	, clearedChangeCount(0)
+	, invalidatedCount(0)
+	, clearedInvalidationCount(0)
+	, identityTransform(1.0f)
 {
+	this->debugDraw = new DebugDraw(driver);
+	
 	Log::info("New graphic world !!");
 }
 
 GraphicWorld::~GraphicWorld()
 {
+	for (unsigned int i = 0; i < this->staticBatches.size(); i++)
+	{
+		this->driver->destroyVertexBuffer(this->staticBatches[i]->buffer);
+		delete this->staticBatches[i];
+	}
+	delete this->debugDraw;
+	
 	Log::info("Destroyed graphic world !!");
 }
 
-void GraphicWorld::render(GraphicDriver *driver, Camera *camera)
+GraphicWorld::RenderList::RenderList()
+	: targetHeight(0)
+	, occlusionVersion(0)
+	, updateCount(0)
+	, synchronized(false)
+	, changeCount(0)
+	, invalidationCount(0)
 {
+}
+
+GraphicWorld::RenderList::~RenderList()
+{
+	std::vector<CommandList *> commandLists;
+	this->releaseCommandLists(&commandLists);
+	for (unsigned int i = 0; i < commandLists.size(); i++)
+		delete commandLists[i];
+}
+
+void GraphicWorld::RenderList::releaseCommandLists(std::vector<CommandList *> *commandLists)
+{
+	for (unsigned int i = 0; i < this->chunks.size(); i++)
+	{
+		if (this->chunks[i]->commandList)
+			commandLists->push_back(this->chunks[i]->commandList);
+		delete this->chunks[i];
+	}
+	this->chunks.clear();
+	
+	for (unsigned int i = 0; i < this->retiredLists.size(); i++)
+		commandLists->push_back(this->retiredLists[i].commandList);
+	this->retiredLists.clear();
+	
+	commandLists->insert(commandLists->end(), this->freeLists.begin(), this->freeLists.end());
+	this->freeLists.clear();
+	
+	// rebuilt if updated again
+	this->synchronized = false;
+}
+
+void GraphicWorld::updateRenderList(RenderList *renderList, const Camera *camera, const OcclusionBuffer *occlusionBuffer, unsigned int targetHeight, unsigned int framesInFlight) const
+{
+	// lists retired long enough ago are not replayed anymore
+	renderList->updateCount++;
+	unsigned int retiredCount = 0;
+	for (unsigned int i = 0; i < renderList->retiredLists.size(); i++)
+	{
+		const RenderList::RetiredList &retired = renderList->retiredLists[i];
+		if (renderList->updateCount - retired.update >= framesInFlight)
+			renderList->freeLists.push_back(retired.commandList);
+		else
+			renderList->retiredLists[retiredCount++] = retired;
+	}
+	renderList->retiredLists.resize(retiredCount);
+	
+	unsigned int handleCount = (unsigned int)this->handleSlots.size();
+	renderList->handleChunks.resize(handleCount, NULL);
+	renderList->lodStates.resize(handleCount);
+	
+	if (!renderList->synchronized || renderList->changeCount < this->clearedChangeCount || renderList->invalidationCount < this->clearedInvalidationCount)
+	{
+		// some changes were missed, start over
+		for (unsigned int i = 0; i < renderList->chunks.size(); i++)
+		{
+			retireCommandList(renderList, renderList->chunks[i]->commandList);
+			delete renderList->chunks[i];
+		}
+		renderList->chunks.clear();
+		renderList->handleChunks.assign(handleCount, NULL);
+		renderList->translucentHandles.clear();
+		renderList->shaderCounts.clear();
+		
+		// sorted at once, then cut in chunks
+		std::vector<RenderList::Item> items;
+		for (unsigned int i = 0; i < this->renderables.size(); i++)
+		{
+			RenderableHandle handle = this->renderableHandles[i];
+			renderList->lodStates[handle] = LodState();
+			if (isTranslucent(this->renderables[i]))
+				renderList->translucentHandles.push_back(handle);
+			else
+			{
+				items.push_back(getRenderItem(this->renderables[i], handle));
+				renderList->shaderCounts[this->renderables[i].shader]++;
+			}
+		}
+		std::sort(items.begin(), items.end(), RenderStateComparator());
+		
+		for (unsigned int i = 0; i < items.size(); i += renderChunkSize)
+		{
+			RenderList::Chunk *chunk = new RenderList::Chunk;
+			chunk->items.assign(items.begin() + i, items.begin() + std::min(i + renderChunkSize, (unsigned int)items.size()));
+			for (unsigned int j = 0; j < chunk->items.size(); j++)
+				renderList->handleChunks[chunk->items[j].handle] = chunk;
+			renderList->chunks.push_back(chunk);
+		}
+	}
+	else
+	{
+		// patch the renderables registered and unregistered in, once each
+		unsigned int firstChange = renderList->changeCount - this->clearedChangeCount;
+		if (firstChange < this->changes.size())
+		{
+			std::vector<bool> changed(handleCount, false);
+			for (unsigned int i = firstChange; i < this->changes.size(); i++)
+			{
+				RenderableHandle handle = this->changes[i].handle;
+				if (changed[handle])
+					continue;
+				changed[handle] = true;
+				
+				this->removeRenderItem(renderList, handle);
+				
+				const HandleSlot &slot = this->handleSlots[handle];
+				if (slot.registered && !slot.batched)
+				{
+					renderList->lodStates[handle] = LodState();
+					this->addRenderItem(renderList, handle);
+				}
+			}
+		}
+		
+		// then the invalidated ones: moved again if their render state changed,
+		// recorded again otherwise
+		for (unsigned int i = renderList->invalidationCount - this->clearedInvalidationCount; i < (unsigned int)this->invalidatedCount; i++)
+		{
+			RenderableHandle handle = this->invalidatedHandles[i];
+			const HandleSlot &slot = this->handleSlots[handle];
+			if (!slot.registered || slot.batched)
+				continue;
+			
+			// translucent ones are recorded each frame anyway
+			const Renderable &renderable = this->getRenderable(handle);
+			RenderList::Chunk *chunk = renderList->handleChunks[handle];
+			if (!chunk && isTranslucent(renderable))
+				continue;
+			
+			if (chunk && !isTranslucent(renderable))
+			{
+				RenderList::Item item = getRenderItem(renderable, handle);
+				unsigned int index = 0;
+				while (chunk->items[index].handle != handle)
+					index++;
+				
+				if (hasRenderState(item, chunk->items[index]))
+				{
+					chunk->dirty = true;
+					continue;
+				}
+			}
+			
+			this->removeRenderItem(renderList, handle);
+			this->addRenderItem(renderList, handle);
+		}
+		
+		// merge the chunks left small with the next one
+		std::vector<RenderList::Chunk *> &chunks = renderList->chunks;
+		for (unsigned int i = 0; i + 1 < chunks.size(); )
+		{
+			RenderList::Chunk *chunk = chunks[i];
+			RenderList::Chunk *next = chunks[i + 1];
+			unsigned int itemCount = (unsigned int)(chunk->items.size() + next->items.size());
+			if (itemCount > renderChunkSize || (chunk->items.size() >= renderChunkSize / 4 && next->items.size() >= renderChunkSize / 4))
+			{
+				i++;
+				continue;
+			}
+			
+			for (unsigned int j = 0; j < next->items.size(); j++)
+				renderList->handleChunks[next->items[j].handle] = chunk;
+			chunk->items.insert(chunk->items.end(), next->items.begin(), next->items.end());
+			chunk->dirty = true;
+			
+			retireCommandList(renderList, next->commandList);
+			delete next;
+			chunks.erase(chunks.begin() + i + 1);
+		}
+	}
+	renderList->synchronized = true;
+	renderList->changeCount = this->clearedChangeCount + (unsigned int)this->changes.size();
+	renderList->invalidationCount = this->clearedInvalidationCount + (unsigned int)this->invalidatedCount;
+	
+	// everything is culled again when the view changed
 	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
 	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+	bool viewChanged = (viewProjectionMatrix != renderList->viewProjectionMatrix || targetHeight != renderList->targetHeight || occlusionBuffer->getVersion() != renderList->occlusionVersion);
+	renderList->viewProjectionMatrix = viewProjectionMatrix;
+	renderList->targetHeight = targetHeight;
+	renderList->occlusionVersion = occlusionBuffer->getVersion();
+	
+	Frustum frustum(viewProjectionMatrix);
+	CullView view;
+	view.frustum = &frustum;
+	view.occlusionBuffer = occlusionBuffer;
+	view.viewMatrix = viewMatrix;
+	view.cameraPosition = glm::vec3(cameraTransform[3]);
+	view.projectionScale = projectionMatrix[1][1];
+	view.pixelScale = projectionMatrix[1][1] * 0.5f * (float)targetHeight;
+	view.nearPlane = camera->getNearPlane();
+	view.time = (float)Time::getTime();
 	
+	for (unsigned int i = 0; i < renderList->chunks.size(); i++)
+	{
+		RenderList::Chunk *chunk = renderList->chunks[i];
+		chunk->changed = false;
+		
+		// textures streamed in since recorded are bound again
+		for (unsigned int j = 0; j < chunk->textures.size(); j++)
+		{
+			if (chunk->textures[j].resource->getTexture() != chunk->textures[j].texture)
+				chunk->dirty = true;
+		}
+		
+		if (viewChanged || chunk->dirty || chunk->fading)
+			cullChunk(this, chunk, &renderList->lodStates[0], view);
+		else
+		{
+			for (unsigned int j = 0; j < chunk->textures.size(); j++)
+			{
+				const RenderList::TextureUse &use = chunk->textures[j];
+				if (use.resource->isUsable())
+					use.resource->requestLevel(use.level);
+			}
+		}
+		
+		// recorded in a fresh list, frames in flight may still replay the previous one
+		if (chunk->changed)
+		{
+			retireCommandList(renderList, chunk->commandList);
+			if (renderList->freeLists.empty())
+				chunk->commandList = new CommandList;
+			else
+			{
+				chunk->commandList = renderList->freeLists.back();
+				renderList->freeLists.pop_back();
+			}
+		}
+	}
+}
+
+void GraphicWorld::recordViewConstants(CommandList *commandList, const RenderList *renderList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, float fogDensity) const
+{
+	glm::mat4 viewMatrix = glm::affineInverse(camera->getEntity()->getLocalTransform());
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	float time = (float)Time::getTime();
+	
+	// the programs keep their constants for the chunks replayed after
+	for (RenderList::ShaderCountMap::const_iterator it = renderList->shaderCounts.begin(); it != renderList->shaderCounts.end(); ++it)
+	{
+		commandList->bindShaderProgram(it->first);
+		commandList->setShaderConstant("viewMatrix", viewMatrix);
+		commandList->setShaderConstant("projectionMatrix", projectionMatrix);
+		commandList->setShaderConstant("time", time);
+		lightClusters->record(commandList);
+		shadowMaps->record(commandList);
+		commandList->setShaderConstant("lodFade", 0.0f);
+		commandList->setShaderConstant("transparency", 0.0f);
+		commandList->setShaderConstant("fogDensity", fogDensity);
+	}
+}
+
+void GraphicWorld::recordRenderChunk(CommandList *commandList, const RenderList::Chunk *chunk) const
+{
+	// the view constants are already set, the fade is left at 0 for the next lists
+	ShaderProgram *currentShader = NULL;
+	VertexBuffer *currentBuffer = NULL;
+	Texture *currentTexture = NULL;
+	float currentFade = 0.0f;
+	for (unsigned int i = 0; i < chunk->items.size(); i++)
+	{
+		const RenderList::Item &item = chunk->items[i];
+		if (!item.visible)
+			continue;
+		
+		const Renderable &renderable = this->getRenderable(item.handle);
+		if (renderable.shader != currentShader)
+		{
+			if (currentFade != 0.0f)
+				commandList->setShaderConstant("lodFade", 0.0f);
+			
+			commandList->bindShaderProgram(renderable.shader);
+			currentShader = renderable.shader;
+			currentBuffer = NULL;
+			currentFade = 0.0f;
+		}
+		
+		if (renderable.texture)
+		{
+			TextureResource *resource = *renderable.texture;
+			Texture *texture = resource ? resource->getTexture() : this->defaultTexture;
+			if (texture != currentTexture)
+			{
+				commandList->bindTexture(texture, 0);
+				currentTexture = texture;
+			}
+		}
+		
+		const glm::mat4 &transform = *renderable.transform;
+		commandList->setShaderConstant("modelMatrix", transform);
+		commandList->setShaderConstant("normalMatrix", glm::inverseTranspose(glm::mat3(transform)));
+		if (renderable.color)
+			commandList->setShaderConstant("color", *renderable.color);
+		if (renderable.boneCount > 0)
+			commandList->setShaderConstant("boneMatrices", renderable.boneMatrices, renderable.boneCount * 3);
+		
+		if (item.fade < 1.0f)
+		{
+			drawLod(commandList, renderable, item.previousLevel, -item.fade, &currentBuffer, &currentFade);
+			drawLod(commandList, renderable, item.level, glm::max(item.fade, 0.001f), &currentBuffer, &currentFade);
+		}
+		else
+			drawLod(commandList, renderable, item.level, 0.0f, &currentBuffer, &currentFade);
+	}
+	
+	if (currentFade != 0.0f)
+		commandList->setShaderConstant("lodFade", 0.0f);
+}
+
+void GraphicWorld::recordTranslucent(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, const OcclusionBuffer *occlusionBuffer, RenderList *renderList, unsigned int targetHeight, float fogDensity) const
+{
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	Frustum frustum(camera->getProjectionMatrix() * viewMatrix);
+	
+	// cull like the opaque renderables, keying the others by the depth of their center
+	std::vector<TranslucentItem> items;
+	for (unsigned int i = 0; i < renderList->translucentHandles.size(); i++)
+	{
+		RenderableHandle handle = renderList->translucentHandles[i];
+		const Renderable &renderable = this->getRenderable(handle);
+		if (*renderable.opacity <= 0.0f || !isVisible(renderable, frustum))
+			continue;
+		
+		const glm::mat4 &transform = *renderable.transform;
+		glm::vec3 center = glm::vec3(transform * glm::vec4(renderable.boundingCenter, 1.0f));
+		if (renderable.boundingRadius > 0.0f && !occlusionBuffer->isVisible(center, renderable.boundingRadius * getLargestScale(transform)))
+			continue;
+		
+		TranslucentItem item;
+		item.key = RadixSort::getBackToFrontKey(-(viewMatrix * glm::vec4(center, 1.0f)).z, camera->getNearPlane(), camera->getFarPlane());
+		item.index = handle;
+		items.push_back(item);
+	}
+	
+	if (items.empty())
+		return;
+	
+	std::vector<TranslucentItem> scratch;
+	RadixSort::sort(&items, &scratch);
+	
+	std::vector<RenderableHandle> order(items.size());
+	for (unsigned int i = 0; i < items.size(); i++)
+		order[i] = items[i].index;
+	
+	commandList->setBlendMode(GraphicDriver::AlphaBlend);
+	this->recordRenderables(commandList, camera, lightClusters, shadowMaps, renderList, targetHeight, fogDensity, &order[0], (unsigned int)order.size());
+	commandList->setBlendMode(GraphicDriver::OpaqueBlend);
+}
+
+void GraphicWorld::recordRenderables(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, RenderList *renderList, unsigned int targetHeight, float fogDensity, const RenderableHandle *order, unsigned int count) const
+{
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	
+	float time = (float)Time::getTime();
+	float pixelScale = projectionMatrix[1][1] * 0.5f * (float)targetHeight;
+	glm::vec3 cameraPosition = glm::vec3(cameraTransform[3]);
+	
+	// record, with view constants set only once per shader
+	ShaderProgram *currentShader = NULL;
+	VertexBuffer *currentBuffer = NULL;
+	Texture *currentTexture = NULL;
+	float currentFade = 0.0f;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const Renderable &renderable = this->getRenderable(order[i]);
+		
+		if (renderable.shader != currentShader)
+		{
+			commandList->bindShaderProgram(renderable.shader);
+			commandList->setShaderConstant("viewMatrix", viewMatrix);
+			commandList->setShaderConstant("projectionMatrix", projectionMatrix);
+			commandList->setShaderConstant("time", time);
+			lightClusters->record(commandList);
+			shadowMaps->record(commandList);
+			commandList->setShaderConstant("lodFade", 0.0f);
+			commandList->setShaderConstant("transparency", 0.0f);
+			commandList->setShaderConstant("fogDensity", fogDensity);
+			
+			currentShader = renderable.shader;
+			currentBuffer = NULL;
+			currentFade = 0.0f;
+		}
+		
+		// level of detail, and the one fading out after a switch
+		unsigned int level = 0;
+		unsigned int previousLevel = 0;
+		float fadeProgress = 1.0f;
+		if (renderable.lodCount > 0)
+		{
+			LodState *state = &renderList->lodStates[order[i]];
+			fadeProgress = updateLod(renderable, getScreenSize(renderable, cameraPosition, projectionMatrix[1][1], camera->getNearPlane()), time, state);
+			level = state->level;
+			previousLevel = state->previousLevel;
+		}
+		
+		if (renderable.texture)
+		{
+			TextureResource *resource = *renderable.texture;
+			if (resource && resource->isUsable())
+				resource->requestLevel(getRequiredLevel(renderable, resource, viewMatrix, pixelScale, camera->getNearPlane()));
+			
+			Texture *texture = resource ? resource->getTexture() : this->defaultTexture;
+			if (texture != currentTexture)
+			{
+				commandList->bindTexture(texture, 0);
+				currentTexture = texture;
+			}
+		}
+		
+		commandList->setShaderConstant("modelMatrix", *renderable.transform);
+		commandList->setShaderConstant("normalMatrix", glm::inverseTranspose(glm::mat3(*renderable.transform)));
+		if (renderable.color)
+			commandList->setShaderConstant("color", *renderable.color);
+		commandList->setShaderConstant("transparency", 1.0f - *renderable.opacity);
+		if (renderable.boneCount > 0)
+			commandList->setShaderConstant("boneMatrices", renderable.boneMatrices, renderable.boneCount * 3);
+		
+		if (fadeProgress < 1.0f)
+		{
+			drawLod(commandList, renderable, previousLevel, -fadeProgress, &currentBuffer, &currentFade);
+			drawLod(commandList, renderable, level, glm::max(fadeProgress, 0.001f), &currentBuffer, &currentFade);
+		}
+		else
+			drawLod(commandList, renderable, level, 0.0f, &currentBuffer, &currentFade);
+	}
+}
+
+void GraphicWorld::recordShadowCasters(CommandList *commandList, const glm::mat4 &viewProjectionMatrix, bool staticCasters, ShaderProgram *shader) const
+{
+	Frustum frustum(viewProjectionMatrix);
+	
+	// orthographic projections: sizes do not depend on the distance
+	float projectionScale = glm::length(glm::vec3(viewProjectionMatrix[0][1], viewProjectionMatrix[1][1], viewProjectionMatrix[2][1]));
+	
+	// cull
+	std::vector<unsigned int> casters;
+	unsigned int firstBatch = (unsigned int)this->renderables.size() - this->batchCount;
 	for (unsigned int i = 0; i < this->renderables.size(); i++)
 	{
 		const Renderable &renderable = this->renderables[i];
+		bool isStatic = (i >= firstBatch) || (renderable.entity && renderable.entity->isStatic());
+		if (renderable.castsShadows && isStatic == staticCasters && isVisible(renderable, frustum))
+			casters.push_back(i);
+	}
+	
+	if (casters.empty())
+		return;
+	
+	// sort
+	std::sort(casters.begin(), casters.end(), BufferComparator(&this->renderables[0]));
+	
+	// record
+	commandList->bindShaderProgram(shader);
+	commandList->setShaderConstant("viewProjectionMatrix", viewProjectionMatrix);
+	VertexBuffer *currentBuffer = NULL;
+	float currentFade = 0.0f;
+	for (unsigned int i = 0; i < casters.size(); i++)
+	{
+		const Renderable &renderable = this->renderables[casters[i]];
 		
-		driver->bindShaderProgram(renderable.shader);
-		driver->bindVertexBuffer(renderable.buffer);
+		// levels of detail are selected without hysteresis, static maps are cached anyway
+		unsigned int level = 0;
+		if (renderable.lodCount > 0)
+		{
+			float screenSize = renderable.boundingRadius * getLargestScale(*renderable.transform) * projectionScale;
+			while (level < renderable.lodCount && screenSize < renderable.lods[level].screenSize)
+				level++;
+		}
+		
+		commandList->setShaderConstant("modelMatrix", *renderable.transform);
+		drawLod(commandList, renderable, level, 0.0f, &currentBuffer, &currentFade);
+	}
+}
+
+bool GraphicWorld::hasDynamicShadowCasters(const glm::mat4 &viewProjectionMatrix) const
+{
+	Frustum frustum(viewProjectionMatrix);
+	
+	// batches are all static
+	unsigned int firstBatch = (unsigned int)this->renderables.size() - this->batchCount;
+	for (unsigned int i = 0; i < firstBatch; i++)
+	{
+		const Renderable &renderable = this->renderables[i];
+		if (renderable.castsShadows && !(renderable.entity && renderable.entity->isStatic()) && isVisible(renderable, frustum))
+			return true;
+	}
+	
+	return false;
+}
+
+GraphicWorld::RenderableHandle GraphicWorld::registerRenderable(const Renderable &renderable)
+{
+	RenderableHandle handle = this->allocateHandle();
+	this->addDrawnRenderable(renderable, handle, false);
+	
+	if (renderable.entity && renderable.entity->isStatic())
+		this->staticVersion++;
+	
+	return handle;
+}
+
+void GraphicWorld::unregisterRenderable(RenderableHandle handle)
+{
+	OAK_ASSERT(handle < this->handleSlots.size() && this->handleSlots[handle].registered, "Unregistering an unknown renderable");
+	
+	HandleSlot &slot = this->handleSlots[handle];
+	if (slot.batched)
+	{
+		// merged in the batches, which are rebuilt without it
+		unsigned int last = (unsigned int)this->staticRenderables.size() - 1;
+		this->staticRenderables[slot.index] = this->staticRenderables[last];
+		this->staticHandles[slot.index] = this->staticHandles[last];
+		this->handleSlots[this->staticHandles[slot.index]].index = slot.index;
+		this->staticRenderables.pop_back();
+		this->staticHandles.pop_back();
 		
-		driver->setShaderConstant("modelMatrix", *renderable.transform);
-		driver->setShaderConstant("normalMatrix", glm::inverseTranspose(glm::mat3(*renderable.transform)));
-		driver->setShaderConstant("viewMatrix", viewMatrix);
-		driver->setShaderConstant("projectionMatrix", camera->getProjectionMatrix());
+		this->staticBatchesChanged = true;
+		this->staticVersion++;
+	}
+	else
+	{
+		const Renderable &renderable = this->renderables[slot.index];
+		if (renderable.entity && renderable.entity->isStatic())
+			this->staticVersion++;
 		
-		driver->draw(renderable.primitiveType, renderable.startElement, renderable.elementCount);
+		this->removeDrawnRenderable(slot.index);
+	}
+	
+	this->releaseHandle(handle);
+}
+
+const GraphicWorld::Renderable &GraphicWorld::getRenderable(RenderableHandle handle) const
+{
+	const HandleSlot &slot = this->handleSlots[handle];
+	OAK_ASSERT(slot.registered, "Unknown renderable");
+	return slot.batched ? this->staticRenderables[slot.index] : this->renderables[slot.index];
+}
+
+void GraphicWorld::invalidateRenderable(RenderableHandle handle)
+{
+	OAK_ASSERT(handle < this->handleSlots.size() && this->handleSlots[handle].registered, "Invalidating an unknown renderable");
+	
+	// listed once per frame
+	if (Atomic::compareAndSwap(&this->handleSlots[handle].invalidated, 0, 1) != 0)
+		return;
+	
+	int index = Atomic::increment(&this->invalidatedCount) - 1;
+	this->invalidatedHandles[index] = handle;
+}
+
+void GraphicWorld::clearChanges()
+{
+	this->clearedChangeCount += (unsigned int)this->changes.size();
+	this->changes.clear();
+	
+	for (int i = 0; i < this->invalidatedCount; i++)
+		this->handleSlots[this->invalidatedHandles[i]].invalidated = 0;
+	this->clearedInvalidationCount += (unsigned int)this->invalidatedCount;
+	this->invalidatedCount = 0;
+}
+
+void GraphicWorld::addRenderItem(RenderList *renderList, RenderableHandle handle) const
+{
+	const Renderable &renderable = this->getRenderable(handle);
+	if (isTranslucent(renderable))
+	{
+		renderList->translucentHandles.push_back(handle);
+		return;
+	}
+	
+	RenderList::Item item = getRenderItem(renderable, handle);
+	renderList->shaderCounts[item.shader]++;
+	
+	// in the first chunk ending after it, or the last one
+	std::vector<RenderList::Chunk *> &chunks = renderList->chunks;
+	std::vector<RenderList::Chunk *>::iterator it;
+	if (chunks.empty())
+		it = chunks.insert(chunks.end(), new RenderList::Chunk);
+	else
+	{
+		it = std::lower_bound(chunks.begin(), chunks.end(), item, ChunkComparator());
+		if (it == chunks.end())
+			--it;
+	}
+	
+	RenderList::Chunk *chunk = *it;
+	chunk->items.insert(std::upper_bound(chunk->items.begin(), chunk->items.end(), item, RenderStateComparator()), item);
+	chunk->dirty = true;
+	renderList->handleChunks[handle] = chunk;
+	
+	// split in two halves, both culled and recorded again
+	if (chunk->items.size() > renderChunkSize * 2)
+	{
+		RenderList::Chunk *next = new RenderList::Chunk;
+		unsigned int half = (unsigned int)chunk->items.size() / 2;
+		next->items.assign(chunk->items.begin() + half, chunk->items.end());
+		chunk->items.resize(half);
+		for (unsigned int i = 0; i < next->items.size(); i++)
+			renderList->handleChunks[next->items[i].handle] = next;
+		chunks.insert(it + 1, next);
+	}
+}
+
+void GraphicWorld::removeRenderItem(RenderList *renderList, RenderableHandle handle) const
+{
+	RenderList::Chunk *chunk = renderList->handleChunks[handle];
+	if (!chunk)
+	{
+		// translucent, or not in the list
+		std::vector<RenderableHandle> &handles = renderList->translucentHandles;
+		std::vector<RenderableHandle>::iterator it = std::find(handles.begin(), handles.end(), handle);
+		if (it != handles.end())
+		{
+			*it = handles.back();
+			handles.pop_back();
+		}
+		return;
+	}
+	
+	unsigned int index = 0;
+	while (chunk->items[index].handle != handle)
+		index++;
+	
+	RenderList::ShaderCountMap::iterator count = renderList->shaderCounts.find(chunk->items[index].shader);
+	if (--count->second == 0)
+		renderList->shaderCounts.erase(count);
+	
+	chunk->items.erase(chunk->items.begin() + index);
+	chunk->dirty = true;
+	renderList->handleChunks[handle] = NULL;
+	
+	if (chunk->items.empty())
+	{
+		retireCommandList(renderList, chunk->commandList);
+		renderList->chunks.erase(std::find(renderList->chunks.begin(), renderList->chunks.end(), chunk));
+		delete chunk;
 	}
 }
 
-void GraphicWorld::registerRenderable(const Renderable &renderable)
+void GraphicWorld::addDrawnRenderable(const Renderable &renderable, RenderableHandle handle, bool batch)
 {
+	unsigned int index = (unsigned int)this->renderables.size();
 	this->renderables.push_back(renderable);
+	this->renderableHandles.push_back(handle);
+	
+	// keep the batches at the end: the first one moves to the end instead
+	if (batch)
+		this->batchCount++;
+	else if (this->batchCount > 0)
+	{
+		index -= this->batchCount;
+		this->moveDrawnRenderable(index, (unsigned int)this->renderables.size() - 1);
+		this->renderables[index] = renderable;
+		this->renderableHandles[index] = handle;
+	}
+	
+	HandleSlot &slot = this->handleSlots[handle];
+	slot.index = index;
+	slot.batched = false;
+	
+	RenderableChange change;
+	change.handle = handle;
+	change.registered = true;
+	this->changes.push_back(change);
+}
+
+void GraphicWorld::removeDrawnRenderable(unsigned int index)
+{
+	RenderableChange change;
+	change.handle = this->renderableHandles[index];
+	change.registered = false;
+	this->changes.push_back(change);
+	
+	// fill the hole with the last renderable of the same kind, and the hole it
+	// leaves with the last batch
+	unsigned int last = (unsigned int)this->renderables.size() - 1;
+	unsigned int firstBatch = last + 1 - this->batchCount;
+	if (index >= firstBatch)
+	{
+		this->moveDrawnRenderable(last, index);
+		this->batchCount--;
+	}
+	else
+	{
+		this->moveDrawnRenderable(firstBatch - 1, index);
+		this->moveDrawnRenderable(last, firstBatch - 1);
+	}
+	
+	this->renderables.pop_back();
+	this->renderableHandles.pop_back();
+}
+
+void GraphicWorld::moveDrawnRenderable(unsigned int from, unsigned int to)
+{
+	if (from == to)
+		return;
+	
+	this->renderables[to] = this->renderables[from];
+	this->renderableHandles[to] = this->renderableHandles[from];
+	this->handleSlots[this->renderableHandles[to]].index = to;
+}
+
+GraphicWorld::RenderableHandle GraphicWorld::allocateHandle()
+{
+	RenderableHandle handle;
+	if (this->freeHandles.empty())
+	{
+		handle = (RenderableHandle)this->handleSlots.size();
+		this->handleSlots.push_back(HandleSlot());
+		this->invalidatedHandles.resize(this->handleSlots.size());
+	}
+	else
+	{
+		handle = this->freeHandles.back();
+		this->freeHandles.pop_back();
+	}
+	
+	this->handleSlots[handle].registered = true;
+	return handle;
+}
+
+void GraphicWorld::releaseHandle(RenderableHandle handle)
+{
+	this->handleSlots[handle].registered = false;
+	this->freeHandles.push_back(handle);
+}
+
+void GraphicWorld::registerLight(const Light *light)
+{
+	this->lights.push_back(light);
+}
+
+void GraphicWorld::unregisterLight(const Light *light)
+{
+	LightVector::iterator it = std::find(this->lights.begin(), this->lights.end(), light);
+	OAK_ASSERT(it != this->lights.end(), "Unregistering a light that was never registered");
+	
+	*it = this->lights.back();
+	this->lights.pop_back();
+}
+
+void GraphicWorld::registerOccluder(const Occluder *occluder)
+{
+	this->occluders.push_back(occluder);
+}
+
+void GraphicWorld::unregisterOccluder(const Occluder *occluder)
+{
+	OccluderVector::iterator it = std::find(this->occluders.begin(), this->occluders.end(), occluder);
+	OAK_ASSERT(it != this->occluders.end(), "Unregistering an occluder that was never registered");
+	
+	*it = this->occluders.back();
+	this->occluders.pop_back();
+}
+
+void GraphicWorld::registerSprite(const Sprite *sprite)
+{
+	this->sprites.push_back(sprite);
+}
+
+void GraphicWorld::unregisterSprite(const Sprite *sprite)
+{
+	SpriteVector::iterator it = std::find(this->sprites.begin(), this->sprites.end(), sprite);
+	OAK_ASSERT(it != this->sprites.end(), "Unregistering a sprite that was never registered");
+	
+	// the order of the others is kept, it breaks ties when sorting
+	this->sprites.erase(it);
+}
+
+void GraphicWorld::registerText(const Text *text)
+{
+	this->texts.push_back(text);
+}
+
+void GraphicWorld::unregisterText(const Text *text)
+{
+	TextVector::iterator it = std::find(this->texts.begin(), this->texts.end(), text);
+	OAK_ASSERT(it != this->texts.end(), "Unregistering a text that was never registered");
+	
+	// the order of the others is kept, it breaks ties when sorting
+	this->texts.erase(it);
+}
+
+void GraphicWorld::registerParticleEmitter(ParticleEmitter *emitter)
+{
+	this->particleEmitters.push_back(emitter);
+}
+
+void GraphicWorld::unregisterParticleEmitter(ParticleEmitter *emitter)
+{
+	ParticleEmitterVector::iterator it = std::find(this->particleEmitters.begin(), this->particleEmitters.end(), emitter);
+	OAK_ASSERT(it != this->particleEmitters.end(), "Unregistering a particle emitter that was never registered");
+	
+	// the order of the others is kept, emitters are drawn in registration order
+	this->particleEmitters.erase(it);
+}
+
+void GraphicWorld::simulateParticles(float elapsedTime, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	// the jobs must not move once pushed
+	this->particleJobs.resize(this->particleEmitters.size());
+	for (unsigned int i = 0; i < this->particleEmitters.size(); i++)
+	{
+		ParticleJob &job = this->particleJobs[i];
+		job.emitter = this->particleEmitters[i];
+		job.elapsedTime = elapsedTime;
+		
+		jobQueue->push(GraphicWorld::runParticleJob, &job, batch);
+	}
+}
+
+void GraphicWorld::runParticleJob(void *userData)
+{
+	ParticleJob *job = (ParticleJob *)userData;
+	job->emitter->simulate(job->elapsedTime);
+}
+
+void GraphicWorld::registerSkinnedMesh(SkinnedMesh *mesh)
+{
+	this->skinnedMeshes.push_back(mesh);
+}
+
+void GraphicWorld::unregisterSkinnedMesh(SkinnedMesh *mesh)
+{
+	SkinnedMeshVector::iterator it = std::find(this->skinnedMeshes.begin(), this->skinnedMeshes.end(), mesh);
+	OAK_ASSERT(it != this->skinnedMeshes.end(), "Unregistering a skinned mesh that was never registered");
+	
+	this->skinnedMeshes.erase(it);
+}
+
+void GraphicWorld::animateSkinnedMeshes(float elapsedTime, StreamBuffer *streamBuffer, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	// the jobs must not move once pushed
+	unsigned int jobCount = ((unsigned int)this->skinnedMeshes.size() + skinnedMeshesPerJob - 1) / skinnedMeshesPerJob;
+	this->animationJobs.resize(jobCount);
+	for (unsigned int i = 0; i < jobCount; i++)
+	{
+		AnimationJob &job = this->animationJobs[i];
+		job.meshes = &this->skinnedMeshes[i * skinnedMeshesPerJob];
+		job.meshCount = std::min(skinnedMeshesPerJob, (unsigned int)this->skinnedMeshes.size() - i * skinnedMeshesPerJob);
+		job.elapsedTime = elapsedTime;
+		job.streamBuffer = streamBuffer;
+		
+		jobQueue->push(GraphicWorld::runAnimationJob, &job, batch);
+	}
+}
+
+void GraphicWorld::runAnimationJob(void *userData)
+{
+	AnimationJob *job = (AnimationJob *)userData;
+	for (unsigned int i = 0; i < job->meshCount; i++)
+		job->meshes[i]->animate(job->elapsedTime, job->streamBuffer);
+}
+
+void GraphicWorld::registerAnimator(Animator *animator)
+{
+	this->animators.push_back(animator);
+}
+
+void GraphicWorld::unregisterAnimator(Animator *animator)
+{
+	AnimatorVector::iterator it = std::find(this->animators.begin(), this->animators.end(), animator);
+	OAK_ASSERT(it != this->animators.end(), "Unregistering an animator that was never registered");
+	
+	this->animators.erase(it);
+}
+
+void GraphicWorld::updateAnimators(float elapsedTime, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	// the jobs must not move once pushed
+	unsigned int jobCount = ((unsigned int)this->animators.size() + animatorsPerJob - 1) / animatorsPerJob;
+	this->animatorJobs.resize(jobCount);
+	for (unsigned int i = 0; i < jobCount; i++)
+	{
+		AnimatorJob &job = this->animatorJobs[i];
+		job.animators = &this->animators[i * animatorsPerJob];
+		job.animatorCount = std::min(animatorsPerJob, (unsigned int)this->animators.size() - i * animatorsPerJob);
+		job.elapsedTime = elapsedTime;
+		
+		jobQueue->push(GraphicWorld::runAnimatorJob, &job, batch);
+	}
+}
+
+void GraphicWorld::runAnimatorJob(void *userData)
+{
+	AnimatorJob *job = (AnimatorJob *)userData;
+	for (unsigned int i = 0; i < job->animatorCount; i++)
+		job->animators[i]->animate(job->elapsedTime);
 }
 
-/*void GraphicWorld::unregisterRenderable(Renderable *renderable)
+void GraphicWorld::registerVoxelChunk(VoxelChunk *chunk)
 {
-}*/
+	this->voxelChunks.push_back(chunk);
+}
+
+void GraphicWorld::unregisterVoxelChunk(VoxelChunk *chunk)
+{
+	VoxelChunkVector::iterator it = std::find(this->voxelChunks.begin(), this->voxelChunks.end(), chunk);
+	OAK_ASSERT(it != this->voxelChunks.end(), "Unregistering a voxel chunk that was never registered");
+	
+	this->voxelChunks.erase(it);
+}
+
+void GraphicWorld::updateVoxelChunks()
+{
+	for (unsigned int i = 0; i < this->voxelChunks.size(); i++)
+		this->voxelChunks[i]->update();
+}
+
+void GraphicWorld::registerTerrain(Terrain *terrain)
+{
+	this->terrains.push_back(terrain);
+}
+
+void GraphicWorld::unregisterTerrain(Terrain *terrain)
+{
+	TerrainVector::iterator it = std::find(this->terrains.begin(), this->terrains.end(), terrain);
+	OAK_ASSERT(it != this->terrains.end(), "Unregistering a terrain that was never registered");
+	
+	this->terrains.erase(it);
+}
+
+void GraphicWorld::updateTerrains()
+{
+	for (unsigned int i = 0; i < this->terrains.size(); i++)
+		this->terrains[i]->update();
+}
+
+void GraphicWorld::buildStaticBatches(float cellSize)
+{
+	OAK_ASSERT(cellSize > 0.0f, "Static batches need a positive cell size");
+	
+	this->batchCellSize = cellSize;
+	this->staticBatchesChanged = false;
+	
+	// release the previous batches
+	while (this->batchCount > 0)
+	{
+		unsigned int index = (unsigned int)this->renderables.size() - 1;
+		RenderableHandle handle = this->renderableHandles[index];
+		this->removeDrawnRenderable(index);
+		this->releaseHandle(handle);
+	}
+	for (unsigned int i = 0; i < this->staticBatches.size(); i++)
+	{
+		this->driver->destroyVertexBuffer(this->staticBatches[i]->buffer);
+		delete this->staticBatches[i];
+	}
+	this->staticBatches.clear();
+	
+	// take the static renderables out of the dynamic ones, their handles still
+	// point to them
+	for (unsigned int i = 0; i < this->renderables.size(); )
+	{
+		if (!isBatchable(this->renderables[i]))
+		{
+			i++;
+			continue;
+		}
+		
+		RenderableHandle handle = this->renderableHandles[i];
+		this->staticRenderables.push_back(this->renderables[i]);
+		this->staticHandles.push_back(handle);
+		this->removeDrawnRenderable(i);
+		
+		HandleSlot &slot = this->handleSlots[handle];
+		slot.index = (unsigned int)this->staticRenderables.size() - 1;
+		slot.batched = true;
+	}
+	
+	// group them by material and cell
+	typedef std::map<BatchKey, std::vector<unsigned int> > BatchMap;
+	BatchMap batches;
+	for (unsigned int i = 0; i < this->staticRenderables.size(); i++)
+	{
+		const Renderable &renderable = this->staticRenderables[i];
+		glm::vec3 center = glm::vec3(*renderable.transform * glm::vec4(renderable.boundingCenter, 1.0f));
+		
+		BatchKey key;
+		key.shader = renderable.shader;
+		key.hasTexture = (renderable.texture != NULL);
+		key.texture = renderable.texture ? *renderable.texture : NULL;
+		key.hasColor = (renderable.color != NULL);
+		key.color = renderable.color ? *renderable.color : glm::vec3(0.0f);
+		key.castsShadows = renderable.castsShadows;
+		key.cell = glm::ivec3(glm::floor(center / cellSize));
+		
+		batches[key].push_back(i);
+	}
+	
+	// then merge the pre-transformed vertices of each group in a single buffer
+	std::vector<GraphicDriver::Standard3DVertex> vertices;
+	for (BatchMap::iterator it = batches.begin(); it != batches.end(); ++it)
+	{
+		const std::vector<unsigned int> &members = it->second;
+		
+		vertices.clear();
+		float textureSpan = 0.0f;
+		bool fullDetail = false;
+		glm::vec3 boundsMin(std::numeric_limits<float>::max());
+		glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+		for (unsigned int i = 0; i < members.size(); i++)
+		{
+			const Renderable &renderable = this->staticRenderables[members[i]];
+			const glm::mat4 &transform = *renderable.transform;
+			glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3(transform));
+			
+			// the largest texture span needs the most detail
+			textureSpan = glm::max(textureSpan, renderable.textureSpan * getLargestScale(transform));
+			fullDetail = fullDetail || (renderable.textureSpan <= 0.0f);
+			
+			for (unsigned int j = renderable.startElement; j < renderable.startElement + renderable.elementCount; j++)
+			{
+				GraphicDriver::Standard3DVertex vertex = renderable.vertices[j];
+				vertex.position = glm::vec3(transform * glm::vec4(vertex.position, 1.0f));
+				vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+				
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+				vertices.push_back(vertex);
+			}
+		}
+		
+		if (vertices.empty())
+			continue;
+		
+		StaticBatch *batch = new StaticBatch;
+		batch->buffer = this->driver->createVertexBuffer(&vertices[0], (unsigned int)vertices.size());
+		batch->color = it->first.color;
+		batch->texture = it->first.texture;
+		this->staticBatches.push_back(batch);
+		
+		Renderable renderable;
+		renderable.transform = &this->identityTransform;
+		renderable.color = it->first.hasColor ? &batch->color : NULL;
+		renderable.texture = it->first.hasTexture ? &batch->texture : NULL;
+		renderable.textureSpan = fullDetail ? 0.0f : textureSpan;
+		renderable.buffer = batch->buffer;
+		renderable.shader = it->first.shader;
+		renderable.primitiveType = GraphicDriver::Triangles;
+		renderable.startElement = 0;
+		renderable.elementCount = (unsigned int)vertices.size();
+		renderable.castsShadows = it->first.castsShadows;
+		
+		// the bounding box center is good enough for cells, not worth a minimal sphere
+		renderable.boundingCenter = (boundsMin + boundsMax) * 0.5f;
+		renderable.boundingRadius = 0.0f;
+		for (unsigned int i = 0; i < vertices.size(); i++)
+			renderable.boundingRadius = glm::max(renderable.boundingRadius, glm::distance(renderable.boundingCenter, vertices[i].position));
+		
+		// a null radius would disable culling
+		renderable.boundingRadius = glm::max(renderable.boundingRadius, 0.0001f);
+		
+		this->addDrawnRenderable(renderable, this->allocateHandle(), true);
+	}
+	
+	this->staticVersion++;
+	
+	Log::info("%u static renderables merged in %u batches", (unsigned int)this->staticRenderables.size(), this->batchCount);
+}
+
+void GraphicWorld::updateStaticBatches()
+{
+	if (this->staticBatchesChanged)
+		this->buildStaticBatches(this->batchCellSize);
+}
 
 } // oak namespace
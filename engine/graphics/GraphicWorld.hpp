@@ -27,53 +27,516 @@
 
 #include <engine/graphics/GraphicDriver.hpp>
 
+#include <engine/system/JobQueue.hpp>
+
 #include <glm/glm.hpp>
 
+#include <map>
 #include <vector>
 
 namespace oak {
 
+class Animator;
 class Camera;
+class CommandList;
+class DebugDraw;
+class Entity;
+class Light;
+class LightClusters;
+class OcclusionBuffer;
+class Occluder;
+class ParticleEmitter;
+class ShadowMaps;
+class SkinnedMesh;
+class Sprite;
+class StreamBuffer;
+class Terrain;
+class Text;
+class TextureResource;
+class VoxelChunk;
 class World;
 
 class GraphicWorld
 {
 	public:
-		GraphicWorld(World *world);
+		// renderables without texture resource are drawn with the default texture
+		GraphicWorld(World *world, GraphicDriver *driver, Texture *defaultTexture);
 		~GraphicWorld();
 		
 		World *getWorld() const { return this->world; }
 		
-		void render(GraphicDriver *driver, Camera *camera);
+		// coarser geometry of a renderable, drawn while its bounding sphere radius,
+		// projected over half the target height, is below the screen size
+		struct Lod
+		{
+			VertexBuffer *buffer;
+			unsigned int startElement;
+			unsigned int elementCount;
+			float screenSize;
+			
+			Lod()
+				: buffer(NULL)
+				, startElement(0)
+				, elementCount(0)
+				, screenSize(0.0f)
+			{}
+		};
+		
+		// level of detail of a renderable in a view, kept from one frame to the next
+		struct LodState
+		{
+			bool valid; // false until the renderable is first seen
+			unsigned char level;
+			unsigned char previousLevel; // faded out after a switch
+			float switchTime;
+			
+			LodState()
+				: valid(false)
+				, level(0)
+				, previousLevel(0)
+				, switchTime(0.0f)
+			{}
+		};
+		
+		// identifies a registered renderable, whatever its index; handles are reused
+		// once unregistered
+		typedef unsigned int RenderableHandle;
+		
+		// Renderables drawn by a view, kept from one frame to the next. The opaque
+		// ones are sorted by render state and cut in chunks, each recorded in its
+		// own command list, which is replayed as it is while the chunk does not
+		// change; what changes each frame (camera, lights, time) is recorded apart,
+		// once per shader (see recordViewConstants()).
+		struct RenderList
+		{
+			// opaque renderable, with the render state it is sorted by, and how it
+			// was last culled
+			struct Item
+			{
+				RenderableHandle handle;
+				ShaderProgram *shader;
+				TextureResource *texture;
+				VertexBuffer *buffer;
+				
+				bool visible;
+				unsigned char level;
+				unsigned char previousLevel;
+				float fade; // progress of the cross-fade from the previous level, 1 once done
+			};
+			
+			// texture bound by the draws of a chunk, with the level they need
+			struct TextureUse
+			{
+				TextureResource *resource;
+				Texture *texture; // bound when recorded
+				unsigned int level;
+			};
+			
+			struct Chunk
+			{
+				std::vector<Item> items;
+				std::vector<TextureUse> textures;
+				CommandList *commandList; // NULL until first recorded
+				bool dirty; // items changed since culled
+				bool changed; // to record again this frame
+				bool fading; // culled again each frame until the cross-fades end
+				
+				Chunk()
+					: commandList(NULL)
+					, dirty(true)
+					, changed(true)
+					, fading(false)
+				{}
+			};
+			std::vector<Chunk *> chunks;
+			
+			// by handle: chunk of the opaque renderables (NULL for the translucent
+			// ones), and levels of detail
+			std::vector<Chunk *> handleChunks;
+			std::vector<LodState> lodStates;
+			
+			// blended renderables, sorted each frame
+			std::vector<RenderableHandle> translucentHandles;
+			
+			// programs drawing the chunks, with their number of items
+			typedef std::map<ShaderProgram *, unsigned int> ShaderCountMap;
+			ShaderCountMap shaderCounts;
+			
+			// view the chunks were last culled for
+			glm::mat4 viewProjectionMatrix;
+			unsigned int targetHeight;
+			unsigned int occlusionVersion;
+			
+			// Lists of the chunks recorded again are retired, since frames in flight
+			// may still replay them; they are reused after as many updates.
+			struct RetiredList
+			{
+				CommandList *commandList;
+				unsigned int update;
+			};
+			std::vector<RetiredList> retiredLists;
+			std::vector<CommandList *> freeLists;
+			unsigned int updateCount;
+			
+			// changes and invalidations of the world applied up to now, cleared
+			// ones included
+			bool synchronized;
+			unsigned int changeCount;
+			unsigned int invalidationCount;
+			
+			RenderList();
+			~RenderList();
+			
+			// hand all command lists over, for frames in flight (see GraphicsEngine::destroyView())
+			void releaseCommandLists(std::vector<CommandList *> *commandLists);
+		};
+		
+		// Patch a render list with the renderables registered, unregistered and
+		// invalidated since its last update, then cull again the chunks that
+		// changed, or all of them when the camera, the target height or the
+		// occluders changed; levels of detail and texture levels are selected at
+		// the same time. Chunks whose draws differ are marked to be recorded again,
+		// in a fresh command list; the others only request their texture levels
+		// again. Lists that missed some changes (not updated every frame) are
+		// rebuilt. Retired command lists are reused after the given number of
+		// updates, the frames that may be in flight.
+		void updateRenderList(RenderList *renderList, const Camera *camera, const OcclusionBuffer *occlusionBuffer, unsigned int targetHeight, unsigned int framesInFlight) const;
+		
+		// Record what the chunks of a render list expect to be set for each of their
+		// shaders, as seen from the given camera: the view and projection, the time,
+		// the lights binned in the given clusters and the shadow maps, and the fog of
+		// the given density (see PostProcess); to be replayed before the chunks.
+		void recordViewConstants(CommandList *commandList, const RenderList *renderList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, float fogDensity) const;
+		
+		// Record the draw calls of the visible renderables of a chunk, as culled by
+		// the last update. Chunks can be recorded concurrently, in different lists.
+		void recordRenderChunk(CommandList *commandList, const RenderList::Chunk *chunk) const;
+		
+		// Record the translucent renderables of a render list, culled like the
+		// opaque ones and blended over what was drawn before, from the farthest to
+		// the nearest: their depths in the view are quantized and radix sorted.
+		// The texture levels needed for a target of the given height are requested,
+		// and the view constants are set for their shaders.
+		void recordTranslucent(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, const OcclusionBuffer *occlusionBuffer, RenderList *renderList, unsigned int targetHeight, float fogDensity) const;
+		
+		// Record the depth of the shadow casters inside the given light clip space,
+		// with the given depth shader: either the static ones (batched, or owned by
+		// static entities) or all the others.
+		void recordShadowCasters(CommandList *commandList, const glm::mat4 &viewProjectionMatrix, bool staticCasters, ShaderProgram *shader) const;
+		
+		// whether some dynamic shadow caster is inside the given light clip space
+		bool hasDynamicShadowCasters(const glm::mat4 &viewProjectionMatrix) const;
 		
 		struct Renderable
 		{
+			const Entity *entity; // optional owner, static renderables get batched
 			const glm::mat4 *transform;
+			const glm::vec3 *color; // optional
+			
+			// optional, blended in the translucent queue while below 1, and not drawn
+			// at 0 (transparency shader constant); static renderables batched while
+			// opaque stay opaque
+			const float *opacity;
+			TextureResource *const *texture; // optional, bound to the first texture unit
+			float textureSpan; // local size covered by the whole texture, to stream its levels (0 for full detail)
 			VertexBuffer *buffer;
 			ShaderProgram *shader;
 			GraphicDriver::PrimitiveType primitiveType;
 			unsigned int startElement;
 			unsigned int elementCount;
 			
+			// bounding sphere, in local space (a null radius disables culling)
+			glm::vec3 boundingCenter;
+			float boundingRadius;
+			
+			// optional CPU copy of the buffer content, needed to batch static triangles
+			const GraphicDriver::Standard3DVertex *vertices;
+			
+			// drawn in the shadow maps, with a shader taking only the position attribute
+			bool castsShadows;
+			
+			// Optional coarser levels of detail, from the finest one; the renderable
+			// is then selected per view and never batched. Switches can cross-fade
+			// the levels with a dithering pattern (lodFade shader constant).
+			const Lod *lods;
+			unsigned int lodCount;
+			bool lodCrossFade;
+			
+			// Optional geometry read back each time the renderable is recorded, instead
+			// of the buffer and range above, for geometry rebuilt over time; nothing
+			// is drawn while it has no element.
+			const Lod *geometry;
+			
+			// optional skinning matrices, read back each time the renderable is
+			// recorded, as the first three rows of each (boneMatrices shader constant)
+			const glm::vec4 *boneMatrices;
+			unsigned int boneCount;
+			
 			Renderable()
-				: transform(NULL)
+				: entity(NULL)
+				, transform(NULL)
+				, color(NULL)
+				, opacity(NULL)
+				, texture(NULL)
+				, textureSpan(0.0f)
 				, buffer(NULL)
 				, shader(NULL)
 				, primitiveType(GraphicDriver::TriangleStrip)
 				, startElement(0)
 				, elementCount(0)
+				, boundingCenter(0.0f, 0.0f, 0.0f)
+				, boundingRadius(0.0f)
+				, vertices(NULL)
+				, castsShadows(false)
+				, lods(NULL)
+				, lodCount(0)
+				, lodCrossFade(false)
+				, geometry(NULL)
+				, boneMatrices(NULL)
+				, boneCount(0)
 			{}
 		};
 		
-		void registerRenderable(const Renderable &renderable);
-		//void unregisterRenderable(const Component *owner);
+		// Renderables of static entities are merged in the static batches once built;
+		// unregistering one of them rebuilds the batches with the next frame.
+		RenderableHandle registerRenderable(const Renderable &renderable);
+		void unregisterRenderable(RenderableHandle handle);
+		
+		// drawn renderables, batches included (not the renderables merged in them)
+		unsigned int getRenderableCount() const { return (unsigned int)this->renderables.size(); }
+		RenderableHandle getRenderableHandle(unsigned int index) const { return this->renderableHandles[index]; }
+		const Renderable &getRenderable(RenderableHandle handle) const;
+		
+		// arrays kept by handle are sized after it
+		unsigned int getHandleCount() const { return (unsigned int)this->handleSlots.size(); }
+		
+		// To be called when a renderable moved, or something its draws are recorded
+		// with changed (color, opacity, texture, geometry or bones), since render
+		// lists replay what they recorded otherwise. Can be called concurrently, from
+		// jobs; renderables merged in the static batches ignore it.
+		void invalidateRenderable(RenderableHandle handle);
+		
+		// Drawn renderables registered and unregistered since the last call to
+		// clearChanges(), in order; merging renderables in static batches
+		// unregisters them and registers the batches. The cleared changes are
+		// counted, so that what missed some of them can be rebuilt instead.
+		struct RenderableChange
+		{
+			RenderableHandle handle;
+			bool registered;
+		};
+		typedef std::vector<RenderableChange> RenderableChangeVector;
+		const RenderableChangeVector &getChanges() const { return this->changes; }
+		unsigned int getClearedChangeCount() const { return this->clearedChangeCount; }
+		
+		// renderables invalidated since the last call to clearChanges(), each once
+		const RenderableHandle *getInvalidatedHandles() const { return this->invalidatedHandles.empty() ? NULL : &this->invalidatedHandles[0]; }
+		unsigned int getInvalidatedCount() const { return (unsigned int)this->invalidatedCount; }
+		unsigned int getClearedInvalidationCount() const { return this->clearedInvalidationCount; }
+		
+		void clearChanges();
+		
+		// point lights, binned in the clusters of each view before recording
+		typedef std::vector<const Light *> LightVector;
+		void registerLight(const Light *light);
+		void unregisterLight(const Light *light);
+		const LightVector &getLights() const { return this->lights; }
+		
+		// occluders, rasterized by each view before recording
+		typedef std::vector<const Occluder *> OccluderVector;
+		void registerOccluder(const Occluder *occluder);
+		void unregisterOccluder(const Occluder *occluder);
+		const OccluderVector &getOccluders() const { return this->occluders; }
+		
+		// sprites, batched by each view after recording the renderables; those of
+		// a layer sharing a texture are drawn in registration order
+		typedef std::vector<const Sprite *> SpriteVector;
+		void registerSprite(const Sprite *sprite);
+		void unregisterSprite(const Sprite *sprite);
+		const SpriteVector &getSprites() const { return this->sprites; }
+		
+		// texts, drawn by each view over its sprites
+		typedef std::vector<const Text *> TextVector;
+		void registerText(const Text *text);
+		void unregisterText(const Text *text);
+		const TextVector &getTexts() const { return this->texts; }
+		
+		// primitives drawn by each view for a frame, to debug the world (see DebugDraw)
+		DebugDraw *getDebugDraw() const { return this->debugDraw; }
+		
+		// particle emitters, drawn by each view between its renderables and its sprites
+		typedef std::vector<ParticleEmitter *> ParticleEmitterVector;
+		void registerParticleEmitter(ParticleEmitter *emitter);
+		void unregisterParticleEmitter(ParticleEmitter *emitter);
+		const ParticleEmitterVector &getParticleEmitters() const { return this->particleEmitters; }
+		
+		// advance the particles of all emitters by the given time, one job per
+		// emitter pushed in the batch, which must be done before recording
+		void simulateParticles(float elapsedTime, JobQueue *jobQueue, JobQueue::Batch *batch);
+		
+		// skinned meshes, animated before each frame is recorded
+		typedef std::vector<SkinnedMesh *> SkinnedMeshVector;
+		void registerSkinnedMesh(SkinnedMesh *mesh);
+		void unregisterSkinnedMesh(SkinnedMesh *mesh);
+		
+		// advance the animations of all skinned meshes by the given time and pose
+		// them, a few meshes per job pushed in the batch, which must be done before
+		// recording; those skinned on the CPU write into the given stream buffer
+		void animateSkinnedMeshes(float elapsedTime, StreamBuffer *streamBuffer, JobQueue *jobQueue, JobQueue::Batch *batch);
 		
+		// animators, moving their entities before each frame is recorded
+		typedef std::vector<Animator *> AnimatorVector;
+		void registerAnimator(Animator *animator);
+		void unregisterAnimator(Animator *animator);
+		
+		// advance all animators by the given time, a few dozens per job pushed in
+		// the batch, which must be done before anything reads the transforms
+		void updateAnimators(float elapsedTime, JobQueue *jobQueue, JobQueue::Batch *batch);
+		
+		// voxel chunks, updated before each frame is recorded
+		typedef std::vector<VoxelChunk *> VoxelChunkVector;
+		void registerVoxelChunk(VoxelChunk *chunk);
+		void unregisterVoxelChunk(VoxelChunk *chunk);
+		
+		// swap in the chunk sections meshed since the last call, and start meshing
+		// the changed ones
+		void updateVoxelChunks();
+		
+		// terrains, drawn by each view after its renderables
+		typedef std::vector<Terrain *> TerrainVector;
+		void registerTerrain(Terrain *terrain);
+		void unregisterTerrain(Terrain *terrain);
+		const TerrainVector &getTerrains() const { return this->terrains; }
+		
+		// upload the terrain heights changed since the last call
+		void updateTerrains();
+		
+		// Merge the static renderables sharing the same shader, texture and color into
+		// pre-transformed vertex buffers, one per spatial cell of the given size.
+		// Calling it again rebuilds all batches, including the renderables
+		// registered since.
+		void buildStaticBatches(float cellSize);
+		
+		// rebuild the batches if renderables merged in them were unregistered (once
+		// per prepared frame)
+		void updateStaticBatches();
+		
+		// changes when static renderables are registered or batched, so that what
+		// is cached from them (e.g. static shadows) can be rebuilt
+		unsigned int getStaticVersion() const { return this->staticVersion; }
+		
+		// to be called when the geometry of a static renderable changes
+		void invalidateStaticRenderables() { this->staticVersion++; }
+	
 	private:
+		// record translucent renderables in the given order, with the view constants
+		// set once per shader
+		void recordRenderables(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, RenderList *renderList, unsigned int targetHeight, float fogDensity, const RenderableHandle *order, unsigned int count) const;
+		
+		// add a drawn renderable to a render list, in a chunk or with the translucent
+		// ones, or remove it
+		void addRenderItem(RenderList *renderList, RenderableHandle handle) const;
+		void removeRenderItem(RenderList *renderList, RenderableHandle handle) const;
+		
+		// Add a renderable to the drawn ones, before the batches unless it is one,
+		// or remove the one at the given index, filling its place with the last one;
+		// either is logged in the changes.
+		void addDrawnRenderable(const Renderable &renderable, RenderableHandle handle, bool batch);
+		void removeDrawnRenderable(unsigned int index);
+		void moveDrawnRenderable(unsigned int from, unsigned int to);
+		
+		RenderableHandle allocateHandle();
+		void releaseHandle(RenderableHandle handle);
+		
 		// the generic world this graphic world is bound to
 		World *world;
 		
+		GraphicDriver *driver;
+		Texture *defaultTexture;
+		
+		// batches are kept at the end of the renderables
 		typedef std::vector<Renderable> RenderableVector;
+		typedef std::vector<RenderableHandle> HandleVector;
 		RenderableVector renderables;
+		HandleVector renderableHandles;
+		unsigned int batchCount;
+		
+		// renderables merged in the batches, kept to rebuild them
+		RenderableVector staticRenderables;
+		HandleVector staticHandles;
+		unsigned int staticVersion;
+		float batchCellSize;
+		bool staticBatchesChanged;
+		
+		// where the renderable of each handle is: in the drawn ones, or merged
+		// in the batches (index in the static renderables)
+		struct HandleSlot
+		{
+			unsigned int index;
+			bool registered;
+			bool batched;
+			volatile int invalidated; // this frame
+		};
+		std::vector<HandleSlot> handleSlots;
+		HandleVector freeHandles;
+		
+		RenderableChangeVector changes;
+		unsigned int clearedChangeCount;
+		
+		// room for each handle, appended to concurrently
+		HandleVector invalidatedHandles;
+		volatile int invalidatedCount;
+		unsigned int clearedInvalidationCount;
+		
+		struct StaticBatch
+		{
+			VertexBuffer *buffer;
+			glm::vec3 color;
+			TextureResource *texture;
+		};
+		typedef std::vector<StaticBatch *> StaticBatchVector;
+		StaticBatchVector staticBatches;
+		
+		LightVector lights;
+		OccluderVector occluders;
+		SpriteVector sprites;
+		TextVector texts;
+		DebugDraw *debugDraw;
+		ParticleEmitterVector particleEmitters;
+		SkinnedMeshVector skinnedMeshes;
+		AnimatorVector animators;
+		VoxelChunkVector voxelChunks;
+		TerrainVector terrains;
+		
+		struct ParticleJob
+		{
+			ParticleEmitter *emitter;
+			float elapsedTime;
+		};
+		static void runParticleJob(void *userData);
+		std::vector<ParticleJob> particleJobs;
+		
+		struct AnimationJob
+		{
+			SkinnedMesh *const *meshes;
+			unsigned int meshCount;
+			float elapsedTime;
+			StreamBuffer *streamBuffer;
+		};
+		static void runAnimationJob(void *userData);
+		std::vector<AnimationJob> animationJobs;
+		
+		struct AnimatorJob
+		{
+			Animator *const *animators;
+			unsigned int animatorCount;
+			float elapsedTime;
+		};
+		static void runAnimatorJob(void *userData);
+		std::vector<AnimatorJob> animatorJobs;
+		
+		// batched vertices are already in world space
+		glm::mat4 identityTransform;
 };
 
 } // oak namespace
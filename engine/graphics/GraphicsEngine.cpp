@@ -24,19 +24,45 @@
  *****************************************************************************/
 
 #include <engine/graphics/GraphicsEngine.hpp>
+#include <engine/graphics/AnimationManager.hpp>
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/DebugDraw.hpp>
+#include <engine/graphics/DynamicResolution.hpp>
 #include <engine/graphics/GraphicDriver.hpp>
 #include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/MeshManager.hpp>
+#include <engine/graphics/PostProcess.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+#include <engine/graphics/TextLayoutCache.hpp>
+#include <engine/graphics/TextureManager.hpp>
 #include <engine/graphics/View.hpp>
+#include <engine/graphics/components/Animator.hpp>
 #include <engine/graphics/components/Camera.hpp>
 #include <engine/graphics/components/Cube.hpp>
 #include <engine/graphics/components/DemoQuad.hpp>
+#include <engine/graphics/components/Light.hpp>
+#include <engine/graphics/components/Mesh.hpp>
+#include <engine/graphics/components/Occluder.hpp>
+#include <engine/graphics/components/ParticleEmitter.hpp>
+#include <engine/graphics/components/SkinnedMesh.hpp>
+#include <engine/graphics/components/Sprite.hpp>
+#include <engine/graphics/components/Terrain.hpp>
+#include <engine/graphics/components/Text.hpp>
+#include <engine/graphics/components/VoxelChunk.hpp>
+
+#include <engine/graphics/shaders/upscale.vs.h>
+#include <engine/graphics/shaders/upscale.fs.h>
 
 #include <engine/sg/Entity.hpp>
 #include <engine/sg/Scene.hpp>
 #include <engine/sg/World.hpp>
 #include <engine/sg/WorldManager.hpp>
 
+#include <engine/system/Atomic.hpp>
+#include <engine/system/JobQueue.hpp>
 #include <engine/system/Log.hpp>
+#include <engine/system/PrecisionTime.hpp>
+#include <engine/system/Time.hpp>
 
 #include <algorithm>
 
@@ -44,6 +70,30 @@ namespace oak {
 
 namespace {
 
+// size of the spatial cells static geometry is batched in, so that batches can still be culled
+const float staticBatchCellSize = 32.0f;
+
+// dynamic vertices available per frame, and number of frames the GPU may still be reading
+const unsigned int streamElementCapacity = 16384;
+const unsigned int streamRegionCount = 3;
+
+// six vertices per sprite
+const unsigned int spriteStreamElementCapacity = 6 * 16384;
+
+// particles drawn per frame at most, by all views, and per record job
+const unsigned int particleStreamElementCapacity = 6 * 131072;
+const unsigned int particlesPerJob = 16384;
+
+// until told otherwise by the platform
+const int defaultScreenWidth = 1280;
+const int defaultScreenHeight = 720;
+
+// size of the part matching the scene of a post-processing target, at a fraction of its resolution
+unsigned int getPostSize(unsigned int size, unsigned int divisor)
+{
+	return std::max((size + divisor - 1) / divisor, 1u);
+}
+
 // sorting functor
 struct ViewPriorityComparator
 {
@@ -55,19 +105,83 @@ struct ViewPriorityComparator
 
 } // anonymous namespace
 
-GraphicsEngine::GraphicsEngine(WorldManager *worldManager)
+GraphicsEngine::GraphicsEngine(WorldManager *worldManager, JobQueue *jobQueue, unsigned int snapshotCount)
+	: freeSnapshots(snapshotCount)
+	, readySnapshots(0)
+	, particleStreamBuffer(NULL)
+	, screenWidth(defaultScreenWidth)
+	, screenHeight(defaultScreenHeight)
+	, sceneResource(0)
+	, frameScreenWidth(0)
+	, frameScreenHeight(0)
+	, sceneWidth(0)
+	, sceneHeight(0)
+	, bloomResource(0)
+	, compositeResource(0)
+	, frameTime(0)
+	, lastSubmitTime(0)
 {
+	OAK_ASSERT(snapshotCount > 0, "At least one frame snapshot is needed");
+	
 	this->driver = new GraphicDriver;
+	this->jobQueue = jobQueue;
+	
+	// when recording runs ahead of the driver thread, resource creations and
+	// destructions must be replayed in frame order too
+	this->driver->setDeferredResourceOperations(snapshotCount > 1);
+	
+	for (unsigned int i = 0; i < snapshotCount; i++)
+		this->snapshots.push_back(new Snapshot);
+	this->nextPreparedSnapshot = 0;
+	this->nextSubmittedSnapshot = 0;
+	
+	this->textureManager = new TextureManager(this->driver, this->jobQueue);
+	this->meshManager = new MeshManager(this->driver);
+	this->animationManager = new AnimationManager(this->driver);
+	this->glyphAtlas = new GlyphAtlas(this->driver);
+	this->textLayoutCache = new TextLayoutCache(this->glyphAtlas);
+	
+	// dynamic vertices are staged with each snapshot, in the order of VertexFormat
+	this->streamBuffers.push_back(new StreamBuffer(this->driver, GraphicDriver::Simple2DVertexFormat, streamElementCapacity, streamRegionCount, snapshotCount));
+	this->streamBuffers.push_back(new StreamBuffer(this->driver, GraphicDriver::Standard3DVertexFormat, streamElementCapacity, streamRegionCount, snapshotCount));
+	this->streamBuffers.push_back(new StreamBuffer(this->driver, GraphicDriver::SpriteVertexFormat, spriteStreamElementCapacity, streamRegionCount, snapshotCount));
 	
 	// default color
 	this->backgroundColor = glm::vec3(0.4f, 0.6f, 0.7f);
 	
+	this->renderGraph = new RenderGraph(this->driver);
+	
+	// the scene target is only allocated when drawing at a lower resolution
+	this->dynamicResolution = new DynamicResolution;
+	this->upscaleShader = this->driver->createShaderProgram(upscaleVSString, upscaleFSString);
+	GraphicDriver::Simple2DVertex quadVertices[] = {
+		{ glm::vec2(-1.0f, -1.0f) },
+		{ glm::vec2(1.0f, -1.0f) },
+		{ glm::vec2(-1.0f, 1.0f) },
+		{ glm::vec2(1.0f, 1.0f) }
+	};
+	this->upscaleQuad = this->driver->createVertexBuffer(quadVertices, 4);
+	
+	this->postProcess = new PostProcess(this->driver);
+	this->blurResources[0] = 0;
+	this->blurResources[1] = 0;
+	
 	this->worldManager = worldManager;
 	this->worldManager->addWorldListener(this);
 	
 	Entity::registerComponentFactory("Camera", this);
 	Entity::registerComponentFactory("Cube", this);
 	Entity::registerComponentFactory("DemoQuad", this);
+	Entity::registerComponentFactory("Light", this);
+	Entity::registerComponentFactory("Mesh", this);
+	Entity::registerComponentFactory("Occluder", this);
+	Entity::registerComponentFactory("ParticleEmitter", this);
+	Entity::registerComponentFactory("Sprite", this);
+	Entity::registerComponentFactory("Text", this);
+	Entity::registerComponentFactory("VoxelChunk", this);
+	Entity::registerComponentFactory("Terrain", this);
+	Entity::registerComponentFactory("SkinnedMesh", this);
+	Entity::registerComponentFactory("Animator", this);
 }
 
 GraphicsEngine::~GraphicsEngine()
@@ -77,33 +191,620 @@ GraphicsEngine::~GraphicsEngine()
 	Entity::unregisterComponentFactory("Camera");
 	Entity::unregisterComponentFactory("Cube");
 	Entity::unregisterComponentFactory("DemoQuad");
+	Entity::unregisterComponentFactory("Light");
+	Entity::unregisterComponentFactory("Mesh");
+	Entity::unregisterComponentFactory("Occluder");
+	Entity::unregisterComponentFactory("ParticleEmitter");
+	Entity::unregisterComponentFactory("Sprite");
+	Entity::unregisterComponentFactory("Text");
+	Entity::unregisterComponentFactory("VoxelChunk");
+	Entity::unregisterComponentFactory("Terrain");
+	Entity::unregisterComponentFactory("SkinnedMesh");
+	Entity::unregisterComponentFactory("Animator");
 	
 	this->worldManager->removeWorldListener(this);
 	
+	for (unsigned int i = 0; i < this->snapshots.size(); i++)
+	{
+		Snapshot *snapshot = this->snapshots[i];
+		for (unsigned int j = 0; j < snapshot->commandLists.size(); j++)
+			delete snapshot->commandLists[j];
+		for (unsigned int j = 0; j < snapshot->releasedCommandLists.size(); j++)
+			delete snapshot->releasedCommandLists[j];
+		
+		delete snapshot;
+	}
+	
+	for (unsigned int i = 0; i < this->streamBuffers.size(); i++)
+		delete this->streamBuffers[i];
+	delete this->particleStreamBuffer;
+	
+	delete this->textureManager;
+	delete this->meshManager;
+	delete this->animationManager;
+	delete this->textLayoutCache;
+	delete this->glyphAtlas;
+	
+	delete this->renderGraph;
+	this->driver->destroyShaderProgram(this->upscaleShader);
+	this->driver->destroyVertexBuffer(this->upscaleQuad);
+	delete this->dynamicResolution;
+	delete this->postProcess;
+	
+	// run the resource destructions that were still pending
+	this->driver->setDeferredResourceOperations(false);
+	
 	delete this->driver;
 }
 
-void GraphicsEngine::renderFrame()
+void GraphicsEngine::prepareFrame()
 {
-	this->driver->setClearColor(this->backgroundColor);
-	this->driver->setClearDepth(1.0f);
-	this->driver->clear(true, true);
+	this->freeSnapshots.wait();
+	
+	unsigned int snapshotIndex = this->nextPreparedSnapshot;
+	Snapshot *snapshot = this->snapshots[snapshotIndex];
+	this->nextPreparedSnapshot = (this->nextPreparedSnapshot + 1) % this->snapshots.size();
+	
+	snapshot->backgroundColor = this->backgroundColor;
+	
+	for (unsigned int i = 0; i < snapshot->releasedCommandLists.size(); i++)
+		delete snapshot->releasedCommandLists[i];
+	snapshot->releasedCommandLists.clear();
+	
+	for (unsigned int i = 0; i < this->streamBuffers.size(); i++)
+		this->streamBuffers[i]->beginFrame(snapshotIndex);
+	
+	snapshot->particleStreamBuffer = this->particleStreamBuffer;
+	if (this->particleStreamBuffer)
+		this->particleStreamBuffer->beginFrame(snapshotIndex);
+	
+	// texture uploads are resource operations, replayed before this frame
+	this->textureManager->update();
+	
+	// remeshed voxel chunk sections and terrain heights as well, and static
+	// batches that lost some of their renderables
+	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
+	{
+		this->graphicWorlds[i]->updateVoxelChunks();
+		this->graphicWorlds[i]->updateTerrains();
+		this->graphicWorlds[i]->updateStaticBatches();
+	}
+	
+	// glyphs shown by texts and debug labels are rasterized in the atlas, and uploaded the same way
+	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
+	{
+		this->textLayoutCache->useGlyphs(this->graphicWorlds[i]->getTexts());
+		this->graphicWorlds[i]->getDebugDraw()->prepareLabels(this->textLayoutCache);
+	}
+	this->glyphAtlas->update();
+	this->textLayoutCache->update();
 	
 	// order views by priority
 	// lower priority gets rendered first (thus "under" the next ones)
 	std::sort(this->views.begin(), this->views.end(), ViewPriorityComparator());
 	
-	// render each view sequentially
+	// adapt the resolution to the last frame time, read once per frame
+	int frameTime = Atomic::load(&this->frameTime);
+	if (frameTime > 0 && Atomic::compareAndSwap(&this->frameTime, frameTime, 0) == frameTime)
+		this->dynamicResolution->update((float)frameTime * 1e-6f);
+	
+	// screen views draw into a part of the scene target at lower scales
+	this->frameScreenWidth = (unsigned int)Atomic::load(&this->screenWidth);
+	this->frameScreenHeight = (unsigned int)Atomic::load(&this->screenHeight);
+	bool scaled = this->dynamicResolution->isEnabled() || this->dynamicResolution->getScale() < 1.0f;
+	float scale = scaled ? this->dynamicResolution->getScale() : 1.0f;
+	this->sceneWidth = std::max((unsigned int)((float)this->frameScreenWidth * scale + 0.5f), 1u);
+	this->sceneHeight = std::max((unsigned int)((float)this->frameScreenHeight * scale + 0.5f), 1u);
+	
+	// Declare the passes of the frame: each view draws into its target or the
+	// scene after its shadow maps. The scene is then post-processed, or upscaled
+	// to the screen at lower scales, and the texts of its views are drawn over the
+	// screen. Views drawing into textures nobody drew last frame are culled.
+	this->renderGraph->reset();
+	this->framePasses.clear();
+	this->framePasses.reserve(this->views.size() * 3 + 5); // the passes point into it
+	
+	bool postProcessed = this->postProcess->isEnabled();
+	RenderGraph::Resource screen = this->renderGraph->importTarget(NULL, true);
+	this->sceneResource = (scaled || postProcessed) ? this->renderGraph->createTarget(this->frameScreenWidth, this->frameScreenHeight) : screen;
 	for (unsigned int i = 0; i < this->views.size(); i++)
 	{
-		this->views[i]->render(this->driver);
+		View *view = this->views[i];
+		if (!view->isEnabled() || !view->getCamera())
+			continue;
+		
+		RenderGraph::Resource target = this->sceneResource;
+		if (view->getRenderTarget())
+			target = this->renderGraph->importTarget(view->getRenderTarget(), view->isTargetNeeded());
+		
+		// the atlases are only known by the shadow maps
+		RenderGraph::Resource shadows = this->renderGraph->importTarget(NULL, false);
+		
+		FramePass shadowPass = { FramePass::ShadowPass, view, shadows };
+		this->framePasses.push_back(shadowPass);
+		RenderGraph::Pass pass = this->renderGraph->addPass(&this->framePasses.back());
+		this->renderGraph->addWrite(pass, shadows);
+		
+		FramePass viewPass = { FramePass::ViewPass, view, target };
+		this->framePasses.push_back(viewPass);
+		pass = this->renderGraph->addPass(&this->framePasses.back());
+		this->renderGraph->addRead(pass, shadows);
+		this->renderGraph->addWrite(pass, target);
+	}
+	
+	if (postProcessed)
+	{
+		// the bloom is extracted at half resolution, then blurred at quarter resolution
+		RenderGraph::Resource bloom = this->sceneResource;
+		if (this->postProcess->hasBloom())
+		{
+			unsigned int halfWidth = getPostSize(this->frameScreenWidth, 2);
+			unsigned int halfHeight = getPostSize(this->frameScreenHeight, 2);
+			unsigned int quarterWidth = getPostSize(this->frameScreenWidth, 4);
+			unsigned int quarterHeight = getPostSize(this->frameScreenHeight, 4);
+			this->bloomResource = this->renderGraph->createTarget(halfWidth, halfHeight);
+			this->blurResources[0] = this->renderGraph->createTarget(quarterWidth, quarterHeight);
+			this->blurResources[1] = this->renderGraph->createTarget(quarterWidth, quarterHeight);
+			
+			FramePass extractPass = { FramePass::BloomExtractPass, NULL, this->bloomResource };
+			FramePass horizontalPass = { FramePass::BloomHorizontalPass, NULL, this->blurResources[0] };
+			FramePass verticalPass = { FramePass::BloomVerticalPass, NULL, this->blurResources[1] };
+			FramePass bloomPasses[] = { extractPass, horizontalPass, verticalPass };
+			for (unsigned int i = 0; i < 3; i++)
+			{
+				this->framePasses.push_back(bloomPasses[i]);
+				RenderGraph::Pass pass = this->renderGraph->addPass(&this->framePasses.back());
+				this->renderGraph->addRead(pass, bloom);
+				this->renderGraph->addWrite(pass, bloomPasses[i].target);
+				bloom = bloomPasses[i].target;
+			}
+		}
+		
+		// everything else at once, over the screen unless antialiased afterwards
+		bool antialiased = this->postProcess->isAntialiasing();
+		this->compositeResource = antialiased ? this->renderGraph->createTarget(this->frameScreenWidth, this->frameScreenHeight) : screen;
+		FramePass compositePass = { FramePass::CompositePass, NULL, this->compositeResource };
+		this->framePasses.push_back(compositePass);
+		RenderGraph::Pass pass = this->renderGraph->addPass(&this->framePasses.back());
+		this->renderGraph->addRead(pass, this->sceneResource);
+		if (bloom != this->sceneResource)
+			this->renderGraph->addRead(pass, bloom);
+		this->renderGraph->addWrite(pass, this->compositeResource);
+		
+		if (antialiased)
+		{
+			FramePass antialiasingPass = { FramePass::AntialiasingPass, NULL, screen };
+			this->framePasses.push_back(antialiasingPass);
+			pass = this->renderGraph->addPass(&this->framePasses.back());
+			this->renderGraph->addRead(pass, this->compositeResource);
+			this->renderGraph->addWrite(pass, screen);
+		}
+	}
+	else if (scaled)
+	{
+		FramePass upscalePass = { FramePass::UpscalePass, NULL, screen };
+		this->framePasses.push_back(upscalePass);
+		RenderGraph::Pass pass = this->renderGraph->addPass(&this->framePasses.back());
+		this->renderGraph->addRead(pass, this->sceneResource);
+		this->renderGraph->addWrite(pass, screen);
+	}
+	
+	// texts are placed on the screen, sharp and untouched by the post-processing
+	if (this->sceneResource != screen)
+	{
+		for (unsigned int i = 0; i < this->views.size(); i++)
+		{
+			View *view = this->views[i];
+			if (!view->isEnabled() || !view->getCamera() || view->getRenderTarget() || !view->hasTexts())
+				continue;
+			
+			FramePass textPass = { FramePass::TextPass, view, screen };
+			this->framePasses.push_back(textPass);
+			RenderGraph::Pass pass = this->renderGraph->addPass(&this->framePasses.back());
+			this->renderGraph->addWrite(pass, screen);
+		}
+	}
+	
+	this->renderGraph->compile();
+	
+	// entities are moved by their animators first, the jobs below read their transforms
+	float elapsedTime = (float)Time::getElapsedTime();
+	JobQueue::Batch animatorBatch;
+	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
+		this->graphicWorlds[i]->updateAnimators(elapsedTime, this->jobQueue, &animatorBatch);
+	this->jobQueue->wait(&animatorBatch);
+	
+	// bin the lights and rasterize the occluders of the views in parallel, the
+	// textures holding the lights are uploaded before this frame like any resource;
+	// particles are advanced and skinned meshes posed at the same time
+	JobQueue::Batch viewBatch;
+	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
+	{
+		this->graphicWorlds[i]->simulateParticles(elapsedTime, this->jobQueue, &viewBatch);
+		this->graphicWorlds[i]->animateSkinnedMeshes(elapsedTime, this->getStreamBuffer(GraphicDriver::Standard3DVertexFormat), this->jobQueue, &viewBatch);
+	}
+	
+	for (unsigned int i = 0; i < this->renderGraph->getExecutedPassCount(); i++)
+	{
+		const FramePass *framePass = (const FramePass *)this->renderGraph->getUserData(this->renderGraph->getExecutedPass(i));
+		if (framePass->type != FramePass::ViewPass)
+			continue;
+		
+		View *view = framePass->view;
+		unsigned int targetWidth = view->getRenderTarget() ? view->getTargetWidth() : this->sceneWidth;
+		unsigned int targetHeight = view->getRenderTarget() ? view->getTargetHeight() : this->sceneHeight;
+		view->binLights(targetWidth, targetHeight, this->jobQueue, &viewBatch);
+		view->rasterizeOccluders(targetWidth, targetHeight, this->jobQueue, &viewBatch);
+	}
+	this->jobQueue->wait(&viewBatch);
+	
+	// split the passes in record jobs, in execution order
+	snapshot->recordJobs.clear();
+	for (unsigned int i = 0; i < this->renderGraph->getExecutedPassCount(); i++)
+	{
+		RenderGraph::Pass pass = this->renderGraph->getExecutedPass(i);
+		const FramePass *framePass = (const FramePass *)this->renderGraph->getUserData(pass);
+		View *view = framePass->view;
+		
+		RecordJob job;
+		job.engine = this;
+		job.pass = framePass;
+		job.shadowMap = 0;
+		job.sprites = false;
+		job.texts = false;
+		job.translucent = false;
+		job.particleEmitter = NULL;
+		job.firstParticle = 0;
+		job.particleCount = 0;
+		job.terrain = NULL;
+		job.bindTarget = true;
+		job.renderTarget = this->renderGraph->getTarget(framePass->target);
+		job.targetWidth = this->frameScreenWidth;
+		job.targetHeight = this->frameScreenHeight;
+		job.clearTarget = false;
+		job.clearColor = this->backgroundColor;
+		job.renderChunk = -1;
+		job.commandList = NULL;
+		
+		if (framePass->type == FramePass::ShadowPass)
+		{
+			view->updateShadows();
+			for (unsigned int j = 0; j < view->getUpdatedShadowMapCount(); j++)
+			{
+				job.shadowMap = (int)j;
+				snapshot->recordJobs.push_back(job);
+			}
+		}
+		else if (framePass->type == FramePass::ViewPass)
+		{
+			view->uploadLights();
+			
+			// the screen is cleared by submitFrame, other targets by their first writer
+			job.targetWidth = view->getRenderTarget() ? view->getTargetWidth() : this->sceneWidth;
+			job.targetHeight = view->getRenderTarget() ? view->getTargetHeight() : this->sceneHeight;
+			job.clearTarget = (framePass->target != screen && this->renderGraph->isFirstWrite(pass, framePass->target));
+			
+			// the recorded draws and levels of detail are kept per view, while the
+			// snapshots in flight may replay them; the fog is added by the post-processing
+			view->prepareRecord((postProcessed && framePass->target == this->sceneResource) ? this->postProcess->getFogDensity() : 0.0f, job.targetHeight, (unsigned int)this->snapshots.size());
+			
+			// the first job binds and clears the target, and sets the view constants
+			snapshot->recordJobs.push_back(job);
+			job.bindTarget = false;
+			
+			// then the chunks of opaque renderables, each in the list the view keeps for it
+			for (unsigned int j = 0; j < view->getRenderChunkCount(); j++)
+			{
+				job.renderChunk = (int)j;
+				snapshot->recordJobs.push_back(job);
+			}
+			job.renderChunk = -1;
+			
+			// terrains, each selecting its own patches
+			const GraphicWorld::TerrainVector &terrains = view->getGraphicWorld()->getTerrains();
+			for (unsigned int j = 0; j < terrains.size(); j++)
+			{
+				job.terrain = terrains[j];
+				snapshot->recordJobs.push_back(job);
+			}
+			job.terrain = NULL;
+			
+			// translucent renderables, sorted together
+			if (view->hasTranslucent())
+			{
+				job.translucent = true;
+				snapshot->recordJobs.push_back(job);
+				job.translucent = false;
+			}
+			
+			// particles in chunks, each drawn at once; alpha blended emitters are
+			// sorted back to front as a whole
+			const GraphicWorld::ParticleEmitterVector &emitters = view->getGraphicWorld()->getParticleEmitters();
+			for (unsigned int j = 0; j < emitters.size(); j++)
+			{
+				unsigned int particleCount = (unsigned int)emitters[j]->getParticleCount();
+				unsigned int chunkSize = emitters[j]->isAdditive() ? particlesPerJob : std::max(particleCount, 1u);
+				for (unsigned int k = 0; k < particleCount; k += chunkSize)
+				{
+					job.particleEmitter = emitters[j];
+					job.firstParticle = k;
+					job.particleCount = std::min(chunkSize, particleCount - k);
+					snapshot->recordJobs.push_back(job);
+				}
+			}
+			job.particleEmitter = NULL;
+			
+			// texts of the views drawn into the scene have their own pass
+			job.sprites = view->hasSprites();
+			job.texts = view->hasTexts() && (framePass->target != this->sceneResource || this->sceneResource == screen);
+			if (job.sprites || job.texts)
+				snapshot->recordJobs.push_back(job);
+		}
+		else if (framePass->type == FramePass::TextPass)
+		{
+			job.texts = true;
+			snapshot->recordJobs.push_back(job);
+		}
+		else
+		{
+			// bloom passes draw over the part of their target matching the scene
+			unsigned int divisor = 1;
+			if (framePass->type == FramePass::BloomExtractPass)
+				divisor = 2;
+			else if (framePass->type == FramePass::BloomHorizontalPass || framePass->type == FramePass::BloomVerticalPass)
+				divisor = 4;
+			
+			if (divisor > 1)
+			{
+				job.targetWidth = getPostSize(this->sceneWidth, divisor);
+				job.targetHeight = getPostSize(this->sceneHeight, divisor);
+			}
+			
+			// the quads are depth tested against whatever the pooled targets held
+			job.clearTarget = (framePass->target != screen);
+			snapshot->recordJobs.push_back(job);
+		}
+	}
+	
+	while (snapshot->commandLists.size() < snapshot->recordJobs.size())
+		snapshot->commandLists.push_back(new CommandList);
+	
+	// record all views in parallel, the chunks of renderables that did not
+	// change are replayed as they were recorded
+	JobQueue::Batch batch;
+	for (unsigned int i = 0; i < snapshot->recordJobs.size(); i++)
+	{
+		RecordJob &job = snapshot->recordJobs[i];
+		if (job.renderChunk >= 0)
+		{
+			View *view = job.pass->view;
+			job.commandList = view->getRenderChunkList((unsigned int)job.renderChunk);
+			if (!view->isRenderChunkChanged((unsigned int)job.renderChunk))
+				continue;
+		}
+		else
+			job.commandList = snapshot->commandLists[i];
+		job.commandList->clear();
+		
+		this->jobQueue->push(GraphicsEngine::runRecordJob, &job, &batch);
+	}
+	this->jobQueue->wait(&batch);
+	
+	// debug primitives are drawn for a single frame, and the render lists are
+	// patched with the renderable changes of this frame
+	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
+	{
+		this->graphicWorlds[i]->getDebugDraw()->clear(this->textLayoutCache);
+		this->graphicWorlds[i]->clearChanges();
 	}
+	
+	// resources created up to now are used by this snapshot
+	snapshot->resourceMarker = this->driver->markResourceOperations();
+	
+	this->readySnapshots.post();
+}
+
+void GraphicsEngine::submitFrame()
+{
+	this->readySnapshots.wait();
+	
+	unsigned int snapshotIndex = this->nextSubmittedSnapshot;
+	Snapshot *snapshot = this->snapshots[snapshotIndex];
+	this->nextSubmittedSnapshot = (this->nextSubmittedSnapshot + 1) % this->snapshots.size();
+	
+	this->driver->executeResourceOperations(snapshot->resourceMarker);
+	
+	// upload the dynamic vertices before the draws using them
+	for (unsigned int i = 0; i < this->streamBuffers.size(); i++)
+		this->streamBuffers[i]->submitFrame(snapshotIndex);
+	if (snapshot->particleStreamBuffer)
+		snapshot->particleStreamBuffer->submitFrame(snapshotIndex);
+	
+	this->driver->setClearColor(snapshot->backgroundColor);
+	this->driver->setClearDepth(1.0f);
+	this->driver->clear(true, true);
+	
+	// replay the command lists in order, on the driver thread
+	for (unsigned int i = 0; i < snapshot->recordJobs.size(); i++)
+	{
+		snapshot->recordJobs[i].commandList->execute(this->driver);
+	}
+	
+	// back to the screen, targets can then be destroyed between frames
+	this->driver->bindRenderTarget(NULL);
+	
+	// time between submitted frames, which includes waiting for the GPU when it is late
+	unsigned long long now = PrecisionTime::readNanoseconds();
+	if (this->lastSubmitTime != 0)
+		Atomic::store(&this->frameTime, (int)std::min((now - this->lastSubmitTime) / 1000, (unsigned long long)1000000));
+	this->lastSubmitTime = now;
+	
+	this->freeSnapshots.post();
+}
+
+bool GraphicsEngine::discardFrame()
+{
+	if (!this->readySnapshots.tryWait())
+		return false;
+	
+	Snapshot *snapshot = this->snapshots[this->nextSubmittedSnapshot];
+	this->nextSubmittedSnapshot = (this->nextSubmittedSnapshot + 1) % this->snapshots.size();
+	
+	// resources still have to be created in order, later frames may use them
+	this->driver->executeResourceOperations(snapshot->resourceMarker);
+	
+	this->freeSnapshots.post();
+	
+	return true;
+}
+
+void GraphicsEngine::renderFrame()
+{
+	this->prepareFrame();
+	this->submitFrame();
+}
+
+void GraphicsEngine::setScreenSize(unsigned int width, unsigned int height)
+{
+	Atomic::store(&this->screenWidth, (int)width);
+	Atomic::store(&this->screenHeight, (int)height);
+}
+
+bool GraphicsEngine::isDynamicResolution() const
+{
+	return this->dynamicResolution->isEnabled();
+}
+
+void GraphicsEngine::setDynamicResolution(bool enabled)
+{
+	this->dynamicResolution->setEnabled(enabled);
+}
+
+float GraphicsEngine::getFrameBudget() const
+{
+	return this->dynamicResolution->getFrameBudget();
+}
+
+void GraphicsEngine::setFrameBudget(float seconds)
+{
+	this->dynamicResolution->setFrameBudget(seconds);
+}
+
+float GraphicsEngine::getRenderScale() const
+{
+	return this->dynamicResolution->getScale();
+}
+
+void GraphicsEngine::setRenderScale(float scale)
+{
+	this->dynamicResolution->setScale(scale);
+}
+
+float GraphicsEngine::getMinRenderScale() const
+{
+	return this->dynamicResolution->getMinScale();
+}
+
+void GraphicsEngine::setMinRenderScale(float scale)
+{
+	this->dynamicResolution->setMinScale(scale);
+}
+
+const GraphicDriver::Statistics &GraphicsEngine::getDriverStatistics() const
+{
+	return this->driver->getStatistics();
+}
+
+void GraphicsEngine::resetDriverStatistics()
+{
+	this->driver->resetStatistics();
+}
+
+void GraphicsEngine::setDriverCommandTrace(bool enabled)
+{
+	this->driver->setCommandTrace(enabled);
+}
+
+StreamBuffer *GraphicsEngine::getStreamBuffer(GraphicDriver::VertexFormat format) const
+{
+	OAK_ASSERT((unsigned int)format < this->streamBuffers.size(), "No stream buffer for this vertex format");
+	return this->streamBuffers[format];
+}
+
+void GraphicsEngine::setBaseFolder(const std::string &baseFolder)
+{
+	this->baseFolder = baseFolder;
+	std::replace(this->baseFolder.begin(), this->baseFolder.end(), '\\', '/');
+	if (!this->baseFolder.empty() && this->baseFolder[this->baseFolder.size() - 1] != '/')
+		this->baseFolder += '/';
+}
+
+TextureResource *GraphicsEngine::loadTexture(const std::string &filename)
+{
+	return this->textureManager->load(this->baseFolder + filename);
+}
+
+int GraphicsEngine::getTextureUploadBudget() const
+{
+	return (int)this->textureManager->getUploadBudget();
+}
+
+void GraphicsEngine::setTextureUploadBudget(int bytes)
+{
+	OAK_ASSERT(bytes >= 0, "The texture upload budget cannot be negative");
+	this->textureManager->setUploadBudget((unsigned int)bytes);
+}
+
+int GraphicsEngine::getTextureMemoryBudget() const
+{
+	return (int)this->textureManager->getMemoryBudget();
+}
+
+void GraphicsEngine::setTextureMemoryBudget(int bytes)
+{
+	OAK_ASSERT(bytes >= 0, "The texture memory budget cannot be negative");
+	this->textureManager->setMemoryBudget((unsigned int)bytes);
+}
+
+const TextureManager::Statistics &GraphicsEngine::getTextureStatistics() const
+{
+	return this->textureManager->getStatistics();
+}
+
+const RenderGraph::Statistics &GraphicsEngine::getRenderGraphStatistics() const
+{
+	return this->renderGraph->getStatistics();
+}
+
+const GlyphAtlas::Statistics &GraphicsEngine::getGlyphStatistics() const
+{
+	return this->glyphAtlas->getStatistics();
+}
+
+unsigned int GraphicsEngine::getTextLayoutCount() const
+{
+	return this->textLayoutCache->getLayoutCount();
+}
+
+MeshResource *GraphicsEngine::loadMesh(const std::string &filename)
+{
+	return this->meshManager->load(this->baseFolder + filename);
+}
+
+SkinnedMeshResource *GraphicsEngine::loadSkinnedMesh(const std::string &filename)
+{
+	return this->animationManager->loadSkinnedMesh(this->baseFolder + filename);
+}
+
+AnimationResource *GraphicsEngine::loadAnimation(const std::string &filename)
+{
+	return this->animationManager->loadAnimation(this->baseFolder + filename);
 }
 
 View *GraphicsEngine::createView(World *world)
 {
 	GraphicWorld *graphicWorld = findGraphicWorld(world);
-	View *view = new View(graphicWorld);
+	View *view = new View(graphicWorld, this->driver, this->textureManager);
 	
 	this->views.push_back(view);
 	
@@ -115,10 +816,30 @@ void GraphicsEngine::destroyView(View *view)
 	ViewVector::iterator it = std::find(this->views.begin(), this->views.end(), view);
 	OAK_ASSERT(it != this->views.end(), "Trying to destroy an unexisting view");
 	
+	// the snapshots in flight may still replay its lists, kept until the last
+	// prepared one is prepared again
+	Snapshot *lastSnapshot = this->snapshots[(this->nextPreparedSnapshot + this->snapshots.size() - 1) % this->snapshots.size()];
+	view->releaseCommandLists(&lastSnapshot->releasedCommandLists);
+	
 	delete view;
 	this->views.erase(it);
 }
 
+DebugDraw *GraphicsEngine::getDebugDraw(World *world)
+{
+	GraphicWorld *graphicWorld = this->findGraphicWorld(world);
+	OAK_ASSERT(graphicWorld, "Drawing debug primitives in an unknown world");
+	return graphicWorld->getDebugDraw();
+}
+
+void GraphicsEngine::buildStaticBatches(World *world)
+{
+	GraphicWorld *graphicWorld = this->findGraphicWorld(world);
+	OAK_ASSERT(graphicWorld != NULL, "Building static batches of an unregistered world");
+	
+	graphicWorld->buildStaticBatches(staticBatchCellSize);
+}
+
 Component *GraphicsEngine::createComponent(Entity *entity, const std::string &className)
 {
 	// find the world in which the entity lives
@@ -131,13 +852,30 @@ Component *GraphicsEngine::createComponent(Entity *entity, const std::string &cl
 	if (className == "Camera") return new Camera;
 	if (className == "Cube") return new Cube(graphicWorld, this->driver);
 	if (className == "DemoQuad") return new DemoQuad(graphicWorld, this->driver);
+	if (className == "Light") return new Light(graphicWorld);
+	if (className == "Mesh") return new Mesh(graphicWorld, this->driver);
+	if (className == "Occluder") return new Occluder(graphicWorld);
+	if (className == "ParticleEmitter")
+	{
+		// the stream buffer is large, games without particles do without it
+		if (!this->particleStreamBuffer)
+			this->particleStreamBuffer = new StreamBuffer(this->driver, GraphicDriver::SpriteVertexFormat, particleStreamElementCapacity, streamRegionCount, (unsigned int)this->snapshots.size());
+		
+		return new ParticleEmitter(graphicWorld);
+	}
+	if (className == "Sprite") return new Sprite(graphicWorld);
+	if (className == "Text") return new Text(graphicWorld, this->textLayoutCache);
+	if (className == "VoxelChunk") return new VoxelChunk(graphicWorld, this->driver, this->jobQueue);
+	if (className == "Terrain") return new Terrain(graphicWorld, this->driver);
+	if (className == "SkinnedMesh") return new SkinnedMesh(graphicWorld, this->driver);
+	if (className == "Animator") return new Animator(graphicWorld);
 	
 	return NULL;
 }
 
 void GraphicsEngine::worldCreated(World *world)
 {
-	GraphicWorld *graphicWorld = new GraphicWorld(world);
+	GraphicWorld *graphicWorld = new GraphicWorld(world, this->driver, this->textureManager->getDefaultTexture());
 	this->graphicWorlds.push_back(graphicWorld);
 }
 
@@ -162,6 +900,116 @@ void GraphicsEngine::worldDestroyed(World *world)
 	OAK_ASSERT(false, "Unregistering a world that was never registered");
 }
 
+void GraphicsEngine::runRecordJob(void *userData)
+{
+	RecordJob *job = (RecordJob *)userData;
+	if (job->pass->type == FramePass::ShadowPass)
+	{
+		job->pass->view->recordShadowMap(job->commandList, (unsigned int)job->shadowMap);
+		return;
+	}
+	
+	// the previous lists may have drawn anywhere
+	if (job->bindTarget)
+	{
+		job->commandList->bindRenderTarget(job->renderTarget);
+		if (job->renderTarget)
+			job->commandList->setViewport(0, 0, job->targetWidth, job->targetHeight);
+		if (job->clearTarget)
+			job->commandList->clearBuffers(job->clearColor, true, true);
+	}
+	
+	if (job->terrain)
+		job->pass->view->recordTerrain(job->commandList, job->terrain);
+	else if (job->particleEmitter)
+	{
+		StreamBuffer *streamBuffer = job->engine->particleStreamBuffer;
+		job->pass->view->recordParticles(job->commandList, job->particleEmitter, job->firstParticle, job->particleCount, job->targetHeight, streamBuffer);
+	}
+	else if (job->translucent)
+		job->pass->view->recordTranslucent(job->commandList, job->targetHeight);
+	else if (job->sprites || job->texts)
+	{
+		View *view = job->pass->view;
+		StreamBuffer *streamBuffer = job->engine->getStreamBuffer(GraphicDriver::SpriteVertexFormat);
+		if (job->sprites)
+			view->recordSprites(job->commandList, job->targetHeight, streamBuffer);
+		
+		// texts are placed on the screen, even when drawn at a lower resolution
+		if (job->texts)
+		{
+			unsigned int width = view->getRenderTarget() ? view->getTargetWidth() : job->engine->frameScreenWidth;
+			unsigned int height = view->getRenderTarget() ? view->getTargetHeight() : job->engine->frameScreenHeight;
+			view->recordTexts(job->commandList, job->engine->glyphAtlas, width, height, streamBuffer);
+		}
+	}
+	else if (job->renderChunk >= 0)
+		job->pass->view->recordRenderChunk(job->commandList, (unsigned int)job->renderChunk);
+	else if (job->pass->type == FramePass::ViewPass)
+		job->pass->view->recordViewConstants(job->commandList);
+	else if (job->pass->type == FramePass::UpscalePass)
+		job->engine->recordUpscale(job->commandList);
+	else
+		job->engine->recordPostProcess(job->commandList, job->pass->type);
+}
+
+void GraphicsEngine::recordUpscale(CommandList *commandList) const
+{
+	// stretch the part of the scene drawn into over the screen, with bilinear filtering
+	glm::vec2 targetSize((float)this->frameScreenWidth, (float)this->frameScreenHeight);
+	glm::vec2 sceneSize((float)this->sceneWidth, (float)this->sceneHeight);
+	commandList->bindShaderProgram(this->upscaleShader);
+	commandList->bindTexture(this->driver->getRenderTargetTexture(this->renderGraph->getTarget(this->sceneResource)), 0);
+	commandList->setShaderConstant("sceneTexture", 0);
+	commandList->setShaderConstant("uvScale", sceneSize / targetSize);
+	commandList->setShaderConstant("uvMax", (sceneSize - 0.5f) / targetSize);
+	commandList->bindVertexBuffer(this->upscaleQuad);
+	commandList->draw(GraphicDriver::TriangleStrip, 0, 4);
+}
+
+void GraphicsEngine::recordPostProcess(CommandList *commandList, FramePass::Type type) const
+{
+	// sources are the parts matching the scene of targets sized after the screen
+	glm::vec2 screenSize((float)this->frameScreenWidth, (float)this->frameScreenHeight);
+	PostProcess::Source scene = { this->driver->getRenderTargetTexture(this->renderGraph->getTarget(this->sceneResource)), glm::vec2((float)this->sceneWidth, (float)this->sceneHeight), screenSize };
+	
+	unsigned int divisor = (type == FramePass::BloomHorizontalPass) ? 2 : 4;
+	PostProcess::Source bloom = { NULL, glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f) };
+	if (this->postProcess->hasBloom())
+	{
+		RenderGraph::Resource resource = (type == FramePass::BloomHorizontalPass) ? this->bloomResource : this->blurResources[type == FramePass::BloomVerticalPass ? 0 : 1];
+		bloom.texture = this->driver->getRenderTargetTexture(this->renderGraph->getTarget(resource));
+		bloom.regionSize = glm::vec2((float)getPostSize(this->sceneWidth, divisor), (float)getPostSize(this->sceneHeight, divisor));
+		bloom.textureSize = glm::vec2((float)getPostSize(this->frameScreenWidth, divisor), (float)getPostSize(this->frameScreenHeight, divisor));
+	}
+	
+	switch (type)
+	{
+		case FramePass::BloomExtractPass:
+			this->postProcess->recordBloomExtract(commandList, scene);
+			break;
+		
+		case FramePass::BloomHorizontalPass:
+		case FramePass::BloomVerticalPass:
+			this->postProcess->recordBloomBlur(commandList, bloom, type == FramePass::BloomVerticalPass);
+			break;
+		
+		case FramePass::CompositePass:
+			this->postProcess->recordComposite(commandList, scene, bloom.texture ? &bloom : NULL);
+			break;
+		
+		case FramePass::AntialiasingPass:
+		{
+			PostProcess::Source composite = { this->driver->getRenderTargetTexture(this->renderGraph->getTarget(this->compositeResource)), screenSize, screenSize };
+			this->postProcess->recordAntialiasing(commandList, composite);
+			break;
+		}
+		
+		default:
+			break;
+	}
+}
+
 GraphicWorld *GraphicsEngine::findGraphicWorld(World *world)
 {
 	for (unsigned int i = 0; i < this->graphicWorlds.size(); i++)
@@ -25,19 +25,41 @@
 
 #pragma once
 
+#include <engine/graphics/GlyphAtlas.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/RenderGraph.hpp>
+#include <engine/graphics/TextureManager.hpp>
+
 #include <engine/sg/ComponentFactory.hpp>
 #include <engine/sg/WorldListener.hpp>
 
+#include <engine/system/Semaphore.hpp>
+
 #include <glm/glm.hpp>
 
+#include <string>
 #include <vector>
 
 namespace oak {
 
-class GraphicDriver;
+class AnimationManager;
+class AnimationResource;
+class CommandList;
+class DebugDraw;
+class DynamicResolution;
 class GraphicWorld;
+class JobQueue;
+class MeshManager;
+class MeshResource;
+class ParticleEmitter;
+class PostProcess;
+struct RenderTarget;
 class ScriptEngine;
 struct ShaderProgram;
+class SkinnedMeshResource;
+class StreamBuffer;
+class Terrain;
+class TextLayoutCache;
 struct VertexBuffer;
 class View;
 class WorldManager;
@@ -45,17 +67,99 @@ class WorldManager;
 class GraphicsEngine: public ComponentFactory, public WorldListener
 {
 	public:
-		GraphicsEngine(WorldManager *worldManager);
+		// with more than one snapshot, frames are recorded by the simulation
+		// thread (prepareFrame) while the previous ones are replayed on the
+		// driver thread (submitFrame)
+		GraphicsEngine(WorldManager *worldManager, JobQueue *jobQueue, unsigned int snapshotCount = 1);
 		~GraphicsEngine();
 		
+		// record the current state of all views into a free snapshot,
+		// blocking until one is available (simulation thread)
+		void prepareFrame();
+		
+		// replay the oldest recorded snapshot, blocking until one is available (driver thread)
+		void submitFrame();
+		
+		// release the oldest recorded snapshot without replaying it, if any;
+		// returns false if no snapshot was ready (driver thread)
+		bool discardFrame();
+		
+		// prepare and submit in sequence, for single-threaded use
 		void renderFrame();
 		
+		// size of the screen in pixels, can be changed from any thread
+		void setScreenSize(unsigned int width, unsigned int height);
+		
 		glm::vec3 getBackgroundColor() const { return this->backgroundColor; }
 		void setBackgroundColor(const glm::vec3 &color) { this->backgroundColor = color; }
 		
+		// Draw the views of the screen at a lower resolution, then upscale them. With
+		// dynamic resolution, the scale follows the time between submitted frames to
+		// hold the frame budget (in seconds); otherwise it is only set by hand.
+		bool isDynamicResolution() const;
+		void setDynamicResolution(bool enabled);
+		float getFrameBudget() const;
+		void setFrameBudget(float seconds);
+		float getRenderScale() const;
+		void setRenderScale(float scale);
+		float getMinRenderScale() const;
+		void setMinRenderScale(float scale);
+		
+		// effects applied to the views drawn into the screen (fog, tone mapping, bloom,
+		// antialiasing); their texts are then drawn over the result
+		PostProcess *getPostProcess() const { return this->postProcess; }
+		
+		// counters of the driver commands replayed by submitFrame()
+		const GraphicDriver::Statistics &getDriverStatistics() const;
+		void resetDriverStatistics();
+		void setDriverCommandTrace(bool enabled);
+		
+		// Dynamic vertices of the given format, to be allocated while recording
+		// (during prepareFrame); they are uploaded when the frame is submitted.
+		StreamBuffer *getStreamBuffer(GraphicDriver::VertexFormat format) const;
+		
+		// folder texture, mesh and animation file names are relative to
+		void setBaseFolder(const std::string &baseFolder);
+		
+		// start loading a cooked texture in the background, it can be drawn right away
+		TextureResource *loadTexture(const std::string &filename);
+		
+		// bytes of texels uploaded per frame at most, to spread texture loads over frames
+		int getTextureUploadBudget() const;
+		void setTextureUploadBudget(int bytes);
+		
+		// bytes of texture levels kept resident, besides the smallest levels of each texture
+		int getTextureMemoryBudget() const;
+		void setTextureMemoryBudget(int bytes);
+		
+		// texture residency, and counters of the streamed levels
+		const TextureManager::Statistics &getTextureStatistics() const;
+		
+		// passes and transient targets of the last prepared frame
+		const RenderGraph::Statistics &getRenderGraphStatistics() const;
+		
+		// glyphs in the atlas drawn by texts, and layouts computed since the start
+		const GlyphAtlas::Statistics &getGlyphStatistics() const;
+		unsigned int getTextLayoutCount() const;
+		
+		// load a cooked mesh with its levels of detail, or get the one already loaded
+		MeshResource *loadMesh(const std::string &filename);
+		
+		// load a cooked skinned mesh or animation clip, or get the one already loaded
+		SkinnedMeshResource *loadSkinnedMesh(const std::string &filename);
+		AnimationResource *loadAnimation(const std::string &filename);
+		
 		View *createView(World *world);
 		void destroyView(View *view);
 		
+		// Lines, boxes, spheres, frustums and labels drawn over the views of a world
+		// for the next frame only; nothing is drawn without OAK_DEBUG.
+		DebugDraw *getDebugDraw(World *world);
+		
+		// merge the geometry of the static entities of a world into a few
+		// pre-transformed batches; to be called once the world is loaded
+		void buildStaticBatches(World *world);
+		
 		// ComponentFactory
 		virtual Component *createComponent(Entity *entity, const std::string &className);
 		
@@ -66,10 +170,143 @@ class GraphicsEngine: public ComponentFactory, public WorldListener
 	private:
 		GraphicWorld *findGraphicWorld(World *world);
 		
+		// pass of the render graph, declared again each frame
+		struct FramePass
+		{
+			enum Type
+			{
+				ShadowPass, // the shadow maps of a view
+				ViewPass, // a view, into its target or the scene
+				UpscalePass, // the scene, stretched over the screen
+				
+				// post-processing of the scene, from the bright parts to the screen
+				BloomExtractPass,
+				BloomHorizontalPass,
+				BloomVerticalPass,
+				CompositePass,
+				AntialiasingPass,
+				
+				TextPass // the texts of a view drawn into the scene, over the screen
+			};
+			Type type;
+			View *view;
+			RenderGraph::Resource target;
+		};
+		
+		// recording of the constants of a view, of a chunk of its renderables, of its translucent
+		// ones, of a terrain, of a range of particles, of its sprites, of one of its shadow maps,
+		// or of the upscale pass, run on the job queue
+		struct RecordJob
+		{
+			GraphicsEngine *engine;
+			const FramePass *pass;
+			int shadowMap; // index in the maps updated this frame
+			bool sprites; // drawn by the last jobs of a view over its renderables
+			bool texts; // over the sprites
+			bool translucent; // renderables blended back to front, after the opaque ones and the terrains
+			
+			// particles drawn over the renderables, instead of them
+			const ParticleEmitter *particleEmitter;
+			unsigned int firstParticle;
+			unsigned int particleCount;
+			
+			const Terrain *terrain; // drawn instead of the renderables
+			
+			// the first job of a view binds its target, and clears it when first written
+			bool bindTarget;
+			RenderTarget *renderTarget; // NULL for the screen
+			unsigned int targetWidth;
+			unsigned int targetHeight;
+			bool clearTarget;
+			glm::vec3 clearColor;
+			
+			int renderChunk; // index in the render list of the view, -1 for the other jobs
+			CommandList *commandList; // kept by the view for the chunks
+		};
+		static void runRecordJob(void *userData);
+		void recordUpscale(CommandList *commandList) const;
+		void recordPostProcess(CommandList *commandList, FramePass::Type type) const;
+		
+		typedef std::vector<RecordJob> RecordJobVector;
+		typedef std::vector<CommandList *> CommandListVector;
+		
+		// everything needed to replay a frame, recorded ahead of time
+		struct Snapshot
+		{
+			glm::vec3 backgroundColor;
+			
+			// jobs and command lists are kept from one frame to the next, to reuse their memory
+			RecordJobVector recordJobs;
+			CommandListVector commandLists;
+			
+			// driver resource operations to execute before replaying this frame
+			unsigned int resourceMarker;
+			
+			// NULL until the first particle emitter is created
+			StreamBuffer *particleStreamBuffer;
+			
+			// lists of destroyed views, deleted once this snapshot is replayed
+			CommandListVector releasedCommandLists;
+		};
+		
+		// ring of snapshots, the simulation thread fills them in order and the
+		// driver thread consumes them in the same order
+		typedef std::vector<Snapshot *> SnapshotVector;
+		SnapshotVector snapshots;
+		unsigned int nextPreparedSnapshot;
+		unsigned int nextSubmittedSnapshot;
+		Semaphore freeSnapshots;
+		Semaphore readySnapshots;
+		
 		GraphicDriver *driver;
+		JobQueue *jobQueue;
+		
+		// one per vertex format
+		typedef std::vector<StreamBuffer *> StreamBufferVector;
+		StreamBufferVector streamBuffers;
+		
+		// sprite vertices of the particles, only allocated for the first emitter
+		StreamBuffer *particleStreamBuffer;
+		
+		TextureManager *textureManager;
+		MeshManager *meshManager;
+		AnimationManager *animationManager;
+		GlyphAtlas *glyphAtlas;
+		TextLayoutCache *textLayoutCache;
+		std::string baseFolder;
+		
+		volatile int screenWidth;
+		volatile int screenHeight;
 		
 		glm::vec3 backgroundColor;
 		
+		// passes of the frame being prepared
+		RenderGraph *renderGraph;
+		std::vector<FramePass> framePasses;
+		
+		// At lower scales, the screen views draw into part of a transient scene
+		// target as large as the screen, then upscaled; this frame sizes.
+		DynamicResolution *dynamicResolution;
+		RenderGraph::Resource sceneResource;
+		unsigned int frameScreenWidth;
+		unsigned int frameScreenHeight;
+		unsigned int sceneWidth;
+		unsigned int sceneHeight;
+		ShaderProgram *upscaleShader;
+		VertexBuffer *upscaleQuad;
+		
+		// Transient targets of the post-processing, this frame: bloom at half and
+		// quarter resolution, and the composite when antialiased afterwards. The
+		// scene is drawn into its transient target whenever post-processed.
+		PostProcess *postProcess;
+		RenderGraph::Resource bloomResource;
+		RenderGraph::Resource blurResources[2];
+		RenderGraph::Resource compositeResource;
+		
+		// microseconds between the last two submitted frames, 0 once read (driver thread)
+		volatile int frameTime;
+		unsigned long long lastSubmitTime;
+		
 		WorldManager *worldManager;
 		
 		// Generic scene graph worlds are mirrored here for performance reasons.
@@ -0,0 +1,388 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/LightClusters.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/Light.hpp>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// Layout of the data textures, also written in the shaders using them:
+// - clusters: one texel per tile (row-major) and one row per depth slice,
+//   holding the offset of the cluster lights (16 bits, low byte first) and their count
+// - indices: the light index of each reference, four per texel, row-major
+// - lights: one row per light, texels holding the view space position and the
+//   radius (16 bits each, high byte first, within the light range), then the
+//   color and the intensity
+const unsigned int gridWidth = 16;
+const unsigned int gridHeight = 9;
+const unsigned int gridDepth = 24;
+const unsigned int clusterCount = gridWidth * gridHeight * gridDepth;
+
+const unsigned int indexTextureWidth = 128;
+const unsigned int indexTextureHeight = 64;
+const unsigned int maxReferenceCount = indexTextureWidth * indexTextureHeight * 4;
+
+const unsigned int lightTextureWidth = 4;
+const unsigned int maxLightCount = 256; // indices are stored on a byte
+const float maxIntensity = 64.0f;
+
+// the shaders loop over this many lights at most
+const unsigned int maxClusterLightCount = 64;
+
+// depth slices binned by each job
+const unsigned int slicesPerJob = 4;
+
+// Conservative [0, 1] screen extent of a view space box, centered on (x, y)
+// and spanning the given depths; x and y get their smallest and largest
+// values over the box divided by the depth.
+void getScreenBounds(float x, float y, float extent, float nearDepth, float farDepth, const glm::vec2 &projectionScale, glm::vec4 *bounds)
+{
+	float x0 = x - extent;
+	float x1 = x + extent;
+	float y0 = y - extent;
+	float y1 = y + extent;
+	
+	bounds->x = projectionScale.x * (x0 >= 0.0f ? x0 / farDepth : x0 / nearDepth) * 0.5f + 0.5f;
+	bounds->y = projectionScale.y * (y0 >= 0.0f ? y0 / farDepth : y0 / nearDepth) * 0.5f + 0.5f;
+	bounds->z = projectionScale.x * (x1 >= 0.0f ? x1 / nearDepth : x1 / farDepth) * 0.5f + 0.5f;
+	bounds->w = projectionScale.y * (y1 >= 0.0f ? y1 / nearDepth : y1 / farDepth) * 0.5f + 0.5f;
+}
+
+// tile of a [0, 1] screen coordinate
+int clampTile(float coordinate, unsigned int tileCount)
+{
+	return glm::clamp((int)std::floor(coordinate * (float)tileCount), 0, (int)tileCount - 1);
+}
+
+// same as the shaders
+int getSlice(float depth, const glm::vec2 &depthSlicing)
+{
+	return glm::clamp((int)std::floor(std::log(depth) * depthSlicing.x + depthSlicing.y), 0, (int)gridDepth - 1);
+}
+
+void encode16(unsigned char *texel, float value)
+{
+	unsigned int encoded = (unsigned int)(glm::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	texel[0] = (unsigned char)(encoded >> 8);
+	texel[1] = (unsigned char)(encoded & 0xff);
+}
+
+unsigned char encode8(float value)
+{
+	return (unsigned char)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+} // end of private section
+
+LightClusters::LightClusters(GraphicDriver *driver)
+	: driver(driver)
+	, lightCount(0)
+	, droppedLightCount(0)
+	, projectionScale(1.0f, 1.0f)
+	, targetSize(1.0f, 1.0f)
+	, depthSlicing(0.0f, 0.0f)
+	, lightRange(1.0f)
+	, emptyUploaded(false)
+	, overflowReported(false)
+{
+	this->clusterTexture = this->driver->createTexture();
+	this->indexTexture = this->driver->createTexture();
+	this->lightTexture = this->driver->createTexture();
+	
+	// texels are read as is, and the cluster texture size is not a power of two
+	this->driver->setTextureSampling(this->clusterTexture, false, false);
+	this->driver->setTextureSampling(this->indexTexture, false, false);
+	this->driver->setTextureSampling(this->lightTexture, false, false);
+	
+	this->sliceDepths.resize(gridDepth + 1);
+	this->clusterLights.resize(clusterCount * maxClusterLightCount);
+	this->clusterLightCounts.resize(clusterCount, 0);
+	this->clusterTexels.resize(clusterCount * 4, 0);
+	this->indexTexels.resize(maxReferenceCount, 0);
+	this->lightTexels.resize(lightTextureWidth * maxLightCount * 4, 0);
+	
+	// single levels, defined right away so that the textures can be bound before the first binning
+	this->driver->uploadTextureLevel(this->clusterTexture, GraphicDriver::RGBA8TextureFormat, 0, gridWidth * gridHeight, gridDepth, &this->clusterTexels[0]);
+	this->driver->uploadTextureLevel(this->indexTexture, GraphicDriver::RGBA8TextureFormat, 0, indexTextureWidth, indexTextureHeight, &this->indexTexels[0]);
+	this->driver->uploadTextureLevel(this->lightTexture, GraphicDriver::RGBA8TextureFormat, 0, lightTextureWidth, maxLightCount, &this->lightTexels[0]);
+	this->emptyUploaded = true;
+}
+
+LightClusters::~LightClusters()
+{
+	this->driver->destroyTexture(this->clusterTexture);
+	this->driver->destroyTexture(this->indexTexture);
+	this->driver->destroyTexture(this->lightTexture);
+}
+
+void LightClusters::bin(const GraphicWorld::LightVector &lights, const Camera *camera, unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	glm::mat4 viewMatrix = glm::affineInverse(camera->getEntity()->getLocalTransform());
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	float nearPlane = camera->getNearPlane();
+	float farPlane = camera->getFarPlane();
+	
+	this->projectionScale = glm::vec2(projectionMatrix[0][0], projectionMatrix[1][1]);
+	this->targetSize = glm::vec2((float)std::max(targetWidth, 1u), (float)std::max(targetHeight, 1u));
+	
+	// slices get exponentially deeper, so that clusters stay about as deep as wide
+	float sliceScale = (float)gridDepth / std::log(farPlane / nearPlane);
+	this->depthSlicing = glm::vec2(sliceScale, -std::log(nearPlane) * sliceScale);
+	for (unsigned int i = 0; i <= gridDepth; i++)
+		this->sliceDepths[i] = std::exp(((float)i - this->depthSlicing.y) / sliceScale);
+	
+	// view space positions, of all point lights
+	this->lightX.resize(lights.size());
+	this->lightY.resize(lights.size());
+	this->lightZ.resize(lights.size());
+	this->lightRadius.resize(lights.size());
+	this->lightColors.resize(lights.size());
+	this->minSlice.resize(lights.size());
+	this->maxSlice.resize(lights.size());
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		const Light *light = lights[i];
+		if (light->isDirectional())
+			continue;
+		
+		glm::vec4 position = viewMatrix * light->getEntity()->getLocalTransform()[3];
+		
+		this->lightX[count] = position.x;
+		this->lightY[count] = position.y;
+		this->lightZ[count] = position.z;
+		this->lightRadius[count] = light->getRadius();
+		this->lightColors[count] = glm::vec4(light->getColor(), light->getIntensity());
+		count++;
+	}
+	
+	// Slices covered by each light, or an empty range for lights out of the
+	// frustum. The loop only has selects and math functions, so that compilers
+	// can vectorize it for the targeted instruction set.
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float radius = this->lightRadius[i];
+		float depth = -this->lightZ[i];
+		float nearDepth = glm::max(depth - radius, nearPlane);
+		float farDepth = glm::clamp(depth + radius, nearPlane, farPlane);
+		
+		glm::vec4 bounds;
+		getScreenBounds(this->lightX[i], this->lightY[i], radius, nearDepth, farDepth, this->projectionScale, &bounds);
+		
+		bool outside = (bounds.z < 0.0f || bounds.x > 1.0f || bounds.w < 0.0f || bounds.y > 1.0f || depth + radius < nearPlane || depth - radius > farPlane);
+		this->minSlice[i] = getSlice(nearDepth, this->depthSlicing);
+		this->maxSlice[i] = outside ? -1 : getSlice(farDepth, this->depthSlicing);
+	}
+	
+	// keep the visible lights only, in the same order
+	this->lightCount = 0;
+	this->droppedLightCount = 0;
+	this->lightRange = 0.001f;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (this->maxSlice[i] < 0)
+			continue;
+		
+		if (this->lightCount == maxLightCount)
+		{
+			this->droppedLightCount++;
+			continue;
+		}
+		
+		unsigned int j = this->lightCount++;
+		this->lightX[j] = this->lightX[i];
+		this->lightY[j] = this->lightY[i];
+		this->lightZ[j] = this->lightZ[i];
+		this->lightRadius[j] = this->lightRadius[i];
+		this->lightColors[j] = this->lightColors[i];
+		this->minSlice[j] = this->minSlice[i];
+		this->maxSlice[j] = this->maxSlice[i];
+		
+		float extent = glm::max(glm::max(std::abs(this->lightX[j]), std::abs(this->lightY[j])), glm::max(std::abs(this->lightZ[j]), this->lightRadius[j]));
+		this->lightRange = glm::max(this->lightRange, extent);
+	}
+	
+	// then fill the clusters, a few slices per job
+	std::fill(this->clusterLightCounts.begin(), this->clusterLightCounts.end(), 0);
+	this->binJobs.clear();
+	if (this->lightCount == 0)
+		return;
+	
+	this->binJobs.resize((gridDepth + slicesPerJob - 1) / slicesPerJob);
+	for (unsigned int i = 0; i < this->binJobs.size(); i++)
+	{
+		BinJob &job = this->binJobs[i];
+		job.clusters = this;
+		job.firstSlice = i * slicesPerJob;
+		job.sliceCount = std::min(slicesPerJob, gridDepth - job.firstSlice);
+		job.droppedCount = 0;
+		
+		jobQueue->push(LightClusters::runBinJob, &job, batch);
+	}
+}
+
+void LightClusters::upload()
+{
+	// nothing changes while there is no light
+	if (this->lightCount == 0 && this->emptyUploaded)
+		return;
+	
+	unsigned int droppedCount = 0;
+	for (unsigned int i = 0; i < this->binJobs.size(); i++)
+		droppedCount += this->binJobs[i].droppedCount;
+	
+	// pack the cluster lists one after the other
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < clusterCount; i++)
+	{
+		unsigned int count = this->clusterLightCounts[i];
+		if (offset + count > maxReferenceCount)
+		{
+			droppedCount += offset + count - maxReferenceCount;
+			count = maxReferenceCount - offset;
+		}
+		
+		const unsigned char *lights = &this->clusterLights[i * maxClusterLightCount];
+		std::copy(lights, lights + count, this->indexTexels.begin() + offset);
+		
+		unsigned char *texel = &this->clusterTexels[i * 4];
+		texel[0] = (unsigned char)(offset & 0xff);
+		texel[1] = (unsigned char)(offset >> 8);
+		texel[2] = (unsigned char)count;
+		
+		offset += count;
+	}
+	
+	for (unsigned int i = 0; i < this->lightCount; i++)
+	{
+		unsigned char *texels = &this->lightTexels[i * lightTextureWidth * 4];
+		encode16(texels + 0, this->lightX[i] / this->lightRange * 0.5f + 0.5f);
+		encode16(texels + 2, this->lightY[i] / this->lightRange * 0.5f + 0.5f);
+		encode16(texels + 4, this->lightZ[i] / this->lightRange * 0.5f + 0.5f);
+		encode16(texels + 6, this->lightRadius[i] / this->lightRange);
+		
+		const glm::vec4 &color = this->lightColors[i];
+		texels[8] = encode8(color.x);
+		texels[9] = encode8(color.y);
+		texels[10] = encode8(color.z);
+		texels[11] = encode8(color.w / maxIntensity);
+	}
+	
+	if ((droppedCount > 0 || this->droppedLightCount > 0) && !this->overflowReported)
+	{
+		Log::warning("Too many lights for the clusters: %u lights and %u cluster references ignored", this->droppedLightCount, droppedCount);
+		this->overflowReported = true;
+	}
+	
+	this->driver->uploadTextureLevel(this->clusterTexture, GraphicDriver::RGBA8TextureFormat, 0, gridWidth * gridHeight, gridDepth, &this->clusterTexels[0]);
+	this->driver->uploadTextureLevel(this->indexTexture, GraphicDriver::RGBA8TextureFormat, 0, indexTextureWidth, indexTextureHeight, &this->indexTexels[0]);
+	this->driver->uploadTextureLevel(this->lightTexture, GraphicDriver::RGBA8TextureFormat, 0, lightTextureWidth, maxLightCount, &this->lightTexels[0]);
+	this->emptyUploaded = (this->lightCount == 0);
+}
+
+void LightClusters::record(CommandList *commandList) const
+{
+	commandList->bindTexture(this->clusterTexture, 1);
+	commandList->bindTexture(this->indexTexture, 2);
+	commandList->bindTexture(this->lightTexture, 3);
+	
+	commandList->setShaderConstant("lightClusters", 1);
+	commandList->setShaderConstant("lightIndices", 2);
+	commandList->setShaderConstant("lightData", 3);
+	
+	commandList->setShaderConstant("lightGridSize", glm::vec3((float)gridWidth, (float)gridHeight, (float)gridDepth));
+	commandList->setShaderConstant("lightTargetSize", this->targetSize);
+	commandList->setShaderConstant("lightDepthSlicing", this->depthSlicing);
+	commandList->setShaderConstant("lightRange", this->lightRange);
+}
+
+void LightClusters::runBinJob(void *userData)
+{
+	BinJob *job = (BinJob *)userData;
+	job->clusters->binSlices(job);
+}
+
+void LightClusters::binSlices(BinJob *job)
+{
+	int firstSlice = (int)job->firstSlice;
+	int lastSlice = (int)(job->firstSlice + job->sliceCount) - 1;
+	
+	for (unsigned int i = 0; i < this->lightCount; i++)
+	{
+		float radius = this->lightRadius[i];
+		float depth = -this->lightZ[i];
+		
+		int sliceBegin = std::max(this->minSlice[i], firstSlice);
+		int sliceEnd = std::min(this->maxSlice[i], lastSlice);
+		for (int slice = sliceBegin; slice <= sliceEnd; slice++)
+		{
+			// the part of the sphere within the slice is as wide as its section
+			// at the depth of the slice closest to its center
+			float sliceNear = glm::max(depth - radius, this->sliceDepths[slice]);
+			float sliceFar = glm::min(depth + radius, this->sliceDepths[slice + 1]);
+			float offset = glm::clamp(depth, sliceNear, sliceFar) - depth;
+			float extent = std::sqrt(glm::max(radius * radius - offset * offset, 0.0f));
+			
+			glm::vec4 bounds;
+			getScreenBounds(this->lightX[i], this->lightY[i], extent, sliceNear, glm::max(sliceFar, sliceNear), this->projectionScale, &bounds);
+			if (bounds.z < 0.0f || bounds.x > 1.0f || bounds.w < 0.0f || bounds.y > 1.0f)
+				continue;
+			
+			int minX = clampTile(bounds.x, gridWidth);
+			int maxX = clampTile(bounds.z, gridWidth);
+			int minY = clampTile(bounds.y, gridHeight);
+			int maxY = clampTile(bounds.w, gridHeight);
+			for (int y = minY; y <= maxY; y++)
+			{
+				for (int x = minX; x <= maxX; x++)
+				{
+					unsigned int cluster = (slice * gridHeight + y) * gridWidth + x;
+					unsigned char &clusterLightCount = this->clusterLightCounts[cluster];
+					if (clusterLightCount < maxClusterLightCount)
+						this->clusterLights[cluster * maxClusterLightCount + clusterLightCount++] = (unsigned char)i;
+					else
+						job->droppedCount++;
+				}
+			}
+		}
+	}
+}
+
+} // oak namespace
@@ -0,0 +1,124 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <engine/system/JobQueue.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class Camera;
+class CommandList;
+class GraphicDriver;
+struct Texture;
+
+/**
+ * Clustered forward lighting: the view frustum is split in a grid of clusters
+ * (screen tiles, times depth slices), and shaders only evaluate the lights
+ * touching the cluster of each fragment.
+ *
+ * Lights are assigned to the clusters on the CPU, by jobs each filling some
+ * depth slices. Cluster contents, light lists and light parameters are then
+ * packed in RGBA8 data textures, which GLES2 can sample; the shaders reading
+ * them are tied to the layout described in LightClusters.cpp.
+ */
+class LightClusters
+{
+	public:
+		LightClusters(GraphicDriver *driver);
+		~LightClusters();
+		
+		// Assign the lights to the clusters of a camera, for a target of the given size.
+		// The jobs are pushed in the batch, which must be done before upload().
+		void bin(const GraphicWorld::LightVector &lights, const Camera *camera, unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch);
+		
+		// pack the clusters in the data textures (resource operations)
+		void upload();
+		
+		// bind the data textures to the units 1 to 3, and set the constants
+		// reading them for the shader bound last; can be called concurrently
+		void record(CommandList *commandList) const;
+		
+		// lights in the view during the last binning
+		unsigned int getVisibleLightCount() const { return this->lightCount; }
+	
+	private:
+		// fill the clusters of a range of depth slices, run on the job queue
+		struct BinJob
+		{
+			LightClusters *clusters;
+			unsigned int firstSlice;
+			unsigned int sliceCount;
+			unsigned int droppedCount; // references beyond the capacity of clusters
+		};
+		static void runBinJob(void *userData);
+		void binSlices(BinJob *job);
+		
+		GraphicDriver *driver;
+		Texture *clusterTexture;
+		Texture *indexTexture;
+		Texture *lightTexture;
+		
+		// visible lights, in view space, as separate arrays for the binning loops
+		unsigned int lightCount;
+		unsigned int droppedLightCount; // beyond the light count limit
+		std::vector<float> lightX;
+		std::vector<float> lightY;
+		std::vector<float> lightZ;
+		std::vector<float> lightRadius;
+		std::vector<glm::vec4> lightColors; // with the intensity in w
+		
+		// slices covered by each light, inclusive ranges
+		std::vector<int> minSlice;
+		std::vector<int> maxSlice;
+		
+		// light indices of each cluster, filled by the bin jobs
+		std::vector<unsigned char> clusterLights;
+		std::vector<unsigned char> clusterLightCounts;
+		std::vector<BinJob> binJobs;
+		
+		// constants of the last binning
+		std::vector<float> sliceDepths; // bounds of each slice
+		glm::vec2 projectionScale;
+		glm::vec2 targetSize;
+		glm::vec2 depthSlicing; // scale and bias from the log of the depth to the slice
+		float lightRange; // view space positions are encoded within this distance
+		
+		// texels, kept to reuse their memory
+		std::vector<unsigned char> clusterTexels;
+		std::vector<unsigned char> indexTexels;
+		std::vector<unsigned char> lightTexels;
+		
+		bool emptyUploaded;
+		bool overflowReported;
+};
+
+} // oak namespace
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/MeshManager.hpp>
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/system/File.hpp>
+#include <engine/system/Log.hpp>
+
+#include <cstring>
+
+namespace oak {
+
+namespace { // private section
+
+// Layout of the cooked mesh files, written by tools/mesh-simplifier; integers
+// and floats are 32-bit little-endian values:
+//
+//   "OMSH", version, levelCount
+//   bounding sphere: center x, y, z, radius
+//   for each level, from the finest: screenSize, vertexCount, then the vertices
+//   (position, normal and uv floats)
+const char meshMagic[4] = { 'O', 'M', 'S', 'H' };
+const unsigned int meshVersion = 1;
+const unsigned int floatsPerVertex = 8;
+
+// sequential reading of a file in memory, with bound checks
+class MeshFileReader
+{
+	public:
+		MeshFileReader(const std::vector<char> &content)
+			: content(content)
+			, offset(0)
+		{}
+		
+		bool readInteger(unsigned int *value)
+		{
+			const unsigned char *data = (const unsigned char *)this->read(4);
+			if (!data)
+				return false;
+			
+			*value = data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+			return true;
+		}
+		
+		bool readFloat(float *value)
+		{
+			unsigned int bits;
+			if (!this->readInteger(&bits))
+				return false;
+			
+			memcpy(value, &bits, sizeof(float));
+			return true;
+		}
+		
+		// returns NULL past the end of the file
+		const char *read(unsigned int size)
+		{
+			if (size > this->content.size() - this->offset)
+				return NULL;
+			
+			const char *data = &this->content[this->offset];
+			this->offset += size;
+			
+			return data;
+		}
+	
+	private:
+		const std::vector<char> &content;
+		unsigned int offset;
+};
+
+} // end of private section
+
+MeshResource::MeshResource(const std::string &path)
+	: path(path)
+	, failed(false)
+	, buffer(NULL)
+	, boundingCenter(0.0f)
+	, boundingRadius(0.0f)
+{
+}
+
+MeshManager::MeshManager(GraphicDriver *driver)
+	: driver(driver)
+{
+}
+
+MeshManager::~MeshManager()
+{
+	for (MeshMap::iterator it = this->meshes.begin(); it != this->meshes.end(); ++it)
+	{
+		if (it->second->buffer)
+			this->driver->destroyVertexBuffer(it->second->buffer);
+		
+		delete it->second;
+	}
+}
+
+MeshResource *MeshManager::load(const std::string &path)
+{
+	MeshMap::iterator it = this->meshes.find(path);
+	if (it != this->meshes.end())
+		return it->second;
+	
+	MeshResource *resource = new MeshResource(path);
+	this->meshes[path] = resource;
+	
+	if (!this->read(resource))
+	{
+		resource->failed = true;
+		resource->levels.clear();
+		resource->occluderPositions.clear();
+	}
+	
+	return resource;
+}
+
+bool MeshManager::read(MeshResource *resource)
+{
+	std::vector<char> content;
+	if (!File::read(resource->path, &content))
+	{
+		Log::error("Failed to open mesh '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	MeshFileReader reader(content);
+	
+	const char *magic = reader.read(4);
+	unsigned int version = 0;
+	unsigned int levelCount = 0;
+	bool valid = (magic && memcmp(magic, meshMagic, 4) == 0);
+	valid = valid && reader.readInteger(&version) && version == meshVersion;
+	valid = valid && reader.readInteger(&levelCount) && levelCount > 0;
+	valid = valid && reader.readFloat(&resource->boundingCenter.x) && reader.readFloat(&resource->boundingCenter.y) && reader.readFloat(&resource->boundingCenter.z);
+	valid = valid && reader.readFloat(&resource->boundingRadius);
+	
+	// all levels go in the same buffer, one after the other
+	std::vector<GraphicDriver::Standard3DVertex> vertices;
+	for (unsigned int i = 0; valid && i < levelCount; i++)
+	{
+		GraphicWorld::Lod level;
+		unsigned int vertexCount = 0;
+		valid = reader.readFloat(&level.screenSize) && reader.readInteger(&vertexCount);
+		valid = valid && vertexCount > 0 && vertexCount % 3 == 0;
+		
+		const char *data = valid ? reader.read(vertexCount * floatsPerVertex * sizeof(float)) : NULL;
+		valid = (data != NULL);
+		if (!valid)
+			break;
+		
+		level.startElement = (unsigned int)vertices.size();
+		level.elementCount = vertexCount;
+		resource->levels.push_back(level);
+		
+		for (unsigned int j = 0; j < vertexCount; j++)
+		{
+			float values[floatsPerVertex];
+			memcpy(values, data + j * sizeof(values), sizeof(values));
+			
+			GraphicDriver::Standard3DVertex vertex;
+			vertex.position = glm::vec3(values[0], values[1], values[2]);
+			vertex.normal = glm::vec3(values[3], values[4], values[5]);
+			vertex.uv = glm::vec2(values[6], values[7]);
+			vertices.push_back(vertex);
+		}
+	}
+	
+	if (!valid)
+	{
+		Log::error("Invalid mesh file '%s'", resource->path.c_str());
+		return false;
+	}
+	
+	const GraphicWorld::Lod &coarsest = resource->levels.back();
+	for (unsigned int i = 0; i < coarsest.elementCount; i++)
+		resource->occluderPositions.push_back(vertices[coarsest.startElement + i].position);
+	
+	resource->buffer = this->driver->createVertexBuffer(&vertices[0], (unsigned int)vertices.size());
+	for (unsigned int i = 0; i < resource->levels.size(); i++)
+		resource->levels[i].buffer = resource->buffer;
+	
+	return true;
+}
+
+} // oak namespace
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace oak {
+
+class GraphicDriver;
+class MeshManager;
+struct VertexBuffer;
+
+/**
+ * Mesh loaded by the mesh manager, with its levels of detail.
+ */
+class MeshResource
+{
+	public:
+		const std::string &getPath() const { return this->path; }
+		bool hasFailed() const { return this->failed; }
+		
+		// levels of detail from the finest one, all in the same vertex buffer;
+		// empty if the load failed
+		const std::vector<GraphicWorld::Lod> &getLevels() const { return this->levels; }
+		
+		// positions of the coarsest level, kept on the CPU for occlusion culling
+		const std::vector<glm::vec3> &getOccluderPositions() const { return this->occluderPositions; }
+		
+		// bounding sphere of all levels, in local space
+		const glm::vec3 &getBoundingCenter() const { return this->boundingCenter; }
+		float getBoundingRadius() const { return this->boundingRadius; }
+	
+	private:
+		friend class MeshManager;
+		
+		MeshResource(const std::string &path);
+		
+		std::string path;
+		bool failed;
+		
+		VertexBuffer *buffer;
+		std::vector<GraphicWorld::Lod> levels;
+		std::vector<glm::vec3> occluderPositions;
+		
+		glm::vec3 boundingCenter;
+		float boundingRadius;
+};
+
+/**
+ * Loads cooked meshes (.omesh files, see tools/mesh-simplifier), each holding
+ * a chain of levels of detail. Unlike textures, meshes are small enough to be
+ * read right away, when first requested.
+ */
+class MeshManager
+{
+	public:
+		MeshManager(GraphicDriver *driver);
+		~MeshManager();
+		
+		// load a mesh file, or return the mesh already loaded from it
+		MeshResource *load(const std::string &path);
+	
+	private:
+		bool read(MeshResource *resource);
+		
+		GraphicDriver *driver;
+		
+		// all meshes, by path
+		typedef std::map<std::string, MeshResource *> MeshMap;
+		MeshMap meshes;
+};
+
+} // oak namespace
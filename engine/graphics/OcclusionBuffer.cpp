@@ -0,0 +1,386 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/OcclusionBuffer.hpp>
+
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/Occluder.hpp>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Simd.hpp>
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace oak {
+
+namespace { // private section
+
+// The buffer is this wide, and as high as the target aspect allows, in whole
+// tiles. Tiles are split in square blocks for the hierarchical depths.
+const unsigned int bufferWidth = 256;
+const unsigned int maxBufferHeight = 256;
+const unsigned int tileWidth = 64;
+const unsigned int tileHeight = 16;
+const unsigned int blockSize = 8;
+
+// pixels are written four at a time
+const unsigned int laneCount = 4;
+
+// the largest axis scaling gives conservative world-space sizes
+float getLargestScale(const glm::mat4 &transform)
+{
+	return glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+}
+
+// point of a segment where the clip space w reaches the near plane
+glm::vec4 clipNear(const glm::vec4 &inside, const glm::vec4 &outside, float nearPlane)
+{
+	float t = (inside.w - nearPlane) / (inside.w - outside.w);
+	return inside + (outside - inside) * t;
+}
+
+} // end of private section
+
+OcclusionBuffer::OcclusionBuffer()
+	: width(0)
+	, height(0)
+	, tileColumnCount(0)
+	, version(0)
+	, projectionScale(1.0f, 1.0f)
+	, nearPlane(0.0f)
+{
+}
+
+void OcclusionBuffer::rasterize(const GraphicWorld::OccluderVector &occluders, const Camera *camera, unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	unsigned int previousHeight = this->height;
+	this->viewMatrix = glm::affineInverse(camera->getEntity()->getLocalTransform());
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	this->projectionScale = glm::vec2(projectionMatrix[0][0], projectionMatrix[1][1]);
+	this->nearPlane = camera->getNearPlane();
+	
+	// same aspect as the target, in whole tiles
+	float aspect = (float)std::max(targetHeight, 1u) / (float)std::max(targetWidth, 1u);
+	unsigned int rowCount = (unsigned int)(aspect * (float)bufferWidth / (float)tileHeight + 0.5f);
+	this->width = bufferWidth;
+	this->height = glm::clamp(rowCount, 1u, maxBufferHeight / tileHeight) * tileHeight;
+	this->tileColumnCount = this->width / tileWidth;
+	
+	this->depths.resize(this->width * this->height);
+	this->blockDepths.resize((this->width / blockSize) * (this->height / blockSize));
+	this->tileTriangles.resize(this->tileColumnCount * (this->height / tileHeight));
+	for (unsigned int i = 0; i < this->tileTriangles.size(); i++)
+		this->tileTriangles[i].clear();
+	
+	// transform, clip and bin the triangles of the occluders in the frustum
+	glm::mat4 viewProjectionMatrix = projectionMatrix * this->viewMatrix;
+	Frustum frustum(viewProjectionMatrix);
+	
+	this->previousTriangles.swap(this->triangles);
+	this->triangles.clear();
+	for (unsigned int i = 0; i < occluders.size(); i++)
+	{
+		const Occluder *occluder = occluders[i];
+		const glm::mat4 &transform = occluder->getEntity()->getLocalTransform();
+		
+		glm::vec3 center = glm::vec3(transform * glm::vec4(occluder->getBoundingCenter(), 1.0f));
+		if (!frustum.intersectsSphere(center, occluder->getBoundingRadius() * getLargestScale(transform)))
+			continue;
+		
+		glm::mat4 matrix = viewProjectionMatrix * transform;
+		const glm::vec3 *positions = occluder->getPositions();
+		for (unsigned int j = 0; j + 2 < occluder->getVertexCount(); j += 3)
+		{
+			glm::vec4 clipPositions[3];
+			for (unsigned int k = 0; k < 3; k++)
+				clipPositions[k] = matrix * glm::vec4(positions[j + k], 1.0f);
+			
+			this->addTriangle(clipPositions);
+		}
+	}
+	
+	// the same triangles give the same depths
+	unsigned int triangleCount = (unsigned int)this->triangles.size();
+	if (this->height != previousHeight || triangleCount != this->previousTriangles.size() || (triangleCount > 0 && std::memcmp(&this->triangles[0], &this->previousTriangles[0], triangleCount * sizeof(Triangle)) != 0))
+		this->version++;
+	
+	// then rasterize each tile in its own job
+	if (this->triangles.empty())
+		return;
+	
+	this->tileJobs.resize(this->tileTriangles.size());
+	for (unsigned int i = 0; i < this->tileJobs.size(); i++)
+	{
+		TileJob &job = this->tileJobs[i];
+		job.buffer = this;
+		job.tile = i;
+		
+		jobQueue->push(OcclusionBuffer::runTileJob, &job, batch);
+	}
+}
+
+bool OcclusionBuffer::isVisible(const glm::vec3 &center, float radius) const
+{
+	if (this->triangles.empty())
+		return true;
+	
+	// nearest depth of the sphere, visible if it crosses the near plane
+	glm::vec3 viewCenter = glm::vec3(this->viewMatrix * glm::vec4(center, 1.0f));
+	float nearDepth = -viewCenter.z - radius;
+	float farDepth = -viewCenter.z + radius;
+	if (nearDepth <= this->nearPlane)
+		return true;
+	
+	// conservative screen bounds, in pixels; x and y get their smallest and
+	// largest values over the bounding box divided by the depth
+	float x0 = viewCenter.x - radius;
+	float x1 = viewCenter.x + radius;
+	float y0 = viewCenter.y - radius;
+	float y1 = viewCenter.y + radius;
+	float left = (this->projectionScale.x * (x0 >= 0.0f ? x0 / farDepth : x0 / nearDepth) * 0.5f + 0.5f) * (float)this->width;
+	float right = (this->projectionScale.x * (x1 >= 0.0f ? x1 / nearDepth : x1 / farDepth) * 0.5f + 0.5f) * (float)this->width;
+	float bottom = (this->projectionScale.y * (y0 >= 0.0f ? y0 / farDepth : y0 / nearDepth) * 0.5f + 0.5f) * (float)this->height;
+	float top = (this->projectionScale.y * (y1 >= 0.0f ? y1 / nearDepth : y1 / farDepth) * 0.5f + 0.5f) * (float)this->height;
+	
+	int minX = glm::clamp((int)std::floor(left), 0, (int)this->width - 1);
+	int maxX = glm::clamp((int)std::floor(right), 0, (int)this->width - 1);
+	int minY = glm::clamp((int)std::floor(bottom), 0, (int)this->height - 1);
+	int maxY = glm::clamp((int)std::floor(top), 0, (int)this->height - 1);
+	if (right < 0.0f || left >= (float)this->width || top < 0.0f || bottom >= (float)this->height)
+		return true;
+	
+	// Hidden if all the covered pixels have an occluder nearer than the sphere;
+	// blocks are checked first, then the pixels of the blocks that do not
+	// settle it alone.
+	float depth = 1.0f / nearDepth;
+	unsigned int blockColumnCount = this->width / blockSize;
+	for (int blockY = minY / (int)blockSize; blockY <= maxY / (int)blockSize; blockY++)
+	{
+		for (int blockX = minX / (int)blockSize; blockX <= maxX / (int)blockSize; blockX++)
+		{
+			if (this->blockDepths[blockY * blockColumnCount + blockX] > depth)
+				continue;
+			
+			int startX = std::max(minX, blockX * (int)blockSize);
+			int endX = std::min(maxX, blockX * (int)blockSize + (int)blockSize - 1);
+			int startY = std::max(minY, blockY * (int)blockSize);
+			int endY = std::min(maxY, blockY * (int)blockSize + (int)blockSize - 1);
+			for (int y = startY; y <= endY; y++)
+			{
+				const float *row = &this->depths[y * this->width];
+				for (int x = startX; x <= endX; x++)
+				{
+					if (row[x] <= depth)
+						return true;
+				}
+			}
+		}
+	}
+	
+	return false;
+}
+
+void OcclusionBuffer::addTriangle(const glm::vec4 *clipPositions)
+{
+	// clip against the near plane, which gives up to four vertices
+	glm::vec4 polygon[4];
+	unsigned int vertexCount = 0;
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		const glm::vec4 &current = clipPositions[i];
+		const glm::vec4 &next = clipPositions[(i + 1) % 3];
+		bool currentInside = (current.w >= this->nearPlane);
+		bool nextInside = (next.w >= this->nearPlane);
+		
+		if (currentInside)
+			polygon[vertexCount++] = current;
+		if (currentInside != nextInside)
+			polygon[vertexCount++] = currentInside ? clipNear(current, next, this->nearPlane) : clipNear(next, current, this->nearPlane);
+	}
+	
+	for (unsigned int i = 2; i < vertexCount; i++)
+		this->addScreenTriangle(polygon[0], polygon[i - 1], polygon[i]);
+}
+
+void OcclusionBuffer::addScreenTriangle(const glm::vec4 &position0, const glm::vec4 &position1, const glm::vec4 &position2)
+{
+	Triangle triangle;
+	const glm::vec4 *clipPositions[3] = { &position0, &position1, &position2 };
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		float inverseW = 1.0f / clipPositions[i]->w;
+		triangle.positions[i].x = (clipPositions[i]->x * inverseW * 0.5f + 0.5f) * (float)this->width;
+		triangle.positions[i].y = (clipPositions[i]->y * inverseW * 0.5f + 0.5f) * (float)this->height;
+		triangle.depths[i] = inverseW;
+	}
+	
+	// back faces are hidden by the front ones of closed occluders
+	glm::vec2 edge1 = triangle.positions[1] - triangle.positions[0];
+	glm::vec2 edge2 = triangle.positions[2] - triangle.positions[0];
+	if (edge1.x * edge2.y - edge1.y * edge2.x <= 0.0f)
+		return;
+	
+	// bin in the tiles overlapped by its bounds
+	glm::vec2 low = glm::min(triangle.positions[0], glm::min(triangle.positions[1], triangle.positions[2]));
+	glm::vec2 high = glm::max(triangle.positions[0], glm::max(triangle.positions[1], triangle.positions[2]));
+	if (high.x < 0.0f || high.y < 0.0f || low.x >= (float)this->width || low.y >= (float)this->height)
+		return;
+	
+	unsigned int rowCount = this->height / tileHeight;
+	int minColumn = glm::clamp((int)(low.x / (float)tileWidth), 0, (int)this->tileColumnCount - 1);
+	int maxColumn = glm::clamp((int)(high.x / (float)tileWidth), 0, (int)this->tileColumnCount - 1);
+	int minRow = glm::clamp((int)(low.y / (float)tileHeight), 0, (int)rowCount - 1);
+	int maxRow = glm::clamp((int)(high.y / (float)tileHeight), 0, (int)rowCount - 1);
+	
+	unsigned int index = (unsigned int)this->triangles.size();
+	this->triangles.push_back(triangle);
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+			this->tileTriangles[row * this->tileColumnCount + column].push_back(index);
+	}
+}
+
+void OcclusionBuffer::runTileJob(void *userData)
+{
+	TileJob *job = (TileJob *)userData;
+	job->buffer->rasterizeTile(job->tile);
+}
+
+void OcclusionBuffer::rasterizeTile(unsigned int tile)
+{
+	int tileX = (int)((tile % this->tileColumnCount) * tileWidth);
+	int tileY = (int)((tile / this->tileColumnCount) * tileHeight);
+	
+	// nothing is infinitely far
+	for (int y = tileY; y < tileY + (int)tileHeight; y++)
+		std::fill(&this->depths[y * this->width + tileX], &this->depths[y * this->width + tileX] + tileWidth, 0.0f);
+	
+	const std::vector<unsigned int> &indices = this->tileTriangles[tile];
+	for (unsigned int i = 0; i < indices.size(); i++)
+	{
+		const Triangle &triangle = this->triangles[indices[i]];
+		const glm::vec2 *p = triangle.positions;
+		
+		// Edge functions, positive inside. They are offset by half a pixel along
+		// their gradient, so that they are only positive at the center of the
+		// pixels fully covered.
+		float a[3];
+		float b[3];
+		float c[3];
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			const glm::vec2 &from = p[j];
+			const glm::vec2 &to = p[(j + 1) % 3];
+			a[j] = from.y - to.y;
+			b[j] = to.x - from.x;
+			c[j] = -(a[j] * from.x + b[j] * from.y) - 0.5f * (std::abs(a[j]) + std::abs(b[j]));
+		}
+		
+		// inverse depth plane, offset to the farthest value over each pixel
+		float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+		float depth1 = triangle.depths[1] - triangle.depths[0];
+		float depth2 = triangle.depths[2] - triangle.depths[0];
+		float depthX = (depth1 * (p[2].y - p[0].y) - depth2 * (p[1].y - p[0].y)) / area;
+		float depthY = (depth2 * (p[1].x - p[0].x) - depth1 * (p[2].x - p[0].x)) / area;
+		float depthC = triangle.depths[0] - depthX * p[0].x - depthY * p[0].y - 0.5f * (std::abs(depthX) + std::abs(depthY));
+		
+		// bounds within the tile, from a multiple of the lane count
+		glm::vec2 low = glm::min(p[0], glm::min(p[1], p[2]));
+		glm::vec2 high = glm::max(p[0], glm::max(p[1], p[2]));
+		int minX = std::max(tileX, (int)std::floor(low.x)) & ~(int)(laneCount - 1);
+		int maxX = std::min(tileX + (int)tileWidth - 1, (int)std::floor(high.x));
+		int minY = std::max(tileY, (int)std::floor(low.y));
+		int maxY = std::min(tileY + (int)tileHeight - 1, (int)std::floor(high.y));
+		
+		// values at the centers of the first lanes, and their steps
+		Float4 laneX = Simd::set((float)minX + 0.5f, (float)minX + 1.5f, (float)minX + 2.5f, (float)minX + 3.5f);
+		Float4 edgeStepX[3];
+		Float4 edgeRow[3];
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			edgeStepX[j] = Simd::set(a[j] * (float)laneCount);
+			edgeRow[j] = Simd::add(Simd::mul(Simd::set(a[j]), laneX), Simd::set(b[j] * ((float)minY + 0.5f) + c[j]));
+		}
+		Float4 depthStepX = Simd::set(depthX * (float)laneCount);
+		Float4 depthRow = Simd::add(Simd::mul(Simd::set(depthX), laneX), Simd::set(depthY * ((float)minY + 0.5f) + depthC));
+		Float4 zero = Simd::set(0.0f);
+		
+		for (int y = minY; y <= maxY; y++)
+		{
+			Float4 edge0 = edgeRow[0];
+			Float4 edge1 = edgeRow[1];
+			Float4 edge2 = edgeRow[2];
+			Float4 depth = depthRow;
+			float *row = &this->depths[y * this->width];
+			
+			for (int x = minX; x <= maxX; x += (int)laneCount)
+			{
+				Float4 inside = Simd::bitAnd(Simd::greaterEqual(edge0, zero), Simd::bitAnd(Simd::greaterEqual(edge1, zero), Simd::greaterEqual(edge2, zero)));
+				if (Simd::getMask(inside) != 0)
+				{
+					Float4 previous = Simd::load(row + x);
+					Simd::store(row + x, Simd::select(inside, Simd::max(previous, depth), previous));
+				}
+				
+				edge0 = Simd::add(edge0, edgeStepX[0]);
+				edge1 = Simd::add(edge1, edgeStepX[1]);
+				edge2 = Simd::add(edge2, edgeStepX[2]);
+				depth = Simd::add(depth, depthStepX);
+			}
+			
+			for (unsigned int j = 0; j < 3; j++)
+				edgeRow[j] = Simd::add(edgeRow[j], Simd::set(b[j]));
+			depthRow = Simd::add(depthRow, Simd::set(depthY));
+		}
+	}
+	
+	// farthest depth of each block
+	unsigned int blockColumnCount = this->width / blockSize;
+	for (int blockY = tileY; blockY < tileY + (int)tileHeight; blockY += (int)blockSize)
+	{
+		for (int blockX = tileX; blockX < tileX + (int)tileWidth; blockX += (int)blockSize)
+		{
+			Float4 farthest = Simd::load(&this->depths[blockY * this->width + blockX]);
+			for (int y = blockY; y < blockY + (int)blockSize; y++)
+			{
+				for (int x = blockX; x < blockX + (int)blockSize; x += (int)laneCount)
+					farthest = Simd::min(farthest, Simd::load(&this->depths[y * this->width + x]));
+			}
+			
+			float lanes[laneCount];
+			Simd::store(lanes, farthest);
+			this->blockDepths[(blockY / blockSize) * blockColumnCount + blockX / blockSize] = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+		}
+	}
+}
+
+} // oak namespace
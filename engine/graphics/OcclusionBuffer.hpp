@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <engine/system/JobQueue.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class Camera;
+
+/**
+ * Software occlusion culling: the occluders of a world are rasterized on the
+ * CPU in a small depth buffer, then the bounding spheres of the renderables
+ * are tested against it before recording, without any GPU readback.
+ *
+ * Triangles are binned in screen tiles, each rasterized by a job with SIMD
+ * edge functions, four pixels at a time. Depths are stored as the inverse of
+ * the view depth, which is linear in screen space; a hierarchical level then
+ * keeps the farthest depth of each block of pixels, so that most tests only
+ * read a few values.
+ *
+ * Rasterization is conservative: only pixels fully covered by a triangle are
+ * written, with the farthest depth of the triangle over the pixel, so that
+ * renderables are never culled while partially visible.
+ */
+class OcclusionBuffer
+{
+	public:
+		OcclusionBuffer();
+		
+		// Rasterize the occluders as seen from a camera, for a target of the given aspect.
+		// The jobs are pushed in the batch, which must be done before testing.
+		void rasterize(const GraphicWorld::OccluderVector &occluders, const Camera *camera, unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch);
+		
+		// whether a world space sphere may be visible, false only if it is hidden
+		// behind the occluders; can be called concurrently
+		bool isVisible(const glm::vec3 &center, float radius) const;
+		
+		// triangles rasterized during the last update
+		unsigned int getTriangleCount() const { return (unsigned int)this->triangles.size(); }
+		
+		// changes when an update rasterizes other triangles than the previous one,
+		// so that what was culled against the buffer can be kept otherwise
+		unsigned int getVersion() const { return this->version; }
+	
+	private:
+		// screen space triangle, counter-clockwise, with inverse depths
+		struct Triangle
+		{
+			glm::vec2 positions[3];
+			float depths[3];
+		};
+		
+		void addTriangle(const glm::vec4 *clipPositions);
+		void addScreenTriangle(const glm::vec4 &position0, const glm::vec4 &position1, const glm::vec4 &position2);
+		
+		// rasterize the triangles binned in a tile, run on the job queue
+		struct TileJob
+		{
+			OcclusionBuffer *buffer;
+			unsigned int tile;
+		};
+		static void runTileJob(void *userData);
+		void rasterizeTile(unsigned int tile);
+		
+		// size of the last update
+		unsigned int width;
+		unsigned int height;
+		unsigned int tileColumnCount;
+		
+		std::vector<float> depths; // row-major, one per pixel
+		std::vector<float> blockDepths; // farthest depth of each block, row-major
+		
+		std::vector<Triangle> triangles;
+		std::vector<Triangle> previousTriangles;
+		unsigned int version;
+		std::vector<std::vector<unsigned int> > tileTriangles;
+		std::vector<TileJob> tileJobs;
+		
+		// camera of the last update
+		glm::mat4 viewMatrix;
+		glm::vec2 projectionScale;
+		float nearPlane;
+};
+
+} // oak namespace
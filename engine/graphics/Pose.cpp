@@ -0,0 +1,145 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/Pose.hpp>
+
+#include <engine/system/Log.hpp>
+#include <engine/system/Simd.hpp>
+
+#include <glm/ext.hpp>
+
+namespace oak {
+
+Pose::Pose()
+	: boneCount(0)
+	, paddedBoneCount(0)
+{
+}
+
+void Pose::resize(unsigned int boneCount)
+{
+	this->boneCount = boneCount;
+	this->paddedBoneCount = (boneCount + 3) & ~3u;
+	
+	this->values.assign(StreamCount * this->paddedBoneCount, 0.0f);
+	for (unsigned int i = 0; i < this->paddedBoneCount; i++)
+	{
+		this->getStream(RotationW)[i] = 1.0f;
+		this->getStream(ScaleX)[i] = 1.0f;
+		this->getStream(ScaleY)[i] = 1.0f;
+		this->getStream(ScaleZ)[i] = 1.0f;
+	}
+}
+
+void Pose::clear()
+{
+	this->values.assign(this->values.size(), 0.0f);
+}
+
+void Pose::accumulate(const Pose &pose, float weight)
+{
+	OAK_ASSERT(pose.paddedBoneCount == this->paddedBoneCount, "Blending poses of different skeletons");
+	
+	Float4 zero = Simd::set(0.0f);
+	Float4 weights = Simd::set(weight);
+	for (unsigned int i = 0; i < this->paddedBoneCount; i += 4)
+	{
+		// negate the added rotations that are more than half a turn away
+		Float4 dot = zero;
+		for (int j = RotationX; j <= RotationW; j++)
+			dot = Simd::add(dot, Simd::mul(Simd::load(this->getStream((Stream)j) + i), Simd::load(pose.getStream((Stream)j) + i)));
+		Float4 rotationWeights = Simd::select(Simd::less(dot, zero), Simd::sub(zero, weights), weights);
+		
+		for (int j = RotationX; j <= RotationW; j++)
+		{
+			float *values = this->getStream((Stream)j) + i;
+			Simd::store(values, Simd::add(Simd::load(values), Simd::mul(Simd::load(pose.getStream((Stream)j) + i), rotationWeights)));
+		}
+		
+		for (int j = TranslationX; j < StreamCount; j++)
+		{
+			float *values = this->getStream((Stream)j) + i;
+			Simd::store(values, Simd::add(Simd::load(values), Simd::mul(Simd::load(pose.getStream((Stream)j) + i), weights)));
+		}
+	}
+}
+
+void Pose::normalize(const Pose &restPose, float totalWeight)
+{
+	if (totalWeight < 1.0f)
+	{
+		this->accumulate(restPose, 1.0f - totalWeight);
+		totalWeight = 1.0f;
+	}
+	
+	Float4 scale = Simd::set(1.0f / totalWeight);
+	for (unsigned int i = 0; i < this->paddedBoneCount; i += 4)
+	{
+		Float4 x = Simd::load(this->getStream(RotationX) + i);
+		Float4 y = Simd::load(this->getStream(RotationY) + i);
+		Float4 z = Simd::load(this->getStream(RotationZ) + i);
+		Float4 w = Simd::load(this->getStream(RotationW) + i);
+		Float4 length = Simd::sqrt(Simd::add(Simd::add(Simd::mul(x, x), Simd::mul(y, y)), Simd::add(Simd::mul(z, z), Simd::mul(w, w))));
+		
+		// opposite rotations of equal weights cancel out, keep the identity then
+		Float4 valid = Simd::greaterEqual(length, Simd::set(1e-6f));
+		Float4 inverseLength = Simd::div(Simd::set(1.0f), Simd::max(length, Simd::set(1e-6f)));
+		Simd::store(this->getStream(RotationX) + i, Simd::select(valid, Simd::mul(x, inverseLength), Simd::set(0.0f)));
+		Simd::store(this->getStream(RotationY) + i, Simd::select(valid, Simd::mul(y, inverseLength), Simd::set(0.0f)));
+		Simd::store(this->getStream(RotationZ) + i, Simd::select(valid, Simd::mul(z, inverseLength), Simd::set(0.0f)));
+		Simd::store(this->getStream(RotationW) + i, Simd::select(valid, Simd::mul(w, inverseLength), Simd::set(1.0f)));
+		
+		for (int j = TranslationX; j < StreamCount; j++)
+		{
+			float *values = this->getStream((Stream)j) + i;
+			Simd::store(values, Simd::mul(Simd::load(values), scale));
+		}
+	}
+}
+
+void Pose::computeSkinningMatrices(const std::vector<int> &parents, const std::vector<glm::mat4> &inverseBindMatrices, glm::vec4 *rows)
+{
+	OAK_ASSERT(parents.size() == this->boneCount && inverseBindMatrices.size() == this->boneCount, "Skinning a pose with another skeleton");
+	
+	this->modelMatrices.resize(this->boneCount);
+	for (unsigned int i = 0; i < this->boneCount; i++)
+	{
+		glm::quat rotation(this->getStream(RotationW)[i], this->getStream(RotationX)[i], this->getStream(RotationY)[i], this->getStream(RotationZ)[i]);
+		glm::mat4 local = glm::mat4_cast(rotation);
+		local[0] *= this->getStream(ScaleX)[i];
+		local[1] *= this->getStream(ScaleY)[i];
+		local[2] *= this->getStream(ScaleZ)[i];
+		local[3] = glm::vec4(this->getStream(TranslationX)[i], this->getStream(TranslationY)[i], this->getStream(TranslationZ)[i], 1.0f);
+		
+		int parent = parents[i];
+		this->modelMatrices[i] = (parent < 0) ? local : this->modelMatrices[parent] * local;
+		
+		glm::mat4 skinning = this->modelMatrices[i] * inverseBindMatrices[i];
+		for (int j = 0; j < 3; j++)
+			rows[i * 3 + j] = glm::vec4(skinning[0][j], skinning[1][j], skinning[2][j], skinning[3][j]);
+	}
+}
+
+} // oak namespace
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+/**
+ * Local transforms of the bones of a skeleton, relative to their parents.
+ *
+ * Transforms are kept as one array of floats per component (rotation
+ * quaternion x, y, z and w, translation x, y, z, scale x, y, z), padded to
+ * a multiple of 4 bones with the identity, so that poses are sampled and
+ * blended four bones at a time with SIMD operations.
+ */
+class Pose
+{
+	public:
+		enum Stream
+		{
+			RotationX,
+			RotationY,
+			RotationZ,
+			RotationW,
+			TranslationX,
+			TranslationY,
+			TranslationZ,
+			ScaleX,
+			ScaleY,
+			ScaleZ,
+			StreamCount
+		};
+		
+		Pose();
+		
+		// all bones back to the identity
+		void resize(unsigned int boneCount);
+		
+		unsigned int getBoneCount() const { return this->boneCount; }
+		unsigned int getPaddedBoneCount() const { return this->paddedBoneCount; }
+		
+		float *getStream(Stream stream) { return &this->values[stream * this->paddedBoneCount]; }
+		const float *getStream(Stream stream) const { return &this->values[stream * this->paddedBoneCount]; }
+		
+		// set all transforms to zero, to accumulate weighted poses
+		void clear();
+		
+		// Add a pose of the same skeleton times the given weight. Rotations are
+		// flipped to the hemisphere of the accumulated ones, so that they blend
+		// along the shortest path.
+		void accumulate(const Pose &pose, float weight);
+		
+		// Turn the accumulated poses back into transforms: the missing weight, below
+		// one, goes to the given rest pose, then rotations are normalized (nlerp).
+		void normalize(const Pose &restPose, float totalWeight);
+		
+		// Walk the hierarchy (parents before their children, -1 for the roots) to
+		// get the transform of each bone in the space of the mesh, times its inverse
+		// bind matrix; the first three rows of each are written, as shader constants.
+		void computeSkinningMatrices(const std::vector<int> &parents, const std::vector<glm::mat4> &inverseBindMatrices, glm::vec4 *rows);
+	
+	private:
+		unsigned int boneCount;
+		unsigned int paddedBoneCount;
+		std::vector<float> values;
+		
+		// transforms in the space of the mesh, kept to avoid reallocations
+		std::vector<glm::mat4> modelMatrices;
+};
+
+} // oak namespace
@@ -0,0 +1,188 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/PostProcess.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/graphics/shaders/post.vs.h>
+#include <engine/graphics/shaders/bloom.fs.h>
+#include <engine/graphics/shaders/composite.fs.h>
+#include <engine/graphics/shaders/fxaa.fs.h>
+
+#include <engine/system/Log.hpp>
+
+#include <string>
+
+namespace oak {
+
+namespace { // private section
+
+// fog of the materials before the chain
+const float defaultFogDensity = 0.02f;
+const glm::vec3 defaultFogColor(0.6f, 0.8f, 0.9f);
+
+// shader constants describing a source, for the pass reading it (NULL when unused)
+struct SourceNames
+{
+	const char *texture;
+	const char *uvScale;
+	const char *uvMax;
+	const char *texelSize;
+};
+const SourceNames sourceNames = { "sourceTexture", "sourceUvScale", "sourceUvMax", "sourceTexelSize" };
+const SourceNames sceneNames = { "sceneTexture", "sceneUvScale", "sceneUvMax", NULL };
+const SourceNames bloomNames = { "bloomTexture", "bloomUvScale", "bloomUvMax", NULL };
+
+void bindSource(CommandList *commandList, const SourceNames &names, unsigned int unit, const PostProcess::Source &source)
+{
+	// filtering must not read past the center of the last texel drawn into
+	commandList->bindTexture(source.texture, unit);
+	commandList->setShaderConstant(names.texture, (int)unit);
+	commandList->setShaderConstant(names.uvScale, source.regionSize / source.textureSize);
+	commandList->setShaderConstant(names.uvMax, (source.regionSize - 0.5f) / source.textureSize);
+	if (names.texelSize)
+		commandList->setShaderConstant(names.texelSize, 1.0f / source.textureSize);
+}
+
+} // end of private section
+
+PostProcess::PostProcess(GraphicDriver *driver)
+	: driver(driver)
+	, fogDensity(defaultFogDensity)
+	, fogColor(defaultFogColor)
+	, toneMapping(false)
+	, exposure(1.0f)
+	, gamma(1.0f)
+	, bloomThreshold(0.8f)
+	, bloomIntensity(0.0f)
+	, antialiasing(false)
+{
+	// variants of the same shaders, selected by definitions
+	this->extractShader = this->driver->createShaderProgram(postVSString, std::string("#define DOWNSAMPLE\n") + bloomFSString);
+	this->blurShader = this->driver->createShaderProgram(postVSString, bloomFSString);
+	this->compositeShader = this->driver->createShaderProgram(postVSString, compositeFSString);
+	this->bloomCompositeShader = this->driver->createShaderProgram(postVSString, std::string("#define BLOOM\n") + compositeFSString);
+	this->antialiasingShader = this->driver->createShaderProgram(postVSString, fxaaFSString);
+	
+	GraphicDriver::Simple2DVertex quadVertices[] = {
+		{ glm::vec2(-1.0f, -1.0f) },
+		{ glm::vec2(1.0f, -1.0f) },
+		{ glm::vec2(-1.0f, 1.0f) },
+		{ glm::vec2(1.0f, 1.0f) }
+	};
+	this->quad = this->driver->createVertexBuffer(quadVertices, 4);
+}
+
+PostProcess::~PostProcess()
+{
+	this->driver->destroyShaderProgram(this->extractShader);
+	this->driver->destroyShaderProgram(this->blurShader);
+	this->driver->destroyShaderProgram(this->compositeShader);
+	this->driver->destroyShaderProgram(this->bloomCompositeShader);
+	this->driver->destroyShaderProgram(this->antialiasingShader);
+	this->driver->destroyVertexBuffer(this->quad);
+}
+
+void PostProcess::setFogDensity(float fogDensity)
+{
+	OAK_ASSERT(fogDensity >= 0.0f, "The fog density cannot be negative");
+	this->fogDensity = fogDensity;
+}
+
+void PostProcess::setExposure(float exposure)
+{
+	OAK_ASSERT(exposure > 0.0f, "The exposure must be positive");
+	this->exposure = exposure;
+}
+
+void PostProcess::setGamma(float gamma)
+{
+	OAK_ASSERT(gamma > 0.0f, "The gamma must be positive");
+	this->gamma = gamma;
+}
+
+void PostProcess::setBloomIntensity(float bloomIntensity)
+{
+	OAK_ASSERT(bloomIntensity >= 0.0f, "The bloom intensity cannot be negative");
+	this->bloomIntensity = bloomIntensity;
+}
+
+bool PostProcess::isEnabled() const
+{
+	return this->fogDensity > 0.0f || this->toneMapping || this->exposure != 1.0f || this->gamma != 1.0f || this->hasBloom() || this->antialiasing;
+}
+
+void PostProcess::recordBloomExtract(CommandList *commandList, const Source &scene) const
+{
+	commandList->bindShaderProgram(this->extractShader);
+	bindSource(commandList, sourceNames, 0, scene);
+	commandList->setShaderConstant("fogColor", this->fogColor);
+	commandList->setShaderConstant("bloomThreshold", this->bloomThreshold);
+	commandList->bindVertexBuffer(this->quad);
+	commandList->draw(GraphicDriver::TriangleStrip, 0, 4);
+}
+
+void PostProcess::recordBloomBlur(CommandList *commandList, const Source &source, bool vertical) const
+{
+	// taps a quarter resolution texel apart, the horizontal pass reads the half resolution
+	glm::vec2 texelSize = 1.0f / source.textureSize;
+	glm::vec2 step = vertical ? glm::vec2(0.0f, texelSize.y) : glm::vec2(texelSize.x * 2.0f, 0.0f);
+	
+	commandList->bindShaderProgram(this->blurShader);
+	bindSource(commandList, sourceNames, 0, source);
+	commandList->setShaderConstant("blurStep", step);
+	commandList->bindVertexBuffer(this->quad);
+	commandList->draw(GraphicDriver::TriangleStrip, 0, 4);
+}
+
+void PostProcess::recordComposite(CommandList *commandList, const Source &scene, const Source *bloom) const
+{
+	commandList->bindShaderProgram(bloom ? this->bloomCompositeShader : this->compositeShader);
+	bindSource(commandList, sceneNames, 0, scene);
+	if (bloom)
+	{
+		bindSource(commandList, bloomNames, 1, *bloom);
+		commandList->setShaderConstant("bloomIntensity", this->bloomIntensity);
+	}
+	
+	commandList->setShaderConstant("fogColor", this->fogColor);
+	commandList->setShaderConstant("exposure", this->exposure);
+	commandList->setShaderConstant("toneMapping", this->toneMapping ? 1.0f : 0.0f);
+	commandList->setShaderConstant("inverseGamma", 1.0f / this->gamma);
+	commandList->bindVertexBuffer(this->quad);
+	commandList->draw(GraphicDriver::TriangleStrip, 0, 4);
+}
+
+void PostProcess::recordAntialiasing(CommandList *commandList, const Source &source) const
+{
+	commandList->bindShaderProgram(this->antialiasingShader);
+	bindSource(commandList, sourceNames, 0, source);
+	commandList->bindVertexBuffer(this->quad);
+	commandList->draw(GraphicDriver::TriangleStrip, 0, 4);
+}
+
+} // oak namespace
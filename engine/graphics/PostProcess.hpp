@@ -0,0 +1,124 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+class CommandList;
+class GraphicDriver;
+struct ShaderProgram;
+struct Texture;
+struct VertexBuffer;
+
+/**
+ * Screen-space effects applied to the scene once it is drawn, so that they are
+ * paid once per pixel instead of once per shaded fragment.
+ *
+ * Materials only write the visibility through the fog in the alpha of the scene
+ * (blended draws keep it). A single composite pass then adds the fog and the
+ * bloom, maps the tones, corrects the gamma and upscales the scene to the screen;
+ * antialiasing (FXAA) runs last, over the screen colors. The bloom is extracted
+ * at half resolution and blurred at quarter resolution, from the same target
+ * sizes whatever the scene scale, so that they are kept in the render graph pool.
+ *
+ * Effects are disabled by neutral settings; the scene skips the chain when all
+ * of them are. Views drawn into their own targets are not post-processed.
+ */
+class PostProcess
+{
+	public:
+		PostProcess(GraphicDriver *driver);
+		~PostProcess();
+		
+		// per unit of view depth, 0 for no fog
+		float getFogDensity() const { return this->fogDensity; }
+		void setFogDensity(float fogDensity);
+		const glm::vec3 &getFogColor() const { return this->fogColor; }
+		void setFogColor(const glm::vec3 &fogColor) { this->fogColor = fogColor; }
+		
+		// colors are scaled by the exposure, then mapped exponentially below 1 if enabled
+		bool isToneMapping() const { return this->toneMapping; }
+		void setToneMapping(bool toneMapping) { this->toneMapping = toneMapping; }
+		float getExposure() const { return this->exposure; }
+		void setExposure(float exposure);
+		
+		// of the screen, 1 to write the colors as they are
+		float getGamma() const { return this->gamma; }
+		void setGamma(float gamma);
+		
+		// brightness above which colors bloom, and weight of the bloom (0 for none)
+		float getBloomThreshold() const { return this->bloomThreshold; }
+		void setBloomThreshold(float bloomThreshold) { this->bloomThreshold = bloomThreshold; }
+		float getBloomIntensity() const { return this->bloomIntensity; }
+		void setBloomIntensity(float bloomIntensity);
+		
+		bool isAntialiasing() const { return this->antialiasing; }
+		void setAntialiasing(bool antialiasing) { this->antialiasing = antialiasing; }
+		
+		// whether some effect is enabled, and the scene needs the chain
+		bool isEnabled() const;
+		bool hasBloom() const { return this->bloomIntensity > 0.0f; }
+		
+		// texture read by a pass: the part drawn into, from the origin, and the whole size, in texels
+		struct Source
+		{
+			Texture *texture;
+			glm::vec2 regionSize;
+			glm::vec2 textureSize;
+		};
+		
+		// Record a pass of the chain, drawn over the viewport of the bound target:
+		// the bright parts of the scene at half resolution, then their blur along
+		// each axis (the horizontal one down to quarter resolution), the
+		// composite with the bloom source if any, and the antialiasing.
+		void recordBloomExtract(CommandList *commandList, const Source &scene) const;
+		void recordBloomBlur(CommandList *commandList, const Source &source, bool vertical) const;
+		void recordComposite(CommandList *commandList, const Source &scene, const Source *bloom) const;
+		void recordAntialiasing(CommandList *commandList, const Source &source) const;
+	
+	private:
+		GraphicDriver *driver;
+		
+		float fogDensity;
+		glm::vec3 fogColor;
+		bool toneMapping;
+		float exposure;
+		float gamma;
+		float bloomThreshold;
+		float bloomIntensity;
+		bool antialiasing;
+		
+		ShaderProgram *extractShader;
+		ShaderProgram *blurShader;
+		ShaderProgram *compositeShader;
+		ShaderProgram *bloomCompositeShader;
+		ShaderProgram *antialiasingShader;
+		VertexBuffer *quad;
+};
+
+} // oak namespace
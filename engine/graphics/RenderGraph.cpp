@@ -0,0 +1,277 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/RenderGraph.hpp>
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace oak {
+
+RenderGraph::RenderGraph(GraphicDriver *driver)
+	: driver(driver)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	for (unsigned int i = 0; i < this->pool.size(); i++)
+		this->driver->destroyRenderTarget(this->pool[i].target);
+}
+
+void RenderGraph::reset()
+{
+	// the pool is kept, most frames need the same targets
+	this->resources.clear();
+	this->passes.clear();
+	this->executedPasses.clear();
+}
+
+RenderGraph::Resource RenderGraph::importTarget(RenderTarget *target, bool output)
+{
+	ResourceEntry resource;
+	resource.target = target;
+	resource.transient = false;
+	resource.output = output;
+	resource.width = 0;
+	resource.height = 0;
+	resource.firstUse = -1;
+	resource.lastUse = -1;
+	resource.firstWriter = -1;
+	
+	this->resources.push_back(resource);
+	return (Resource)(this->resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::createTarget(unsigned int width, unsigned int height)
+{
+	OAK_ASSERT(width > 0 && height > 0, "Transient render targets cannot be empty");
+	
+	Resource resource = this->importTarget(NULL, false);
+	this->resources[resource].transient = true;
+	this->resources[resource].width = width;
+	this->resources[resource].height = height;
+	
+	return resource;
+}
+
+RenderGraph::Pass RenderGraph::addPass(void *userData)
+{
+	PassEntry pass;
+	pass.userData = userData;
+	pass.executed = false;
+	
+	this->passes.push_back(pass);
+	return (Pass)(this->passes.size() - 1);
+}
+
+void RenderGraph::addRead(Pass pass, Resource resource)
+{
+	OAK_ASSERT(std::find(this->passes[pass].writes.begin(), this->passes[pass].writes.end(), resource) == this->passes[pass].writes.end(), "A pass cannot read the target it writes");
+	
+	this->passes[pass].reads.push_back(resource);
+	this->resources[resource].readers.push_back(pass);
+}
+
+void RenderGraph::addWrite(Pass pass, Resource resource)
+{
+	OAK_ASSERT(std::find(this->passes[pass].reads.begin(), this->passes[pass].reads.end(), resource) == this->passes[pass].reads.end(), "A pass cannot read the target it writes");
+	
+	this->passes[pass].writes.push_back(resource);
+	this->resources[resource].writers.push_back(pass);
+}
+
+void RenderGraph::compile()
+{
+	this->sortPasses();
+	this->cullPasses();
+	this->allocateTargets();
+	
+	this->statistics.passCount = (unsigned int)this->passes.size();
+	this->statistics.culledPassCount = (unsigned int)(this->passes.size() - this->executedPasses.size());
+}
+
+void RenderGraph::sortPasses()
+{
+	// writers of a target run in declaration order, then its readers
+	std::vector<std::vector<Pass> > successors(this->passes.size());
+	std::vector<unsigned int> predecessorCounts(this->passes.size(), 0);
+	for (unsigned int i = 0; i < this->resources.size(); i++)
+	{
+		const ResourceEntry &resource = this->resources[i];
+		for (unsigned int j = 0; j < resource.writers.size(); j++)
+		{
+			if (j + 1 < resource.writers.size())
+			{
+				successors[resource.writers[j]].push_back(resource.writers[j + 1]);
+				predecessorCounts[resource.writers[j + 1]]++;
+			}
+			
+			for (unsigned int k = 0; k < resource.readers.size(); k++)
+			{
+				successors[resource.writers[j]].push_back(resource.readers[k]);
+				predecessorCounts[resource.readers[k]]++;
+			}
+		}
+	}
+	
+	// passes that are ready run in declaration order
+	std::priority_queue<Pass, std::vector<Pass>, std::greater<Pass> > readyPasses;
+	for (unsigned int i = 0; i < this->passes.size(); i++)
+	{
+		if (predecessorCounts[i] == 0)
+			readyPasses.push((Pass)i);
+	}
+	
+	while (!readyPasses.empty())
+	{
+		Pass pass = readyPasses.top();
+		readyPasses.pop();
+		this->executedPasses.push_back(pass);
+		
+		for (unsigned int i = 0; i < successors[pass].size(); i++)
+		{
+			if (--predecessorCounts[successors[pass][i]] == 0)
+				readyPasses.push(successors[pass][i]);
+		}
+	}
+	
+	OAK_ASSERT(this->executedPasses.size() == this->passes.size(), "Render passes depend on each other in a cycle");
+}
+
+void RenderGraph::cullPasses()
+{
+	// from the last pass, which only runs if it writes to an output, or to a
+	// target read by a pass that runs; readers always come after the writers
+	std::vector<bool> neededResources(this->resources.size());
+	for (unsigned int i = 0; i < this->resources.size(); i++)
+		neededResources[i] = this->resources[i].output;
+	
+	for (unsigned int i = (unsigned int)this->executedPasses.size(); i-- > 0; )
+	{
+		PassEntry &pass = this->passes[this->executedPasses[i]];
+		for (unsigned int j = 0; j < pass.writes.size() && !pass.executed; j++)
+			pass.executed = neededResources[pass.writes[j]];
+		
+		for (unsigned int j = 0; j < pass.reads.size() && pass.executed; j++)
+			neededResources[pass.reads[j]] = true;
+	}
+	
+	unsigned int executedCount = 0;
+	for (unsigned int i = 0; i < this->executedPasses.size(); i++)
+	{
+		if (this->passes[this->executedPasses[i]].executed)
+			this->executedPasses[executedCount++] = this->executedPasses[i];
+	}
+	this->executedPasses.resize(executedCount);
+}
+
+void RenderGraph::allocateTargets()
+{
+	// lifetimes, and transient targets in the order they are needed
+	std::vector<Resource> transientResources;
+	for (unsigned int i = 0; i < this->executedPasses.size(); i++)
+	{
+		Pass passIndex = this->executedPasses[i];
+		const PassEntry &pass = this->passes[passIndex];
+		for (unsigned int j = 0; j < pass.reads.size() + pass.writes.size(); j++)
+		{
+			bool write = (j >= pass.reads.size());
+			Resource resourceIndex = write ? pass.writes[j - pass.reads.size()] : pass.reads[j];
+			ResourceEntry &resource = this->resources[resourceIndex];
+			
+			if (resource.firstUse < 0 && resource.transient)
+				transientResources.push_back(resourceIndex);
+			if (resource.firstUse < 0)
+				resource.firstUse = (int)i;
+			resource.lastUse = (int)i;
+			
+			if (write && resource.firstWriter < 0)
+				resource.firstWriter = (int)passIndex;
+		}
+	}
+	
+	for (unsigned int i = 0; i < this->pool.size(); i++)
+	{
+		this->pool[i].busyUntil = -1;
+		this->pool[i].used = false;
+	}
+	
+	// reuse the first free target of the same size, or make a new one
+	for (unsigned int i = 0; i < transientResources.size(); i++)
+	{
+		ResourceEntry &resource = this->resources[transientResources[i]];
+		
+		unsigned int index = 0;
+		while (index < this->pool.size())
+		{
+			const PooledTarget &pooled = this->pool[index];
+			if (pooled.width == resource.width && pooled.height == resource.height && pooled.busyUntil < resource.firstUse)
+				break;
+			
+			index++;
+		}
+		
+		if (index == this->pool.size())
+		{
+			PooledTarget pooled;
+			pooled.target = this->driver->createRenderTarget(resource.width, resource.height);
+			pooled.width = resource.width;
+			pooled.height = resource.height;
+			
+			// clamped, so that filtering does not wrap around, and GLES2 can sample any size
+			this->driver->setTextureSampling(this->driver->getRenderTargetTexture(pooled.target), true, false);
+			
+			this->pool.push_back(pooled);
+			this->statistics.createdTargetCount++;
+		}
+		
+		PooledTarget &pooled = this->pool[index];
+		pooled.busyUntil = resource.lastUse;
+		pooled.used = true;
+		resource.target = pooled.target;
+	}
+	
+	// targets unused this frame are released, destructions run after the frames still using them
+	unsigned int usedCount = 0;
+	for (unsigned int i = 0; i < this->pool.size(); i++)
+	{
+		if (this->pool[i].used)
+			this->pool[usedCount++] = this->pool[i];
+		else
+			this->driver->destroyRenderTarget(this->pool[i].target);
+	}
+	this->pool.resize(usedCount);
+	
+	this->statistics.transientTargetCount = (unsigned int)transientResources.size();
+	this->statistics.allocatedTargetCount = usedCount;
+}
+
+} // oak namespace
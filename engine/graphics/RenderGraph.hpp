@@ -0,0 +1,159 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+namespace oak {
+
+class GraphicDriver;
+struct RenderTarget;
+
+/**
+ * Passes of a frame, with the render targets they read and write.
+ *
+ * The graph is declared again every frame, then compiled: passes are ordered
+ * so that the writers of a target run before its readers (writers of a same
+ * target keep their declaration order), and passes whose results never reach
+ * an output target are culled. Transient targets only live during the frame,
+ * between their first and last use: they are allocated from a pool kept from
+ * one frame to the next, and targets of the same size whose lifetimes do not
+ * overlap share the same memory.
+ *
+ * The graph only orders and allocates; passes are then recorded by the caller,
+ * which clears a target when it is first written (see isFirstWrite).
+ */
+class RenderGraph
+{
+	public:
+		typedef unsigned int Resource;
+		typedef unsigned int Pass;
+		
+		RenderGraph(GraphicDriver *driver);
+		~RenderGraph();
+		
+		// forget the passes and targets declared for the previous frame
+		void reset();
+		
+		// Target managed elsewhere, given back as is by getTarget (NULL for the screen,
+		// or for targets only known by their passes). Passes writing to outputs are
+		// never culled.
+		Resource importTarget(RenderTarget *target, bool output);
+		
+		// target allocated by the graph for this frame, its content is undefined until written
+		Resource createTarget(unsigned int width, unsigned int height);
+		
+		// the user data identifies the pass for the caller
+		Pass addPass(void *userData);
+		void addRead(Pass pass, Resource resource);
+		void addWrite(Pass pass, Resource resource);
+		
+		// order the passes, cull the unused ones and allocate the transient targets
+		void compile();
+		
+		// passes left after culling, in execution order
+		unsigned int getExecutedPassCount() const { return (unsigned int)this->executedPasses.size(); }
+		Pass getExecutedPass(unsigned int index) const { return this->executedPasses[index]; }
+		void *getUserData(Pass pass) const { return this->passes[pass].userData; }
+		
+		RenderTarget *getTarget(Resource resource) const { return this->resources[resource].target; }
+		
+		// whether no executed pass wrote the target before this one
+		bool isFirstWrite(Pass pass, Resource resource) const { return this->resources[resource].firstWriter == (int)pass; }
+		
+		struct Statistics
+		{
+			// last frame
+			unsigned int passCount;
+			unsigned int culledPassCount;
+			unsigned int transientTargetCount; // used by the executed passes
+			unsigned int allocatedTargetCount; // in the pool, shared by the transient targets
+			
+			// accumulated since the graph creation
+			unsigned int createdTargetCount;
+			
+			Statistics()
+				: passCount(0)
+				, culledPassCount(0)
+				, transientTargetCount(0)
+				, allocatedTargetCount(0)
+				, createdTargetCount(0)
+			{}
+		};
+		const Statistics &getStatistics() const { return this->statistics; }
+	
+	private:
+		struct ResourceEntry
+		{
+			RenderTarget *target;
+			bool transient;
+			bool output;
+			unsigned int width;
+			unsigned int height;
+			
+			// filled by compile: passes using the target, in execution order (-1 if none)
+			int firstUse;
+			int lastUse;
+			int firstWriter;
+			
+			std::vector<Pass> writers; // in declaration order
+			std::vector<Pass> readers;
+		};
+		
+		struct PassEntry
+		{
+			void *userData;
+			std::vector<Resource> reads;
+			std::vector<Resource> writes;
+			bool executed;
+		};
+		
+		// transient render target, busy until the last use of the resource using it
+		struct PooledTarget
+		{
+			RenderTarget *target;
+			unsigned int width;
+			unsigned int height;
+			int busyUntil;
+			bool used;
+		};
+		
+		void sortPasses();
+		void cullPasses();
+		void allocateTargets();
+		
+		GraphicDriver *driver;
+		
+		std::vector<ResourceEntry> resources;
+		std::vector<PassEntry> passes;
+		std::vector<Pass> executedPasses;
+		
+		std::vector<PooledTarget> pool;
+		
+		Statistics statistics;
+};
+
+} // oak namespace
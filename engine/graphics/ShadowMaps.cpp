@@ -0,0 +1,282 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/ShadowMaps.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/Light.hpp>
+
+#include <engine/graphics/shaders/shadow.vs.h>
+#include <engine/graphics/shaders/shadow.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <glm/ext.hpp>
+
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// Cascades are square tiles of the atlases, in rows of two from the bottom
+// left one; the shaders using them are written for this count.
+const unsigned int cascadeCount = 4;
+const unsigned int cascadeResolution = 512;
+const unsigned int atlasResolution = cascadeResolution * 2;
+
+// shadows are only drawn up to this depth
+const float shadowDistance = 80.0f;
+
+// blend between uniform (0) and logarithmic (1) depth splits
+const float splitBlend = 0.75f;
+
+// Cascade regions are snapped to a grid of this fraction of their radius,
+// and enlarged by a grid step so that they still cover their slice.
+const float regionGridFraction = 0.25f;
+
+// casters are drawn up to this distance before the region, towards the light
+const float casterDistance = 100.0f;
+
+const char *cascadeConstantNames[cascadeCount] = { "shadowCascade0", "shadowCascade1", "shadowCascade2", "shadowCascade3" };
+
+glm::vec2 getTileOrigin(unsigned int cascade)
+{
+	return glm::vec2((float)(cascade % 2), (float)(cascade / 2)) * 0.5f;
+}
+
+} // end of private section
+
+ShadowMaps::ShadowMaps(GraphicDriver *driver)
+	: driver(driver)
+	, depthShader(NULL)
+	, staticAtlas(NULL)
+	, dynamicAtlas(NULL)
+	, cascades(cascadeCount)
+	, hasLight(false)
+	, castsShadows(false)
+	, lightDirection(0.0f, 0.0f, 1.0f)
+	, lightColor(0.0f)
+	, lightRotation(1.0f)
+	, staticVersion(0)
+{
+	for (unsigned int i = 0; i < cascadeCount; i++)
+	{
+		Cascade &cascade = this->cascades[i];
+		cascade.regionCell = glm::ivec3(0);
+		cascade.regionRadius = 0.0f;
+		cascade.atlasTransform = glm::vec4(0.0f);
+		cascade.depthScale = 0.0f;
+		cascade.farDepth = 0.0f;
+		cascade.texelSize = 0.0f;
+		cascade.staticValid = false;
+		cascade.dynamicEmpty = false; // the atlas content is undefined at first
+	}
+}
+
+ShadowMaps::~ShadowMaps()
+{
+	if (this->depthShader)
+	{
+		this->driver->destroyShaderProgram(this->depthShader);
+		this->driver->destroyRenderTarget(this->staticAtlas);
+		this->driver->destroyRenderTarget(this->dynamicAtlas);
+	}
+}
+
+void ShadowMaps::update(const GraphicWorld *graphicWorld, const Camera *camera)
+{
+	this->updatedMaps.clear();
+	
+	// the first directional light of the world
+	const GraphicWorld::LightVector &lights = graphicWorld->getLights();
+	const Light *light = NULL;
+	for (unsigned int i = 0; i < lights.size() && !light; i++)
+	{
+		if (lights[i]->isDirectional())
+			light = lights[i];
+	}
+	
+	this->hasLight = (light != NULL);
+	if (!light)
+		return;
+	
+	glm::vec3 previousDirection = this->lightDirection;
+	this->lightDirection = glm::normalize(glm::vec3(light->getEntity()->getLocalTransform()[2]));
+	this->lightColor = light->getColor() * light->getIntensity();
+	this->castsShadows = light->isCastingShadows();
+	if (!this->castsShadows)
+		return;
+	
+	if (!this->depthShader)
+		this->createAtlases();
+	
+	// light space, looking along -Z
+	glm::vec3 lightX = glm::cross(glm::abs(this->lightDirection.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), this->lightDirection);
+	lightX = glm::normalize(lightX);
+	glm::vec3 lightY = glm::cross(this->lightDirection, lightX);
+	this->lightRotation = glm::transpose(glm::mat3(lightX, lightY, this->lightDirection));
+	
+	// everything cached is invalid once the light or the static geometry changes
+	bool lightChanged = (this->lightDirection != previousDirection);
+	bool staticChanged = (graphicWorld->getStaticVersion() != this->staticVersion);
+	this->staticVersion = graphicWorld->getStaticVersion();
+	
+	// depth splits of the camera, and the squared slope of its frustum corners
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::vec3 cameraPosition = glm::vec3(cameraTransform[3]);
+	glm::vec3 cameraForward = -glm::normalize(glm::vec3(cameraTransform[2]));
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	float cornerSlope = 1.0f / (projectionMatrix[0][0] * projectionMatrix[0][0]) + 1.0f / (projectionMatrix[1][1] * projectionMatrix[1][1]);
+	float nearPlane = camera->getNearPlane();
+	float farPlane = glm::min(camera->getFarPlane(), shadowDistance);
+	
+	float sliceNear = nearPlane;
+	for (unsigned int i = 0; i < cascadeCount; i++)
+	{
+		Cascade &cascade = this->cascades[i];
+		
+		float ratio = (float)(i + 1) / (float)cascadeCount;
+		float sliceFar = splitBlend * nearPlane * std::pow(farPlane / nearPlane, ratio) + (1.0f - splitBlend) * (nearPlane + (farPlane - nearPlane) * ratio);
+		
+		// smallest sphere around the slice, its center being on the view axis
+		float centerDepth = glm::min((sliceNear + sliceFar) * (1.0f + cornerSlope) * 0.5f, sliceFar);
+		float nearDistance = (centerDepth - sliceNear) * (centerDepth - sliceNear) + sliceNear * sliceNear * cornerSlope;
+		float farDistance = (sliceFar - centerDepth) * (sliceFar - centerDepth) + sliceFar * sliceFar * cornerSlope;
+		float radius = std::sqrt(glm::max(nearDistance, farDistance));
+		
+		// snapped region
+		float gridStep = radius * regionGridFraction;
+		float regionRadius = radius + gridStep;
+		glm::vec3 center = this->lightRotation * (cameraPosition + cameraForward * centerDepth);
+		glm::ivec3 regionCell = glm::ivec3(glm::floor(center / gridStep + 0.5f));
+		glm::vec3 regionCenter = glm::vec3(regionCell) * gridStep;
+		
+		if (lightChanged || staticChanged || regionCell != cascade.regionCell || regionRadius != cascade.regionRadius)
+			cascade.staticValid = false;
+		
+		cascade.regionCell = regionCell;
+		cascade.regionRadius = regionRadius;
+		cascade.farDepth = sliceFar;
+		cascade.texelSize = regionRadius * 2.0f / (float)cascadeResolution;
+		
+		// from light space to the tile
+		glm::mat4 projection = glm::ortho(-regionRadius, regionRadius, -regionRadius, regionRadius, -(regionRadius + casterDistance), regionRadius);
+		cascade.viewProjectionMatrix = projection * glm::translate(glm::mat4(1.0f), -regionCenter) * glm::mat4(this->lightRotation);
+		
+		// same mapping to atlas coordinates, and to [0, 1] depths
+		float scale = 0.25f / regionRadius;
+		float depthRange = regionRadius * 2.0f + casterDistance;
+		glm::vec2 offset = getTileOrigin(i) + 0.25f - glm::vec2(regionCenter) * scale;
+		cascade.atlasTransform = glm::vec4(offset, (regionCenter.z + regionRadius + casterDistance) / depthRange, scale);
+		cascade.depthScale = -1.0f / depthRange;
+		
+		// maps to redraw
+		if (!cascade.staticValid)
+		{
+			this->updatedMaps.push_back(i * 2);
+			cascade.staticValid = true;
+		}
+		
+		bool dynamicEmpty = !graphicWorld->hasDynamicShadowCasters(cascade.viewProjectionMatrix);
+		if (!dynamicEmpty || !cascade.dynamicEmpty)
+			this->updatedMaps.push_back(i * 2 + 1);
+		cascade.dynamicEmpty = dynamicEmpty;
+		
+		sliceNear = sliceFar;
+	}
+}
+
+void ShadowMaps::recordMap(CommandList *commandList, const GraphicWorld *graphicWorld, unsigned int updatedMap) const
+{
+	unsigned int map = this->updatedMaps[updatedMap];
+	unsigned int cascadeIndex = map / 2;
+	bool dynamicMap = (map % 2) == 1;
+	const Cascade &cascade = this->cascades[cascadeIndex];
+	
+	// white stands for the farthest depth
+	commandList->bindRenderTarget(dynamicMap ? this->dynamicAtlas : this->staticAtlas);
+	glm::vec2 origin = getTileOrigin(cascadeIndex) * (float)atlasResolution;
+	commandList->setViewport((unsigned int)origin.x, (unsigned int)origin.y, cascadeResolution, cascadeResolution);
+	commandList->clearBuffers(glm::vec3(1.0f), true, true);
+	
+	graphicWorld->recordShadowCasters(commandList, cascade.viewProjectionMatrix, !dynamicMap, this->depthShader);
+	
+	commandList->bindRenderTarget(NULL);
+}
+
+void ShadowMaps::record(CommandList *commandList) const
+{
+	if (!this->hasLight)
+	{
+		commandList->setShaderConstant("sunColor", glm::vec3(0.0f));
+		commandList->setShaderConstant("shadowsEnabled", 0.0f);
+		return;
+	}
+	
+	commandList->setShaderConstant("sunDirection", this->lightDirection);
+	commandList->setShaderConstant("sunColor", this->lightColor);
+	commandList->setShaderConstant("shadowsEnabled", this->castsShadows ? 1.0f : 0.0f);
+	if (!this->castsShadows)
+		return;
+	
+	commandList->bindTexture(this->driver->getRenderTargetTexture(this->staticAtlas), 4);
+	commandList->bindTexture(this->driver->getRenderTargetTexture(this->dynamicAtlas), 5);
+	commandList->setShaderConstant("staticShadows", 4);
+	commandList->setShaderConstant("dynamicShadows", 5);
+	commandList->setShaderConstant("shadowAtlasTexel", 1.0f / (float)atlasResolution);
+	
+	commandList->setShaderConstant("lightRotation", this->lightRotation);
+	glm::vec4 splits;
+	glm::vec4 depthScales;
+	glm::vec4 texelSizes;
+	for (unsigned int i = 0; i < cascadeCount; i++)
+	{
+		const Cascade &cascade = this->cascades[i];
+		commandList->setShaderConstant(cascadeConstantNames[i], cascade.atlasTransform);
+		splits[i] = cascade.farDepth;
+		depthScales[i] = cascade.depthScale;
+		texelSizes[i] = cascade.texelSize;
+	}
+	commandList->setShaderConstant("shadowSplits", splits);
+	commandList->setShaderConstant("shadowDepthScales", depthScales);
+	commandList->setShaderConstant("shadowTexelSizes", texelSizes);
+}
+
+void ShadowMaps::createAtlases()
+{
+	this->depthShader = this->driver->createShaderProgram(shadowVSString, shadowFSString);
+	this->staticAtlas = this->driver->createRenderTarget(atlasResolution, atlasResolution);
+	this->dynamicAtlas = this->driver->createRenderTarget(atlasResolution, atlasResolution);
+	
+	// depths are packed in the texels, they cannot be filtered
+	this->driver->setTextureSampling(this->driver->getRenderTargetTexture(this->staticAtlas), false, false);
+	this->driver->setTextureSampling(this->driver->getRenderTargetTexture(this->dynamicAtlas), false, false);
+}
+
+} // oak namespace
@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class Camera;
+class CommandList;
+class GraphicDriver;
+class GraphicWorld;
+struct RenderTarget;
+struct ShaderProgram;
+
+/**
+ * Cascaded shadow maps of the first directional light of a world, as seen
+ * from a camera.
+ *
+ * The view is split in depth slices, each covered by a cascade: a square tile
+ * of the shadow atlases, rendered from the light with only the depth of the
+ * shadow casters. Cascade regions are snapped to a coarse grid in light space,
+ * so they only move once in a while.
+ *
+ * Static casters are drawn in their own atlas, redrawn only when the region of
+ * a cascade changes (or the static geometry does); dynamic casters are drawn
+ * each frame in a second atlas, and shaders keep the nearest of both depths.
+ * Depths are packed in RGBA8 render targets, which GLES2 can render to and sample.
+ */
+class ShadowMaps
+{
+	public:
+		ShadowMaps(GraphicDriver *driver);
+		~ShadowMaps();
+		
+		// Place the cascades for the camera, and list the maps to redraw this frame.
+		// Creates the atlases the first time a directional light casts shadows.
+		void update(const GraphicWorld *graphicWorld, const Camera *camera);
+		
+		// maps to redraw this frame, each recorded in its own list; can be called concurrently
+		unsigned int getUpdatedMapCount() const { return (unsigned int)this->updatedMaps.size(); }
+		void recordMap(CommandList *commandList, const GraphicWorld *graphicWorld, unsigned int updatedMap) const;
+		
+		// bind the atlases to the units 4 and 5, and set the constants of the light
+		// and its shadows for the shader bound last; can be called concurrently
+		void record(CommandList *commandList) const;
+	
+	private:
+		struct Cascade
+		{
+			// light clip space, for the whole atlas
+			glm::mat4 viewProjectionMatrix;
+			
+			// the region is a cube around a grid point, in light space
+			glm::ivec3 regionCell;
+			float regionRadius;
+			
+			// scale and offset from light space to atlas coordinates and depth
+			glm::vec4 atlasTransform; // offset in xyz, scale of x and y in w
+			float depthScale;
+			
+			float farDepth; // of the camera slice
+			float texelSize; // in world units
+			
+			bool staticValid; // static map drawn for the current region
+			bool dynamicEmpty; // no dynamic caster in the last dynamic map
+		};
+		
+		void createAtlases();
+		
+		GraphicDriver *driver;
+		ShaderProgram *depthShader;
+		RenderTarget *staticAtlas;
+		RenderTarget *dynamicAtlas;
+		
+		std::vector<Cascade> cascades;
+		
+		// cascade index times two, plus one for dynamic maps
+		std::vector<unsigned int> updatedMaps;
+		
+		// light of the last update
+		bool hasLight;
+		bool castsShadows;
+		glm::vec3 lightDirection; // towards the light
+		glm::vec3 lightColor; // times its intensity
+		glm::mat3 lightRotation; // from world space to light space
+		
+		unsigned int staticVersion;
+};
+
+} // oak namespace
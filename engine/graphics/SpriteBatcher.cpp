@@ -0,0 +1,593 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/SpriteBatcher.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/GlyphAtlas.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+#include <engine/graphics/TextLayoutCache.hpp>
+#include <engine/graphics/TextureManager.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/ParticleEmitter.hpp>
+#include <engine/graphics/components/Sprite.hpp>
+#include <engine/graphics/components/Text.hpp>
+
+#include <engine/graphics/shaders/sprite.vs.h>
+#include <engine/graphics/shaders/sprite.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+#include <engine/system/RadixSort.hpp>
+#include <engine/system/Simd.hpp>
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// two triangles per sprite, without index buffer
+const unsigned int verticesPerSprite = 6;
+
+// Sort keys: the layer on 16 bits (offset to be positive), the blend mode on
+// 1 bit (alpha blended first), then on 16 bits the depth of alpha blended
+// sprites, from back to front, or the texture number of additive ones, which
+// can be drawn in any order. The sort is stable, ties keep the registration order.
+const int layerOffset = 0x8000;
+const unsigned int maxTextureNumber = 0xffff;
+
+// texts are drawn on the near plane, in front of everything drawn before
+const float textDepth = 1.0f;
+
+unsigned char toByte(float value)
+{
+	return (unsigned char)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+GraphicDriver::BlendMode getBlendMode(const Sprite *sprite)
+{
+	return sprite->isAdditive() ? GraphicDriver::AdditiveBlend : GraphicDriver::AlphaBlend;
+}
+
+inline void writeVertex(GraphicDriver::SpriteVertex &vertex, const glm::vec3 &position, float u, float v, const unsigned char *color)
+{
+	vertex.position = position;
+	vertex.uv.x = u;
+	vertex.uv.y = v;
+	vertex.color[0] = color[0];
+	vertex.color[1] = color[1];
+	vertex.color[2] = color[2];
+	vertex.color[3] = color[3];
+}
+
+// quads of the glyphs of a layout found in the atlas, from its top-left corner in pixels
+GraphicDriver::SpriteVertex *writeGlyphs(GraphicDriver::SpriteVertex *quad, const TextLayout *layout, const GlyphAtlas *glyphAtlas, const glm::vec2 &origin, const unsigned char *color)
+{
+	const std::vector<TextLayout::Glyph> &glyphs = layout->glyphs;
+	for (unsigned int i = 0; i < glyphs.size(); i++)
+	{
+		const TextLayout::Glyph &glyph = glyphs[i];
+		if (glyph.slot == GlyphAtlas::invalidSlot)
+			continue;
+		
+		const glm::vec4 &region = glyphAtlas->getRegion(glyph.slot);
+		glm::vec2 topLeft = origin + glyph.position;
+		glm::vec2 bottomRight = topLeft + glyph.size;
+		
+		GraphicDriver::SpriteVertex corners[4];
+		corners[0].position = glm::vec3(topLeft.x, topLeft.y, textDepth);
+		corners[0].uv = glm::vec2(region.x, region.y);
+		corners[1].position = glm::vec3(topLeft.x, bottomRight.y, textDepth);
+		corners[1].uv = glm::vec2(region.x, region.w);
+		corners[2].position = glm::vec3(bottomRight.x, topLeft.y, textDepth);
+		corners[2].uv = glm::vec2(region.z, region.y);
+		corners[3].position = glm::vec3(bottomRight.x, bottomRight.y, textDepth);
+		corners[3].uv = glm::vec2(region.z, region.w);
+		for (unsigned int j = 0; j < 4; j++)
+			std::copy(color, color + 4, corners[j].color);
+		
+		quad[0] = corners[0];
+		quad[1] = corners[1];
+		quad[2] = corners[2];
+		quad[3] = corners[2];
+		quad[4] = corners[1];
+		quad[5] = corners[3];
+		quad += verticesPerSprite;
+	}
+	
+	return quad;
+}
+
+unsigned long long getLayerKey(int layer)
+{
+	return (unsigned long long)(glm::clamp(layer + layerOffset, 0, 0xffff));
+}
+
+// Texture level whose texels are about the size of a pixel, for a region of
+// the texture drawn at the given depth. The pixel scale is the size in pixels
+// of a unit long object at a unit distance.
+unsigned int getRequiredLevel(const glm::vec4 &region, const TextureResource *texture, float halfSize, float depth, float pixelScale)
+{
+	float texelCount = std::max(std::abs(region.z - region.x) * (float)texture->getWidth(), std::abs(region.w - region.y) * (float)texture->getHeight());
+	float pixelCount = 2.0f * halfSize * pixelScale / depth;
+	if (pixelCount >= texelCount)
+		return 0;
+	
+	unsigned int level = (unsigned int)(std::log(texelCount / pixelCount) / std::log(2.0f));
+	return std::min(level, texture->getLevelCount() - 1);
+}
+
+} // end of private section
+
+SpriteBatcher::SpriteBatcher(GraphicDriver *driver, Texture *defaultTexture)
+	: driver(driver)
+	, defaultTexture(defaultTexture)
+{
+	this->shader = this->driver->createShaderProgram(spriteVSString, spriteFSString);
+}
+
+SpriteBatcher::~SpriteBatcher()
+{
+	this->driver->destroyShaderProgram(this->shader);
+}
+
+void SpriteBatcher::record(CommandList *commandList, const GraphicWorld::SpriteVector &sprites, const Camera *camera, unsigned int targetHeight, StreamBuffer *streamBuffer)
+{
+	OAK_ASSERT(streamBuffer->getFormat() == GraphicDriver::SpriteVertexFormat, "Sprites are batched into sprite vertices");
+	
+	if (sprites.empty())
+		return;
+	
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	glm::mat4 viewProjectionMatrix = camera->getProjectionMatrix() * viewMatrix;
+	float pixelScale = camera->getProjectionMatrix()[1][1] * 0.5f * (float)targetHeight;
+	
+	// billboards use the axes of the camera
+	glm::vec3 cameraRight = glm::vec3(cameraTransform[0]);
+	glm::vec3 cameraUp = glm::vec3(cameraTransform[1]);
+	
+	// place and cull
+	Frustum frustum(viewProjectionMatrix);
+	this->visibleSprites.clear();
+	this->spriteOrder.clear();
+	this->textures.clear();
+	const TextureResource *lastTexture = NULL;
+	unsigned long long textureNumber = 0;
+	for (unsigned int i = 0; i < sprites.size(); i++)
+	{
+		const Sprite *sprite = sprites[i];
+		if (sprite->getOpacity() <= 0.0f)
+			continue;
+		
+		// textures are numbered as they are met, runs of sprites often share one
+		if (sprite->getTexture() != lastTexture || this->textures.empty())
+		{
+			lastTexture = sprite->getTexture();
+			textureNumber = std::find(this->textures.begin(), this->textures.end(), lastTexture) - this->textures.begin();
+			if (textureNumber == this->textures.size())
+				this->textures.push_back(lastTexture);
+			textureNumber = std::min(textureNumber, (unsigned long long)maxTextureNumber);
+		}
+		
+		const glm::mat4 &transform = sprite->getEntity()->getLocalTransform();
+		glm::vec2 halfSize = sprite->getSize() * 0.5f;
+		
+		VisibleSprite visibleSprite;
+		visibleSprite.sprite = sprite;
+		visibleSprite.center = glm::vec3(transform[3]);
+		if (sprite->isBillboard())
+		{
+			visibleSprite.axisX = cameraRight * (glm::length(glm::vec3(transform[0])) * halfSize.x);
+			visibleSprite.axisY = cameraUp * (glm::length(glm::vec3(transform[1])) * halfSize.y);
+		}
+		else
+		{
+			visibleSprite.axisX = glm::vec3(transform[0]) * halfSize.x;
+			visibleSprite.axisY = glm::vec3(transform[1]) * halfSize.y;
+		}
+		
+		float radius = std::sqrt(glm::dot(visibleSprite.axisX, visibleSprite.axisX) + glm::dot(visibleSprite.axisY, visibleSprite.axisY));
+		if (!frustum.intersectsSphere(visibleSprite.center, radius))
+			continue;
+		
+		unsigned long long order = textureNumber;
+		if (!sprite->isAdditive())
+		{
+			float depth = -(viewMatrix * glm::vec4(visibleSprite.center, 1.0f)).z;
+			order = RadixSort::getBackToFrontKey(depth, camera->getNearPlane(), camera->getFarPlane());
+		}
+		
+		SortItem item;
+		item.key = (getLayerKey(sprite->getLayer()) << 17) | ((unsigned long long)sprite->isAdditive() << 16) | order;
+		item.index = (unsigned int)this->visibleSprites.size();
+		this->spriteOrder.push_back(item);
+		this->visibleSprites.push_back(visibleSprite);
+	}
+	
+	if (this->visibleSprites.empty())
+		return;
+	
+	RadixSort::sort(&this->spriteOrder, &this->sortScratch);
+	
+	// all the quads in one allocation, the overflow is reported when the frame is submitted
+	unsigned int startElement = 0;
+	unsigned int spriteCount = (unsigned int)this->visibleSprites.size();
+	GraphicDriver::SpriteVertex *vertices = (GraphicDriver::SpriteVertex *)streamBuffer->allocate(spriteCount * verticesPerSprite, &startElement);
+	if (!vertices)
+		return;
+	
+	for (unsigned int i = 0; i < spriteCount; i++)
+	{
+		const VisibleSprite &visibleSprite = this->visibleSprites[this->spriteOrder[i].index];
+		const Sprite *sprite = visibleSprite.sprite;
+		const glm::vec4 &region = sprite->getRegion();
+		
+		GraphicDriver::SpriteVertex corners[4];
+		corners[0].position = visibleSprite.center - visibleSprite.axisX + visibleSprite.axisY;
+		corners[0].uv = glm::vec2(region.x, region.y);
+		corners[1].position = visibleSprite.center - visibleSprite.axisX - visibleSprite.axisY;
+		corners[1].uv = glm::vec2(region.x, region.w);
+		corners[2].position = visibleSprite.center + visibleSprite.axisX + visibleSprite.axisY;
+		corners[2].uv = glm::vec2(region.z, region.y);
+		corners[3].position = visibleSprite.center + visibleSprite.axisX - visibleSprite.axisY;
+		corners[3].uv = glm::vec2(region.z, region.w);
+		
+		const glm::vec3 &color = sprite->getColor();
+		unsigned char bytes[4] = { toByte(color.x), toByte(color.y), toByte(color.z), toByte(sprite->getOpacity()) };
+		for (unsigned int j = 0; j < 4; j++)
+			std::copy(bytes, bytes + 4, corners[j].color);
+		
+		GraphicDriver::SpriteVertex *quad = vertices + i * verticesPerSprite;
+		quad[0] = corners[0];
+		quad[1] = corners[1];
+		quad[2] = corners[2];
+		quad[3] = corners[2];
+		quad[4] = corners[1];
+		quad[5] = corners[3];
+	}
+	
+	// one draw per run of sprites sharing a texture and a blend mode
+	commandList->bindShaderProgram(this->shader);
+	commandList->setShaderConstant("viewProjectionMatrix", viewProjectionMatrix);
+	commandList->setShaderConstant("spriteTexture", 0);
+	commandList->bindVertexBuffer(streamBuffer->getVertexBuffer());
+	
+	Texture *currentTexture = NULL;
+	GraphicDriver::BlendMode currentBlendMode = GraphicDriver::OpaqueBlend;
+	unsigned int runStart = 0;
+	while (runStart < spriteCount)
+	{
+		const Sprite *first = this->visibleSprites[this->spriteOrder[runStart].index].sprite;
+		TextureResource *resource = first->getTexture();
+		Texture *texture = resource ? resource->getTexture() : this->defaultTexture;
+		GraphicDriver::BlendMode blendMode = getBlendMode(first);
+		
+		// the largest level needed by the sprites of the run, usable textures
+		// are never shared by different resources
+		unsigned int level = ~0u;
+		unsigned int runEnd = runStart;
+		for (; runEnd < spriteCount; runEnd++)
+		{
+			const VisibleSprite &visibleSprite = this->visibleSprites[this->spriteOrder[runEnd].index];
+			const Sprite *sprite = visibleSprite.sprite;
+			TextureResource *spriteResource = sprite->getTexture();
+			Texture *spriteTexture = spriteResource ? spriteResource->getTexture() : this->defaultTexture;
+			if (spriteTexture != texture || getBlendMode(sprite) != blendMode)
+				break;
+			
+			if (spriteResource && spriteResource->isUsable())
+			{
+				float halfSize = std::max(glm::length(visibleSprite.axisX), glm::length(visibleSprite.axisY));
+				float depth = std::max(-(viewMatrix * glm::vec4(visibleSprite.center, 1.0f)).z - halfSize, camera->getNearPlane());
+				level = std::min(level, getRequiredLevel(sprite->getRegion(), spriteResource, halfSize, depth, pixelScale));
+			}
+		}
+		
+		if (level != ~0u)
+			resource->requestLevel(level);
+		
+		// sprites are always blended
+		if (blendMode != currentBlendMode)
+		{
+			commandList->setBlendMode(blendMode);
+			currentBlendMode = blendMode;
+		}
+		
+		if (texture != currentTexture)
+		{
+			commandList->bindTexture(texture, 0);
+			currentTexture = texture;
+		}
+		
+		commandList->draw(GraphicDriver::Triangles, startElement + runStart * verticesPerSprite, (runEnd - runStart) * verticesPerSprite);
+		runStart = runEnd;
+	}
+	
+	commandList->setBlendMode(GraphicDriver::OpaqueBlend);
+}
+
+void SpriteBatcher::recordTexts(CommandList *commandList, const GraphicWorld::TextVector &texts, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer)
+{
+	OAK_ASSERT(streamBuffer->getFormat() == GraphicDriver::SpriteVertexFormat, "Texts are batched into sprite vertices");
+	
+	// glyphs missing from a full atlas are skipped
+	this->visibleTexts.clear();
+	unsigned int glyphCount = 0;
+	for (unsigned int i = 0; i < texts.size(); i++)
+	{
+		const Text *text = texts[i];
+		if (text->getOpacity() <= 0.0f || text->getLayout()->glyphs.empty())
+			continue;
+		
+		const std::vector<TextLayout::Glyph> &glyphs = text->getLayout()->glyphs;
+		for (unsigned int j = 0; j < glyphs.size(); j++)
+		{
+			if (glyphs[j].slot != GlyphAtlas::invalidSlot)
+				glyphCount++;
+		}
+		
+		VisibleText visibleText;
+		visibleText.key = (getLayerKey(text->getLayer()) << 32) | i;
+		visibleText.text = text;
+		this->visibleTexts.push_back(visibleText);
+	}
+	
+	if (glyphCount == 0)
+		return;
+	
+	std::sort(this->visibleTexts.begin(), this->visibleTexts.end());
+	
+	unsigned int startElement = 0;
+	GraphicDriver::SpriteVertex *vertices = (GraphicDriver::SpriteVertex *)streamBuffer->allocate(glyphCount * verticesPerSprite, &startElement);
+	if (!vertices)
+		return;
+	
+	GraphicDriver::SpriteVertex *quad = vertices;
+	for (unsigned int i = 0; i < this->visibleTexts.size(); i++)
+	{
+		const Text *text = this->visibleTexts[i].text;
+		
+		// texels on pixels
+		const glm::mat4 &transform = text->getEntity()->getLocalTransform();
+		glm::vec2 origin = glm::floor(glm::vec2(transform[3]) + 0.5f);
+		
+		const glm::vec3 &color = text->getColor();
+		unsigned char bytes[4] = { toByte(color.x), toByte(color.y), toByte(color.z), toByte(text->getOpacity()) };
+		quad = writeGlyphs(quad, text->getLayout(), glyphAtlas, origin, bytes);
+	}
+	
+	this->recordGlyphs(commandList, glyphAtlas, width, height, streamBuffer, startElement, glyphCount);
+}
+
+void SpriteBatcher::recordLabels(CommandList *commandList, const DebugDraw::LabelVector &labels, const glm::mat4 &viewProjectionMatrix, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer)
+{
+	OAK_ASSERT(streamBuffer->getFormat() == GraphicDriver::SpriteVertexFormat, "Labels are batched into sprite vertices");
+	
+	// labels anchored out of the view are skipped
+	this->visibleLabels.clear();
+	unsigned int glyphCount = 0;
+	for (unsigned int i = 0; i < labels.size(); i++)
+	{
+		const DebugDraw::Label &label = labels[i];
+		glm::vec4 clipPosition = viewProjectionMatrix * glm::vec4(label.position, 1.0f);
+		if (clipPosition.w <= 0.0f)
+			continue;
+		
+		glm::vec3 position = glm::vec3(clipPosition) / clipPosition.w;
+		if (std::abs(position.x) > 1.0f || std::abs(position.y) > 1.0f || position.z > 1.0f)
+			continue;
+		
+		// centered, texels on pixels
+		glm::vec2 pixel((position.x * 0.5f + 0.5f) * (float)width, (0.5f - position.y * 0.5f) * (float)height);
+		VisibleLabel visibleLabel;
+		visibleLabel.label = &label;
+		visibleLabel.origin = glm::floor(pixel - label.layout->extent * 0.5f + 0.5f);
+		this->visibleLabels.push_back(visibleLabel);
+		
+		const std::vector<TextLayout::Glyph> &glyphs = label.layout->glyphs;
+		for (unsigned int j = 0; j < glyphs.size(); j++)
+		{
+			if (glyphs[j].slot != GlyphAtlas::invalidSlot)
+				glyphCount++;
+		}
+	}
+	
+	if (glyphCount == 0)
+		return;
+	
+	unsigned int startElement = 0;
+	GraphicDriver::SpriteVertex *vertices = (GraphicDriver::SpriteVertex *)streamBuffer->allocate(glyphCount * verticesPerSprite, &startElement);
+	if (!vertices)
+		return;
+	
+	GraphicDriver::SpriteVertex *quad = vertices;
+	for (unsigned int i = 0; i < this->visibleLabels.size(); i++)
+	{
+		const DebugDraw::Label *label = this->visibleLabels[i].label;
+		unsigned char bytes[4] = { toByte(label->color.x), toByte(label->color.y), toByte(label->color.z), 255 };
+		quad = writeGlyphs(quad, label->layout, glyphAtlas, this->visibleLabels[i].origin, bytes);
+	}
+	
+	this->recordGlyphs(commandList, glyphAtlas, width, height, streamBuffer, startElement, glyphCount);
+}
+
+void SpriteBatcher::recordGlyphs(CommandList *commandList, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer, unsigned int startElement, unsigned int glyphCount) const
+{
+	// pixels from the top-left corner, whatever the viewport really covers
+	glm::mat4 projectionMatrix = glm::ortho(0.0f, (float)width, (float)height, 0.0f, -1.0f, 1.0f);
+	
+	commandList->bindShaderProgram(this->shader);
+	commandList->setShaderConstant("viewProjectionMatrix", projectionMatrix);
+	commandList->setShaderConstant("spriteTexture", 0);
+	commandList->bindVertexBuffer(streamBuffer->getVertexBuffer());
+	commandList->bindTexture(glyphAtlas->getTexture(), 0);
+	commandList->setBlendMode(GraphicDriver::AlphaBlend);
+	commandList->draw(GraphicDriver::Triangles, startElement, glyphCount * verticesPerSprite);
+	commandList->setBlendMode(GraphicDriver::OpaqueBlend);
+}
+
+void SpriteBatcher::recordParticles(CommandList *commandList, const ParticleEmitter *emitter, unsigned int firstParticle, unsigned int particleCount, const Camera *camera, unsigned int targetHeight, StreamBuffer *streamBuffer) const
+{
+	OAK_ASSERT(streamBuffer->getFormat() == GraphicDriver::SpriteVertexFormat, "Particles are batched into sprite vertices");
+	OAK_ASSERT(firstParticle + particleCount <= (unsigned int)emitter->getParticleCount(), "Recording particles out of range");
+	
+	if (particleCount == 0)
+		return;
+	
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	glm::mat4 viewProjectionMatrix = camera->getProjectionMatrix() * viewMatrix;
+	
+	// the whole emitter is culled at once, around the largest particles
+	const glm::vec2 &size = emitter->getSize();
+	float maxHalfSize = std::max(size.x, size.y) * 0.5f;
+	glm::vec3 center = (emitter->getBoundsMin() + emitter->getBoundsMax()) * 0.5f;
+	float radius = glm::length(emitter->getBoundsMax() - center) + maxHalfSize * 1.5f;
+	Frustum frustum(viewProjectionMatrix);
+	if (!frustum.intersectsSphere(center, radius))
+		return;
+	
+	unsigned int startElement = 0;
+	GraphicDriver::SpriteVertex *vertices = (GraphicDriver::SpriteVertex *)streamBuffer->allocate(particleCount * verticesPerSprite, &startElement);
+	if (!vertices)
+		return;
+	
+	glm::vec3 cameraRight = glm::vec3(cameraTransform[0]);
+	glm::vec3 cameraUp = glm::vec3(cameraTransform[1]);
+	const glm::vec4 &region = emitter->getRegion();
+	
+	// size and color are interpolated over the life of four particles at once,
+	// colors being scaled to bytes
+	const glm::vec4 &startColor = emitter->getStartColor();
+	const glm::vec4 &endColor = emitter->getEndColor();
+	Float4 zero = Simd::set(0.0f);
+	Float4 one = Simd::set(1.0f);
+	Float4 startHalfSize = Simd::set(size.x * 0.5f);
+	Float4 halfSizeChange = Simd::set((size.y - size.x) * 0.5f);
+	Float4 startChannels[4];
+	Float4 channelChanges[4];
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		float start = glm::clamp(startColor[i], 0.0f, 1.0f) * 255.0f;
+		float end = glm::clamp(endColor[i], 0.0f, 1.0f) * 255.0f;
+		startChannels[i] = Simd::set(start + 0.5f);
+		channelChanges[i] = Simd::set(end - start);
+	}
+	
+	const float *positionX = emitter->getPositionX();
+	const float *positionY = emitter->getPositionY();
+	const float *positionZ = emitter->getPositionZ();
+	const float *life = emitter->getLife();
+	
+	// alpha blended particles are drawn back to front, through their sorted
+	// indices; additive ones in place, their order does not matter
+	std::vector<SortItem> order;
+	if (!emitter->isAdditive())
+	{
+		order.resize(particleCount);
+		for (unsigned int i = 0; i < particleCount; i++)
+		{
+			unsigned int index = firstParticle + i;
+			float depth = -(viewMatrix[0][2] * positionX[index] + viewMatrix[1][2] * positionY[index] + viewMatrix[2][2] * positionZ[index] + viewMatrix[3][2]);
+			order[i].key = RadixSort::getBackToFrontKey(depth, camera->getNearPlane(), camera->getFarPlane());
+			order[i].index = index;
+		}
+		
+		std::vector<SortItem> scratch;
+		RadixSort::sort(&order, &scratch);
+	}
+	
+	// arrays are padded, the last group can be read whole
+	GraphicDriver::SpriteVertex *quad = vertices;
+	for (unsigned int i = 0; i < particleCount; i += 4)
+	{
+		unsigned int groupCount = std::min(particleCount - i, 4u);
+		unsigned int indices[4];
+		float lives[4];
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			indices[j] = order.empty() ? firstParticle + i + j : order[i + std::min(j, groupCount - 1)].index;
+			lives[j] = life[indices[j]];
+		}
+		
+		Float4 age = Simd::sub(one, Simd::min(Simd::max(Simd::load(lives), zero), one));
+		
+		float halfSizes[4];
+		float channels[4][4];
+		Simd::store(halfSizes, Simd::add(startHalfSize, Simd::mul(halfSizeChange, age)));
+		for (unsigned int j = 0; j < 4; j++)
+			Simd::store(channels[j], Simd::add(startChannels[j], Simd::mul(channelChanges[j], age)));
+		
+		// written in place, this loop is bound by memory bandwidth
+		for (unsigned int j = 0; j < groupCount; j++)
+		{
+			unsigned int index = indices[j];
+			glm::vec3 position(positionX[index], positionY[index], positionZ[index]);
+			glm::vec3 axisX = cameraRight * halfSizes[j];
+			glm::vec3 axisY = cameraUp * halfSizes[j];
+			glm::vec3 topLeft = position - axisX + axisY;
+			glm::vec3 bottomLeft = position - axisX - axisY;
+			glm::vec3 topRight = position + axisX + axisY;
+			glm::vec3 bottomRight = position + axisX - axisY;
+			unsigned char color[4] = { (unsigned char)channels[0][j], (unsigned char)channels[1][j], (unsigned char)channels[2][j], (unsigned char)channels[3][j] };
+			
+			writeVertex(quad[0], topLeft, region.x, region.y, color);
+			writeVertex(quad[1], bottomLeft, region.x, region.w, color);
+			writeVertex(quad[2], topRight, region.z, region.y, color);
+			writeVertex(quad[3], topRight, region.z, region.y, color);
+			writeVertex(quad[4], bottomLeft, region.x, region.w, color);
+			writeVertex(quad[5], bottomRight, region.z, region.w, color);
+			quad += verticesPerSprite;
+		}
+	}
+	
+	// the level needed by the largest particles at the nearest point of the emitter
+	TextureResource *resource = emitter->getTexture();
+	if (resource && resource->isUsable())
+	{
+		float pixelScale = camera->getProjectionMatrix()[1][1] * 0.5f * (float)targetHeight;
+		float depth = std::max(-(viewMatrix * glm::vec4(center, 1.0f)).z - radius, camera->getNearPlane());
+		resource->requestLevel(getRequiredLevel(region, resource, maxHalfSize, depth, pixelScale));
+	}
+	
+	commandList->bindShaderProgram(this->shader);
+	commandList->setShaderConstant("viewProjectionMatrix", viewProjectionMatrix);
+	commandList->setShaderConstant("spriteTexture", 0);
+	commandList->bindVertexBuffer(streamBuffer->getVertexBuffer());
+	commandList->bindTexture(resource ? resource->getTexture() : this->defaultTexture, 0);
+	commandList->setBlendMode(emitter->isAdditive() ? GraphicDriver::AdditiveBlend : GraphicDriver::AlphaBlend);
+	commandList->draw(GraphicDriver::Triangles, startElement, particleCount * verticesPerSprite);
+	commandList->setBlendMode(GraphicDriver::OpaqueBlend);
+}
+
+} // oak namespace
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/DebugDraw.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class Camera;
+class CommandList;
+class GlyphAtlas;
+class GraphicDriver;
+class ParticleEmitter;
+struct ShaderProgram;
+class StreamBuffer;
+struct Texture;
+class TextureResource;
+
+/**
+ * Draws the sprites of a world as seen from a camera, with as few draws as
+ * possible.
+ *
+ * The visible sprites are sorted by layer and blend mode, then alpha blended ones
+ * from back to front and additive ones by texture, with a radix sort. Their
+ * corners are written in world space into vertices of a stream buffer, two
+ * triangles per sprite. Each run of sprites sharing a texture and a blend
+ * mode is drawn at once, so a layer using a single atlas costs one draw.
+ * Particles are written the same way, in ranges of their emitter; those of
+ * alpha blended emitters are sorted back to front too.
+ */
+class SpriteBatcher
+{
+	public:
+		// sprites without texture are drawn with the default one
+		SpriteBatcher(GraphicDriver *driver, Texture *defaultTexture);
+		~SpriteBatcher();
+		
+		// Record the draws of the sprites, with vertices allocated from the given
+		// stream buffer (sprite vertex format), and request the texture levels
+		// needed for a target of the given height. The blend mode is opaque again
+		// once done.
+		void record(CommandList *commandList, const GraphicWorld::SpriteVector &sprites, const Camera *camera, unsigned int targetHeight, StreamBuffer *streamBuffer);
+		
+		// Record the glyphs of texts over a view of the given size in pixels, sorted
+		// by layer, in one draw from the glyph atlas; their glyphs must have been
+		// used in the atlas for this frame (see TextLayoutCache).
+		void recordTexts(CommandList *commandList, const GraphicWorld::TextVector &texts, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer);
+		
+		// Record debug labels the same way, centered on their anchor projected with the
+		// given matrix, in one draw; their layouts must have been prepared for this
+		// frame (see DebugDraw::prepareLabels).
+		void recordLabels(CommandList *commandList, const DebugDraw::LabelVector &labels, const glm::mat4 &viewProjectionMatrix, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer);
+		
+		// Record a range of the particles of an emitter as billboards, in one draw,
+		// unless the emitter is out of sight. Ranges of the same emitter can be
+		// recorded concurrently, each into its own list; the particles of alpha
+		// blended emitters are only sorted within their range.
+		void recordParticles(CommandList *commandList, const ParticleEmitter *emitter, unsigned int firstParticle, unsigned int particleCount, const Camera *camera, unsigned int targetHeight, StreamBuffer *streamBuffer) const;
+	
+	private:
+		// visible sprite, with the half axes of its quad in world space
+		struct VisibleSprite
+		{
+			const Sprite *sprite;
+			glm::vec3 center;
+			glm::vec3 axisX;
+			glm::vec3 axisY;
+		};
+		
+		// sort key of a visible sprite or of a particle, and its index
+		struct SortItem
+		{
+			unsigned long long key;
+			unsigned int index;
+		};
+		
+		// visible text, by layer then registration order
+		struct VisibleText
+		{
+			unsigned long long key;
+			const Text *text;
+			
+			bool operator< (const VisibleText &other) const { return this->key < other.key; }
+		};
+		
+		// label anchored in the view, with the top-left corner of its text in pixels
+		struct VisibleLabel
+		{
+			const DebugDraw::Label *label;
+			glm::vec2 origin;
+		};
+		
+		// draw glyph quads from the stream buffer, over a view of the given size
+		void recordGlyphs(CommandList *commandList, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer, unsigned int startElement, unsigned int glyphCount) const;
+		
+		GraphicDriver *driver;
+		Texture *defaultTexture;
+		ShaderProgram *shader;
+		
+		// kept from one recording to the next, to reuse their memory
+		std::vector<VisibleSprite> visibleSprites;
+		std::vector<SortItem> spriteOrder;
+		std::vector<SortItem> sortScratch;
+		std::vector<const TextureResource *> textures; // numbered in the sort keys
+		std::vector<VisibleText> visibleTexts;
+		std::vector<VisibleLabel> visibleLabels;
+};
+
+} // oak namespace
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/StreamBuffer.hpp>
+
+#include <engine/system/Atomic.hpp>
+#include <engine/system/Log.hpp>
+
+namespace oak {
+
+StreamBuffer::StreamBuffer(GraphicDriver *driver, GraphicDriver::VertexFormat format, unsigned int elementCapacity, unsigned int regionCount, unsigned int frameCount)
+	: driver(driver)
+	, format(format)
+	, vertexSize(GraphicDriver::getVertexSize(format))
+	, elementCapacity(elementCapacity)
+	, currentFrame(NULL)
+{
+	OAK_ASSERT(frameCount > 0, "Stream buffers need at least one frame");
+	
+	this->buffer = driver->createStreamingVertexBuffer(format, elementCapacity, regionCount);
+	
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		Frame *frame = new Frame;
+		frame->data.resize(this->vertexSize * elementCapacity);
+		frame->allocatedElementCount = 0;
+		
+		this->frames.push_back(frame);
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (unsigned int i = 0; i < this->frames.size(); i++)
+		delete this->frames[i];
+	
+	this->driver->destroyVertexBuffer(this->buffer);
+}
+
+void *StreamBuffer::allocate(unsigned int elementCount, unsigned int *startElement)
+{
+	OAK_ASSERT(this->currentFrame != NULL, "Allocating stream vertices outside of a frame");
+	
+	Frame *frame = this->currentFrame;
+	unsigned int first = (unsigned int)Atomic::add(&frame->allocatedElementCount, (int)elementCount);
+	if (first + elementCount > this->elementCapacity)
+		return NULL;
+	
+	*startElement = first;
+	return &frame->data[first * this->vertexSize];
+}
+
+void StreamBuffer::beginFrame(unsigned int frame)
+{
+	OAK_ASSERT(frame < this->frames.size(), "Recording an unknown stream buffer frame");
+	
+	this->currentFrame = this->frames[frame];
+	Atomic::store(&this->currentFrame->allocatedElementCount, 0);
+}
+
+void StreamBuffer::submitFrame(unsigned int frame)
+{
+	OAK_ASSERT(frame < this->frames.size(), "Submitting an unknown stream buffer frame");
+	
+	Frame *submittedFrame = this->frames[frame];
+	unsigned int elementCount = (unsigned int)Atomic::load(&submittedFrame->allocatedElementCount);
+	if (elementCount > this->elementCapacity)
+	{
+		Log::warning("Stream buffer overflow: %u vertices requested, %u available", elementCount, this->elementCapacity);
+		elementCount = this->elementCapacity;
+	}
+	
+	// nothing can draw from an empty frame, leave the buffer as it is
+	if (elementCount == 0)
+		return;
+	
+	this->driver->streamVertexBuffer(this->buffer, &submittedFrame->data[0], elementCount);
+}
+
+} // oak namespace
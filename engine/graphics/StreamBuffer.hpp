@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <vector>
+
+namespace oak {
+
+/**
+ * Per-frame allocator of dynamic vertices (particles, debug lines, UI...).
+ *
+ * Vertices are sub-allocated while a frame is recorded, from any thread and
+ * without locking, into system memory kept with the frame. When the frame is
+ * submitted, everything allocated is sent in a single write to the next region
+ * of a streaming vertex buffer, and draws use the returned element offsets.
+ */
+class StreamBuffer
+{
+	public:
+		// frameCount is the number of frames that can be recorded ahead of submission
+		StreamBuffer(GraphicDriver *driver, GraphicDriver::VertexFormat format, unsigned int elementCapacity, unsigned int regionCount, unsigned int frameCount);
+		~StreamBuffer();
+		
+		VertexBuffer *getVertexBuffer() const { return this->buffer; }
+		GraphicDriver::VertexFormat getFormat() const { return this->format; }
+		unsigned int getElementCapacity() const { return this->elementCapacity; }
+		
+		// Reserve vertices in the frame being recorded, to be filled by the caller.
+		// Returns NULL when the frame is full, otherwise startElement receives the
+		// element to draw from once the buffer is bound.
+		void *allocate(unsigned int elementCount, unsigned int *startElement);
+		
+		// start recording a frame, dropping what was allocated the last time it was used
+		void beginFrame(unsigned int frame);
+		
+		// upload what was allocated in a recorded frame (driver thread)
+		void submitFrame(unsigned int frame);
+	
+	private:
+		GraphicDriver *driver;
+		GraphicDriver::VertexFormat format;
+		unsigned int vertexSize;
+		unsigned int elementCapacity;
+		
+		VertexBuffer *buffer;
+		
+		struct Frame
+		{
+			std::vector<char> data;
+			
+			// may grow past the capacity, allocations that do not fit are refused
+			volatile int allocatedElementCount;
+		};
+		typedef std::vector<Frame *> FrameVector;
+		FrameVector frames;
+		
+		Frame *currentFrame;
+};
+
+} // oak namespace
@@ -0,0 +1,195 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/TextLayoutCache.hpp>
+
+#include <engine/graphics/GlyphAtlas.hpp>
+#include <engine/graphics/components/Text.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// unreferenced layouts kept before dropping the oldest ones
+const unsigned int maxUnreferencedLayouts = 256;
+
+// distance between baselines, relative to the glyph size
+const float lineSpacing = 1.25f;
+
+// sorting functor, least recently released first
+struct ReleasedFrameComparator
+{
+	bool operator() (const TextLayout *layout1, const TextLayout *layout2) const
+	{
+		return layout1->releasedFrame < layout2->releasedFrame;
+	}
+};
+
+} // end of private section
+
+TextLayoutCache::TextLayoutCache(GlyphAtlas *glyphAtlas)
+	: unreferencedCount(0)
+	, glyphAtlas(glyphAtlas)
+	, frame(1)
+	, layoutCount(0)
+{
+}
+
+TextLayoutCache::~TextLayoutCache()
+{
+	OAK_ASSERT(this->unreferencedCount == this->layouts.size(), "Some text layouts are still referenced");
+	
+	for (LayoutMap::iterator it = this->layouts.begin(); it != this->layouts.end(); ++it)
+		delete it->second;
+}
+
+TextLayout *TextLayoutCache::acquire(const std::string &text, unsigned int size)
+{
+	size = GlyphAtlas::clampSize(size);
+	
+	LayoutKey key(text, size);
+	LayoutMap::iterator it = this->layouts.find(key);
+	if (it != this->layouts.end())
+	{
+		TextLayout *layout = it->second;
+		if (layout->referenceCount == 0)
+			this->unreferencedCount--;
+		layout->referenceCount++;
+		return layout;
+	}
+	
+	TextLayout *layout = new TextLayout;
+	layout->text = text;
+	layout->size = size;
+	layout->referenceCount = 1;
+	layout->releasedFrame = 0;
+	layout->usedFrame = 0;
+	this->layouts[key] = layout;
+	this->layoutCount++;
+	
+	// pen on the top-left corner of each line, glyphs on whole pixels
+	float lineHeight = std::floor((float)size * lineSpacing + 0.5f);
+	glm::vec2 pen(0.0f, 0.0f);
+	glm::vec2 extent(0.0f, (float)size);
+	for (unsigned int i = 0; i < text.size(); i++)
+	{
+		unsigned int character = (unsigned char)text[i];
+		if (character == '\n')
+		{
+			pen = glm::vec2(0.0f, pen.y + lineHeight);
+			extent.y = pen.y + (float)size;
+			continue;
+		}
+		
+		if (!GlyphAtlas::isBlank(character))
+		{
+			TextLayout::Glyph glyph;
+			glyph.position = glm::vec2(std::floor(pen.x + GlyphAtlas::getGlyphOffset(character, size) + 0.5f), pen.y);
+			glyph.size = (float)size;
+			glyph.key = GlyphAtlas::getGlyphKey(character, size);
+			glyph.slot = GlyphAtlas::invalidSlot;
+			layout->glyphs.push_back(glyph);
+		}
+		
+		pen.x += GlyphAtlas::getGlyphAdvance(character, size);
+		extent.x = std::max(extent.x, pen.x);
+	}
+	layout->extent = extent;
+	
+	return layout;
+}
+
+void TextLayoutCache::release(const TextLayout *constLayout)
+{
+	// layouts are owned by the cache
+	TextLayout *layout = const_cast<TextLayout *>(constLayout);
+	OAK_ASSERT(layout->referenceCount > 0, "Releasing a text layout more than acquired");
+	
+	layout->referenceCount--;
+	if (layout->referenceCount == 0)
+	{
+		layout->releasedFrame = this->frame;
+		this->unreferencedCount++;
+	}
+}
+
+void TextLayoutCache::useGlyphs(const GraphicWorld::TextVector &texts)
+{
+	for (unsigned int i = 0; i < texts.size(); i++)
+	{
+		const Text *text = texts[i];
+		if (text->getOpacity() > 0.0f)
+			this->useGlyphs(text->getLayout());
+	}
+}
+
+void TextLayoutCache::useGlyphs(TextLayout *layout)
+{
+	if (layout->usedFrame == this->frame)
+		return;
+	
+	// unchanged glyphs are found where they were, with one comparison
+	for (unsigned int i = 0; i < layout->glyphs.size(); i++)
+	{
+		TextLayout::Glyph &glyph = layout->glyphs[i];
+		glyph.slot = this->glyphAtlas->useGlyph(glyph.key, glyph.slot);
+	}
+	
+	layout->usedFrame = this->frame;
+}
+
+void TextLayoutCache::update()
+{
+	if (this->unreferencedCount > maxUnreferencedLayouts)
+	{
+		std::vector<TextLayout *> unreferencedLayouts;
+		unreferencedLayouts.reserve(this->unreferencedCount);
+		for (LayoutMap::iterator it = this->layouts.begin(); it != this->layouts.end(); ++it)
+		{
+			if (it->second->referenceCount == 0)
+				unreferencedLayouts.push_back(it->second);
+		}
+		
+		// drop the least recently released half
+		std::vector<TextLayout *>::iterator middle = unreferencedLayouts.begin() + unreferencedLayouts.size() / 2;
+		std::nth_element(unreferencedLayouts.begin(), middle, unreferencedLayouts.end(), ReleasedFrameComparator());
+		for (std::vector<TextLayout *>::iterator it = unreferencedLayouts.begin(); it != middle; ++it)
+		{
+			TextLayout *layout = *it;
+			this->layouts.erase(LayoutKey(layout->text, layout->size));
+			delete layout;
+			this->unreferencedCount--;
+		}
+	}
+	
+	this->frame++;
+}
+
+} // oak namespace
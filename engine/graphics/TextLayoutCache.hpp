@@ -0,0 +1,112 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace oak {
+
+class GlyphAtlas;
+
+/**
+ * Glyphs of a string laid out at a size, shared by all the texts showing it.
+ */
+struct TextLayout
+{
+	// glyph cell, in pixels from the top-left corner of the text
+	struct Glyph
+	{
+		glm::vec2 position;
+		float size;
+		unsigned int key; // in the glyph atlas
+		unsigned int slot; // where it was last found in the atlas
+	};
+	std::vector<Glyph> glyphs;
+	
+	// size of the whole text, in pixels
+	glm::vec2 extent;
+	
+	std::string text;
+	unsigned int size;
+	
+	// texts using the layout, the frame the last one released it, and the
+	// frame its glyphs were last used in
+	unsigned int referenceCount;
+	unsigned int releasedFrame;
+	unsigned int usedFrame;
+};
+
+/**
+ * Lays out strings with the metrics of the glyph atlas, and keeps the layouts
+ * keyed by string and size: texts showing the same string at the same size
+ * share one layout, and a text set back to a previous string finds it ready.
+ *
+ * Layouts are referenced by the texts using them. Unreferenced ones are kept
+ * until there are too many of them, then the least recently released half is
+ * dropped.
+ * Lines are split on '\n'; glyph positions are rounded to whole pixels.
+ */
+class TextLayoutCache
+{
+	public:
+		TextLayoutCache(GlyphAtlas *glyphAtlas);
+		~TextLayoutCache();
+		
+		// get a layout (laying it out if not cached), then release it once unused
+		TextLayout *acquire(const std::string &text, unsigned int size);
+		void release(const TextLayout *layout);
+		
+		// Use the glyphs of the visible texts of a world in the atlas, for the frame
+		// being prepared; layouts already used by another text are skipped.
+		void useGlyphs(const GraphicWorld::TextVector &texts);
+		void useGlyphs(TextLayout *layout);
+		
+		// drop unreferenced layouts if needed, then start a new frame
+		// (once per prepared frame, after the glyphs of all worlds are used)
+		void update();
+		
+		// layouts computed since the creation of the cache, for profiling
+		unsigned int getLayoutCount() const { return this->layoutCount; }
+	
+	private:
+		typedef std::pair<std::string, unsigned int> LayoutKey;
+		typedef std::map<LayoutKey, TextLayout *> LayoutMap;
+		LayoutMap layouts;
+		
+		unsigned int unreferencedCount;
+		
+		GlyphAtlas *glyphAtlas;
+		unsigned int frame;
+		unsigned int layoutCount;
+};
+
+} // oak namespace
@@ -0,0 +1,428 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/TextureDecoder.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <cstring>
+
+namespace oak {
+
+namespace { // private section
+
+// blocks are decoded to 4x4 RGBA8 pixels, row by row
+typedef unsigned char BlockPixels[16][4];
+
+inline unsigned char clampColor(int value)
+{
+	return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void setPixel(unsigned char *pixel, int r, int g, int b, int a)
+{
+	pixel[0] = clampColor(r);
+	pixel[1] = clampColor(g);
+	pixel[2] = clampColor(b);
+	pixel[3] = clampColor(a);
+}
+
+// BCn blocks are little-endian
+
+inline unsigned int readLittleEndian16(const unsigned char *data)
+{
+	return data[0] | (data[1] << 8);
+}
+
+inline unsigned int readLittleEndian32(const unsigned char *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+void decodeRGB565(unsigned int color, int *rgb)
+{
+	int r = (color >> 11) & 0x1f;
+	int g = (color >> 5) & 0x3f;
+	int b = color & 0x1f;
+	
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+// color part of BC1, BC2 and BC3 blocks; the latter two always use four colors
+void decodeBC1Colors(const unsigned char *block, bool allowTransparency, BlockPixels pixels)
+{
+	unsigned int color0 = readLittleEndian16(block);
+	unsigned int color1 = readLittleEndian16(block + 2);
+	unsigned int indices = readLittleEndian32(block + 4);
+	
+	int palette[4][4];
+	decodeRGB565(color0, palette[0]);
+	decodeRGB565(color1, palette[1]);
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	
+	for (int c = 0; c < 3; c++)
+	{
+		if (color0 > color1 || !allowTransparency)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (color0 > color1 || !allowTransparency) ? 255 : 0;
+	
+	for (int i = 0; i < 16; i++)
+	{
+		const int *color = palette[(indices >> (2 * i)) & 3];
+		setPixel(pixels[i], color[0], color[1], color[2], color[3]);
+	}
+}
+
+void decodeBC2Alpha(const unsigned char *block, BlockPixels pixels)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		int alpha = (block[i / 2] >> (4 * (i & 1))) & 0xf;
+		pixels[i][3] = (unsigned char)(alpha * 17);
+	}
+}
+
+void decodeBC3Alpha(const unsigned char *block, BlockPixels pixels)
+{
+	int palette[8];
+	palette[0] = block[0];
+	palette[1] = block[1];
+	
+	if (palette[0] > palette[1])
+	{
+		for (int i = 1; i < 7; i++)
+			palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+	}
+	else
+	{
+		for (int i = 1; i < 5; i++)
+			palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	
+	// 16 indices of 3 bits
+	unsigned int low = block[2] | (block[3] << 8) | (block[4] << 16);
+	unsigned int high = block[5] | (block[6] << 8) | (block[7] << 16);
+	for (int i = 0; i < 8; i++)
+	{
+		pixels[i][3] = (unsigned char)palette[(low >> (3 * i)) & 7];
+		pixels[i + 8][3] = (unsigned char)palette[(high >> (3 * i)) & 7];
+	}
+}
+
+// ETC blocks are big-endian, and pixels are indexed column by column
+
+const int etcModifierTables[8][2] = {
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+	{ 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+const int etcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+const int eacModifierTables[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+inline unsigned int readBigEndian32(const unsigned char *data)
+{
+	return ((unsigned int)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+inline int extend4(int value) { return (value << 4) | value; }
+inline int extend5(int value) { return (value << 3) | (value >> 2); }
+inline int extend6(int value) { return (value << 2) | (value >> 4); }
+inline int extend7(int value) { return (value << 1) | (value >> 6); }
+
+// 2-bit index of pixel i (column-major) in the low word of an ETC block
+inline int getETCIndex(unsigned int low, int i)
+{
+	return (((low >> (i + 16)) & 1) << 1) | ((low >> i) & 1);
+}
+
+inline void setETCPixel(BlockPixels pixels, int i, const int *rgb, int modifier)
+{
+	// column-major index to row-major pixel
+	unsigned char *pixel = pixels[(i & 3) * 4 + (i >> 2)];
+	setPixel(pixel, rgb[0] + modifier, rgb[1] + modifier, rgb[2] + modifier, 255);
+}
+
+void decodeETCSubblocks(unsigned int high, unsigned int low, const int baseColors[2][3], BlockPixels pixels)
+{
+	bool flip = (high & 1) != 0;
+	int tables[2] = { (int)((high >> 5) & 7), (int)((high >> 2) & 7) };
+	
+	for (int i = 0; i < 16; i++)
+	{
+		int x = i >> 2;
+		int y = i & 3;
+		int subblock = flip ? (y >= 2) : (x >= 2);
+		
+		const int *table = etcModifierTables[tables[subblock]];
+		int modifiers[4] = { table[0], table[1], -table[0], -table[1] };
+		
+		setETCPixel(pixels, i, baseColors[subblock], modifiers[getETCIndex(low, i)]);
+	}
+}
+
+void decodeETCPaints(unsigned int low, const int paints[4][3], BlockPixels pixels)
+{
+	for (int i = 0; i < 16; i++)
+		setETCPixel(pixels, i, paints[getETCIndex(low, i)], 0);
+}
+
+void decodeETCPlanar(unsigned int high, unsigned int low, BlockPixels pixels)
+{
+	int origin[3], horizontal[3], vertical[3];
+	origin[0] = extend6((high >> 25) & 0x3f);
+	origin[1] = extend7((((high >> 24) & 1) << 6) | ((high >> 17) & 0x3f));
+	origin[2] = extend6((((high >> 16) & 1) << 5) | (((high >> 11) & 3) << 3) | ((high >> 7) & 7));
+	horizontal[0] = extend6((((high >> 2) & 0x1f) << 1) | (high & 1));
+	horizontal[1] = extend7((low >> 25) & 0x7f);
+	horizontal[2] = extend6((low >> 19) & 0x3f);
+	vertical[0] = extend6((low >> 13) & 0x3f);
+	vertical[1] = extend7((low >> 6) & 0x7f);
+	vertical[2] = extend6(low & 0x3f);
+	
+	for (int y = 0; y < 4; y++)
+	{
+		for (int x = 0; x < 4; x++)
+		{
+			int rgb[3];
+			for (int c = 0; c < 3; c++)
+				rgb[c] = (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+			
+			setPixel(pixels[y * 4 + x], rgb[0], rgb[1], rgb[2], 255);
+		}
+	}
+}
+
+// ETC1 blocks are valid ETC2 blocks: the extra modes of ETC2 are encoded
+// with differential colors that overflow, which ETC1 encoders never produce
+void decodeETC2Colors(const unsigned char *block, BlockPixels pixels)
+{
+	unsigned int high = readBigEndian32(block);
+	unsigned int low = readBigEndian32(block + 4);
+	
+	int baseColors[2][3];
+	
+	// individual mode
+	if ((high & 2) == 0)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			baseColors[0][c] = extend4((high >> (28 - 8 * c)) & 0xf);
+			baseColors[1][c] = extend4((high >> (24 - 8 * c)) & 0xf);
+		}
+		
+		decodeETCSubblocks(high, low, baseColors, pixels);
+		return;
+	}
+	
+	// differential mode
+	int base[3], delta[3];
+	for (int c = 0; c < 3; c++)
+	{
+		base[c] = (high >> (27 - 8 * c)) & 0x1f;
+		delta[c] = (high >> (24 - 8 * c)) & 0x7;
+		if (delta[c] >= 4)
+			delta[c] -= 8;
+	}
+	
+	if (base[0] + delta[0] < 0 || base[0] + delta[0] > 31)
+	{
+		// T mode
+		int color1[3], color2[3];
+		color1[0] = extend4((((high >> 27) & 3) << 2) | ((high >> 24) & 3));
+		color1[1] = extend4((high >> 20) & 0xf);
+		color1[2] = extend4((high >> 16) & 0xf);
+		color2[0] = extend4((high >> 12) & 0xf);
+		color2[1] = extend4((high >> 8) & 0xf);
+		color2[2] = extend4((high >> 4) & 0xf);
+		int distance = etcDistances[(((high >> 2) & 3) << 1) | (high & 1)];
+		
+		int paints[4][3];
+		for (int c = 0; c < 3; c++)
+		{
+			paints[0][c] = color1[c];
+			paints[1][c] = clampColor(color2[c] + distance);
+			paints[2][c] = color2[c];
+			paints[3][c] = clampColor(color2[c] - distance);
+		}
+		
+		decodeETCPaints(low, paints, pixels);
+	}
+	else if (base[1] + delta[1] < 0 || base[1] + delta[1] > 31)
+	{
+		// H mode
+		int color1[3], color2[3];
+		color1[0] = (high >> 27) & 0xf;
+		color1[1] = (((high >> 24) & 7) << 1) | ((high >> 20) & 1);
+		color1[2] = (((high >> 19) & 1) << 3) | ((high >> 15) & 7);
+		color2[0] = (high >> 11) & 0xf;
+		color2[1] = (high >> 7) & 0xf;
+		color2[2] = (high >> 3) & 0xf;
+		
+		// the order of the colors gives the last bit of the distance index
+		int packed1 = (color1[0] << 8) | (color1[1] << 4) | color1[2];
+		int packed2 = (color2[0] << 8) | (color2[1] << 4) | color2[2];
+		int distance = etcDistances[(high & 4) | ((high & 1) << 1) | (packed1 >= packed2 ? 1 : 0)];
+		
+		int paints[4][3];
+		for (int c = 0; c < 3; c++)
+		{
+			paints[0][c] = clampColor(extend4(color1[c]) + distance);
+			paints[1][c] = clampColor(extend4(color1[c]) - distance);
+			paints[2][c] = clampColor(extend4(color2[c]) + distance);
+			paints[3][c] = clampColor(extend4(color2[c]) - distance);
+		}
+		
+		decodeETCPaints(low, paints, pixels);
+	}
+	else if (base[2] + delta[2] < 0 || base[2] + delta[2] > 31)
+	{
+		decodeETCPlanar(high, low, pixels);
+	}
+	else
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			baseColors[0][c] = extend5(base[c]);
+			baseColors[1][c] = extend5(base[c] + delta[c]);
+		}
+		
+		decodeETCSubblocks(high, low, baseColors, pixels);
+	}
+}
+
+void decodeEACAlpha(const unsigned char *block, BlockPixels pixels)
+{
+	int base = block[0];
+	int multiplier = block[1] >> 4;
+	const int *table = eacModifierTables[block[1] & 0xf];
+	
+	// 16 indices of 3 bits, from the most significant bits
+	unsigned int high = (block[2] << 16) | (block[3] << 8) | block[4];
+	unsigned int low = (block[5] << 16) | (block[6] << 8) | block[7];
+	
+	for (int i = 0; i < 16; i++)
+	{
+		unsigned int bits = (i < 8) ? high : low;
+		int index = (bits >> (21 - 3 * (i & 7))) & 7;
+		
+		pixels[(i & 3) * 4 + (i >> 2)][3] = clampColor(base + table[index] * multiplier);
+	}
+}
+
+} // end of private section
+
+void TextureDecoder::decode(GraphicDriver::TextureFormat format, unsigned int width, unsigned int height, const unsigned char *blocks, unsigned char *pixels)
+{
+	if (format == GraphicDriver::RGBA8TextureFormat)
+	{
+		memcpy(pixels, blocks, width * height * 4);
+		return;
+	}
+	
+	unsigned int blockSize = GraphicDriver::getTextureLevelSize(format, 4, 4);
+	
+	for (unsigned int blockY = 0; blockY < height; blockY += 4)
+	{
+		for (unsigned int blockX = 0; blockX < width; blockX += 4)
+		{
+			BlockPixels blockPixels;
+			
+			switch (format)
+			{
+				case GraphicDriver::BC1TextureFormat:
+					decodeBC1Colors(blocks, true, blockPixels);
+					break;
+				
+				case GraphicDriver::BC2TextureFormat:
+					decodeBC1Colors(blocks + 8, false, blockPixels);
+					decodeBC2Alpha(blocks, blockPixels);
+					break;
+				
+				case GraphicDriver::BC3TextureFormat:
+					decodeBC1Colors(blocks + 8, false, blockPixels);
+					decodeBC3Alpha(blocks, blockPixels);
+					break;
+				
+				case GraphicDriver::ETC1TextureFormat:
+				case GraphicDriver::ETC2RGBTextureFormat:
+					decodeETC2Colors(blocks, blockPixels);
+					break;
+				
+				case GraphicDriver::ETC2RGBATextureFormat:
+					decodeETC2Colors(blocks + 8, blockPixels);
+					decodeEACAlpha(blocks, blockPixels);
+					break;
+				
+				default:
+					OAK_ASSERT(false, "Decoding an unknown texture format");
+					return;
+			}
+			
+			blocks += blockSize;
+			
+			// blocks overlapping the level edges are clipped
+			for (unsigned int y = 0; y < 4 && blockY + y < height; y++)
+			{
+				for (unsigned int x = 0; x < 4 && blockX + x < width; x++)
+					memcpy(pixels + ((blockY + y) * width + blockX + x) * 4, blockPixels[y * 4 + x], 4);
+			}
+		}
+	}
+}
+
+} // oak namespace
@@ -0,0 +1,561 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/TextureManager.hpp>
+
+#include <engine/graphics/TextureDecoder.hpp>
+
+#include <engine/system/Atomic.hpp>
+#include <engine/system/File.hpp>
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace oak {
+
+namespace { // private section
+
+// bytes uploaded per frame, and kept resident above the tails, by default
+const unsigned int defaultUploadBudget = 256 * 1024;
+const unsigned int defaultMemoryBudget = 32 * 1024 * 1024;
+
+// levels up to this size are always resident
+const unsigned int tailSize = 64;
+
+// no level requested since the last update
+const int noRequestedLevel = 0x7fffffff;
+
+// Cooked texture files (.otex) hold the same texture in one or more formats,
+// so that each platform can pick one its GPU supports. All values are
+// little-endian 32-bit integers:
+//
+//   "OTEX", version, width, height, levelCount, encodingCount
+//   for each encoding:
+//     format (GraphicDriver::TextureFormat)
+//     for each level, from the largest: size, data
+const char textureMagic[4] = { 'O', 'T', 'E', 'X' };
+const unsigned int textureVersion = 1;
+
+// sequential reading of a file in memory, with bound checks
+class TextureFileReader
+{
+	public:
+		TextureFileReader(const std::vector<char> &content)
+			: content(content)
+			, offset(0)
+		{}
+		
+		bool readInteger(unsigned int *value)
+		{
+			const unsigned char *data = (const unsigned char *)this->read(4);
+			if (!data)
+				return false;
+			
+			*value = data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+			return true;
+		}
+		
+		// returns NULL past the end of the file
+		const char *read(unsigned int size)
+		{
+			if (size > this->content.size() - this->offset)
+				return NULL;
+			
+			const char *data = &this->content[this->offset];
+			this->offset += size;
+			
+			return data;
+		}
+	
+	private:
+		const std::vector<char> &content;
+		unsigned int offset;
+};
+
+} // end of private section
+
+TextureResource::TextureResource(const std::string &path, Texture *defaultTexture)
+	: path(path)
+	, texture(NULL)
+	, defaultTexture(defaultTexture)
+	, usable(false)
+	, failed(false)
+	, width(0)
+	, height(0)
+	, levelCount(0)
+	, residentLevel(0)
+	, targetLevel(0)
+	, tailLevel(0)
+	, requestedLevel(noRequestedLevel)
+	, lastRequestFrame(0)
+	, pendingTexture(NULL)
+	, pendingUploadedLevelCount(0)
+	, format(GraphicDriver::RGBA8TextureFormat)
+	, capabilities(NULL)
+{
+}
+
+void TextureResource::requestLevel(unsigned int level)
+{
+	// atomic minimum, most requests do not lower the current one
+	int requested = this->requestedLevel;
+	while ((int)level < requested)
+	{
+		int previous = Atomic::compareAndSwap(&this->requestedLevel, requested, (int)level);
+		if (previous == requested)
+			break;
+		
+		requested = previous;
+	}
+}
+
+TextureManager::TextureManager(GraphicDriver *driver, JobQueue *jobQueue)
+	: driver(driver)
+	, jobQueue(jobQueue)
+	, uploadBudget(defaultUploadBudget)
+	, memoryBudget(defaultMemoryBudget)
+	, frameIndex(0)
+{
+	unsigned char white[4] = { 255, 255, 255, 255 };
+	
+	this->defaultTexture = this->driver->createTexture();
+	this->driver->uploadTextureLevel(this->defaultTexture, GraphicDriver::RGBA8TextureFormat, 0, 1, 1, white);
+	this->driver->setTextureLevelRange(this->defaultTexture, 0, 0);
+}
+
+TextureManager::~TextureManager()
+{
+	for (TextureMap::iterator it = this->textures.begin(); it != this->textures.end(); ++it)
+	{
+		TextureResource *resource = it->second;
+		
+		// load jobs still reference their texture
+		this->jobQueue->wait(&resource->loadBatch);
+		
+		if (resource->pendingTexture && resource->pendingTexture != resource->texture)
+			this->driver->destroyTexture(resource->pendingTexture);
+		if (resource->texture)
+			this->driver->destroyTexture(resource->texture);
+		
+		delete resource;
+	}
+	
+	for (unsigned int i = 0; i < this->wrappedTextures.size(); i++)
+		delete this->wrappedTextures[i];
+	
+	this->driver->destroyTexture(this->defaultTexture);
+}
+
+TextureResource *TextureManager::load(const std::string &path)
+{
+	TextureMap::iterator it = this->textures.find(path);
+	if (it != this->textures.end())
+		return it->second;
+	
+	TextureResource *resource = new TextureResource(path, this->defaultTexture);
+	resource->capabilities = &this->driver->getCapabilities();
+	this->textures[path] = resource;
+	
+	// the first load reads the file header, then the tail levels
+	this->startLoad(resource, 0);
+	
+	return resource;
+}
+
+TextureResource *TextureManager::wrap(Texture *texture, unsigned int width, unsigned int height)
+{
+	TextureResource *resource = new TextureResource(std::string(), this->defaultTexture);
+	resource->capabilities = &this->driver->getCapabilities();
+	this->setWrappedTexture(resource, texture, width, height);
+	this->wrappedTextures.push_back(resource);
+	
+	return resource;
+}
+
+void TextureManager::setWrappedTexture(TextureResource *resource, Texture *texture, unsigned int width, unsigned int height)
+{
+	OAK_ASSERT(resource->path.empty(), "Only wrapped textures can be replaced");
+	
+	// a single resident level, so that draws never request more
+	resource->texture = texture;
+	resource->usable = (texture != NULL);
+	resource->width = width;
+	resource->height = height;
+	resource->levelCount = 1;
+}
+
+bool TextureManager::wasDrawn(TextureResource *resource)
+{
+	OAK_ASSERT(resource->path.empty(), "Only wrapped textures are tracked this way");
+	
+	// draws request levels like for any texture
+	bool drawn = (resource->requestedLevel != noRequestedLevel);
+	resource->requestedLevel = noRequestedLevel;
+	
+	return drawn;
+}
+
+void TextureManager::update()
+{
+	this->frameIndex++;
+	
+	// collect the levels read since the last frame
+	for (unsigned int i = 0; i < this->loadingTextures.size(); )
+	{
+		TextureResource *resource = this->loadingTextures[i];
+		
+		// without workers, jobs only run when waited for
+		if (this->jobQueue->getWorkerCount() == 0)
+			this->jobQueue->wait(&resource->loadBatch);
+		
+		if (!resource->loadBatch.isDone())
+		{
+			i++;
+			continue;
+		}
+		
+		this->loadingTextures.erase(this->loadingTextures.begin() + i);
+		
+		if (!resource->failed)
+			this->startBuild(resource, resource->targetLevel);
+		else
+			resource->targetLevel = resource->residentLevel;
+	}
+	
+	// Apply the requests recorded with the previous frame. Record jobs are
+	// done at this point, so the requests are read without synchronization.
+	typedef std::pair<unsigned int, TextureResource *> LevelRequest; // missing level count, texture
+	std::vector<LevelRequest> requests;
+	for (TextureMap::iterator it = this->textures.begin(); it != this->textures.end(); ++it)
+	{
+		TextureResource *resource = it->second;
+		if (resource->requestedLevel == noRequestedLevel)
+			continue;
+		
+		unsigned int level = (unsigned int)resource->requestedLevel;
+		resource->requestedLevel = noRequestedLevel;
+		resource->lastRequestFrame = this->frameIndex;
+		
+		if (level >= resource->residentLevel)
+			continue;
+		
+		this->statistics.missCount++;
+		
+		// textures already loading or building are updated once done
+		if (!resource->failed && resource->targetLevel == resource->residentLevel && !resource->pendingTexture)
+			requests.push_back(LevelRequest(resource->residentLevel - level, resource));
+	}
+	
+	// the most blurry textures first
+	std::sort(requests.begin(), requests.end(), std::greater<LevelRequest>());
+	for (unsigned int i = 0; i < requests.size(); i++)
+	{
+		TextureResource *resource = requests[i].second;
+		unsigned int level = resource->residentLevel - requests[i].first;
+		
+		// give up the largest levels first when the budget is short
+		unsigned int residentSize = getResidentSize(resource, resource->residentLevel);
+		while (level < resource->residentLevel && !this->makeRoom(getResidentSize(resource, level) - residentSize))
+			level++;
+		
+		if (level < resource->residentLevel)
+			this->startLoad(resource, level);
+	}
+	
+	// then upload levels in request order, within the budget
+	unsigned int budget = this->uploadBudget;
+	bool uploaded = false;
+	while (!this->uploadingTextures.empty())
+	{
+		TextureResource *resource = this->uploadingTextures.front();
+		if (this->uploadLevels(resource, &budget, &uploaded))
+			break;
+		
+		this->uploadingTextures.erase(this->uploadingTextures.begin());
+	}
+	
+	// residency
+	this->statistics.textureCount = (unsigned int)this->textures.size();
+	this->statistics.residentByteCount = 0;
+	this->statistics.streamedTextureCount = 0;
+	for (TextureMap::iterator it = this->textures.begin(); it != this->textures.end(); ++it)
+	{
+		TextureResource *resource = it->second;
+		if (!resource->usable && !resource->pendingTexture)
+			continue;
+		
+		this->statistics.residentByteCount += getResidentSize(resource, resource->targetLevel);
+		if (resource->targetLevel < resource->tailLevel)
+			this->statistics.streamedTextureCount++;
+	}
+}
+
+unsigned int TextureManager::getResidentSize(const TextureResource *resource, unsigned int level)
+{
+	unsigned int size = 0;
+	for (unsigned int i = level; i < resource->levelCount; i++)
+		size += GraphicDriver::getTextureLevelSize(resource->format, std::max(resource->width >> i, 1u), std::max(resource->height >> i, 1u));
+	
+	return size;
+}
+
+void TextureManager::startLoad(TextureResource *resource, unsigned int level)
+{
+	resource->targetLevel = level;
+	
+	this->jobQueue->push(TextureManager::runLoadJob, resource, &resource->loadBatch);
+	this->loadingTextures.push_back(resource);
+}
+
+void TextureManager::startBuild(TextureResource *resource, unsigned int level)
+{
+	resource->targetLevel = level;
+	resource->pendingTexture = this->driver->createTexture();
+	resource->pendingUploadedLevelCount = 0;
+	
+	this->uploadingTextures.push_back(resource);
+}
+
+bool TextureManager::uploadLevels(TextureResource *resource, unsigned int *budget, bool *uploaded)
+{
+	const GraphicDriver::Capabilities &capabilities = this->driver->getCapabilities();
+	unsigned int baseLevel = resource->targetLevel;
+	unsigned int firstUploadedLevel = resource->levelCount - resource->pendingUploadedLevelCount;
+	unsigned int uploadedLevelCount = 0;
+	
+	while (firstUploadedLevel > baseLevel)
+	{
+		unsigned int level = firstUploadedLevel - 1;
+		std::vector<char> &data = resource->levels[level];
+		unsigned int size = (unsigned int)data.size();
+		
+		// the first upload of a frame ignores the budget, so that large levels still get through
+		if (*uploaded && size > *budget)
+			break;
+		
+		// the texture starts at the base level
+		unsigned int width = std::max(resource->width >> level, 1u);
+		unsigned int height = std::max(resource->height >> level, 1u);
+		this->driver->uploadTextureLevel(resource->pendingTexture, resource->format, level - baseLevel, width, height, &data[0]);
+		
+		// release the texels above the tail, the driver keeps its own copy
+		if (level < resource->tailLevel)
+		{
+			std::vector<char>().swap(data);
+			this->statistics.streamedLevelCount++;
+		}
+		
+		*budget = (size < *budget) ? *budget - size : 0;
+		*uploaded = true;
+		
+		firstUploadedLevel = level;
+		resource->pendingUploadedLevelCount++;
+		uploadedLevelCount++;
+	}
+	
+	unsigned int maxLevel = resource->levelCount - 1 - baseLevel;
+	bool complete = (firstUploadedLevel == baseLevel);
+	
+	if (complete)
+	{
+		// replace the previous texture, if any
+		this->driver->setTextureLevelRange(resource->pendingTexture, 0, maxLevel);
+		if (resource->texture && resource->texture != resource->pendingTexture)
+			this->driver->destroyTexture(resource->texture);
+		
+		resource->texture = resource->pendingTexture;
+		resource->pendingTexture = NULL;
+		resource->residentLevel = baseLevel;
+		resource->usable = true;
+	}
+	else if (uploadedLevelCount > 0 && capabilities.textureLevelRange && (!resource->texture || resource->texture == resource->pendingTexture))
+	{
+		// with nothing else to draw, sample the uploaded levels only
+		this->driver->setTextureLevelRange(resource->pendingTexture, firstUploadedLevel - baseLevel, maxLevel);
+		resource->texture = resource->pendingTexture;
+		resource->residentLevel = firstUploadedLevel;
+		resource->usable = true;
+	}
+	
+	return !complete;
+}
+
+bool TextureManager::makeRoom(unsigned int byteCount)
+{
+	// bytes above the tails, including the loads in progress
+	unsigned int usedByteCount = 0;
+	for (TextureMap::iterator it = this->textures.begin(); it != this->textures.end(); ++it)
+	{
+		TextureResource *resource = it->second;
+		if (resource->usable)
+			usedByteCount += getResidentSize(resource, resource->targetLevel) - getResidentSize(resource, resource->tailLevel);
+	}
+	
+	while (usedByteCount + byteCount > this->memoryBudget)
+	{
+		// least recently requested texture above its tail, and idle; textures
+		// requested in this frame are kept
+		TextureResource *victim = NULL;
+		for (TextureMap::iterator it = this->textures.begin(); it != this->textures.end(); ++it)
+		{
+			TextureResource *resource = it->second;
+			if (!resource->usable || resource->residentLevel >= resource->tailLevel || resource->targetLevel != resource->residentLevel || resource->pendingTexture)
+				continue;
+			
+			if (resource->lastRequestFrame < this->frameIndex && (!victim || resource->lastRequestFrame < victim->lastRequestFrame))
+				victim = resource;
+		}
+		
+		if (!victim)
+			return false;
+		
+		// the tail levels are still in memory
+		usedByteCount -= getResidentSize(victim, victim->residentLevel) - getResidentSize(victim, victim->tailLevel);
+		this->startBuild(victim, victim->tailLevel);
+		this->statistics.evictionCount++;
+	}
+	
+	return true;
+}
+
+void TextureManager::runLoadJob(void *userData)
+{
+	TextureResource *resource = (TextureResource *)userData;
+	
+	std::vector<char> content;
+	if (!File::read(resource->path, &content))
+	{
+		Log::error("Failed to open texture '%s'", resource->path.c_str());
+		resource->failed = true;
+		return;
+	}
+	
+	TextureFileReader reader(content);
+	
+	const char *magic = reader.read(4);
+	unsigned int version = 0;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int levelCount = 0;
+	unsigned int encodingCount = 0;
+	bool valid = (magic && memcmp(magic, textureMagic, 4) == 0);
+	valid = valid && reader.readInteger(&version) && version == textureVersion;
+	valid = valid && reader.readInteger(&width) && reader.readInteger(&height);
+	valid = valid && reader.readInteger(&levelCount) && reader.readInteger(&encodingCount);
+	valid = valid && width > 0 && height > 0 && levelCount > 0 && levelCount <= 16 && encodingCount > 0;
+	
+	// later loads read more levels of the same file
+	bool firstLoad = (resource->levelCount == 0);
+	valid = valid && (firstLoad || (width == resource->width && height == resource->height && levelCount == resource->levelCount));
+	if (!valid)
+	{
+		Log::error("Invalid texture file '%s'", resource->path.c_str());
+		resource->failed = true;
+		return;
+	}
+	
+	// take the first encoding the GPU supports, or decode the first one
+	const char *chosenLevels[16];
+	GraphicDriver::TextureFormat chosenFormat = GraphicDriver::TextureFormatCount;
+	for (unsigned int i = 0; i < encodingCount && valid; i++)
+	{
+		unsigned int format = 0;
+		valid = reader.readInteger(&format) && format < GraphicDriver::TextureFormatCount;
+		
+		const char *levels[16];
+		for (unsigned int level = 0; level < levelCount && valid; level++)
+		{
+			unsigned int levelWidth = std::max(width >> level, 1u);
+			unsigned int levelHeight = std::max(height >> level, 1u);
+			unsigned int size = 0;
+			
+			valid = reader.readInteger(&size) && size == GraphicDriver::getTextureLevelSize((GraphicDriver::TextureFormat)format, levelWidth, levelHeight);
+			levels[level] = valid ? reader.read(size) : NULL;
+			valid = valid && levels[level] != NULL;
+		}
+		
+		if (!valid)
+			break;
+		
+		bool supported = resource->capabilities->textureFormats[format];
+		if (chosenFormat == GraphicDriver::TextureFormatCount || (supported && !resource->capabilities->textureFormats[chosenFormat]))
+		{
+			chosenFormat = (GraphicDriver::TextureFormat)format;
+			std::copy(levels, levels + levelCount, chosenLevels);
+		}
+	}
+	
+	if (!valid)
+	{
+		Log::error("Truncated or corrupted texture file '%s'", resource->path.c_str());
+		resource->failed = true;
+		return;
+	}
+	
+	bool transcode = !resource->capabilities->textureFormats[chosenFormat];
+	
+	unsigned int firstLevel = resource->targetLevel;
+	unsigned int endLevel = resource->tailLevel;
+	if (firstLoad)
+	{
+		resource->width = width;
+		resource->height = height;
+		resource->levelCount = levelCount;
+		resource->format = transcode ? GraphicDriver::RGBA8TextureFormat : chosenFormat;
+		resource->levels.resize(levelCount);
+		
+		// the tail starts with the first level small enough, the whole texture may fit
+		resource->tailLevel = levelCount - 1;
+		while (resource->tailLevel > 0 && std::max(width >> (resource->tailLevel - 1), height >> (resource->tailLevel - 1)) <= tailSize)
+			resource->tailLevel--;
+		
+		resource->residentLevel = levelCount;
+		resource->targetLevel = resource->tailLevel;
+		firstLevel = resource->tailLevel;
+		endLevel = levelCount;
+	}
+	
+	for (unsigned int level = firstLevel; level < endLevel; level++)
+	{
+		unsigned int levelWidth = std::max(width >> level, 1u);
+		unsigned int levelHeight = std::max(height >> level, 1u);
+		std::vector<char> &data = resource->levels[level];
+		
+		if (transcode)
+		{
+			data.resize(GraphicDriver::getTextureLevelSize(GraphicDriver::RGBA8TextureFormat, levelWidth, levelHeight));
+			TextureDecoder::decode(chosenFormat, levelWidth, levelHeight, (const unsigned char *)chosenLevels[level], (unsigned char *)&data[0]);
+		}
+		else
+		{
+			unsigned int size = GraphicDriver::getTextureLevelSize(chosenFormat, levelWidth, levelHeight);
+			data.assign(chosenLevels[level], chosenLevels[level] + size);
+		}
+	}
+}
+
+} // oak namespace
@@ -0,0 +1,230 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/system/JobQueue.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace oak {
+
+class TextureManager;
+
+/**
+ * Texture loaded in the background by the texture manager.
+ *
+ * It can be drawn as soon as it is requested: until its smallest mipmap levels
+ * are uploaded, the default texture is used instead. Larger levels are then
+ * streamed in and out, following the levels requested while drawing.
+ */
+class TextureResource
+{
+	public:
+		const std::string &getPath() const { return this->path; }
+		
+		// once usable, the texture has a valid size and some levels on the GPU
+		bool isUsable() const { return this->usable; }
+		bool hasFailed() const { return this->failed; }
+		
+		// valid once usable
+		unsigned int getWidth() const { return this->width; }
+		unsigned int getHeight() const { return this->height; }
+		unsigned int getLevelCount() const { return this->levelCount; }
+		
+		// largest level available for sampling, levels are uploaded from the smallest one
+		unsigned int getResidentLevel() const { return this->residentLevel; }
+		
+		// texture to bind when drawing
+		Texture *getTexture() const { return this->usable ? this->texture : this->defaultTexture; }
+		
+		// Ask for the given level (and all smaller ones) to be resident; the
+		// largest level requested during a frame is streamed in for the next ones.
+		// Can be called concurrently, from record jobs.
+		void requestLevel(unsigned int level);
+	
+	private:
+		friend class TextureManager;
+		
+		TextureResource(const std::string &path, Texture *defaultTexture);
+		
+		std::string path;
+		
+		Texture *texture;
+		Texture *defaultTexture;
+		bool usable;
+		bool failed;
+		
+		unsigned int width;
+		unsigned int height;
+		unsigned int levelCount;
+		unsigned int residentLevel;
+		
+		// largest level once the current load or build is done
+		unsigned int targetLevel;
+		
+		// levels from this one are small enough to stay resident, and in memory
+		unsigned int tailLevel;
+		
+		// smallest level requested since the last update, and when it was last requested
+		volatile int requestedLevel;
+		unsigned int lastRequestFrame;
+		
+		// texture being built from the target level, replacing the current one once complete
+		Texture *pendingTexture;
+		unsigned int pendingUploadedLevelCount;
+		
+		// filled by the load jobs: levels ready for upload, from the largest one;
+		// the levels below the tail are released once uploaded
+		GraphicDriver::TextureFormat format;
+		std::vector<std::vector<char> > levels;
+		
+		// load job, reading (and transcoding) the levels from the target one to the tail,
+		// or the tail itself on the first load
+		JobQueue::Batch loadBatch;
+		const GraphicDriver::Capabilities *capabilities;
+};
+
+/**
+ * Loads cooked textures (.otex files, see tools/texture-cooker) without
+ * stalling frames, and streams their mipmap levels within a memory budget.
+ *
+ * Files are read, and decoded to RGBA8 when the GPU does not support their
+ * compressed format, by jobs on the job queue. Only the smallest levels (the
+ * tail) are loaded at first; the larger levels requested while drawing are
+ * then loaded, and the least recently requested textures are reduced back to
+ * their tail to stay within the memory budget.
+ *
+ * A texture is rebuilt from its new largest level each time it changes, so
+ * streaming does not depend on level range support. Levels are uploaded from
+ * the smallest one, within a byte budget per frame; when the driver can
+ * restrict sampling to the uploaded levels, textures are used right after their
+ * first upload and get sharper over the next frames.
+ */
+class TextureManager
+{
+	public:
+		TextureManager(GraphicDriver *driver, JobQueue *jobQueue);
+		~TextureManager();
+		
+		// start loading a texture file, or return the texture already loaded from it
+		TextureResource *load(const std::string &path);
+		
+		// Draw a texture created elsewhere (such as the color of a render target) like
+		// a loaded one. It is never streamed, and stays owned by its creator; the
+		// resource lives as long as the manager, and draws the default texture while
+		// it wraps none (NULL).
+		TextureResource *wrap(Texture *texture, unsigned int width, unsigned int height);
+		void setWrappedTexture(TextureResource *resource, Texture *texture, unsigned int width, unsigned int height);
+		
+		// whether a wrapped texture was drawn since the last call, not during recording
+		bool wasDrawn(TextureResource *resource);
+		
+		// bytes of texels sent to the driver per frame; a level larger than the
+		// budget is sent alone in a frame
+		unsigned int getUploadBudget() const { return this->uploadBudget; }
+		void setUploadBudget(unsigned int bytes) { this->uploadBudget = bytes; }
+		
+		// bytes of texture levels kept on the GPU beyond the tails of all textures
+		unsigned int getMemoryBudget() const { return this->memoryBudget; }
+		void setMemoryBudget(unsigned int bytes) { this->memoryBudget = bytes; }
+		
+		// white texture, drawn in place of textures not uploaded yet
+		Texture *getDefaultTexture() const { return this->defaultTexture; }
+		
+		// collect the loaded levels, apply the requests of the previous frame,
+		// and upload the next levels (once per recorded frame)
+		void update();
+		
+		struct Statistics
+		{
+			// current state
+			unsigned int textureCount;
+			unsigned int residentByteCount; // including the textures being built
+			unsigned int streamedTextureCount; // with levels above their tail
+			
+			// accumulated since the manager creation
+			unsigned int missCount; // requests of levels that were not resident
+			unsigned int evictionCount;
+			unsigned int streamedLevelCount;
+			
+			Statistics()
+				: textureCount(0)
+				, residentByteCount(0)
+				, streamedTextureCount(0)
+				, missCount(0)
+				, evictionCount(0)
+				, streamedLevelCount(0)
+			{}
+		};
+		const Statistics &getStatistics() const { return this->statistics; }
+	
+	private:
+		static void runLoadJob(void *userData);
+		
+		// bytes on the GPU for the levels from the given one
+		static unsigned int getResidentSize(const TextureResource *resource, unsigned int level);
+		
+		// load the levels from the given one up to the tail, then rebuild the texture
+		void startLoad(TextureResource *resource, unsigned int level);
+		
+		// rebuild the GPU texture from the given level, with the levels in memory
+		void startBuild(TextureResource *resource, unsigned int level);
+		
+		// returns false once all levels of the new texture are uploaded
+		bool uploadLevels(TextureResource *resource, unsigned int *budget, bool *uploaded);
+		
+		// reduce least recently requested textures to their tail, until the given
+		// bytes fit in the budget; returns false if they still do not fit
+		bool makeRoom(unsigned int byteCount);
+		
+		GraphicDriver *driver;
+		JobQueue *jobQueue;
+		
+		unsigned int uploadBudget;
+		unsigned int memoryBudget;
+		Texture *defaultTexture;
+		
+		// all textures, by path
+		typedef std::map<std::string, TextureResource *> TextureMap;
+		TextureMap textures;
+		
+		// textures being read, then being uploaded, in request order
+		typedef std::vector<TextureResource *> TextureVector;
+		TextureVector loadingTextures;
+		TextureVector uploadingTextures;
+		
+		// textures owned by others, not part of the streaming
+		TextureVector wrappedTextures;
+		
+		unsigned int frameIndex;
+		Statistics statistics;
+};
+
+} // oak namespace
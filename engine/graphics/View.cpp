@@ -25,22 +25,204 @@
 
 #include <engine/graphics/View.hpp>
 
+#include <engine/graphics/GraphicDriver.hpp>
 #include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/LightClusters.hpp>
+#include <engine/graphics/OcclusionBuffer.hpp>
+#include <engine/graphics/ShadowMaps.hpp>
+#include <engine/graphics/SpriteBatcher.hpp>
+#include <engine/graphics/TextureManager.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/components/Terrain.hpp>
+
+#include <engine/sg/Entity.hpp>
+
+#include <glm/ext.hpp>
 
 namespace oak {
 
-View::View(GraphicWorld *graphicWorld)
+View::View(GraphicWorld *graphicWorld, GraphicDriver *driver, TextureManager *textureManager)
 	: graphicWorld(graphicWorld)
+	, driver(driver)
+	, textureManager(textureManager)
 	, priority(0)
 	, enabled(true)
 	, camera(NULL)
+	, renderTarget(NULL)
+	, targetWidth(0)
+	, targetHeight(0)
+	, targetRendered(false)
+	, fogDensity(0.0f)
+{
+	this->targetTexture = this->textureManager->wrap(NULL, 0, 0);
+	
+	this->lightClusters = new LightClusters(driver);
+	this->shadowMaps = new ShadowMaps(driver);
+	this->occlusionBuffer = new OcclusionBuffer;
+	this->spriteBatcher = new SpriteBatcher(driver, textureManager->getDefaultTexture());
+}
+
+View::~View()
+{
+	this->setTargetSize(0, 0);
+	
+	delete this->lightClusters;
+	delete this->shadowMaps;
+	delete this->occlusionBuffer;
+	delete this->spriteBatcher;
+}
+
+void View::setTargetSize(unsigned int width, unsigned int height)
+{
+	if (width == this->targetWidth && height == this->targetHeight)
+		return;
+	
+	// frames still being replayed keep the previous target, destructions run in frame order
+	if (this->renderTarget)
+		this->driver->destroyRenderTarget(this->renderTarget);
+	
+	this->renderTarget = NULL;
+	this->targetWidth = 0;
+	this->targetHeight = 0;
+	this->textureManager->setWrappedTexture(this->targetTexture, NULL, 0, 0);
+	
+	if (width == 0 || height == 0)
+		return;
+	
+	this->renderTarget = this->driver->createRenderTarget(width, height);
+	this->targetWidth = width;
+	this->targetHeight = height;
+	this->targetRendered = false;
+	
+	// clamped, textures of any size can then be sampled on GLES2
+	Texture *texture = this->driver->getRenderTargetTexture(this->renderTarget);
+	this->driver->setTextureSampling(texture, true, false);
+	this->textureManager->setWrappedTexture(this->targetTexture, texture, width, height);
+}
+
+bool View::isTargetNeeded()
+{
+	// a frame late: the texture is drawn as it was when it comes back into sight
+	bool drawn = this->textureManager->wasDrawn(this->targetTexture);
+	bool needed = drawn || !this->targetRendered;
+	this->targetRendered = true;
+	
+	return needed;
+}
+
+void View::binLights(unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	if (this->enabled && this->camera)
+		this->lightClusters->bin(this->graphicWorld->getLights(), this->camera, targetWidth, targetHeight, jobQueue, batch);
+}
+
+void View::uploadLights()
+{
+	if (this->enabled && this->camera)
+		this->lightClusters->upload();
+}
+
+void View::rasterizeOccluders(unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch)
+{
+	if (this->enabled && this->camera)
+		this->occlusionBuffer->rasterize(this->graphicWorld->getOccluders(), this->camera, targetWidth, targetHeight, jobQueue, batch);
+}
+
+void View::updateShadows()
+{
+	if (this->enabled && this->camera)
+		this->shadowMaps->update(this->graphicWorld, this->camera);
+}
+
+unsigned int View::getUpdatedShadowMapCount() const
+{
+	if (this->enabled && this->camera)
+		return this->shadowMaps->getUpdatedMapCount();
+	
+	return 0;
+}
+
+void View::recordShadowMap(CommandList *commandList, unsigned int updatedMap) const
 {
+	this->shadowMaps->recordMap(commandList, this->graphicWorld, updatedMap);
+}
+
+void View::prepareRecord(float fogDensity, unsigned int targetHeight, unsigned int framesInFlight)
+{
+	if (this->enabled && this->camera)
+		this->graphicWorld->updateRenderList(&this->renderList, this->camera, this->occlusionBuffer, targetHeight, framesInFlight);
+	this->fogDensity = fogDensity;
+}
+
+void View::recordViewConstants(CommandList *commandList)
+{
+	if (this->enabled && this->camera)
+		this->graphicWorld->recordViewConstants(commandList, &this->renderList, this->camera, this->lightClusters, this->shadowMaps, this->fogDensity);
 }
 
-void View::render(GraphicDriver *driver)
+unsigned int View::getRenderChunkCount() const
 {
 	if (this->enabled && this->camera)
-		this->graphicWorld->render(driver, this->camera);
+		return (unsigned int)this->renderList.chunks.size();
+	
+	return 0;
+}
+
+void View::recordRenderChunk(CommandList *commandList, unsigned int chunk) const
+{
+	this->graphicWorld->recordRenderChunk(commandList, this->renderList.chunks[chunk]);
+}
+
+void View::recordTranslucent(CommandList *commandList, unsigned int targetHeight)
+{
+	if (this->enabled && this->camera)
+		this->graphicWorld->recordTranslucent(commandList, this->camera, this->lightClusters, this->shadowMaps, this->occlusionBuffer, &this->renderList, targetHeight, this->fogDensity);
+}
+
+void View::recordParticles(CommandList *commandList, const ParticleEmitter *emitter, unsigned int firstParticle, unsigned int particleCount, unsigned int targetHeight, StreamBuffer *streamBuffer)
+{
+	if (this->enabled && this->camera)
+		this->spriteBatcher->recordParticles(commandList, emitter, firstParticle, particleCount, this->camera, targetHeight, streamBuffer);
+}
+
+void View::recordTerrain(CommandList *commandList, const Terrain *terrain)
+{
+	if (this->enabled && this->camera)
+		terrain->record(commandList, this->camera, this->lightClusters, this->shadowMaps, this->fogDensity, this->textureManager->getDefaultTexture());
+}
+
+void View::recordSprites(CommandList *commandList, unsigned int targetHeight, StreamBuffer *streamBuffer)
+{
+	if (!this->enabled || !this->camera)
+		return;
+	
+	this->spriteBatcher->record(commandList, this->graphicWorld->getSprites(), this->camera, targetHeight, streamBuffer);
+	
+	#ifdef OAK_DEBUG
+		const DebugDraw *debugDraw = this->graphicWorld->getDebugDraw();
+		if (debugDraw->hasLines())
+			debugDraw->recordLines(commandList, this->getViewProjectionMatrix(), streamBuffer);
+	#endif // OAK_DEBUG
+}
+
+void View::recordTexts(CommandList *commandList, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer)
+{
+	if (!this->enabled || !this->camera)
+		return;
+	
+	this->spriteBatcher->recordTexts(commandList, this->graphicWorld->getTexts(), glyphAtlas, width, height, streamBuffer);
+	
+	#ifdef OAK_DEBUG
+		const DebugDraw *debugDraw = this->graphicWorld->getDebugDraw();
+		if (debugDraw->hasLabels())
+			this->spriteBatcher->recordLabels(commandList, debugDraw->getLabels(), this->getViewProjectionMatrix(), glyphAtlas, width, height, streamBuffer);
+	#endif // OAK_DEBUG
+}
+
+glm::mat4 View::getViewProjectionMatrix() const
+{
+	const glm::mat4 &cameraTransform = this->camera->getEntity()->getLocalTransform();
+	return this->camera->getProjectionMatrix() * glm::affineInverse(cameraTransform);
 }
 
 } // oak namespace
@@ -25,18 +25,113 @@
 
 #pragma once
 
+#include <engine/graphics/DebugDraw.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <engine/system/JobQueue.hpp>
+
+#include <vector>
+
 namespace oak {
 
 class Camera;
+class CommandList;
+class GlyphAtlas;
 class GraphicDriver;
-class GraphicWorld;
+class LightClusters;
+class OcclusionBuffer;
+class ParticleEmitter;
+struct RenderTarget;
+class ShadowMaps;
+class SpriteBatcher;
+class StreamBuffer;
+class Terrain;
+class TextureManager;
+class TextureResource;
 
 class View
 {
 	public:
-		View(GraphicWorld *graphicWorld);
+		View(GraphicWorld *graphicWorld, GraphicDriver *driver, TextureManager *textureManager);
+		~View();
+		
+		GraphicWorld *getGraphicWorld() const { return this->graphicWorld; }
+		
+		// Draw into a texture of the given size instead of the screen, or back into the
+		// screen with a size of 0. Other views can draw the texture, but not this one;
+		// the ones with a higher priority see it in the same frame.
+		void setTargetSize(unsigned int width, unsigned int height);
+		unsigned int getTargetWidth() const { return this->targetWidth; }
+		unsigned int getTargetHeight() const { return this->targetHeight; }
+		
+		// NULL while drawing into the screen
+		RenderTarget *getRenderTarget() const { return this->renderTarget; }
+		
+		// texture drawn into, for the components of other views; it draws the
+		// default texture while the view draws into the screen
+		TextureResource *getTargetTexture() const { return this->targetTexture; }
+		
+		// Whether the target texture was drawn during the last frame, or never drawn
+		// into yet; views whose texture is not seen can be skipped (once per frame).
+		bool isTargetNeeded();
+		
+		// assign the lights of the graphic world to the clusters of the camera, with
+		// jobs pushed in the given batch, then upload them once it is done
+		void binLights(unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch);
+		void uploadLights();
+		
+		// rasterize the occluders of the graphic world for the camera, with jobs
+		// pushed in the given batch, which must be done before recording
+		void rasterizeOccluders(unsigned int targetWidth, unsigned int targetHeight, JobQueue *jobQueue, JobQueue::Batch *batch);
+		
+		// place the shadow cascades for the camera, then record the maps to
+		// redraw this frame, each in its own list (see ShadowMaps)
+		void updateShadows();
+		unsigned int getUpdatedShadowMapCount() const;
+		void recordShadowMap(CommandList *commandList, unsigned int updatedMap) const;
+		
+		// Update the render list with the changes of the graphic world and the
+		// camera, for a target of the given height, before recording; the materials
+		// then write the visibility through fog of the given density, added by the
+		// post-processing (0 without). Command lists recorded again are only reused
+		// after the given number of frames in flight.
+		void prepareRecord(float fogDensity, unsigned int targetHeight, unsigned int framesInFlight);
 		
-		void render(GraphicDriver *driver);
+		// Record the constants of the view, then each chunk of opaque renderables
+		// into its own list (see GraphicWorld::updateRenderList()): only the chunks
+		// marked as changed are recorded, the lists of the others are replayed as
+		// they are. Chunks can be recorded concurrently.
+		void recordViewConstants(CommandList *commandList);
+		unsigned int getRenderChunkCount() const;
+		CommandList *getRenderChunkList(unsigned int chunk) const { return this->renderList.chunks[chunk]->commandList; }
+		bool isRenderChunkChanged(unsigned int chunk) const { return this->renderList.chunks[chunk]->changed; }
+		void recordRenderChunk(CommandList *commandList, unsigned int chunk) const;
+		
+		// hand the command lists of the render list over, frames in flight may still
+		// replay them (see GraphicsEngine::destroyView())
+		void releaseCommandLists(std::vector<CommandList *> *commandLists) { this->renderList.releaseCommandLists(commandLists); }
+		
+		// record the translucent renderables of the graphic world, after the opaque
+		// ones (see GraphicWorld::recordTranslucent)
+		bool hasTranslucent() const { return !this->renderList.translucentHandles.empty(); }
+		void recordTranslucent(CommandList *commandList, unsigned int targetHeight);
+		
+		// record a range of the particles of an emitter of the graphic world, batched
+		// into the given stream buffer; ranges can be recorded concurrently
+		void recordParticles(CommandList *commandList, const ParticleEmitter *emitter, unsigned int firstParticle, unsigned int particleCount, unsigned int targetHeight, StreamBuffer *streamBuffer);
+		
+		// record a terrain of the graphic world (see Terrain::record)
+		void recordTerrain(CommandList *commandList, const Terrain *terrain);
+		
+		// record the sprites of the graphic world, then its debug lines, batched into the
+		// given stream buffer, to be drawn over the renderables (see SpriteBatcher)
+		bool hasSprites() const { return !this->graphicWorld->getSprites().empty() || this->graphicWorld->getDebugDraw()->hasLines(); }
+		void recordSprites(CommandList *commandList, unsigned int targetHeight, StreamBuffer *streamBuffer);
+		
+		// record the texts of the graphic world over the sprites, then its debug labels,
+		// placed in pixels of a view of the given size, whatever the size really drawn into
+		bool hasTexts() const { return !this->graphicWorld->getTexts().empty() || this->graphicWorld->getDebugDraw()->hasLabels(); }
+		void recordTexts(CommandList *commandList, const GlyphAtlas *glyphAtlas, unsigned int width, unsigned int height, StreamBuffer *streamBuffer);
 		
 		// views with lower priority gets rendered first
 		int getPriority() const { return this->priority; }
@@ -49,11 +144,31 @@ class View
 		void setCamera(Camera *camera) { this->camera = camera; }
 		
 	private:
+		glm::mat4 getViewProjectionMatrix() const;
+		
 		GraphicWorld *graphicWorld;
+		GraphicDriver *driver;
+		TextureManager *textureManager;
 		int priority;
 		bool enabled;
 		
 		Camera *camera;
+		
+		RenderTarget *renderTarget;
+		unsigned int targetWidth;
+		unsigned int targetHeight;
+		TextureResource *targetTexture;
+		bool targetRendered;
+		
+		float fogDensity; // this frame
+		
+		LightClusters *lightClusters;
+		ShadowMaps *shadowMaps;
+		OcclusionBuffer *occlusionBuffer;
+		SpriteBatcher *spriteBatcher;
+		
+		// kept recorded from one frame to the next, with the levels of detail
+		GraphicWorld::RenderList renderList;
 };
 
 } // oak namespace
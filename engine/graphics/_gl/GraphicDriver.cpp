@@ -27,7 +27,9 @@
 
 #include <engine/graphics/_gl/gl_includes.hpp>
 #include <engine/graphics/_gl/GraphicDriverState.hpp>
+#include <engine/graphics/_gl/RenderTarget.hpp>
 #include <engine/graphics/_gl/ShaderProgram.hpp>
+#include <engine/graphics/_gl/Texture.hpp>
 #include <engine/graphics/_gl/VertexBuffer.hpp>
 
 #include <engine/system/Log.hpp>
@@ -35,6 +37,28 @@
 #include <glm/glm.hpp>
 
 #include <cstddef>
+#include <cstring>
+#include <string>
+
+// compressed texture formats, not always defined by GLES2 headers
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#	define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#	define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#	define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_ETC1_RGB8_OES
+#	define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#	define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#	define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
 
 namespace oak {
 
@@ -42,6 +66,11 @@ namespace { // private section
 
 const unsigned int maxInfoLogLength = 2048;
 
+#ifdef OAK_GL_BUFFER_SYNC
+	// upper bound of the wait for a streaming region still read by the GPU, in nanoseconds
+	const GLuint64 streamFenceTimeout = 1000000000;
+#endif
+
 GLuint compileShader(GLenum type, const std::string &code)
 {
 	GLuint name = GL_CHECK(glCreateShader(type));
@@ -80,6 +109,254 @@ GLuint compileShader(GLenum type, const std::string &code)
 	return name;
 }
 
+void uploadVertexBuffer(VertexBuffer *buffer, const void *data, unsigned int size)
+{
+	GL_CHECK(glGenBuffers(1, &buffer->name));
+	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, buffer->name));
+	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, size, data, buffer->streaming ? GL_STREAM_DRAW : GL_STATIC_DRAW));
+}
+
+void releaseVertexBuffer(VertexBuffer *buffer)
+{
+	#ifdef OAK_GL_BUFFER_SYNC
+		for (unsigned int i = 0; i < buffer->regionFences.size(); i++)
+		{
+			if (buffer->regionFences[i])
+				GL_CHECK(glDeleteSync(buffer->regionFences[i]));
+		}
+	#endif
+	
+	GL_CHECK(glDeleteBuffers(1, &buffer->name));
+	delete buffer;
+}
+
+void detectCapabilities(GraphicDriver::Capabilities *capabilities)
+{
+	for (unsigned int i = 0; i < GraphicDriver::TextureFormatCount; i++)
+		capabilities->textureFormats[i] = false;
+	capabilities->textureFormats[GraphicDriver::RGBA8TextureFormat] = true;
+	
+	#if defined(ANDROID) || defined(EMSCRIPTEN)
+		// GLES2 and WebGL only expose compressed formats through extensions
+		const char *extensionString = (const char *)GL_CHECK(glGetString(GL_EXTENSIONS));
+		std::string extensions = extensionString ? extensionString : "";
+		
+		bool s3tc = (extensions.find("texture_compression_s3tc") != std::string::npos || extensions.find("compressed_texture_s3tc") != std::string::npos);
+		bool dxt1 = (s3tc || extensions.find("texture_compression_dxt1") != std::string::npos);
+		bool etc1 = (extensions.find("compressed_ETC1_RGB8_texture") != std::string::npos || extensions.find("compressed_texture_etc1") != std::string::npos);
+		
+		capabilities->textureFormats[GraphicDriver::BC1TextureFormat] = dxt1;
+		capabilities->textureFormats[GraphicDriver::BC2TextureFormat] = s3tc;
+		capabilities->textureFormats[GraphicDriver::BC3TextureFormat] = s3tc;
+		capabilities->textureFormats[GraphicDriver::ETC1TextureFormat] = etc1;
+		
+		// base and max levels appeared with GLES3
+		capabilities->textureLevelRange = false;
+		
+		GLint vectors = 0;
+		GL_CHECK(glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &vectors));
+		capabilities->vertexConstantVectors = (unsigned int)vectors;
+	#else
+		bool s3tc = (GLEW_EXT_texture_compression_s3tc != GL_FALSE);
+		bool etc2 = (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility);
+		
+		capabilities->textureFormats[GraphicDriver::BC1TextureFormat] = s3tc;
+		capabilities->textureFormats[GraphicDriver::BC2TextureFormat] = s3tc;
+		capabilities->textureFormats[GraphicDriver::BC3TextureFormat] = s3tc;
+		
+		// ETC2 decoders also read ETC1 data
+		capabilities->textureFormats[GraphicDriver::ETC1TextureFormat] = etc2;
+		capabilities->textureFormats[GraphicDriver::ETC2RGBTextureFormat] = etc2;
+		capabilities->textureFormats[GraphicDriver::ETC2RGBATextureFormat] = etc2;
+		
+		capabilities->textureLevelRange = true;
+		
+		GLint components = 0;
+		GL_CHECK(glGetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS, &components));
+		capabilities->vertexConstantVectors = (unsigned int)components / 4;
+	#endif
+}
+
+GLenum getCompressedTextureFormat(GraphicDriver::TextureFormat format)
+{
+	switch (format)
+	{
+		case GraphicDriver::BC1TextureFormat: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case GraphicDriver::BC2TextureFormat: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		case GraphicDriver::BC3TextureFormat: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		
+		#if defined(ANDROID) || defined(EMSCRIPTEN)
+			case GraphicDriver::ETC1TextureFormat: return GL_ETC1_RGB8_OES;
+		#else
+			case GraphicDriver::ETC1TextureFormat: return GL_COMPRESSED_RGB8_ETC2;
+		#endif
+		
+		case GraphicDriver::ETC2RGBTextureFormat: return GL_COMPRESSED_RGB8_ETC2;
+		case GraphicDriver::ETC2RGBATextureFormat: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+		default: break;
+	}
+	
+	return 0;
+}
+
+void createTextureObject(Texture *texture)
+{
+	GL_CHECK(glGenTextures(1, &texture->name));
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+}
+
+void releaseTexture(GraphicDriverState *state, Texture *texture)
+{
+	for (unsigned int i = 0; i < maxTextureUnits; i++)
+	{
+		if (state->currentTextures[i] == texture)
+			state->currentTextures[i] = NULL;
+	}
+	
+	GL_CHECK(glDeleteTextures(1, &texture->name));
+	delete texture;
+}
+
+void uploadTextureData(Texture *texture, GraphicDriver::TextureFormat format, unsigned int level, unsigned int width, unsigned int height, const void *data)
+{
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	
+	if (GraphicDriver::isCompressedTextureFormat(format))
+	{
+		GLsizei size = GraphicDriver::getTextureLevelSize(format, width, height);
+		GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, level, getCompressedTextureFormat(format), width, height, 0, size, data));
+	}
+	else
+	{
+		GL_CHECK(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	}
+}
+
+void uploadTextureRegionData(Texture *texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data)
+{
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	
+	// rows are tightly packed, whatever their width
+	GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+}
+
+// expects the texture to be bound
+void applyMinificationFilter(const Texture *texture)
+{
+	GLint filter = texture->filtered ? GL_LINEAR : GL_NEAREST;
+	if (texture->mipmapped)
+		filter = texture->filtered ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+}
+
+void applyTextureLevelRange(const GraphicDriverState *state, Texture *texture, unsigned int baseLevel, unsigned int maxLevel)
+{
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	
+	if (state->capabilities.textureLevelRange)
+	{
+		#if !defined(ANDROID) && !defined(EMSCRIPTEN)
+			GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel));
+			GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel));
+		#endif
+	}
+	
+	texture->mipmapped = (maxLevel > baseLevel);
+	applyMinificationFilter(texture);
+}
+
+void applyTextureSampling(Texture *texture, bool filtered, bool repeated)
+{
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, repeated ? GL_REPEAT : GL_CLAMP_TO_EDGE));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, repeated ? GL_REPEAT : GL_CLAMP_TO_EDGE));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtered ? GL_LINEAR : GL_NEAREST));
+	
+	texture->filtered = filtered;
+	applyMinificationFilter(texture);
+}
+
+void createRenderTargetObjects(const GraphicDriverState *state, RenderTarget *target)
+{
+	createTextureObject(target->texture);
+	GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, target->width, target->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+	
+	GL_CHECK(glGenRenderbuffers(1, &target->depthBufferName));
+	GL_CHECK(glBindRenderbuffer(GL_RENDERBUFFER, target->depthBufferName));
+	GL_CHECK(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, target->width, target->height));
+	
+	GL_CHECK(glGenFramebuffers(1, &target->framebufferName));
+	GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, target->framebufferName));
+	GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture->name, 0));
+	GL_CHECK(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depthBufferName));
+	
+	GLenum status = GL_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		Log::error("Render target of %ux%u is incomplete (status 0x%x)", target->width, target->height, status);
+	
+	// back to the framebuffer in use
+	GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, state->currentTarget ? state->currentTarget->framebufferName : state->screenFramebuffer));
+}
+
+void releaseRenderTarget(GraphicDriverState *state, RenderTarget *target)
+{
+	OAK_ASSERT(state->currentTarget != target, "Destroying the render target in use");
+	
+	GL_CHECK(glDeleteFramebuffers(1, &target->framebufferName));
+	GL_CHECK(glDeleteRenderbuffers(1, &target->depthBufferName));
+	releaseTexture(state, target->texture);
+	delete target;
+}
+
+void linkShaderProgram(ShaderProgram *program, const std::string &vertexCode, const std::string &fragmentCode)
+{
+	program->programName = GL_CHECK(glCreateProgram());
+	program->vertexShaderName = compileShader(GL_VERTEX_SHADER, vertexCode);
+	program->fragmentShaderName = compileShader(GL_FRAGMENT_SHADER, fragmentCode);
+	
+	GL_CHECK(glAttachShader(program->programName, program->vertexShaderName));
+	GL_CHECK(glAttachShader(program->programName, program->fragmentShaderName));
+	GL_CHECK(glLinkProgram(program->programName));
+	
+	// check link status
+	GLint linkStatus;
+	GL_CHECK(glGetProgramiv(program->programName, GL_LINK_STATUS, &linkStatus));
+	if (linkStatus != GL_TRUE)
+	{
+		char errorLog[maxInfoLogLength];
+		GLsizei length;
+		GL_CHECK(glGetProgramInfoLog(program->programName, maxInfoLogLength, &length, errorLog));
+		
+		Log::error("Failed to link shader program:");
+		Log::error("%s", errorLog);
+	}
+}
+
+void releaseShaderProgram(GraphicDriverState *state, ShaderProgram *program)
+{
+	if (state->currentShader == program)
+		state->currentShader = NULL;
+	
+	GL_CHECK(glDeleteShader(program->vertexShaderName));
+	GL_CHECK(glDeleteShader(program->fragmentShaderName));
+	GL_CHECK(glDeleteProgram(program->programName));
+	delete program;
+}
+
+void queueResourceOperation(GraphicDriverState *state, const ResourceOperation &operation)
+{
+	MutexLock lock(&state->resourceMutex);
+	state->resourceOperations.push_back(operation);
+	state->queuedOperationCount++;
+}
+
 } // end of private section
 
 GraphicDriver::GraphicDriver()
@@ -92,6 +369,13 @@ GraphicDriver::GraphicDriver()
 	GL_CHECK(glEnable(GL_DEPTH_TEST));
 	
 	this->state = new GraphicDriverState;
+	detectCapabilities(&this->state->capabilities);
+	
+	#ifdef OAK_GL_BUFFER_SYNC
+		this->state->unsynchronizedMapping = (GLEW_VERSION_3_2 || (GLEW_ARB_map_buffer_range && GLEW_ARB_sync));
+	#endif
+	
+	Log::info("Streaming buffers use %s", this->state->unsynchronizedMapping ? "unsynchronized mapping" : "orphaning");
 }
 
 GraphicDriver::~GraphicDriver()
@@ -101,7 +385,8 @@ GraphicDriver::~GraphicDriver()
 
 void GraphicDriver::setClearColor(const glm::vec3 &color)
 {
-	GL_CHECK(glClearColor(color.x, color.y, color.z, 0.0f));
+	// opaque, the alpha of the scene is the visibility through the fog
+	GL_CHECK(glClearColor(color.x, color.y, color.z, 1.0f));
 }
 
 void GraphicDriver::setClearDepth(float depth)
@@ -115,11 +400,20 @@ void GraphicDriver::setClearDepth(float depth)
 
 void GraphicDriver::clear(bool colorBuffer, bool depthBuffer)
 {
+	// clears ignore the viewport, but not the scissor box
+	GLint viewport[4];
+	GL_CHECK(glGetIntegerv(GL_VIEWPORT, viewport));
+	GL_CHECK(glScissor(viewport[0], viewport[1], viewport[2], viewport[3]));
+	GL_CHECK(glEnable(GL_SCISSOR_TEST));
+	
 	GLuint clearFlags = 0;
 	clearFlags |= colorBuffer ? GL_COLOR_BUFFER_BIT : 0;
 	clearFlags |= depthBuffer ? GL_DEPTH_BUFFER_BIT : 0;
 	
 	GL_CHECK(glClear(clearFlags));
+	GL_CHECK(glDisable(GL_SCISSOR_TEST));
+	
+	this->state->statistics.clearCount++;
 }
 
 VertexBuffer *GraphicDriver::createVertexBuffer(void *data, unsigned int size, VertexFormat format, unsigned int elementCount)
@@ -130,22 +424,144 @@ VertexBuffer *GraphicDriver::createVertexBuffer(void *data, unsigned int size, V
 	buffer->format = format;
 	buffer->elementCount = elementCount;
 	
-	GL_CHECK(glGenBuffers(1, &buffer->name));
-	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, buffer->name));
-	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateVertexBuffer;
+		operation.buffer = buffer;
+		operation.bufferData.assign((const char *)data, (const char *)data + size);
+		operation.bufferSize = size;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		uploadVertexBuffer(buffer, data, size);
+		this->state->statistics.resourceOperationCount++;
+	}
 	
 	return buffer;
 }
 
 void GraphicDriver::destroyVertexBuffer(VertexBuffer *buffer)
 {
-	GL_CHECK(glDeleteBuffers(1, &buffer->name));
-	delete buffer;
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyVertexBuffer;
+		operation.buffer = buffer;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseVertexBuffer(buffer);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+VertexBuffer *GraphicDriver::createStreamingVertexBuffer(VertexFormat format, unsigned int elementCount, unsigned int regionCount)
+{
+	OAK_ASSERT(elementCount > 0 && regionCount > 0, "Streaming vertex buffers need at least one region of one element");
+	
+	VertexBuffer *buffer = new VertexBuffer;
+	buffer->format = format;
+	buffer->elementCount = elementCount;
+	buffer->streaming = true;
+	buffer->regionCount = regionCount;
+	
+	// the last region is considered written, so that the first one is filled first
+	buffer->currentRegion = regionCount - 1;
+	
+	#ifdef OAK_GL_BUFFER_SYNC
+		buffer->regionFences.resize(regionCount, NULL);
+	#endif
+	
+	unsigned int size = getVertexSize(format) * elementCount * regionCount;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateVertexBuffer;
+		operation.buffer = buffer;
+		operation.bufferSize = size;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		uploadVertexBuffer(buffer, NULL, size);
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return buffer;
+}
+
+void GraphicDriver::streamVertexBuffer(VertexBuffer *buffer, const void *data, unsigned int elementCount)
+{
+	OAK_ASSERT(buffer->streaming, "Only streaming vertex buffers can be written after their creation");
+	OAK_ASSERT(elementCount <= buffer->elementCount, "Streaming more vertices than a region can hold");
+	
+	unsigned int regionSize = getVertexSize(buffer->format) * buffer->elementCount;
+	unsigned int size = getVertexSize(buffer->format) * elementCount;
+	unsigned int previousRegion = buffer->currentRegion;
+	unsigned int region = (previousRegion + 1) % buffer->regionCount;
+	
+	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, buffer->name));
+	
+	#ifdef OAK_GL_BUFFER_SYNC
+		if (this->state->unsynchronizedMapping)
+		{
+			// the draws issued so far are the last ones reading the previous region
+			if (buffer->regionFences[previousRegion])
+				GL_CHECK(glDeleteSync(buffer->regionFences[previousRegion]));
+			buffer->regionFences[previousRegion] = GL_CHECK(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+			
+			// the region about to be overwritten was read frames ago, its fence is normally signaled
+			GLsync fence = buffer->regionFences[region];
+			if (fence)
+			{
+				GLenum result = GL_CHECK(glClientWaitSync(fence, 0, 0));
+				if (result == GL_TIMEOUT_EXPIRED)
+				{
+					this->state->statistics.streamStallCount++;
+					GL_CHECK(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, streamFenceTimeout));
+				}
+				
+				GL_CHECK(glDeleteSync(fence));
+				buffer->regionFences[region] = NULL;
+			}
+			
+			if (size > 0)
+			{
+				void *destination = GL_CHECK(glMapBufferRange(GL_ARRAY_BUFFER, region * regionSize, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+				if (destination)
+				{
+					memcpy(destination, data, size);
+					GL_CHECK(glUnmapBuffer(GL_ARRAY_BUFFER));
+				}
+			}
+		}
+		else
+	#endif
+		{
+			// without fences, give the storage away when wrapping around: the driver
+			// allocates a fresh one instead of waiting for the pending draws
+			if (region == 0)
+				GL_CHECK(glBufferData(GL_ARRAY_BUFFER, regionSize * buffer->regionCount, NULL, GL_STREAM_DRAW));
+			
+			if (size > 0)
+				GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, region * regionSize, size, data));
+		}
+	
+	buffer->currentRegion = region;
+	this->state->statistics.streamedByteCount += size;
 }
 
 void GraphicDriver::bindVertexBuffer(VertexBuffer *buffer)
 {
 	GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, buffer->name));
+	this->state->statistics.vertexBufferBindCount++;
+	
+	// streaming buffers are read from their current region
+	size_t base = getVertexSize(buffer->format) * buffer->elementCount * buffer->currentRegion;
 	
 	// TODO: bind to vertex attibutes
 	ShaderProgram *currentShader = this->state->currentShader;
@@ -157,7 +573,7 @@ void GraphicDriver::bindVertexBuffer(VertexBuffer *buffer)
 			{
 				GLint positionAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "position"));
 				GL_CHECK(glEnableVertexAttribArray(positionAttribute));
-				GL_CHECK(glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, 0));
+				GL_CHECK(glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid *)base));
 				break;
 			}
 			
@@ -167,21 +583,89 @@ void GraphicDriver::bindVertexBuffer(VertexBuffer *buffer)
 				if (positionAttribute != -1)
 				{
 					GL_CHECK(glEnableVertexAttribArray(positionAttribute));
-					GL_CHECK(glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)offsetof(Standard3DVertex, position)));
+					GL_CHECK(glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)(base + offsetof(Standard3DVertex, position))));
+				}
+				
+				GLint normalAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "normal"));
+				if (normalAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(normalAttribute));
+					GL_CHECK(glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)(base + offsetof(Standard3DVertex, normal))));
+				}
+				
+				GLint uvAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "uv"));
+				if (uvAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(uvAttribute));
+					GL_CHECK(glVertexAttribPointer(uvAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)(base + offsetof(Standard3DVertex, uv))));
+				}
+				
+				break;
+			}
+			
+			case SpriteVertexFormat:
+			{
+				GLint positionAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "position"));
+				if (positionAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(positionAttribute));
+					GL_CHECK(glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (const GLvoid *)(base + offsetof(SpriteVertex, position))));
+				}
+				
+				GLint uvAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "uv"));
+				if (uvAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(uvAttribute));
+					GL_CHECK(glVertexAttribPointer(uvAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (const GLvoid *)(base + offsetof(SpriteVertex, uv))));
+				}
+				
+				// bytes read as [0, 1] values
+				GLint colorAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "color"));
+				if (colorAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(colorAttribute));
+					GL_CHECK(glVertexAttribPointer(colorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (const GLvoid *)(base + offsetof(SpriteVertex, color))));
+				}
+				
+				break;
+			}
+			
+			case SkinnedVertexFormat:
+			{
+				GLint positionAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "position"));
+				if (positionAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(positionAttribute));
+					GL_CHECK(glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (const GLvoid *)(base + offsetof(SkinnedVertex, position))));
 				}
 				
 				GLint normalAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "normal"));
 				if (normalAttribute != -1)
 				{
 					GL_CHECK(glEnableVertexAttribArray(normalAttribute));
-					GL_CHECK(glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)offsetof(Standard3DVertex, normal)));
+					GL_CHECK(glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (const GLvoid *)(base + offsetof(SkinnedVertex, normal))));
 				}
 				
 				GLint uvAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "uv"));
 				if (uvAttribute != -1)
 				{
 					GL_CHECK(glEnableVertexAttribArray(uvAttribute));
-					GL_CHECK(glVertexAttribPointer(uvAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Standard3DVertex), (const GLvoid *)offsetof(Standard3DVertex, uv)));
+					GL_CHECK(glVertexAttribPointer(uvAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (const GLvoid *)(base + offsetof(SkinnedVertex, uv))));
+				}
+				
+				// bone indices as integral values, weights in [0, 1]
+				GLint bonesAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "bones"));
+				if (bonesAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(bonesAttribute));
+					GL_CHECK(glVertexAttribPointer(bonesAttribute, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(SkinnedVertex), (const GLvoid *)(base + offsetof(SkinnedVertex, bones))));
+				}
+				
+				GLint weightsAttribute = GL_CHECK(glGetAttribLocation(currentShader->programName, "weights"));
+				if (weightsAttribute != -1)
+				{
+					GL_CHECK(glEnableVertexAttribArray(weightsAttribute));
+					GL_CHECK(glVertexAttribPointer(weightsAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinnedVertex), (const GLvoid *)(base + offsetof(SkinnedVertex, weights))));
 				}
 				
 				break;
@@ -190,29 +674,250 @@ void GraphicDriver::bindVertexBuffer(VertexBuffer *buffer)
 	}
 }
 
-ShaderProgram *GraphicDriver::createShaderProgram(const std::string &vertexCode, const std::string &fragmentCode)
+const GraphicDriver::Capabilities &GraphicDriver::getCapabilities() const
 {
-	ShaderProgram *program = new ShaderProgram;
+	return this->state->capabilities;
+}
+
+Texture *GraphicDriver::createTexture()
+{
+	Texture *texture = new Texture;
 	
-	program->programName = GL_CHECK(glCreateProgram());
-	program->vertexShaderName = compileShader(GL_VERTEX_SHADER, vertexCode);
-	program->fragmentShaderName = compileShader(GL_FRAGMENT_SHADER, fragmentCode);
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateTexture;
+		operation.texture = texture;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		createTextureObject(texture);
+		this->state->statistics.resourceOperationCount++;
+	}
 	
-	GL_CHECK(glAttachShader(program->programName, program->vertexShaderName));
-	GL_CHECK(glAttachShader(program->programName, program->fragmentShaderName));
-	GL_CHECK(glLinkProgram(program->programName));
+	return texture;
+}
+
+void GraphicDriver::destroyTexture(Texture *texture)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyTexture;
+		operation.texture = texture;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseTexture(this->state, texture);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+void GraphicDriver::uploadTextureLevel(Texture *texture, TextureFormat format, unsigned int level, unsigned int width, unsigned int height, const void *data)
+{
+	OAK_ASSERT(this->state->capabilities.textureFormats[format], "Uploading a texture format not supported by the GPU");
 	
-	// check link status
-	GLint linkStatus;
-	GL_CHECK(glGetProgramiv(program->programName, GL_LINK_STATUS, &linkStatus));
-	if (linkStatus != GL_TRUE)
+	unsigned int size = getTextureLevelSize(format, width, height);
+	
+	if (this->state->deferResourceOperations)
 	{
-		char errorLog[maxInfoLogLength];
-		GLsizei length;
-		GL_CHECK(glGetProgramInfoLog(program->programName, maxInfoLogLength, &length, errorLog));
+		ResourceOperation operation;
+		operation.type = ResourceOperation::UploadTextureLevel;
+		operation.texture = texture;
+		operation.textureFormat = format;
+		operation.level = level;
+		operation.width = width;
+		operation.height = height;
+		operation.bufferData.assign((const char *)data, (const char *)data + size);
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		uploadTextureData(texture, format, level, width, height, data);
+		this->state->statistics.resourceOperationCount++;
+		this->state->statistics.uploadedTextureByteCount += size;
+	}
+}
+
+void GraphicDriver::uploadTextureRegion(Texture *texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data)
+{
+	unsigned int size = getTextureLevelSize(RGBA8TextureFormat, width, height);
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::UploadTextureRegion;
+		operation.texture = texture;
+		operation.x = x;
+		operation.y = y;
+		operation.width = width;
+		operation.height = height;
+		operation.bufferData.assign((const char *)data, (const char *)data + size);
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		uploadTextureRegionData(texture, x, y, width, height, data);
+		this->state->statistics.resourceOperationCount++;
+		this->state->statistics.uploadedTextureByteCount += size;
+	}
+}
+
+void GraphicDriver::setTextureLevelRange(Texture *texture, unsigned int baseLevel, unsigned int maxLevel)
+{
+	OAK_ASSERT(baseLevel <= maxLevel, "Invalid texture level range");
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::SetTextureLevelRange;
+		operation.texture = texture;
+		operation.level = baseLevel;
+		operation.maxLevel = maxLevel;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		applyTextureLevelRange(this->state, texture, baseLevel, maxLevel);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+void GraphicDriver::setTextureSampling(Texture *texture, bool filtered, bool repeated)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::SetTextureSampling;
+		operation.texture = texture;
+		operation.filtered = filtered;
+		operation.repeated = repeated;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		applyTextureSampling(texture, filtered, repeated);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+RenderTarget *GraphicDriver::createRenderTarget(unsigned int width, unsigned int height)
+{
+	RenderTarget *target = new RenderTarget;
+	target->texture = new Texture;
+	target->width = width;
+	target->height = height;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateRenderTarget;
+		operation.renderTarget = target;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		createRenderTargetObjects(this->state, target);
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return target;
+}
+
+void GraphicDriver::destroyRenderTarget(RenderTarget *target)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyRenderTarget;
+		operation.renderTarget = target;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseRenderTarget(this->state, target);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+Texture *GraphicDriver::getRenderTargetTexture(RenderTarget *target)
+{
+	return target->texture;
+}
+
+void GraphicDriver::bindRenderTarget(RenderTarget *target)
+{
+	if (target == this->state->currentTarget)
+		return;
+	
+	// remember where the screen was drawn, to get back to it
+	if (!this->state->currentTarget)
+	{
+		GL_CHECK(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &this->state->screenFramebuffer));
+		GL_CHECK(glGetIntegerv(GL_VIEWPORT, this->state->screenViewport));
+	}
+	
+	if (target)
+	{
+		// sampling the texture being drawn into is undefined
+		for (unsigned int i = 0; i < maxTextureUnits; i++)
+		{
+			if (this->state->currentTextures[i] == target->texture)
+			{
+				GL_CHECK(glActiveTexture(GL_TEXTURE0 + i));
+				GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+				this->state->currentTextures[i] = NULL;
+			}
+		}
 		
-		Log::error("Failed to link shader program:");
-		Log::error("%s", errorLog);
+		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, target->framebufferName));
+		GL_CHECK(glViewport(0, 0, target->width, target->height));
+	}
+	else
+	{
+		const GLint *viewport = this->state->screenViewport;
+		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, this->state->screenFramebuffer));
+		GL_CHECK(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+	}
+	
+	this->state->currentTarget = target;
+	this->state->statistics.renderTargetBindCount++;
+}
+
+void GraphicDriver::setViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	GL_CHECK(glViewport(x, y, width, height));
+}
+
+void GraphicDriver::bindTexture(Texture *texture, unsigned int unit)
+{
+	OAK_ASSERT(unit < maxTextureUnits, "Texture unit out of range");
+	
+	GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->name));
+	this->state->currentTextures[unit] = texture;
+	this->state->statistics.textureBindCount++;
+}
+
+ShaderProgram *GraphicDriver::createShaderProgram(const std::string &vertexCode, const std::string &fragmentCode)
+{
+	ShaderProgram *program = new ShaderProgram;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateShaderProgram;
+		operation.program = program;
+		operation.vertexCode = vertexCode;
+		operation.fragmentCode = fragmentCode;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		linkShaderProgram(program, vertexCode, fragmentCode);
+		this->state->statistics.resourceOperationCount++;
 	}
 	
 	return program;
@@ -220,19 +925,34 @@ ShaderProgram *GraphicDriver::createShaderProgram(const std::string &vertexCode,
 
 void GraphicDriver::destroyShaderProgram(ShaderProgram *program)
 {
-	if (this->state->currentShader == program)
-		this->state->currentShader = NULL;
-	
-	GL_CHECK(glDeleteShader(program->vertexShaderName));
-	GL_CHECK(glDeleteShader(program->fragmentShaderName));
-	GL_CHECK(glDeleteProgram(program->programName));
-	delete program;
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyShaderProgram;
+		operation.program = program;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseShaderProgram(this->state, program);
+		this->state->statistics.resourceOperationCount++;
+	}
 }
 
 void GraphicDriver::bindShaderProgram(ShaderProgram *program)
 {
 	this->state->currentShader = program;
 	GL_CHECK(glUseProgram(program->programName));
+	this->state->statistics.shaderBindCount++;
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, int value)
+{
+	OAK_ASSERT(this->state->currentShader != NULL, "No shader is bound, cannot set shader constant");
+	
+	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
+	GL_CHECK(glUniform1i(location, value));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::setShaderConstant(const std::string &name, float value)
@@ -241,6 +961,7 @@ void GraphicDriver::setShaderConstant(const std::string &name, float value)
 	
 	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
 	GL_CHECK(glUniform1f(location, value));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec2 &value)
@@ -249,6 +970,7 @@ void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec2 &
 	
 	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
 	GL_CHECK(glUniform2f(location, value.x, value.y));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec3 &value)
@@ -257,6 +979,16 @@ void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec3 &
 	
 	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
 	GL_CHECK(glUniform3f(location, value.x, value.y, value.z));
+	this->state->statistics.shaderConstantCount++;
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec4 &value)
+{
+	OAK_ASSERT(this->state->currentShader != NULL, "No shader is bound, cannot set shader constant");
+	
+	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
+	GL_CHECK(glUniform4f(location, value.x, value.y, value.z, value.w));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat3 &value)
@@ -265,6 +997,7 @@ void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat3 &
 	
 	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
 	GL_CHECK(glUniformMatrix3fv(location, 1, GL_FALSE, &value[0].x));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat4 &value)
@@ -273,6 +1006,16 @@ void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat4 &
 	
 	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
 	GL_CHECK(glUniformMatrix4fv(location, 1, GL_FALSE, &value[0].x));
+	this->state->statistics.shaderConstantCount++;
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec4 *values, unsigned int count)
+{
+	OAK_ASSERT(this->state->currentShader != NULL, "No shader is bound, cannot set shader constant");
+	
+	GLint location = GL_CHECK(glGetUniformLocation(this->state->currentShader->programName, name.c_str()));
+	GL_CHECK(glUniform4fv(location, count, &values[0].x));
+	this->state->statistics.shaderConstantCount++;
 }
 
 void GraphicDriver::draw(PrimitiveType primitiveType, unsigned int startElement, unsigned int elementCount)
@@ -282,9 +1025,147 @@ void GraphicDriver::draw(PrimitiveType primitiveType, unsigned int startElement,
 	{
 		case TriangleStrip: glPrimitiveType = GL_TRIANGLE_STRIP; break;
 		case Triangles: glPrimitiveType = GL_TRIANGLES; break;
+		case Lines: glPrimitiveType = GL_LINES; break;
 	}
 	
 	GL_CHECK(glDrawArrays(glPrimitiveType, startElement, elementCount));
+	
+	this->state->statistics.drawCount++;
+	this->state->statistics.drawnElementCount += elementCount;
+}
+
+void GraphicDriver::setBlendMode(BlendMode mode)
+{
+	switch (mode)
+	{
+		case OpaqueBlend:
+			GL_CHECK(glDisable(GL_BLEND));
+			break;
+		
+		case AlphaBlend:
+			GL_CHECK(glEnable(GL_BLEND));
+			GL_CHECK(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE));
+			break;
+		
+		case AdditiveBlend:
+			GL_CHECK(glEnable(GL_BLEND));
+			GL_CHECK(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE));
+			break;
+	}
+	
+	GL_CHECK(glDepthMask(mode == OpaqueBlend ? GL_TRUE : GL_FALSE));
+}
+
+void GraphicDriver::setDeferredResourceOperations(bool deferred)
+{
+	// operations queued so far must not be skipped
+	if (!deferred)
+		this->executeResourceOperations(this->markResourceOperations());
+	
+	this->state->deferResourceOperations = deferred;
+}
+
+unsigned int GraphicDriver::markResourceOperations()
+{
+	MutexLock lock(&this->state->resourceMutex);
+	return this->state->queuedOperationCount;
+}
+
+void GraphicDriver::executeResourceOperations(unsigned int marker)
+{
+	while (true)
+	{
+		ResourceOperation operation;
+		
+		{
+			MutexLock lock(&this->state->resourceMutex);
+			
+			// the marker is compared as a difference, to be robust to counter wrap-around
+			if (this->state->resourceOperations.empty() || (int)(marker - this->state->executedOperationCount) <= 0)
+				return;
+			
+			// vertex and texel data are moved out rather than copied
+			ResourceOperation &front = this->state->resourceOperations.front();
+			std::vector<char> data;
+			data.swap(front.bufferData);
+			operation = front;
+			operation.bufferData.swap(data);
+			
+			this->state->resourceOperations.pop_front();
+			this->state->executedOperationCount++;
+		}
+		
+		switch (operation.type)
+		{
+			case ResourceOperation::CreateVertexBuffer:
+				uploadVertexBuffer(operation.buffer, operation.bufferData.empty() ? NULL : &operation.bufferData[0], operation.bufferSize);
+				break;
+			
+			case ResourceOperation::DestroyVertexBuffer:
+				releaseVertexBuffer(operation.buffer);
+				break;
+			
+			case ResourceOperation::CreateShaderProgram:
+				linkShaderProgram(operation.program, operation.vertexCode, operation.fragmentCode);
+				break;
+			
+			case ResourceOperation::DestroyShaderProgram:
+				releaseShaderProgram(this->state, operation.program);
+				break;
+			
+			case ResourceOperation::CreateTexture:
+				createTextureObject(operation.texture);
+				break;
+			
+			case ResourceOperation::DestroyTexture:
+				releaseTexture(this->state, operation.texture);
+				break;
+			
+			case ResourceOperation::UploadTextureLevel:
+				uploadTextureData(operation.texture, operation.textureFormat, operation.level, operation.width, operation.height, &operation.bufferData[0]);
+				this->state->statistics.uploadedTextureByteCount += (unsigned int)operation.bufferData.size();
+				break;
+			
+			case ResourceOperation::UploadTextureRegion:
+				uploadTextureRegionData(operation.texture, operation.x, operation.y, operation.width, operation.height, &operation.bufferData[0]);
+				this->state->statistics.uploadedTextureByteCount += (unsigned int)operation.bufferData.size();
+				break;
+			
+			case ResourceOperation::SetTextureLevelRange:
+				applyTextureLevelRange(this->state, operation.texture, operation.level, operation.maxLevel);
+				break;
+			
+			case ResourceOperation::SetTextureSampling:
+				applyTextureSampling(operation.texture, operation.filtered, operation.repeated);
+				break;
+			
+			case ResourceOperation::CreateRenderTarget:
+				createRenderTargetObjects(this->state, operation.renderTarget);
+				break;
+			
+			case ResourceOperation::DestroyRenderTarget:
+				releaseRenderTarget(this->state, operation.renderTarget);
+				break;
+		}
+		
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+const GraphicDriver::Statistics &GraphicDriver::getStatistics() const
+{
+	return this->state->statistics;
+}
+
+void GraphicDriver::resetStatistics()
+{
+	this->state->statistics = Statistics();
+}
+
+void GraphicDriver::setCommandTrace(bool enabled)
+{
+	if (enabled)
+		Log::warning("Command traces are not supported by the GL driver");
 }
 
 } // oak namespace
@@ -28,15 +28,112 @@
 #include <engine/graphics/GraphicDriver.hpp>
 #include <engine/graphics/_gl/gl_includes.hpp>
 
+#include <engine/system/Mutex.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+
 namespace oak {
 
+// the minimum supported by GLES2 fragment shaders
+const unsigned int maxTextureUnits = 8;
+
+// resource creation or destruction, queued in deferred mode
+struct ResourceOperation
+{
+	enum Type
+	{
+		CreateVertexBuffer,
+		DestroyVertexBuffer,
+		CreateShaderProgram,
+		DestroyShaderProgram,
+		CreateTexture,
+		DestroyTexture,
+		UploadTextureLevel,
+		UploadTextureRegion,
+		SetTextureLevelRange,
+		SetTextureSampling,
+		CreateRenderTarget,
+		DestroyRenderTarget
+	};
+	Type type;
+	
+	VertexBuffer *buffer;
+	std::vector<char> bufferData; // vertices or texels, empty for streaming buffers
+	unsigned int bufferSize;
+	
+	ShaderProgram *program;
+	
+	Texture *texture;
+	RenderTarget *renderTarget;
+	GraphicDriver::TextureFormat textureFormat;
+	unsigned int level; // base level for level ranges
+	unsigned int maxLevel;
+	unsigned int x; // of texture regions
+	unsigned int y;
+	unsigned int width;
+	unsigned int height;
+	bool filtered;
+	bool repeated;
+	std::string vertexCode;
+	std::string fragmentCode;
+	
+	ResourceOperation()
+		: type(CreateVertexBuffer)
+		, buffer(NULL)
+		, bufferSize(0)
+		, program(NULL)
+		, texture(NULL)
+		, renderTarget(NULL)
+		, textureFormat(GraphicDriver::RGBA8TextureFormat)
+		, level(0)
+		, maxLevel(0)
+		, x(0)
+		, y(0)
+		, width(0)
+		, height(0)
+		, filtered(true)
+		, repeated(true)
+	{}
+};
+
 struct GraphicDriverState
 {
 	ShaderProgram *currentShader;
+	Texture *currentTextures[maxTextureUnits];
+	
+	// screen framebuffer and viewport, restored when unbinding render targets
+	RenderTarget *currentTarget;
+	GLint screenFramebuffer;
+	GLint screenViewport[4];
+	
+	GraphicDriver::Statistics statistics;
+	GraphicDriver::Capabilities capabilities;
+	
+	// streaming buffers are written through unsynchronized mappings guarded by
+	// fences when supported, and by orphaning their storage otherwise
+	bool unsynchronizedMapping;
+	
+	// deferred resource operations
+	bool deferResourceOperations;
+	Mutex resourceMutex;
+	std::deque<ResourceOperation> resourceOperations;
+	unsigned int queuedOperationCount;
+	unsigned int executedOperationCount;
 	
 	GraphicDriverState()
 		: currentShader(NULL)
-	{}
+		, currentTarget(NULL)
+		, screenFramebuffer(0)
+		, unsynchronizedMapping(false)
+		, deferResourceOperations(false)
+		, queuedOperationCount(0)
+		, executedOperationCount(0)
+	{
+		for (unsigned int i = 0; i < maxTextureUnits; i++)
+			this->currentTextures[i] = NULL;
+	}
 };
 
 } // oak namespace
@@ -28,18 +28,33 @@
 #include <engine/graphics/GraphicDriver.hpp>
 #include <engine/graphics/_gl/gl_includes.hpp>
 
+#include <vector>
+
 namespace oak {
 
 struct VertexBuffer
 {
 	GLuint name;
 	GraphicDriver::VertexFormat format;
-	unsigned int elementCount;
+	unsigned int elementCount; // per region for streaming buffers
+	
+	// streaming buffers are split in regions, written in turn
+	bool streaming;
+	unsigned int regionCount;
+	unsigned int currentRegion;
+	
+	#ifdef OAK_GL_BUFFER_SYNC
+		// fences signaled once the GPU is done with the draws reading each region
+		std::vector<GLsync> regionFences;
+	#endif
 	
 	VertexBuffer()
 		: name(0)
 		, format(GraphicDriver::Simple2DVertexFormat)
 		, elementCount(0)
+		, streaming(false)
+		, regionCount(1)
+		, currentRegion(0)
 	{}
 };
 
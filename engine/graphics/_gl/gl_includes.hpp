@@ -31,7 +31,11 @@
 #	include <GLES2/gl2ext.h>
 #else
 #	include <GL/glew.h>
-#	include <GL/glfw.h>
+#endif
+
+// unsynchronized buffer mapping and fences are not available in GLES2 and WebGL
+#if !defined(ANDROID) && !defined(EMSCRIPTEN)
+#	define OAK_GL_BUFFER_SYNC
 #endif
 
 // gl error debugging
@@ -39,6 +43,8 @@
 
 #	include <engine/system/Log.hpp>
 
+#	include <string>
+
 	namespace oak {
 	inline void checkGLError(const char *callString, const char *filename, int line)
 	{
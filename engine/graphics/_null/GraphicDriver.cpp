@@ -0,0 +1,760 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/graphics/_null/GraphicDriverState.hpp>
+#include <engine/graphics/_null/RenderTarget.hpp>
+#include <engine/graphics/_null/ShaderProgram.hpp>
+#include <engine/graphics/_null/Texture.hpp>
+#include <engine/graphics/_null/VertexBuffer.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <sstream>
+
+// The null driver implements the whole driver API without any graphics context.
+// Commands are validated and counted, and optionally traced, but never reach a GPU;
+// this allows to measure the CPU side of rendering on machines without display.
+
+namespace oak {
+
+namespace { // private section
+
+const char *getPrimitiveTypeName(GraphicDriver::PrimitiveType primitiveType)
+{
+	switch (primitiveType)
+	{
+		case GraphicDriver::TriangleStrip: return "TriangleStrip";
+		case GraphicDriver::Triangles: return "Triangles";
+		case GraphicDriver::Lines: return "Lines";
+	}
+	
+	return "Unknown";
+}
+
+const char *getBlendModeName(GraphicDriver::BlendMode mode)
+{
+	switch (mode)
+	{
+		case GraphicDriver::OpaqueBlend: return "OpaqueBlend";
+		case GraphicDriver::AlphaBlend: return "AlphaBlend";
+		case GraphicDriver::AdditiveBlend: return "AdditiveBlend";
+	}
+	
+	return "Unknown";
+}
+
+void releaseShaderProgram(GraphicDriverState *state, ShaderProgram *program)
+{
+	if (state->currentShader == program)
+		state->currentShader = NULL;
+	
+	delete program;
+}
+
+void releaseVertexBuffer(GraphicDriverState *state, VertexBuffer *buffer)
+{
+	if (state->currentBuffer == buffer)
+		state->currentBuffer = NULL;
+	
+	delete buffer;
+}
+
+void releaseTexture(GraphicDriverState *state, Texture *texture)
+{
+	for (unsigned int i = 0; i < maxTextureUnits; i++)
+	{
+		if (state->currentTextures[i] == texture)
+			state->currentTextures[i] = NULL;
+	}
+	
+	delete texture;
+}
+
+void createRenderTargetObjects(RenderTarget *target)
+{
+	// the color texture is defined with the target
+	target->created = true;
+	target->texture->created = true;
+	target->texture->definedLevels = 1;
+	target->texture->width = target->width;
+	target->texture->height = target->height;
+}
+
+void releaseRenderTarget(GraphicDriverState *state, RenderTarget *target)
+{
+	OAK_ASSERT(state->currentTarget != target, "Destroying the render target in use");
+	
+	releaseTexture(state, target->texture);
+	delete target;
+}
+
+void defineTextureLevel(Texture *texture, unsigned int level, unsigned int width, unsigned int height)
+{
+	OAK_ASSERT(texture->created, "Uploading to a texture before its creation was executed");
+	texture->definedLevels |= (1 << level);
+	
+	if (level == 0)
+	{
+		texture->width = width;
+		texture->height = height;
+	}
+}
+
+void checkTextureRegion(const Texture *texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	OAK_ASSERT(texture->created, "Uploading to a texture before its creation was executed");
+	OAK_ASSERT((texture->definedLevels & 1) != 0, "Uploading a texture region before defining the first level");
+	OAK_ASSERT(x + width <= texture->width && y + height <= texture->height, "Texture region out of bounds");
+}
+
+bool isPowerOfTwo(unsigned int value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+void queueResourceOperation(GraphicDriverState *state, const ResourceOperation &operation)
+{
+	MutexLock lock(&state->resourceMutex);
+	state->resourceOperations.push_back(operation);
+	state->queuedOperationCount++;
+}
+
+void traceShaderConstant(GraphicDriverState *state, const std::string &name, const std::string &value)
+{
+	OAK_ASSERT(state->currentShader != NULL, "No shader is bound, cannot set shader constant");
+	
+	state->statistics.shaderConstantCount++;
+	
+	if (state->commandTrace)
+		Log::info("setShaderConstant %s = %s", name.c_str(), value.c_str());
+}
+
+std::string formatFloats(const float *values, unsigned int count)
+{
+	std::ostringstream result;
+	result << "(";
+	for (unsigned int i = 0; i < count; i++)
+		result << (i > 0 ? ", " : "") << values[i];
+	result << ")";
+	
+	return result.str();
+}
+
+} // end of private section
+
+GraphicDriver::GraphicDriver()
+{
+	this->state = new GraphicDriverState;
+	
+	// only plain textures, compressed ones go through the software decoders
+	for (unsigned int i = 0; i < TextureFormatCount; i++)
+		this->state->capabilities.textureFormats[i] = false;
+	this->state->capabilities.textureFormats[RGBA8TextureFormat] = true;
+	this->state->capabilities.textureLevelRange = true;
+	this->state->capabilities.vertexConstantVectors = 256;
+}
+
+GraphicDriver::~GraphicDriver()
+{
+	delete this->state;
+}
+
+void GraphicDriver::setClearColor(const glm::vec3 &color)
+{
+	if (this->state->commandTrace)
+		Log::info("setClearColor %s", formatFloats(&color.x, 3).c_str());
+}
+
+void GraphicDriver::setClearDepth(float depth)
+{
+	if (this->state->commandTrace)
+		Log::info("setClearDepth %g", depth);
+}
+
+void GraphicDriver::clear(bool colorBuffer, bool depthBuffer)
+{
+	this->state->statistics.clearCount++;
+	
+	if (this->state->commandTrace)
+		Log::info("clear color=%d depth=%d", colorBuffer ? 1 : 0, depthBuffer ? 1 : 0);
+}
+
+VertexBuffer *GraphicDriver::createVertexBuffer(void *data, unsigned int size, VertexFormat format, unsigned int elementCount)
+{
+	OAK_ASSERT((size % elementCount) == 0, "Vertex buffer size is not aligned on a vertex boundary");
+	
+	VertexBuffer *buffer = new VertexBuffer;
+	buffer->format = format;
+	buffer->elementCount = elementCount;
+	buffer->size = size;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateVertexBuffer;
+		operation.buffer = buffer;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		buffer->created = true;
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return buffer;
+}
+
+void GraphicDriver::destroyVertexBuffer(VertexBuffer *buffer)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyVertexBuffer;
+		operation.buffer = buffer;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseVertexBuffer(this->state, buffer);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+VertexBuffer *GraphicDriver::createStreamingVertexBuffer(VertexFormat format, unsigned int elementCount, unsigned int regionCount)
+{
+	OAK_ASSERT(elementCount > 0 && regionCount > 0, "Streaming vertex buffers need at least one region of one element");
+	
+	VertexBuffer *buffer = new VertexBuffer;
+	buffer->format = format;
+	buffer->elementCount = elementCount;
+	buffer->size = getVertexSize(format) * elementCount * regionCount;
+	buffer->streaming = true;
+	buffer->regionCount = regionCount;
+	buffer->currentRegion = regionCount - 1;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateVertexBuffer;
+		operation.buffer = buffer;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		buffer->created = true;
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return buffer;
+}
+
+void GraphicDriver::streamVertexBuffer(VertexBuffer *buffer, const void *data, unsigned int elementCount)
+{
+	OAK_ASSERT(buffer->created, "Streaming to a vertex buffer before its creation was executed");
+	OAK_ASSERT(buffer->streaming, "Only streaming vertex buffers can be written after their creation");
+	OAK_ASSERT(elementCount <= buffer->elementCount, "Streaming more vertices than a region can hold");
+	OAK_ASSERT(data != NULL || elementCount == 0, "Streaming vertices without data");
+	
+	buffer->currentRegion = (buffer->currentRegion + 1) % buffer->regionCount;
+	buffer->streamedElementCount = elementCount;
+	this->state->statistics.streamedByteCount += getVertexSize(buffer->format) * elementCount;
+	
+	if (this->state->commandTrace)
+		Log::info("streamVertexBuffer %p region %u (%u elements)", buffer, buffer->currentRegion, elementCount);
+}
+
+void GraphicDriver::bindVertexBuffer(VertexBuffer *buffer)
+{
+	OAK_ASSERT(buffer->created, "Binding a vertex buffer before its creation was executed");
+	
+	this->state->currentBuffer = buffer;
+	this->state->statistics.vertexBufferBindCount++;
+	
+	if (this->state->commandTrace)
+		Log::info("bindVertexBuffer %p (%u elements)", buffer, buffer->elementCount);
+}
+
+const GraphicDriver::Capabilities &GraphicDriver::getCapabilities() const
+{
+	return this->state->capabilities;
+}
+
+Texture *GraphicDriver::createTexture()
+{
+	Texture *texture = new Texture;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateTexture;
+		operation.texture = texture;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		texture->created = true;
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return texture;
+}
+
+void GraphicDriver::destroyTexture(Texture *texture)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyTexture;
+		operation.texture = texture;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseTexture(this->state, texture);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+void GraphicDriver::uploadTextureLevel(Texture *texture, TextureFormat format, unsigned int level, unsigned int width, unsigned int height, const void *data)
+{
+	OAK_ASSERT(this->state->capabilities.textureFormats[format], "Uploading a texture format not supported by the GPU");
+	OAK_ASSERT(data != NULL, "Uploading a texture level without data");
+	OAK_ASSERT(level < 32, "Texture level out of range");
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::UploadTextureLevel;
+		operation.texture = texture;
+		operation.textureFormat = format;
+		operation.level = level;
+		operation.width = width;
+		operation.height = height;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		defineTextureLevel(texture, level, width, height);
+		this->state->statistics.resourceOperationCount++;
+		this->state->statistics.uploadedTextureByteCount += getTextureLevelSize(format, width, height);
+	}
+	
+	if (this->state->commandTrace)
+		Log::info("uploadTextureLevel %p level %u (%ux%u)", texture, level, width, height);
+}
+
+void GraphicDriver::uploadTextureRegion(Texture *texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data)
+{
+	OAK_ASSERT(data != NULL, "Uploading a texture region without data");
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::UploadTextureRegion;
+		operation.texture = texture;
+		operation.x = x;
+		operation.y = y;
+		operation.width = width;
+		operation.height = height;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		checkTextureRegion(texture, x, y, width, height);
+		this->state->statistics.resourceOperationCount++;
+		this->state->statistics.uploadedTextureByteCount += getTextureLevelSize(RGBA8TextureFormat, width, height);
+	}
+	
+	if (this->state->commandTrace)
+		Log::info("uploadTextureRegion %p (%u, %u, %ux%u)", texture, x, y, width, height);
+}
+
+void GraphicDriver::setTextureLevelRange(Texture *texture, unsigned int baseLevel, unsigned int maxLevel)
+{
+	OAK_ASSERT(baseLevel <= maxLevel, "Invalid texture level range");
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::SetTextureLevelRange;
+		operation.texture = texture;
+		operation.level = baseLevel;
+		operation.maxLevel = maxLevel;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		texture->baseLevel = baseLevel;
+		texture->maxLevel = maxLevel;
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+void GraphicDriver::setTextureSampling(Texture *texture, bool filtered, bool repeated)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::SetTextureSampling;
+		operation.texture = texture;
+		operation.repeated = repeated;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		texture->repeated = repeated;
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+RenderTarget *GraphicDriver::createRenderTarget(unsigned int width, unsigned int height)
+{
+	RenderTarget *target = new RenderTarget;
+	target->texture = new Texture;
+	target->width = width;
+	target->height = height;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateRenderTarget;
+		operation.renderTarget = target;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		createRenderTargetObjects(target);
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return target;
+}
+
+void GraphicDriver::destroyRenderTarget(RenderTarget *target)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyRenderTarget;
+		operation.renderTarget = target;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseRenderTarget(this->state, target);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+Texture *GraphicDriver::getRenderTargetTexture(RenderTarget *target)
+{
+	return target->texture;
+}
+
+void GraphicDriver::bindRenderTarget(RenderTarget *target)
+{
+	OAK_ASSERT(!target || target->created, "Binding a render target before its creation was executed");
+	
+	if (target == this->state->currentTarget)
+		return;
+	
+	this->state->currentTarget = target;
+	this->state->statistics.renderTargetBindCount++;
+	
+	// like GL drivers, which cannot sample it while drawing into it
+	for (unsigned int i = 0; target && i < maxTextureUnits; i++)
+	{
+		if (this->state->currentTextures[i] == target->texture)
+			this->state->currentTextures[i] = NULL;
+	}
+	
+	if (this->state->commandTrace)
+	{
+		if (target)
+			Log::info("bindRenderTarget %ux%u", target->width, target->height);
+		else
+			Log::info("bindRenderTarget screen");
+	}
+}
+
+void GraphicDriver::setViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	RenderTarget *target = this->state->currentTarget;
+	OAK_ASSERT(!target || (x + width <= target->width && y + height <= target->height), "Viewport out of the render target");
+	
+	if (this->state->commandTrace)
+		Log::info("setViewport %u %u %u %u", x, y, width, height);
+}
+
+void GraphicDriver::bindTexture(Texture *texture, unsigned int unit)
+{
+	OAK_ASSERT(texture->created, "Binding a texture before its creation was executed");
+	OAK_ASSERT(unit < maxTextureUnits, "Texture unit out of range");
+	
+	// sampling levels that were never uploaded would read undefined texels
+	for (unsigned int level = texture->baseLevel; level <= texture->maxLevel; level++)
+		OAK_ASSERT(texture->definedLevels & (1 << level), "Binding a texture whose sampled levels are not all uploaded");
+	
+	bool powerOfTwo = isPowerOfTwo(texture->width) && isPowerOfTwo(texture->height);
+	OAK_ASSERT(powerOfTwo || (!texture->repeated && texture->maxLevel == texture->baseLevel), "Textures whose size is not a power of two cannot be repeated or mipmapped on GLES2");
+	
+	this->state->currentTextures[unit] = texture;
+	this->state->statistics.textureBindCount++;
+	
+	if (this->state->commandTrace)
+		Log::info("bindTexture %p unit %u", texture, unit);
+}
+
+ShaderProgram *GraphicDriver::createShaderProgram(const std::string &vertexCode, const std::string &fragmentCode)
+{
+	ShaderProgram *program = new ShaderProgram;
+	program->id = this->state->nextShaderId++;
+	
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::CreateShaderProgram;
+		operation.program = program;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		program->created = true;
+		this->state->statistics.resourceOperationCount++;
+	}
+	
+	return program;
+}
+
+void GraphicDriver::destroyShaderProgram(ShaderProgram *program)
+{
+	if (this->state->deferResourceOperations)
+	{
+		ResourceOperation operation;
+		operation.type = ResourceOperation::DestroyShaderProgram;
+		operation.program = program;
+		queueResourceOperation(this->state, operation);
+	}
+	else
+	{
+		releaseShaderProgram(this->state, program);
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+void GraphicDriver::bindShaderProgram(ShaderProgram *program)
+{
+	OAK_ASSERT(program->created, "Binding a shader program before its creation was executed");
+	
+	this->state->currentShader = program;
+	this->state->statistics.shaderBindCount++;
+	
+	if (this->state->commandTrace)
+		Log::info("bindShaderProgram %u", program->id);
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, int value)
+{
+	std::ostringstream formattedValue;
+	if (this->state->commandTrace)
+		formattedValue << value;
+	
+	traceShaderConstant(this->state, name, formattedValue.str());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, float value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value, 1) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec2 &value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value.x, 2) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec3 &value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value.x, 3) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec4 &value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value.x, 4) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat3 &value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value[0].x, 9) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::mat4 &value)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&value[0].x, 16) : std::string());
+}
+
+void GraphicDriver::setShaderConstant(const std::string &name, const glm::vec4 *values, unsigned int count)
+{
+	traceShaderConstant(this->state, name, this->state->commandTrace ? formatFloats(&values[0].x, count * 4) : std::string());
+}
+
+void GraphicDriver::draw(PrimitiveType primitiveType, unsigned int startElement, unsigned int elementCount)
+{
+	OAK_ASSERT(this->state->currentShader != NULL, "No shader is bound, cannot draw");
+	OAK_ASSERT(this->state->currentBuffer != NULL, "No vertex buffer is bound, cannot draw");
+	OAK_ASSERT(startElement + elementCount <= this->state->currentBuffer->elementCount, "Drawing past the end of the vertex buffer");
+	OAK_ASSERT(!this->state->currentBuffer->streaming || startElement + elementCount <= this->state->currentBuffer->streamedElementCount, "Drawing streamed vertices that were not written this frame");
+	
+	// a target cannot be sampled while drawn into
+	if (this->state->currentTarget)
+	{
+		for (unsigned int i = 0; i < maxTextureUnits; i++)
+			OAK_ASSERT(this->state->currentTextures[i] != this->state->currentTarget->texture, "Sampling the render target being drawn into");
+	}
+	
+	this->state->statistics.drawCount++;
+	this->state->statistics.drawnElementCount += elementCount;
+	
+	if (this->state->commandTrace)
+		Log::info("draw %s %u %u", getPrimitiveTypeName(primitiveType), startElement, elementCount);
+}
+
+void GraphicDriver::setBlendMode(BlendMode mode)
+{
+	if (this->state->commandTrace)
+		Log::info("setBlendMode %s", getBlendModeName(mode));
+}
+
+void GraphicDriver::setDeferredResourceOperations(bool deferred)
+{
+	// operations queued so far must not be skipped
+	if (!deferred)
+		this->executeResourceOperations(this->markResourceOperations());
+	
+	this->state->deferResourceOperations = deferred;
+}
+
+unsigned int GraphicDriver::markResourceOperations()
+{
+	MutexLock lock(&this->state->resourceMutex);
+	return this->state->queuedOperationCount;
+}
+
+void GraphicDriver::executeResourceOperations(unsigned int marker)
+{
+	while (true)
+	{
+		ResourceOperation operation;
+		
+		{
+			MutexLock lock(&this->state->resourceMutex);
+			
+			// the marker is compared as a difference, to be robust to counter wrap-around
+			if (this->state->resourceOperations.empty() || (int)(marker - this->state->executedOperationCount) <= 0)
+				return;
+			
+			operation = this->state->resourceOperations.front();
+			this->state->resourceOperations.pop_front();
+			this->state->executedOperationCount++;
+		}
+		
+		switch (operation.type)
+		{
+			case ResourceOperation::CreateVertexBuffer:
+				operation.buffer->created = true;
+				break;
+			
+			case ResourceOperation::DestroyVertexBuffer:
+				releaseVertexBuffer(this->state, operation.buffer);
+				break;
+			
+			case ResourceOperation::CreateShaderProgram:
+				operation.program->created = true;
+				break;
+			
+			case ResourceOperation::DestroyShaderProgram:
+				releaseShaderProgram(this->state, operation.program);
+				break;
+			
+			case ResourceOperation::CreateTexture:
+				operation.texture->created = true;
+				break;
+			
+			case ResourceOperation::DestroyTexture:
+				releaseTexture(this->state, operation.texture);
+				break;
+			
+			case ResourceOperation::UploadTextureLevel:
+				defineTextureLevel(operation.texture, operation.level, operation.width, operation.height);
+				this->state->statistics.uploadedTextureByteCount += getTextureLevelSize(operation.textureFormat, operation.width, operation.height);
+				break;
+			
+			case ResourceOperation::UploadTextureRegion:
+				checkTextureRegion(operation.texture, operation.x, operation.y, operation.width, operation.height);
+				this->state->statistics.uploadedTextureByteCount += getTextureLevelSize(RGBA8TextureFormat, operation.width, operation.height);
+				break;
+			
+			case ResourceOperation::SetTextureLevelRange:
+				operation.texture->baseLevel = operation.level;
+				operation.texture->maxLevel = operation.maxLevel;
+				break;
+			
+			case ResourceOperation::SetTextureSampling:
+				operation.texture->repeated = operation.repeated;
+				break;
+			
+			case ResourceOperation::CreateRenderTarget:
+				createRenderTargetObjects(operation.renderTarget);
+				break;
+			
+			case ResourceOperation::DestroyRenderTarget:
+				releaseRenderTarget(this->state, operation.renderTarget);
+				break;
+		}
+		
+		this->state->statistics.resourceOperationCount++;
+	}
+}
+
+const GraphicDriver::Statistics &GraphicDriver::getStatistics() const
+{
+	return this->state->statistics;
+}
+
+void GraphicDriver::resetStatistics()
+{
+	this->state->statistics = Statistics();
+}
+
+void GraphicDriver::setCommandTrace(bool enabled)
+{
+	this->state->commandTrace = enabled;
+}
+
+} // oak namespace
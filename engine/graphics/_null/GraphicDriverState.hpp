@@ -0,0 +1,123 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/system/Mutex.hpp>
+
+#include <deque>
+
+namespace oak {
+
+const unsigned int maxTextureUnits = 8;
+
+// resource creation or destruction, queued in deferred mode
+struct ResourceOperation
+{
+	enum Type
+	{
+		CreateVertexBuffer,
+		DestroyVertexBuffer,
+		CreateShaderProgram,
+		DestroyShaderProgram,
+		CreateTexture,
+		DestroyTexture,
+		UploadTextureLevel,
+		UploadTextureRegion,
+		SetTextureLevelRange,
+		SetTextureSampling,
+		CreateRenderTarget,
+		DestroyRenderTarget
+	};
+	Type type;
+	
+	VertexBuffer *buffer;
+	ShaderProgram *program;
+	
+	Texture *texture;
+	RenderTarget *renderTarget;
+	GraphicDriver::TextureFormat textureFormat;
+	unsigned int level; // base level for level ranges
+	unsigned int maxLevel;
+	unsigned int x; // of texture regions
+	unsigned int y;
+	unsigned int width;
+	unsigned int height;
+	bool repeated;
+	
+	ResourceOperation()
+		: type(CreateVertexBuffer)
+		, buffer(NULL)
+		, program(NULL)
+		, texture(NULL)
+		, renderTarget(NULL)
+		, textureFormat(GraphicDriver::RGBA8TextureFormat)
+		, level(0)
+		, maxLevel(0)
+		, x(0)
+		, y(0)
+		, width(0)
+		, height(0)
+		, repeated(true)
+	{}
+};
+
+struct GraphicDriverState
+{
+	ShaderProgram *currentShader;
+	VertexBuffer *currentBuffer;
+	Texture *currentTextures[maxTextureUnits];
+	RenderTarget *currentTarget;
+	
+	GraphicDriver::Statistics statistics;
+	GraphicDriver::Capabilities capabilities;
+	bool commandTrace;
+	unsigned int nextShaderId;
+	
+	// deferred resource operations
+	bool deferResourceOperations;
+	Mutex resourceMutex;
+	std::deque<ResourceOperation> resourceOperations;
+	unsigned int queuedOperationCount;
+	unsigned int executedOperationCount;
+	
+	GraphicDriverState()
+		: currentShader(NULL)
+		, currentBuffer(NULL)
+		, currentTarget(NULL)
+		, commandTrace(false)
+		, nextShaderId(1)
+		, deferResourceOperations(false)
+		, queuedOperationCount(0)
+		, executedOperationCount(0)
+	{
+		for (unsigned int i = 0; i < maxTextureUnits; i++)
+			this->currentTextures[i] = NULL;
+	}
+};
+
+} // oak namespace
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+
+namespace oak {
+
+struct VertexBuffer
+{
+	// set once the (possibly deferred) creation has been executed
+	bool created;
+	GraphicDriver::VertexFormat format;
+	unsigned int elementCount; // per region for streaming buffers
+	unsigned int size;
+	
+	// streaming buffers are split in regions, written in turn
+	bool streaming;
+	unsigned int regionCount;
+	unsigned int currentRegion;
+	unsigned int streamedElementCount; // valid elements in the current region
+	
+	VertexBuffer()
+		: created(false)
+		, format(GraphicDriver::Simple2DVertexFormat)
+		, elementCount(0)
+		, size(0)
+		, streaming(false)
+		, regionCount(1)
+		, currentRegion(0)
+		, streamedElementCount(0)
+	{}
+};
+
+} // oak namespace
@@ -0,0 +1,266 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Animator.hpp>
+
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/components/Light.hpp>
+#include <engine/graphics/components/Sprite.hpp>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+const float twoPi = 6.28318530718f;
+
+// pulses scaling down to nothing could not be taken back
+const float maxPulseAmplitude = 0.9f;
+
+} // end of private section
+
+Animator::Animator(GraphicWorld *graphicWorld)
+	: graphicWorld(graphicWorld)
+	, entity(NULL)
+	, active(false)
+	, time(0.0f)
+	, speed(1.0f)
+	, looping(true)
+	, duration(0.0f)
+	, spinAxis(0.0f, 1.0f, 0.0f)
+	, spinSpeed(0.0f)
+	, spinAngle(0.0f)
+	, orbitU(1.0f, 0.0f, 0.0f)
+	, orbitV(0.0f, 0.0f, 1.0f)
+	, orbitRadius(0.0f)
+	, orbitSpeed(0.0f)
+	, bobAmplitude(0.0f, 0.0f, 0.0f)
+	, bobFrequency(0.0f)
+	, pulseAmplitude(0.0f)
+	, pulseFrequency(0.0f)
+	, appliedOffset(0.0f, 0.0f, 0.0f)
+	, appliedFactor(1.0f)
+	, light(NULL)
+	, sprite(NULL)
+{
+}
+
+void Animator::addPositionKey(float time, const glm::vec3 &position)
+{
+	this->addKey(PositionProperty, time, glm::vec4(position, 0.0f));
+}
+
+void Animator::addRotationKey(float time, const glm::vec3 &axis, float angle)
+{
+	glm::vec3 normalizedAxis = glm::normalize(axis);
+	glm::quat rotation = glm::angleAxis(angle, normalizedAxis.x, normalizedAxis.y, normalizedAxis.z);
+	this->addKey(RotationProperty, time, glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w));
+}
+
+void Animator::addScaleKey(float time, const glm::vec3 &scale)
+{
+	this->addKey(ScaleProperty, time, glm::vec4(scale, 0.0f));
+}
+
+void Animator::addColorKey(float time, const glm::vec3 &color)
+{
+	this->addKey(ColorProperty, time, glm::vec4(color, 0.0f));
+}
+
+void Animator::clearKeys()
+{
+	for (int i = 0; i < PropertyCount; i++)
+		this->keys[i].clear();
+	this->duration = 0.0f;
+}
+
+void Animator::setSpin(const glm::vec3 &axis, float speed)
+{
+	this->spinAxis = glm::normalize(axis);
+	this->spinSpeed = speed;
+}
+
+void Animator::setOrbit(const glm::vec3 &axis, float radius, float speed)
+{
+	// any two vectors orthogonal to the axis and to each other
+	glm::vec3 normal = glm::normalize(axis);
+	glm::vec3 reference = (std::abs(normal.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	this->orbitU = glm::normalize(glm::cross(reference, normal));
+	this->orbitV = glm::cross(normal, this->orbitU);
+	this->orbitRadius = radius;
+	this->orbitSpeed = speed;
+}
+
+void Animator::setBob(const glm::vec3 &amplitude, float frequency)
+{
+	this->bobAmplitude = amplitude;
+	this->bobFrequency = frequency;
+}
+
+void Animator::setPulse(float amplitude, float frequency)
+{
+	this->pulseAmplitude = std::min(std::abs(amplitude), maxPulseAmplitude);
+	this->pulseFrequency = frequency;
+}
+
+void Animator::animate(float elapsedTime)
+{
+	if (!this->active || !this->entity)
+		return;
+	
+	float delta = elapsedTime * this->speed;
+	this->time += delta;
+	this->spinAngle = std::fmod(this->spinAngle + this->spinSpeed * delta, twoPi);
+	
+	// keys loop or hold, procedural motions follow the clock
+	float keyTime = this->time;
+	if (this->duration > 0.0f)
+	{
+		if (this->looping)
+		{
+			keyTime = std::fmod(keyTime, this->duration);
+			if (keyTime < 0.0f)
+				keyTime += this->duration;
+		}
+		else
+			keyTime = std::max(0.0f, std::min(keyTime, this->duration));
+	}
+	
+	if (!this->keys[ColorProperty].empty())
+	{
+		glm::vec3 color = glm::vec3(this->sample(ColorProperty, keyTime));
+		if (this->light)
+			this->light->setColor(color);
+		if (this->sprite)
+			this->sprite->setColor(color);
+	}
+	
+	bool keyedPosition = !this->keys[PositionProperty].empty();
+	bool keyedRotation = !this->keys[RotationProperty].empty();
+	bool keyedScale = !this->keys[ScaleProperty].empty();
+	bool moving = (this->orbitRadius != 0.0f || this->bobAmplitude != glm::vec3(0.0f, 0.0f, 0.0f));
+	bool spinning = (this->spinSpeed != 0.0f);
+	bool pulsing = (this->pulseAmplitude != 0.0f);
+	if (!keyedPosition && !keyedRotation && !keyedScale && !moving && !spinning && !pulsing && this->appliedOffset == glm::vec3(0.0f, 0.0f, 0.0f) && this->appliedFactor == 1.0f)
+		return;
+	
+	glm::vec3 offset(0.0f, 0.0f, 0.0f);
+	if (this->orbitRadius != 0.0f)
+	{
+		float angle = this->orbitSpeed * this->time;
+		offset += (this->orbitU * std::cos(angle) + this->orbitV * std::sin(angle)) * this->orbitRadius;
+	}
+	offset += this->bobAmplitude * std::sin(twoPi * this->bobFrequency * this->time);
+	float factor = 1.0f + this->pulseAmplitude * std::sin(twoPi * this->pulseFrequency * this->time);
+	
+	glm::vec3 position;
+	if (keyedPosition)
+		position = glm::vec3(this->sample(PositionProperty, keyTime)) + offset;
+	else
+		position = this->entity->getLocalPosition() - this->appliedOffset + offset;
+	
+	glm::quat orientation;
+	if (keyedRotation)
+	{
+		glm::vec4 rotation = this->sample(RotationProperty, keyTime);
+		orientation = glm::angleAxis(this->spinAngle, this->spinAxis.x, this->spinAxis.y, this->spinAxis.z) * glm::quat(rotation.w, rotation.x, rotation.y, rotation.z);
+	}
+	else if (spinning)
+		orientation = glm::angleAxis(this->spinSpeed * delta, this->spinAxis.x, this->spinAxis.y, this->spinAxis.z) * this->entity->getLocalOrientation();
+	else
+		orientation = this->entity->getLocalOrientation();
+	
+	glm::vec3 scale;
+	if (keyedScale)
+		scale = glm::vec3(this->sample(ScaleProperty, keyTime)) * factor;
+	else
+		scale = this->entity->getLocalScale() * (factor / this->appliedFactor);
+	
+	this->appliedOffset = offset;
+	this->appliedFactor = factor;
+	
+	this->entity->setLocalTransform(position, orientation, scale);
+}
+
+void Animator::activateComponent(Entity *entity)
+{
+	if (entity->isStatic())
+		Log::warning("Animating a static entity, its batched geometry will not follow");
+	
+	this->active = true;
+	this->graphicWorld->registerAnimator(this);
+}
+
+void Animator::deactivateComponent(Entity *entity)
+{
+	this->active = false;
+	this->graphicWorld->unregisterAnimator(this);
+}
+
+void Animator::addKey(Property property, float time, const glm::vec4 &value)
+{
+	// after the keys at the same time, so that equal times make a step
+	KeyVector &keys = this->keys[property];
+	KeyVector::iterator it = std::upper_bound(keys.begin(), keys.end(), time, Animator::isBefore);
+	
+	Key key;
+	key.time = time;
+	key.value = value;
+	keys.insert(it, key);
+	
+	this->duration = std::max(this->duration, time);
+}
+
+glm::vec4 Animator::sample(Property property, float time) const
+{
+	const KeyVector &keys = this->keys[property];
+	KeyVector::const_iterator next = std::upper_bound(keys.begin(), keys.end(), time, Animator::isBefore);
+	if (next == keys.begin())
+		return next->value;
+	if (next == keys.end())
+		return keys.back().value;
+	
+	const Key &previous = *(next - 1);
+	float t = (time - previous.time) / (next->time - previous.time);
+	if (property != RotationProperty)
+		return previous.value + (next->value - previous.value) * t;
+	
+	glm::quat from(previous.value.w, previous.value.x, previous.value.y, previous.value.z);
+	glm::quat to(next->value.w, next->value.x, next->value.y, next->value.z);
+	
+	// along the shortest arc
+	if (glm::dot(from, to) < 0.0f)
+		to = -to;
+	glm::quat rotation = glm::mix(from, to, t);
+	return glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+}
+
+} // oak namespace
@@ -0,0 +1,169 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class GraphicWorld;
+class Light;
+class Sprite;
+
+/**
+ * Moves its entity along curves, without any script running each frame.
+ *
+ * Keyframes set the position, rotation, scale or color at the time of the
+ * animator, interpolated between keys; each property keeps its keys in one
+ * array, sorted by time. Procedural motions (spin, orbit, bob, pulse) are
+ * added to the keyed values, or to the current transform for properties without
+ * keys, so that scripts can still move the entity. Colors go to the light and
+ * the sprite given to the animator.
+ *
+ * Animators are advanced by jobs when a frame is prepared, before anything
+ * reads the transforms (see GraphicWorld::updateAnimators); an entity should
+ * have only one. Angles are in radians, like Entity::rotate.
+ */
+class Animator: public Component
+{
+	public:
+		Animator(GraphicWorld *graphicWorld);
+		virtual ~Animator() {}
+		
+		// clock of the curves, in seconds
+		float getTime() const { return this->time; }
+		void setTime(float time) { this->time = time; }
+		
+		// rate of the clock, 1 for real time
+		float getSpeed() const { return this->speed; }
+		void setSpeed(float speed) { this->speed = speed; }
+		
+		// keyframes loop over the last key of all properties, or hold their last values
+		bool isLooping() const { return this->looping; }
+		void setLooping(bool looping) { this->looping = looping; }
+		
+		// Add a keyframe at the given time, in seconds; values are interpolated
+		// linearly between keys (rotations spherically), keys added out of order
+		// are sorted.
+		void addPositionKey(float time, const glm::vec3 &position);
+		void addRotationKey(float time, const glm::vec3 &axis, float angle);
+		void addScaleKey(float time, const glm::vec3 &scale);
+		void addColorKey(float time, const glm::vec3 &color);
+		void clearKeys();
+		
+		// rotation around an axis, applied like Entity::rotate, in radians per second (0 to stop)
+		void setSpin(const glm::vec3 &axis, float speed);
+		
+		// circle of the given radius in the plane normal to the axis, around the
+		// position, in radians per second (0 to stop)
+		void setOrbit(const glm::vec3 &axis, float radius, float speed);
+		
+		// sine offset of the position, per axis, with the given number of cycles per second
+		void setBob(const glm::vec3 &amplitude, float frequency);
+		
+		// sine factor of the scale, around 1 (amplitude below 0.9), with the given number
+		// of cycles per second
+		void setPulse(float amplitude, float frequency);
+		
+		// components taking the keyed colors, NULL for none
+		Light *getLight() const { return this->light; }
+		void setLight(Light *light) { this->light = light; }
+		Sprite *getSprite() const { return this->sprite; }
+		void setSprite(Sprite *sprite) { this->sprite = sprite; }
+		
+		// Advance the clock by the given time and update the entity (when a frame
+		// is prepared, by a job).
+		void animate(float elapsedTime);
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		enum Property
+		{
+			PositionProperty,
+			RotationProperty, // quaternions, as x, y, z, w
+			ScaleProperty,
+			ColorProperty,
+			PropertyCount
+		};
+		
+		struct Key
+		{
+			float time;
+			glm::vec4 value;
+		};
+		typedef std::vector<Key> KeyVector;
+		static bool isBefore(float time, const Key &key) { return time < key.time; }
+		
+		void addKey(Property property, float time, const glm::vec4 &value);
+		glm::vec4 sample(Property property, float time) const;
+		
+		GraphicWorld *graphicWorld;
+		Entity *entity;
+		bool active;
+		
+		float time;
+		float speed;
+		bool looping;
+		
+		KeyVector keys[PropertyCount];
+		float duration; // time of the last key
+		
+		glm::vec3 spinAxis;
+		float spinSpeed;
+		float spinAngle; // accumulated, for keyed rotations
+		
+		// unit vectors spanning the plane of the orbit
+		glm::vec3 orbitU;
+		glm::vec3 orbitV;
+		float orbitRadius;
+		float orbitSpeed;
+		
+		glm::vec3 bobAmplitude;
+		float bobFrequency;
+		
+		float pulseAmplitude;
+		float pulseFrequency;
+		
+		// procedural offset and factor added last frame, taken back before adding
+		// the new ones to properties without keys
+		glm::vec3 appliedOffset;
+		float appliedFactor;
+		
+		Light *light;
+		Sprite *sprite;
+};
+
+} // oak namespace
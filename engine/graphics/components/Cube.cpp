@@ -33,10 +33,64 @@
 
 #include <engine/sg/Entity.hpp>
 
-#include <engine/system/Time.hpp>
-
 namespace oak {
 
+namespace { // private section
+
+// kept in memory for static batching
+GraphicDriver::Standard3DVertex cubeVertices[] = {
+	// -X
+	{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	
+	// +X
+	{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	
+	// -Y
+	{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	
+	// +Y
+	{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
+	
+	// -Z
+	{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f) },
+	
+	// +Z
+	{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f) },
+	{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 1.0f) },
+	{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f) },
+	{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f) },
+};
+const unsigned int cubeVertexCount = sizeof(cubeVertices) / sizeof(cubeVertices[0]);
+
+} // end of private section
+
 VertexBuffer *Cube::vertexBuffer = NULL;
 ShaderProgram *Cube::shader = NULL;
 unsigned int Cube::instanceCount = 0;
@@ -45,61 +99,12 @@ Cube::Cube(GraphicWorld *graphicWorld, GraphicDriver *driver)
 {
 	this->driver = driver;
 	this->graphicWorld = graphicWorld;
+	this->registered = false;
 	
 	// if this is the first cube created, initialize common buffers & shaders
 	if (Cube::instanceCount == 0)
 	{
-		// test buffer
-		GraphicDriver::Standard3DVertex vertices[] = {
-			// -X
-			{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			
-			// +X
-			{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			
-			// -Y
-			{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, -1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			
-			// +Y
-			{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 1.0f, 0.0f), glm::vec2(0.0f, 0.0f) },
-			
-			// -Z
-			{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(0.0, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f) },
-			
-			// +Z
-			{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f) },
-			{ glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 1.0f) },
-			{ glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f) },
-			{ glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(0.0, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f) },
-		};
-		Cube::vertexBuffer = this->driver->createVertexBuffer(vertices, 36);
+		Cube::vertexBuffer = this->driver->createVertexBuffer(cubeVertices, cubeVertexCount);
 		
 		// test shader
 		Cube::shader = this->driver->createShaderProgram(cubeVSString, cubeFSString);
@@ -108,6 +113,8 @@ Cube::Cube(GraphicWorld *graphicWorld, GraphicDriver *driver)
 	Cube::instanceCount++;
 	
 	this->setColor(glm::vec3(0.0f, 0.0f, 0.0f));
+	this->opacity = 1.0f;
+	this->texture = NULL;
 }
 
 Cube::~Cube()
@@ -129,29 +136,72 @@ glm::vec3 Cube::getColor() const
 
 void Cube::setColor(const glm::vec3 &color)
 {
+	// read back by the graphic world when the renderable is recorded
 	this->color = color;
-	this->driver->bindShaderProgram(Cube::shader);
-	
-	this->driver->setShaderConstant("time", (float)Time::getTime());
-	this->driver->setShaderConstant("color", color);
+	this->invalidateRenderable();
+}
+
+float Cube::getOpacity() const
+{
+	return this->opacity;
+}
+
+void Cube::setOpacity(float opacity)
+{
+	// read back like the color
+	this->opacity = opacity;
+	this->invalidateRenderable();
+}
+
+TextureResource *Cube::getTexture() const
+{
+	return this->texture;
+}
+
+void Cube::setTexture(TextureResource *texture)
+{
+	// read back like the color
+	this->texture = texture;
+	this->invalidateRenderable();
 }
 
 void Cube::activateComponent(Entity *entity)
 {
 	GraphicWorld::Renderable renderable;
+	renderable.entity = entity;
 	renderable.transform = &entity->getLocalTransform();
+	renderable.color = &this->color;
+	renderable.opacity = &this->opacity;
+	renderable.texture = &this->texture;
+	renderable.textureSpan = 2.0f; // each face maps the whole texture
 	renderable.buffer = Cube::vertexBuffer;
 	renderable.shader = Cube::shader;
 	renderable.primitiveType = GraphicDriver::Triangles;
 	renderable.startElement = 0;
-	renderable.elementCount = 36;
+	renderable.elementCount = cubeVertexCount;
+	renderable.boundingRadius = 1.7320508f; // sqrt(3), the cube spans [-1, 1] on each axis
+	renderable.vertices = cubeVertices;
+	renderable.castsShadows = true;
 	
-	this->graphicWorld->registerRenderable(renderable);
+	this->renderable = this->graphicWorld->registerRenderable(renderable);
+	this->registered = true;
 }
 
 void Cube::deactivateComponent(Entity *entity)
 {
-	//this->graphicWorld->unregisterXXX();
+	this->graphicWorld->unregisterRenderable(this->renderable);
+	this->registered = false;
+}
+
+void Cube::entityMoved(Entity *entity)
+{
+	this->invalidateRenderable();
+}
+
+void Cube::invalidateRenderable()
+{
+	if (this->registered)
+		this->graphicWorld->invalidateRenderable(this->renderable);
 }
 
 } // oak namespace
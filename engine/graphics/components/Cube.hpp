@@ -33,6 +33,7 @@ namespace oak {
 
 class GraphicDriver;
 class GraphicWorld;
+class TextureResource;
 struct ShaderProgram;
 struct VertexBuffer;
 
@@ -45,11 +46,22 @@ class Cube: public Component
 		glm::vec3 getColor() const;
 		void setColor(const glm::vec3 &color);
 		
+		// below 1, drawn blended over the opaque geometry, back to front
+		float getOpacity() const;
+		void setOpacity(float opacity);
+		
+		TextureResource *getTexture() const;
+		void setTexture(TextureResource *texture);
+		
 		// Component
 		virtual void activateComponent(Entity *entity);
 		virtual void deactivateComponent(Entity *entity);
+		virtual void entityMoved(Entity *entity);
 		
 	private:
+		// record the renderable again with the next frame, when registered
+		void invalidateRenderable();
+		
 		GraphicDriver *driver;
 		GraphicWorld *graphicWorld;
 		
@@ -59,6 +71,11 @@ class Cube: public Component
 		static unsigned int instanceCount;
 		
 		glm::vec3 color;
+		float opacity;
+		TextureResource *texture;
+		
+		bool registered;
+		unsigned int renderable; // handle in the graphic world, when registered
 };
 
 } // oak namespace
@@ -33,14 +33,13 @@
 
 #include <engine/sg/Entity.hpp>
 
-#include <engine/system/Time.hpp>
-
 namespace oak {
 
 DemoQuad::DemoQuad(GraphicWorld *graphicWorld, GraphicDriver *driver)
 {
 	this->driver = driver;
 	this->graphicWorld = graphicWorld;
+	this->registered = false;
 	
 	// test buffer
 	GraphicDriver::Simple2DVertex vertices[] = {
@@ -70,29 +69,42 @@ glm::vec3 DemoQuad::getColor() const
 
 void DemoQuad::setColor(const glm::vec3 &color)
 {
+	// read back by the graphic world when the renderable is recorded
 	this->color = color;
-	this->driver->bindShaderProgram(this->shader);
-	
-	this->driver->setShaderConstant("time", (float)Time::getTime());
-	this->driver->setShaderConstant("color", color);
+	this->invalidateRenderable();
 }
 
 void DemoQuad::activateComponent(Entity *entity)
 {
 	GraphicWorld::Renderable renderable;
 	renderable.transform = &entity->getLocalTransform();
+	renderable.color = &this->color;
 	renderable.buffer = this->vertexBuffer;
 	renderable.shader = this->shader;
 	renderable.primitiveType = GraphicDriver::TriangleStrip;
 	renderable.startElement = 0;
 	renderable.elementCount = 4;
+	renderable.boundingRadius = 1.4142136f; // sqrt(2), the quad spans [-1, 1] on X and Y
 	
-	this->graphicWorld->registerRenderable(renderable);
+	this->renderable = this->graphicWorld->registerRenderable(renderable);
+	this->registered = true;
 }
 
 void DemoQuad::deactivateComponent(Entity *entity)
 {
-	//this->graphicWorld->unregisterXXX();
+	this->graphicWorld->unregisterRenderable(this->renderable);
+	this->registered = false;
+}
+
+void DemoQuad::entityMoved(Entity *entity)
+{
+	this->invalidateRenderable();
+}
+
+void DemoQuad::invalidateRenderable()
+{
+	if (this->registered)
+		this->graphicWorld->invalidateRenderable(this->renderable);
 }
 
 } // oak namespace
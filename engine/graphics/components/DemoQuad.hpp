@@ -48,14 +48,21 @@ class DemoQuad: public Component
 		// Component
 		virtual void activateComponent(Entity *entity);
 		virtual void deactivateComponent(Entity *entity);
+		virtual void entityMoved(Entity *entity);
 		
 	private:
+		// record the renderable again with the next frame, when registered
+		void invalidateRenderable();
+		
 		GraphicDriver *driver;
 		GraphicWorld *graphicWorld;
 		VertexBuffer *vertexBuffer;
 		ShaderProgram *shader;
 		
 		glm::vec3 color;
+		
+		bool registered;
+		unsigned int renderable; // handle in the graphic world, when registered
 };
 
 } // oak namespace
@@ -0,0 +1,86 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+class GraphicWorld;
+
+/**
+ * Point light, lighting the renderables within its radius in the world it
+ * lives in. It is placed at the origin of its entity.
+ *
+ * Directional lights shine along the -Z axis of their entity instead, on the
+ * whole world; the first one of a world can cast shadows (see ShadowMaps).
+ */
+class Light: public Component
+{
+	public:
+		Light(GraphicWorld *graphicWorld);
+		virtual ~Light() {}
+		
+		glm::vec3 getColor() const { return this->color; }
+		void setColor(const glm::vec3 &color) { this->color = color; }
+		
+		// brightness at a unit distance
+		float getIntensity() const { return this->intensity; }
+		void setIntensity(float intensity) { this->intensity = intensity; }
+		
+		// the light fades out smoothly up to this distance
+		float getRadius() const { return this->radius; }
+		void setRadius(float radius) { this->radius = radius; }
+		
+		bool isDirectional() const { return this->directional; }
+		void setDirectional(bool directional) { this->directional = directional; }
+		
+		// for directional lights only
+		bool isCastingShadows() const { return this->castingShadows; }
+		void setCastingShadows(bool castingShadows) { this->castingShadows = castingShadows; }
+		
+		Entity *getEntity() const { return this->entity; }
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		GraphicWorld *graphicWorld;
+		Entity *entity;
+		
+		glm::vec3 color;
+		float intensity;
+		float radius;
+		bool directional;
+		bool castingShadows;
+};
+
+} // oak namespace
@@ -0,0 +1,196 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Mesh.hpp>
+
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/MeshManager.hpp>
+
+#include <engine/graphics/shaders/cube.vs.h>
+#include <engine/graphics/shaders/cube.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+namespace oak {
+
+ShaderProgram *Mesh::shader = NULL;
+unsigned int Mesh::instanceCount = 0;
+
+Mesh::Mesh(GraphicWorld *graphicWorld, GraphicDriver *driver)
+{
+	this->driver = driver;
+	this->graphicWorld = graphicWorld;
+	
+	// meshes are lit like cubes
+	if (Mesh::instanceCount == 0)
+		Mesh::shader = this->driver->createShaderProgram(cubeVSString, cubeFSString);
+	
+	Mesh::instanceCount++;
+	
+	this->mesh = NULL;
+	this->color = glm::vec3(0.0f, 0.0f, 0.0f);
+	this->opacity = 1.0f;
+	this->texture = NULL;
+	this->lodCrossFade = false;
+	this->entity = NULL;
+	this->registered = false;
+}
+
+Mesh::~Mesh()
+{
+	Mesh::instanceCount--;
+	
+	if (Mesh::instanceCount == 0)
+		this->driver->destroyShaderProgram(Mesh::shader);
+}
+
+MeshResource *Mesh::getMesh() const
+{
+	return this->mesh;
+}
+
+void Mesh::setMesh(MeshResource *mesh)
+{
+	// the renderable is replaced
+	this->unregisterRenderable();
+	
+	this->mesh = mesh;
+	if (this->entity && this->mesh)
+		this->registerRenderable();
+}
+
+glm::vec3 Mesh::getColor() const
+{
+	return this->color;
+}
+
+void Mesh::setColor(const glm::vec3 &color)
+{
+	// read back by the graphic world when the renderable is recorded
+	this->color = color;
+	this->invalidateRenderable();
+}
+
+float Mesh::getOpacity() const
+{
+	return this->opacity;
+}
+
+void Mesh::setOpacity(float opacity)
+{
+	// read back like the color
+	this->opacity = opacity;
+	this->invalidateRenderable();
+}
+
+TextureResource *Mesh::getTexture() const
+{
+	return this->texture;
+}
+
+void Mesh::setTexture(TextureResource *texture)
+{
+	// read back like the color
+	this->texture = texture;
+	this->invalidateRenderable();
+}
+
+bool Mesh::isLodCrossFade() const
+{
+	return this->lodCrossFade;
+}
+
+void Mesh::setLodCrossFade(bool crossFade)
+{
+	// copied in the renderable when registered
+	this->lodCrossFade = crossFade;
+}
+
+void Mesh::activateComponent(Entity *entity)
+{
+	this->entity = entity;
+	
+	if (this->mesh && !this->registered)
+		this->registerRenderable();
+}
+
+void Mesh::deactivateComponent(Entity *entity)
+{
+	this->unregisterRenderable();
+	this->entity = NULL;
+}
+
+void Mesh::entityMoved(Entity *entity)
+{
+	this->invalidateRenderable();
+}
+
+void Mesh::registerRenderable()
+{
+	const std::vector<GraphicWorld::Lod> &levels = this->mesh->getLevels();
+	if (levels.empty())
+		return;
+	
+	// the finest level is the renderable geometry, the others are its coarser levels
+	GraphicWorld::Renderable renderable;
+	renderable.entity = this->entity;
+	renderable.transform = &this->entity->getLocalTransform();
+	renderable.color = &this->color;
+	renderable.opacity = &this->opacity;
+	renderable.texture = &this->texture;
+	renderable.textureSpan = this->mesh->getBoundingRadius() * 2.0f;
+	renderable.buffer = levels[0].buffer;
+	renderable.shader = Mesh::shader;
+	renderable.primitiveType = GraphicDriver::Triangles;
+	renderable.startElement = levels[0].startElement;
+	renderable.elementCount = levels[0].elementCount;
+	renderable.boundingCenter = this->mesh->getBoundingCenter();
+	renderable.boundingRadius = this->mesh->getBoundingRadius();
+	renderable.castsShadows = true;
+	renderable.lods = (levels.size() > 1) ? &levels[1] : NULL;
+	renderable.lodCount = (unsigned int)levels.size() - 1;
+	renderable.lodCrossFade = this->lodCrossFade;
+	
+	this->renderable = this->graphicWorld->registerRenderable(renderable);
+	this->registered = true;
+}
+
+void Mesh::unregisterRenderable()
+{
+	if (!this->registered)
+		return;
+	
+	this->graphicWorld->unregisterRenderable(this->renderable);
+	this->registered = false;
+}
+
+void Mesh::invalidateRenderable()
+{
+	if (this->registered)
+		this->graphicWorld->invalidateRenderable(this->renderable);
+}
+
+} // oak namespace
@@ -0,0 +1,98 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+class GraphicDriver;
+class GraphicWorld;
+class MeshResource;
+class TextureResource;
+struct ShaderProgram;
+
+/**
+ * Draws a mesh loaded by the mesh manager, with its levels of detail selected
+ * from its size on screen.
+ */
+class Mesh: public Component
+{
+	public:
+		Mesh(GraphicWorld *graphicWorld, GraphicDriver *driver);
+		virtual ~Mesh();
+		
+		MeshResource *getMesh() const;
+		void setMesh(MeshResource *mesh);
+		
+		glm::vec3 getColor() const;
+		void setColor(const glm::vec3 &color);
+		
+		// below 1, drawn blended over the opaque geometry, back to front
+		float getOpacity() const;
+		void setOpacity(float opacity);
+		
+		TextureResource *getTexture() const;
+		void setTexture(TextureResource *texture);
+		
+		// dither between levels for a moment when switching, instead of popping;
+		// to be set before the mesh
+		bool isLodCrossFade() const;
+		void setLodCrossFade(bool crossFade);
+		
+		// Component
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+		virtual void entityMoved(Entity *entity);
+	
+	private:
+		void registerRenderable();
+		void unregisterRenderable();
+		
+		// record the renderable again with the next frame, when registered
+		void invalidateRenderable();
+		
+		GraphicDriver *driver;
+		GraphicWorld *graphicWorld;
+		
+		// shared for all meshes
+		static ShaderProgram *shader;
+		static unsigned int instanceCount;
+		
+		MeshResource *mesh;
+		glm::vec3 color;
+		float opacity;
+		TextureResource *texture;
+		bool lodCrossFade;
+		
+		Entity *entity; // while active
+		bool registered;
+		unsigned int renderable; // handle in the graphic world, when registered
+};
+
+} // oak namespace
@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Occluder.hpp>
+
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/MeshManager.hpp>
+
+namespace oak {
+
+namespace { // private section
+
+// counter-clockwise faces, seen from outside
+const glm::vec3 boxPositions[] = {
+	// -X
+	glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(-1.0f, 1.0f, 1.0f),
+	glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(-1.0f, -1.0f, -1.0f),
+	
+	// +X
+	glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, -1.0f),
+	glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, -1.0f, 1.0f),
+	
+	// -Y
+	glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(1.0f, -1.0f, 1.0f),
+	glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(-1.0f, -1.0f, -1.0f),
+	
+	// +Y
+	glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, -1.0f),
+	glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(-1.0f, 1.0f, 1.0f),
+	
+	// -Z
+	glm::vec3(1.0f, -1.0f, -1.0f), glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0f, 1.0f, -1.0f),
+	glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0f, -1.0f, -1.0f),
+	
+	// +Z
+	glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f),
+	glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(-1.0f, -1.0f, 1.0f),
+};
+const unsigned int boxVertexCount = sizeof(boxPositions) / sizeof(boxPositions[0]);
+
+} // end of private section
+
+Occluder::Occluder(GraphicWorld *graphicWorld)
+	: graphicWorld(graphicWorld)
+	, entity(NULL)
+	, mesh(NULL)
+	, positions(boxPositions)
+	, vertexCount(boxVertexCount)
+	, boundingCenter(0.0f, 0.0f, 0.0f)
+	, boundingRadius(1.7320508f) // sqrt(3)
+{
+}
+
+void Occluder::setMesh(MeshResource *mesh)
+{
+	// read back by the views each frame
+	this->mesh = mesh;
+	if (mesh && !mesh->getOccluderPositions().empty())
+	{
+		this->positions = &mesh->getOccluderPositions()[0];
+		this->vertexCount = (unsigned int)mesh->getOccluderPositions().size();
+		this->boundingCenter = mesh->getBoundingCenter();
+		this->boundingRadius = mesh->getBoundingRadius();
+	}
+	else
+	{
+		this->positions = boxPositions;
+		this->vertexCount = boxVertexCount;
+		this->boundingCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+		this->boundingRadius = 1.7320508f;
+	}
+}
+
+void Occluder::activateComponent(Entity *entity)
+{
+	this->graphicWorld->registerOccluder(this);
+}
+
+void Occluder::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterOccluder(this);
+}
+
+} // oak namespace
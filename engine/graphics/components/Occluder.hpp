@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+class GraphicWorld;
+class MeshResource;
+
+/**
+ * Simplified geometry hiding what is behind it, rasterized on the CPU by each
+ * view to cull the renderables it covers (see OcclusionBuffer). It should be
+ * closed, and stay inside the visible geometry: a box spanning [-1, 1] on each
+ * axis of its entity, like a cube, or the coarsest level of a mesh.
+ */
+class Occluder: public Component
+{
+	public:
+		Occluder(GraphicWorld *graphicWorld);
+		virtual ~Occluder() {}
+		
+		// NULL for the box
+		MeshResource *getMesh() const { return this->mesh; }
+		void setMesh(MeshResource *mesh);
+		
+		// triangle list, in local space
+		const glm::vec3 *getPositions() const { return this->positions; }
+		unsigned int getVertexCount() const { return this->vertexCount; }
+		
+		// bounding sphere, in local space
+		const glm::vec3 &getBoundingCenter() const { return this->boundingCenter; }
+		float getBoundingRadius() const { return this->boundingRadius; }
+		
+		Entity *getEntity() const { return this->entity; }
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		GraphicWorld *graphicWorld;
+		Entity *entity;
+		
+		MeshResource *mesh;
+		const glm::vec3 *positions;
+		unsigned int vertexCount;
+		glm::vec3 boundingCenter;
+		float boundingRadius;
+};
+
+} // oak namespace
@@ -0,0 +1,316 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/ParticleEmitter.hpp>
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Simd.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// particle arrays are processed four elements at a time
+unsigned int roundToGroup(unsigned int count)
+{
+	return (count + 3) & ~3u;
+}
+
+// seeds of the emitters, spread so that identical emitters look different
+unsigned int nextSeed = 0x9e3779b9u;
+
+// directions around the emission axis, to avoid trigonometry per particle
+const unsigned int azimuthCount = 1024;
+struct AzimuthTable
+{
+	float cosine[azimuthCount];
+	float sine[azimuthCount];
+	
+	AzimuthTable()
+	{
+		for (unsigned int i = 0; i < azimuthCount; i++)
+		{
+			float angle = (float)i * (6.28318531f / (float)azimuthCount);
+			this->cosine[i] = std::cos(angle);
+			this->sine[i] = std::sin(angle);
+		}
+	}
+};
+const AzimuthTable azimuths;
+
+} // end of private section
+
+ParticleEmitter::ParticleEmitter(GraphicWorld *graphicWorld)
+	: graphicWorld(graphicWorld)
+	, entity(NULL)
+	, rate(0.0f)
+	, pendingEmission(0.0f)
+	, burstCount(0)
+	, maxParticleCount(10000)
+	, lifetime(1.0f, 1.0f)
+	, speed(1.0f, 1.0f)
+	, spread(0.5f)
+	, radius(0.0f)
+	, acceleration(0.0f, 0.0f, 0.0f)
+	, drag(0.0f)
+	, size(0.1f, 0.1f)
+	, startColor(1.0f, 1.0f, 1.0f, 1.0f)
+	, endColor(1.0f, 1.0f, 1.0f, 0.0f)
+	, texture(NULL)
+	, region(0.0f, 0.0f, 1.0f, 1.0f)
+	, additive(false)
+	, particleCount(0)
+	, boundsMin(0.0f)
+	, boundsMax(0.0f)
+{
+	this->randomState = nextSeed;
+	nextSeed += 0x9e3779b9u;
+	if (this->randomState == 0)
+		this->randomState = 1;
+}
+
+void ParticleEmitter::burst(int count)
+{
+	if (count > 0)
+		this->burstCount += (unsigned int)count;
+}
+
+void ParticleEmitter::setMaxParticleCount(int count)
+{
+	this->maxParticleCount = (unsigned int)std::max(count, 0);
+	this->particleCount = std::min(this->particleCount, this->maxParticleCount);
+}
+
+void ParticleEmitter::simulate(float elapsedTime)
+{
+	this->integrate(elapsedTime);
+	this->removeDead();
+	
+	// whole particles only, the rest is emitted in the next frames
+	this->pendingEmission += this->rate * elapsedTime;
+	unsigned int count = (unsigned int)this->pendingEmission;
+	this->pendingEmission -= (float)count;
+	count += this->burstCount;
+	this->burstCount = 0;
+	
+	count = std::min(count, this->maxParticleCount - this->particleCount);
+	if (count > 0)
+		this->emit(count);
+	
+	this->updateBounds();
+}
+
+void ParticleEmitter::activateComponent(Entity *entity)
+{
+	this->graphicWorld->registerParticleEmitter(this);
+}
+
+void ParticleEmitter::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterParticleEmitter(this);
+	
+	// the effect stops with the emitter
+	this->particleCount = 0;
+	this->burstCount = 0;
+	this->pendingEmission = 0.0f;
+}
+
+void ParticleEmitter::integrate(float elapsedTime)
+{
+	// explicit Euler, the drag is linearized over the step
+	Float4 step = Simd::set(elapsedTime);
+	Float4 damping = Simd::set(std::max(1.0f - this->drag * elapsedTime, 0.0f));
+	Float4 deltaX = Simd::set(this->acceleration.x * elapsedTime);
+	Float4 deltaY = Simd::set(this->acceleration.y * elapsedTime);
+	Float4 deltaZ = Simd::set(this->acceleration.z * elapsedTime);
+	
+	// the padding is advanced too, it is never drawn
+	unsigned int count = roundToGroup(this->particleCount);
+	for (unsigned int i = 0; i < count; i += 4)
+	{
+		Float4 velocityX = Simd::add(Simd::mul(Simd::load(&this->velocityX[i]), damping), deltaX);
+		Float4 velocityY = Simd::add(Simd::mul(Simd::load(&this->velocityY[i]), damping), deltaY);
+		Float4 velocityZ = Simd::add(Simd::mul(Simd::load(&this->velocityZ[i]), damping), deltaZ);
+		Simd::store(&this->velocityX[i], velocityX);
+		Simd::store(&this->velocityY[i], velocityY);
+		Simd::store(&this->velocityZ[i], velocityZ);
+		
+		Simd::store(&this->positionX[i], Simd::add(Simd::load(&this->positionX[i]), Simd::mul(velocityX, step)));
+		Simd::store(&this->positionY[i], Simd::add(Simd::load(&this->positionY[i]), Simd::mul(velocityY, step)));
+		Simd::store(&this->positionZ[i], Simd::add(Simd::load(&this->positionZ[i]), Simd::mul(velocityZ, step)));
+		
+		Simd::store(&this->life[i], Simd::sub(Simd::load(&this->life[i]), Simd::mul(Simd::load(&this->lifeRate[i]), step)));
+	}
+}
+
+void ParticleEmitter::removeDead()
+{
+	// dead particles are replaced by the last alive one, groups of four alive
+	// particles are skipped at once
+	Float4 zero = Simd::set(0.0f);
+	unsigned int i = 0;
+	while (i < this->particleCount)
+	{
+		if (i + 4 <= this->particleCount && Simd::getMask(Simd::less(zero, Simd::load(&this->life[i]))) == 0xf)
+		{
+			i += 4;
+			continue;
+		}
+		
+		if (this->life[i] > 0.0f)
+		{
+			i++;
+			continue;
+		}
+		
+		unsigned int last = --this->particleCount;
+		this->positionX[i] = this->positionX[last];
+		this->positionY[i] = this->positionY[last];
+		this->positionZ[i] = this->positionZ[last];
+		this->velocityX[i] = this->velocityX[last];
+		this->velocityY[i] = this->velocityY[last];
+		this->velocityZ[i] = this->velocityZ[last];
+		this->life[i] = this->life[last];
+		this->lifeRate[i] = this->lifeRate[last];
+	}
+}
+
+void ParticleEmitter::emit(unsigned int count)
+{
+	// arrays only grow, the new padding is zeroed
+	unsigned int first = this->particleCount;
+	this->particleCount += count;
+	unsigned int capacity = roundToGroup(this->particleCount);
+	if (this->life.size() < capacity)
+	{
+		this->positionX.resize(capacity, 0.0f);
+		this->positionY.resize(capacity, 0.0f);
+		this->positionZ.resize(capacity, 0.0f);
+		this->velocityX.resize(capacity, 0.0f);
+		this->velocityY.resize(capacity, 0.0f);
+		this->velocityZ.resize(capacity, 0.0f);
+		this->life.resize(capacity, 0.0f);
+		this->lifeRate.resize(capacity, 0.0f);
+	}
+	
+	// directions are taken in the frame of the entity, without its scale
+	const glm::mat4 &transform = this->entity->getLocalTransform();
+	glm::vec3 origin = glm::vec3(transform[3]);
+	glm::vec3 axisX = glm::normalize(glm::vec3(transform[0]));
+	glm::vec3 axisY = glm::normalize(glm::vec3(transform[1]));
+	glm::vec3 axisZ = glm::normalize(glm::vec3(transform[2]));
+	float minCosine = std::cos(glm::clamp(this->spread, 0.0f, 3.14159265f));
+	
+	for (unsigned int i = first; i < this->particleCount; i++)
+	{
+		// uniform over the cap of the cone
+		float cosine = 1.0f - this->random() * (1.0f - minCosine);
+		float sine = std::sqrt(std::max(1.0f - cosine * cosine, 0.0f));
+		unsigned int azimuth = (unsigned int)(this->random() * (float)azimuthCount) % azimuthCount;
+		float a = azimuths.cosine[azimuth] * sine;
+		float b = azimuths.sine[azimuth] * sine;
+		
+		float particleSpeed = this->speed.x + (this->speed.y - this->speed.x) * this->random();
+		glm::vec3 velocity = (axisX * a + axisY * cosine + axisZ * b) * particleSpeed;
+		
+		glm::vec3 position = origin;
+		if (this->radius > 0.0f)
+		{
+			glm::vec3 offset;
+			do
+			{
+				offset = glm::vec3(this->random(), this->random(), this->random()) * 2.0f - 1.0f;
+			} while (glm::dot(offset, offset) > 1.0f);
+			position += offset * this->radius;
+		}
+		
+		float particleLifetime = this->lifetime.x + (this->lifetime.y - this->lifetime.x) * this->random();
+		
+		this->positionX[i] = position.x;
+		this->positionY[i] = position.y;
+		this->positionZ[i] = position.z;
+		this->velocityX[i] = velocity.x;
+		this->velocityY[i] = velocity.y;
+		this->velocityZ[i] = velocity.z;
+		this->life[i] = 1.0f;
+		this->lifeRate[i] = 1.0f / std::max(particleLifetime, 1e-3f);
+	}
+}
+
+void ParticleEmitter::updateBounds()
+{
+	if (this->particleCount == 0)
+	{
+		this->boundsMin = this->boundsMax = glm::vec3(this->entity->getLocalTransform()[3]);
+		return;
+	}
+	
+	// whole groups first, the padding must not be included
+	unsigned int groupEnd = this->particleCount & ~3u;
+	float minimum[3][4];
+	float maximum[3][4];
+	const float *positions[3] = { &this->positionX[0], &this->positionY[0], &this->positionZ[0] };
+	for (unsigned int axis = 0; axis < 3; axis++)
+	{
+		const float *position = positions[axis];
+		Float4 low = Simd::set(position[0]);
+		Float4 high = low;
+		for (unsigned int i = 0; i < groupEnd; i += 4)
+		{
+			Float4 value = Simd::load(position + i);
+			low = Simd::min(low, value);
+			high = Simd::max(high, value);
+		}
+		
+		Simd::store(minimum[axis], low);
+		Simd::store(maximum[axis], high);
+		for (unsigned int i = groupEnd; i < this->particleCount; i++)
+		{
+			minimum[axis][0] = std::min(minimum[axis][0], position[i]);
+			maximum[axis][0] = std::max(maximum[axis][0], position[i]);
+		}
+		
+		this->boundsMin[axis] = std::min(std::min(minimum[axis][0], minimum[axis][1]), std::min(minimum[axis][2], minimum[axis][3]));
+		this->boundsMax[axis] = std::max(std::max(maximum[axis][0], maximum[axis][1]), std::max(maximum[axis][2], maximum[axis][3]));
+	}
+}
+
+float ParticleEmitter::random()
+{
+	this->randomState ^= this->randomState << 13;
+	this->randomState ^= this->randomState >> 17;
+	this->randomState ^= this->randomState << 5;
+	
+	// 24 bits, exactly representable
+	return (float)(this->randomState >> 8) * (1.0f / 16777216.0f);
+}
+
+} // oak namespace
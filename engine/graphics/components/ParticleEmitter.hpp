@@ -0,0 +1,189 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class GraphicWorld;
+class TextureResource;
+
+/**
+ * Emits particles from its entity, drawn as billboards facing the camera.
+ *
+ * Particles are not entities: their state is kept in arrays of floats, one per
+ * attribute, and advanced four at a time with SIMD operations; each emitter is
+ * simulated by its own job when a frame is prepared, in world space. Views
+ * then write the visible particles into a stream buffer, two triangles each,
+ * and draw a few thousands of them at once (see SpriteBatcher).
+ *
+ * Particles leave along the Y axis of the entity, within a cone of the given
+ * spread, and fade from the start color to the end color over their life.
+ */
+class ParticleEmitter: public Component
+{
+	public:
+		ParticleEmitter(GraphicWorld *graphicWorld);
+		virtual ~ParticleEmitter() {}
+		
+		// particles emitted per second, continuously
+		float getRate() const { return this->rate; }
+		void setRate(float rate) { this->rate = rate; }
+		
+		// emit a number of particles at once, when next simulated
+		void burst(int count);
+		
+		// particles emitted when alive ones already reach this count are dropped
+		int getMaxParticleCount() const { return (int)this->maxParticleCount; }
+		void setMaxParticleCount(int count);
+		
+		// alive particles, as of the last simulated frame
+		int getParticleCount() const { return (int)this->particleCount; }
+		
+		// range of the life of each particle, in seconds
+		const glm::vec2 &getLifetime() const { return this->lifetime; }
+		void setLifetime(const glm::vec2 &lifetime) { this->lifetime = lifetime; }
+		
+		// range of the initial speed, in units per second
+		const glm::vec2 &getSpeed() const { return this->speed; }
+		void setSpeed(const glm::vec2 &speed) { this->speed = speed; }
+		
+		// half angle of the emission cone, in radians (pi for all directions)
+		float getSpread() const { return this->spread; }
+		void setSpread(float spread) { this->spread = spread; }
+		
+		// particles start anywhere in a sphere of this radius around the entity
+		float getRadius() const { return this->radius; }
+		void setRadius(float radius) { this->radius = radius; }
+		
+		// world space acceleration (e.g. gravity), in units per second squared
+		const glm::vec3 &getAcceleration() const { return this->acceleration; }
+		void setAcceleration(const glm::vec3 &acceleration) { this->acceleration = acceleration; }
+		
+		// fraction of the velocity lost per second
+		float getDrag() const { return this->drag; }
+		void setDrag(float drag) { this->drag = drag; }
+		
+		// size of the particles at the start and at the end of their life, in world units
+		const glm::vec2 &getSize() const { return this->size; }
+		void setSize(const glm::vec2 &size) { this->size = size; }
+		
+		// color and opacity at the start and at the end of the life of the particles,
+		// multiplied by the texture
+		const glm::vec4 &getStartColor() const { return this->startColor; }
+		void setStartColor(const glm::vec4 &color) { this->startColor = color; }
+		const glm::vec4 &getEndColor() const { return this->endColor; }
+		void setEndColor(const glm::vec4 &color) { this->endColor = color; }
+		
+		// NULL for the default texture
+		TextureResource *getTexture() const { return this->texture; }
+		void setTexture(TextureResource *texture) { this->texture = texture; }
+		
+		// part of the texture drawn: left, top, right and bottom texture coordinates
+		const glm::vec4 &getRegion() const { return this->region; }
+		void setRegion(const glm::vec4 &region) { this->region = region; }
+		
+		// added to the scene instead of drawn over it, for sparks and fire
+		bool isAdditive() const { return this->additive; }
+		void setAdditive(bool additive) { this->additive = additive; }
+		
+		// Advance the particles by the given time, removing the dead ones, then emit
+		// the new ones (when a frame is prepared, by a job).
+		void simulate(float elapsedTime);
+		
+		// Particle arrays, padded to a multiple of 4 elements with harmless values:
+		// positions, then life as a fraction going from 1 to 0. They stay valid
+		// until the next simulation.
+		const float *getPositionX() const { return this->positionX.empty() ? NULL : &this->positionX[0]; }
+		const float *getPositionY() const { return this->positionY.empty() ? NULL : &this->positionY[0]; }
+		const float *getPositionZ() const { return this->positionZ.empty() ? NULL : &this->positionZ[0]; }
+		const float *getLife() const { return this->life.empty() ? NULL : &this->life[0]; }
+		
+		// box around the alive particles, without their size
+		const glm::vec3 &getBoundsMin() const { return this->boundsMin; }
+		const glm::vec3 &getBoundsMax() const { return this->boundsMax; }
+		
+		Entity *getEntity() const { return this->entity; }
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		void integrate(float elapsedTime);
+		void removeDead();
+		void emit(unsigned int count);
+		void updateBounds();
+		
+		// xorshift, uniform in [0, 1)
+		float random();
+		
+		GraphicWorld *graphicWorld;
+		Entity *entity;
+		
+		float rate;
+		float pendingEmission; // fraction of a particle left from the last frames
+		unsigned int burstCount;
+		unsigned int maxParticleCount;
+		
+		glm::vec2 lifetime;
+		glm::vec2 speed;
+		float spread;
+		float radius;
+		glm::vec3 acceleration;
+		float drag;
+		glm::vec2 size;
+		glm::vec4 startColor;
+		glm::vec4 endColor;
+		TextureResource *texture;
+		glm::vec4 region;
+		bool additive;
+		
+		unsigned int randomState;
+		
+		// one array per attribute, life decreasing by lifeRate per second
+		unsigned int particleCount;
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> positionZ;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> velocityZ;
+		std::vector<float> life;
+		std::vector<float> lifeRate;
+		
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+};
+
+} // oak namespace
@@ -0,0 +1,351 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/SkinnedMesh.hpp>
+
+#include <engine/graphics/AnimationManager.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+
+#include <engine/graphics/shaders/cube.vs.h>
+#include <engine/graphics/shaders/cube.fs.h>
+#include <engine/graphics/shaders/skinned.vs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+#include <engine/system/Simd.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace oak {
+
+namespace { // private section
+
+// vertex shader constants kept for the other uniforms, then three per bone
+const unsigned int reservedConstantVectors = 32;
+
+// bytes indices can address no more
+const unsigned int maxSkeletonBones = 256;
+
+} // end of private section
+
+unsigned int SkinnedMesh::maxBones = 0;
+ShaderProgram *SkinnedMesh::skinningShader = NULL;
+ShaderProgram *SkinnedMesh::shader = NULL;
+unsigned int SkinnedMesh::instanceCount = 0;
+
+SkinnedMesh::SkinnedMesh(GraphicWorld *graphicWorld, GraphicDriver *driver)
+{
+	this->graphicWorld = graphicWorld;
+	this->driver = driver;
+	
+	if (SkinnedMesh::instanceCount == 0)
+	{
+		// the bone array is sized for the platform
+		unsigned int constantVectors = this->driver->getCapabilities().vertexConstantVectors;
+		SkinnedMesh::maxBones = (constantVectors > reservedConstantVectors) ? std::min((constantVectors - reservedConstantVectors) / 3, maxSkeletonBones) : 0;
+		if (SkinnedMesh::maxBones > 0)
+		{
+			std::ostringstream header;
+			header << "#define MAX_BONES " << SkinnedMesh::maxBones << "\n";
+			SkinnedMesh::skinningShader = this->driver->createShaderProgram(header.str() + skinnedVSString, cubeFSString);
+		}
+		
+		// the vertices skinned on the CPU are lit like cubes
+		SkinnedMesh::shader = this->driver->createShaderProgram(cubeVSString, cubeFSString);
+	}
+	
+	SkinnedMesh::instanceCount++;
+	
+	this->mesh = NULL;
+	this->color = glm::vec3(0.0f, 0.0f, 0.0f);
+	this->texture = NULL;
+	this->gpuSkinned = false;
+	
+	for (int i = 0; i < layerCount; i++)
+	{
+		this->layers[i].animation = NULL;
+		this->layers[i].weight = 1.0f;
+		this->layers[i].speed = 1.0f;
+		this->layers[i].time = 0.0f;
+	}
+	
+	this->entity = NULL;
+	this->registered = false;
+}
+
+SkinnedMesh::~SkinnedMesh()
+{
+	SkinnedMesh::instanceCount--;
+	
+	if (SkinnedMesh::instanceCount == 0)
+	{
+		if (SkinnedMesh::skinningShader)
+			this->driver->destroyShaderProgram(SkinnedMesh::skinningShader);
+		this->driver->destroyShaderProgram(SkinnedMesh::shader);
+		SkinnedMesh::skinningShader = NULL;
+	}
+}
+
+void SkinnedMesh::setMesh(SkinnedMeshResource *mesh)
+{
+	// the renderable is replaced, its bone matrices move
+	this->unregisterRenderable();
+	
+	this->mesh = mesh;
+	if (!this->mesh || this->mesh->hasFailed())
+		return;
+	
+	unsigned int boneCount = this->mesh->getBoneCount();
+	this->gpuSkinned = (boneCount <= SkinnedMesh::maxBones);
+	if (!this->gpuSkinned)
+		Log::info("Skinning '%s' on the CPU, %u bones do not fit in the shader constants", this->mesh->getPath().c_str(), boneCount);
+	
+	this->pose.resize(boneCount);
+	this->layerPose.resize(boneCount);
+	this->boneMatrices.assign(boneCount * 3, glm::vec4(0.0f));
+	
+	if (this->entity)
+		this->registerRenderable();
+}
+
+AnimationResource *SkinnedMesh::getAnimation(int layer) const
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	return this->layers[layer].animation;
+}
+
+void SkinnedMesh::setAnimation(int layer, AnimationResource *animation)
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	
+	if (animation && this->mesh && animation->getBoneCount() != this->mesh->getBoneCount())
+	{
+		Log::warning("Animation '%s' does not match the skeleton of '%s'", animation->getPath().c_str(), this->mesh->getPath().c_str());
+		animation = NULL;
+	}
+	
+	this->layers[layer].animation = animation;
+	this->layers[layer].time = 0.0f;
+}
+
+float SkinnedMesh::getLayerWeight(int layer) const
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	return this->layers[layer].weight;
+}
+
+void SkinnedMesh::setLayerWeight(int layer, float weight)
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	this->layers[layer].weight = weight;
+}
+
+float SkinnedMesh::getLayerSpeed(int layer) const
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	return this->layers[layer].speed;
+}
+
+void SkinnedMesh::setLayerSpeed(int layer, float speed)
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	this->layers[layer].speed = speed;
+}
+
+float SkinnedMesh::getLayerTime(int layer) const
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	return this->layers[layer].time;
+}
+
+void SkinnedMesh::setLayerTime(int layer, float time)
+{
+	OAK_ASSERT(layer >= 0 && layer < layerCount, "Invalid animation layer");
+	this->layers[layer].time = time;
+}
+
+void SkinnedMesh::animate(float elapsedTime, StreamBuffer *streamBuffer)
+{
+	if (!this->registered || !this->entity)
+		return;
+	
+	// sample and blend the layers, looping their clips
+	this->pose.clear();
+	float totalWeight = 0.0f;
+	for (int i = 0; i < layerCount; i++)
+	{
+		Layer &layer = this->layers[i];
+		if (!layer.animation || layer.animation->hasFailed() || layer.animation->getBoneCount() != this->mesh->getBoneCount())
+			continue;
+		
+		float duration = layer.animation->getDuration();
+		layer.time += elapsedTime * layer.speed;
+		if (duration > 0.0f)
+		{
+			layer.time = std::fmod(layer.time, duration);
+			if (layer.time < 0.0f)
+				layer.time += duration;
+		}
+		
+		if (layer.weight <= 0.0f)
+			continue;
+		
+		layer.animation->sample(layer.time, &this->layerPose);
+		this->pose.accumulate(this->layerPose, layer.weight);
+		totalWeight += layer.weight;
+	}
+	this->pose.normalize(this->mesh->getRestPose(), totalWeight);
+	this->pose.computeSkinningMatrices(this->mesh->getParents(), this->mesh->getInverseBindMatrices(), &this->boneMatrices[0]);
+	
+	if (this->gpuSkinned)
+	{
+		this->geometry.buffer = this->mesh->getVertexBuffer();
+		this->geometry.startElement = 0;
+		this->geometry.elementCount = (unsigned int)this->mesh->getVertices().size();
+	}
+	else
+		this->skinVertices(streamBuffer);
+	
+	this->invalidateRenderable();
+}
+
+void SkinnedMesh::activateComponent(Entity *entity)
+{
+	this->entity = entity;
+	this->graphicWorld->registerSkinnedMesh(this);
+	
+	if (this->mesh && !this->mesh->hasFailed() && !this->registered)
+		this->registerRenderable();
+}
+
+void SkinnedMesh::deactivateComponent(Entity *entity)
+{
+	this->unregisterRenderable();
+	this->entity = NULL;
+	this->graphicWorld->unregisterSkinnedMesh(this);
+}
+
+void SkinnedMesh::entityMoved(Entity *entity)
+{
+	this->invalidateRenderable();
+}
+
+void SkinnedMesh::registerRenderable()
+{
+	GraphicWorld::Renderable renderable;
+	renderable.entity = this->entity;
+	renderable.transform = &this->entity->getLocalTransform();
+	renderable.color = &this->color;
+	renderable.texture = &this->texture;
+	renderable.textureSpan = this->mesh->getBoundingRadius() * 2.0f;
+	renderable.buffer = this->mesh->getVertexBuffer();
+	renderable.shader = this->gpuSkinned ? SkinnedMesh::skinningShader : SkinnedMesh::shader;
+	renderable.primitiveType = GraphicDriver::Triangles;
+	renderable.boundingCenter = this->mesh->getBoundingCenter();
+	renderable.boundingRadius = this->mesh->getBoundingRadius();
+	renderable.geometry = &this->geometry;
+	
+	// the shadow shaders only take positions, they would draw the bind pose
+	renderable.castsShadows = false;
+	
+	if (this->gpuSkinned)
+	{
+		renderable.boneMatrices = &this->boneMatrices[0];
+		renderable.boneCount = this->mesh->getBoneCount();
+	}
+	
+	this->renderable = this->graphicWorld->registerRenderable(renderable);
+	this->registered = true;
+}
+
+void SkinnedMesh::unregisterRenderable()
+{
+	if (!this->registered)
+		return;
+	
+	this->graphicWorld->unregisterRenderable(this->renderable);
+	this->registered = false;
+}
+
+void SkinnedMesh::invalidateRenderable()
+{
+	if (this->registered)
+		this->graphicWorld->invalidateRenderable(this->renderable);
+}
+
+void SkinnedMesh::skinVertices(StreamBuffer *streamBuffer)
+{
+	const std::vector<GraphicDriver::SkinnedVertex> &vertices = this->mesh->getVertices();
+	
+	// nothing is drawn this frame when the buffer is full
+	unsigned int startElement = 0;
+	GraphicDriver::Standard3DVertex *skinnedVertices = (GraphicDriver::Standard3DVertex *)streamBuffer->allocate((unsigned int)vertices.size(), &startElement);
+	this->geometry.buffer = streamBuffer->getVertexBuffer();
+	this->geometry.startElement = startElement;
+	this->geometry.elementCount = skinnedVertices ? (unsigned int)vertices.size() : 0;
+	if (!skinnedVertices)
+		return;
+	
+	// blend the rows of the matrices four floats at a time, then transform once
+	const float *matrices = &this->boneMatrices[0].x;
+	Float4 weightScale = Simd::set(1.0f / 255.0f);
+	for (unsigned int i = 0; i < vertices.size(); i++)
+	{
+		const GraphicDriver::SkinnedVertex &vertex = vertices[i];
+		
+		Float4 rows[3];
+		for (int j = 0; j < 3; j++)
+			rows[j] = Simd::set(0.0f);
+		
+		for (int k = 0; k < 4; k++)
+		{
+			if (vertex.weights[k] == 0)
+				continue;
+			
+			Float4 weight = Simd::mul(Simd::set((float)vertex.weights[k]), weightScale);
+			const float *bone = matrices + vertex.bones[k] * 12;
+			for (int j = 0; j < 3; j++)
+				rows[j] = Simd::add(rows[j], Simd::mul(Simd::load(bone + j * 4), weight));
+		}
+		
+		float row[3][4];
+		for (int j = 0; j < 3; j++)
+			Simd::store(row[j], rows[j]);
+		
+		GraphicDriver::Standard3DVertex &skinnedVertex = skinnedVertices[i];
+		for (int j = 0; j < 3; j++)
+		{
+			skinnedVertex.position[j] = row[j][0] * vertex.position.x + row[j][1] * vertex.position.y + row[j][2] * vertex.position.z + row[j][3];
+			skinnedVertex.normal[j] = row[j][0] * vertex.normal.x + row[j][1] * vertex.normal.y + row[j][2] * vertex.normal.z;
+		}
+		skinnedVertex.uv = vertex.uv;
+	}
+}
+
+} // oak namespace
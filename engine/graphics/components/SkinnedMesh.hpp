@@ -0,0 +1,152 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/Pose.hpp>
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class AnimationResource;
+class GraphicDriver;
+class SkinnedMeshResource;
+class StreamBuffer;
+class TextureResource;
+struct ShaderProgram;
+
+/**
+ * Mesh deformed by a skeleton, posed by a blend of animation clips.
+ *
+ * Each of the layers plays a clip in a loop, at its own speed; the sampled
+ * poses are blended by the weights of the layers, the rest pose taking what
+ * their sum leaves below one. Poses are evaluated by jobs when a frame is
+ * prepared (see GraphicWorld::animateSkinnedMeshes).
+ *
+ * The bone matrices are sent to the vertex shader, which skins the vertices.
+ * Skeletons with more bones than the uniforms of the platform can hold are
+ * skinned on the CPU instead, into a stream buffer. Skinned meshes are lit like
+ * cubes, but cast no shadow.
+ */
+class SkinnedMesh: public Component
+{
+	public:
+		static const int layerCount = 4;
+		
+		SkinnedMesh(GraphicWorld *graphicWorld, GraphicDriver *driver);
+		virtual ~SkinnedMesh();
+		
+		SkinnedMeshResource *getMesh() const { return this->mesh; }
+		void setMesh(SkinnedMeshResource *mesh);
+		
+		glm::vec3 getColor() const { return this->color; }
+		void setColor(const glm::vec3 &color) { this->color = color; this->invalidateRenderable(); }
+		
+		// NULL for the default texture
+		TextureResource *getTexture() const { return this->texture; }
+		void setTexture(TextureResource *texture) { this->texture = texture; this->invalidateRenderable(); }
+		
+		// clip played by a layer, NULL to stop it; restarts the layer
+		AnimationResource *getAnimation(int layer) const;
+		void setAnimation(int layer, AnimationResource *animation);
+		
+		// share of the pose taken by a layer, usually between 0 and 1
+		float getLayerWeight(int layer) const;
+		void setLayerWeight(int layer, float weight);
+		
+		// playback rate of a layer, 1 for the recorded speed
+		float getLayerSpeed(int layer) const;
+		void setLayerSpeed(int layer, float speed);
+		
+		// position of a layer in its clip, in seconds
+		float getLayerTime(int layer) const;
+		void setLayerTime(int layer, float time);
+		
+		// whether the bones are sent to the vertex shader, rather than skinned on the CPU
+		bool isGpuSkinned() const { return this->gpuSkinned; }
+		
+		// Advance the layers by the given time and evaluate the pose, recorded
+		// again with the frame; skinning on the CPU writes the vertices in the given
+		// stream buffer (when a frame is prepared, by a job).
+		void animate(float elapsedTime, StreamBuffer *streamBuffer);
+		
+		// Component
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+		virtual void entityMoved(Entity *entity);
+	
+	private:
+		void registerRenderable();
+		void unregisterRenderable();
+		
+		// record the renderable again with the next frame, when registered
+		void invalidateRenderable();
+		void skinVertices(StreamBuffer *streamBuffer);
+		
+		GraphicWorld *graphicWorld;
+		GraphicDriver *driver;
+		
+		// shared for all skinned meshes: bones at most in the uniforms, and the
+		// shaders skinning on the GPU, and drawing what the CPU skinned
+		static unsigned int maxBones;
+		static ShaderProgram *skinningShader;
+		static ShaderProgram *shader;
+		static unsigned int instanceCount;
+		
+		SkinnedMeshResource *mesh;
+		glm::vec3 color;
+		TextureResource *texture;
+		bool gpuSkinned;
+		
+		struct Layer
+		{
+			AnimationResource *animation;
+			float weight;
+			float speed;
+			float time;
+		};
+		Layer layers[layerCount];
+		
+		// blended pose, the pose of a layer, and the three first rows of each
+		// skinning matrix, read by the renderable
+		Pose pose;
+		Pose layerPose;
+		std::vector<glm::vec4> boneMatrices;
+		
+		// drawn geometry, from the stream buffer when skinned on the CPU
+		GraphicWorld::Lod geometry;
+		
+		Entity *entity; // while active
+		bool registered;
+		GraphicWorld::RenderableHandle renderable; // when registered
+};
+
+} // oak namespace
@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Sprite.hpp>
+
+#include <engine/graphics/GraphicWorld.hpp>
+
+namespace oak {
+
+Sprite::Sprite(GraphicWorld *graphicWorld)
+	: graphicWorld(graphicWorld)
+	, entity(NULL)
+	, texture(NULL)
+	, region(0.0f, 0.0f, 1.0f, 1.0f)
+	, size(1.0f, 1.0f)
+	, color(1.0f, 1.0f, 1.0f)
+	, opacity(1.0f)
+	, layer(0)
+	, additive(false)
+	, billboard(false)
+{
+}
+
+void Sprite::activateComponent(Entity *entity)
+{
+	this->graphicWorld->registerSprite(this);
+}
+
+void Sprite::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterSprite(this);
+}
+
+} // oak namespace
@@ -0,0 +1,105 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+namespace oak {
+
+class GraphicWorld;
+class TextureResource;
+
+/**
+ * Textured quad, centered on its entity in its XY plane, or facing the camera
+ * as a billboard. Sprites are not renderables: each view batches the visible
+ * ones of its world into dynamic vertices, sorted by layer, texture and blend
+ * mode, and draws each run sharing a texture and a mode at once (see
+ * SpriteBatcher). They are blended over the scene, after it.
+ *
+ * Many sprites can share one texture atlas, each drawing a region of it; the
+ * regions are listed by the atlas packer (see tools/atlas-packer).
+ */
+class Sprite: public Component
+{
+	public:
+		Sprite(GraphicWorld *graphicWorld);
+		virtual ~Sprite() {}
+		
+		// NULL for the default texture
+		TextureResource *getTexture() const { return this->texture; }
+		void setTexture(TextureResource *texture) { this->texture = texture; }
+		
+		// part of the texture drawn: left, top, right and bottom texture coordinates
+		const glm::vec4 &getRegion() const { return this->region; }
+		void setRegion(const glm::vec4 &region) { this->region = region; }
+		
+		// in local units
+		const glm::vec2 &getSize() const { return this->size; }
+		void setSize(const glm::vec2 &size) { this->size = size; }
+		
+		// multiplied by the texture
+		const glm::vec3 &getColor() const { return this->color; }
+		void setColor(const glm::vec3 &color) { this->color = color; }
+		float getOpacity() const { return this->opacity; }
+		void setOpacity(float opacity) { this->opacity = opacity; }
+		
+		// lower layers are drawn first, under the higher ones
+		int getLayer() const { return this->layer; }
+		void setLayer(int layer) { this->layer = layer; }
+		
+		// added to the scene instead of drawn over it, for glows and sparks
+		bool isAdditive() const { return this->additive; }
+		void setAdditive(bool additive) { this->additive = additive; }
+		
+		// facing the camera, only scaled by the entity
+		bool isBillboard() const { return this->billboard; }
+		void setBillboard(bool billboard) { this->billboard = billboard; }
+		
+		Entity *getEntity() const { return this->entity; }
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		GraphicWorld *graphicWorld;
+		Entity *entity;
+		
+		TextureResource *texture;
+		glm::vec4 region;
+		glm::vec2 size;
+		glm::vec3 color;
+		float opacity;
+		int layer;
+		bool additive;
+		bool billboard;
+};
+
+} // oak namespace
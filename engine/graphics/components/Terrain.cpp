@@ -0,0 +1,440 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Terrain.hpp>
+
+#include <engine/graphics/CommandList.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/LightClusters.hpp>
+#include <engine/graphics/ShadowMaps.hpp>
+#include <engine/graphics/TextureManager.hpp>
+#include <engine/graphics/components/Camera.hpp>
+#include <engine/graphics/shaders/terrain.vs.h>
+#include <engine/graphics/shaders/cube.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <engine/system/Log.hpp>
+#include <engine/system/Time.hpp>
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oak {
+
+namespace { // private section
+
+// bound after the shadow maps
+const unsigned int heightmapUnit = 6;
+
+unsigned char encodeUnit(float value)
+{
+	return (unsigned char)(glm::clamp(value * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+} // end of private section
+
+ShaderProgram *Terrain::shader = NULL;
+VertexBuffer *Terrain::patchBuffer = NULL;
+unsigned int Terrain::instanceCount = 0;
+
+Terrain::Terrain(GraphicWorld *graphicWorld, GraphicDriver *driver)
+	: graphicWorld(graphicWorld)
+	, driver(driver)
+	, resolution(0)
+	, maxLevel(0)
+	, spacing(1.0f)
+	, heightmap(NULL)
+	, heightRange(0.0f, 0.0f)
+	, dirty(false)
+	, allDirty(false)
+	, texture(NULL)
+	, textureScale(1.0f)
+	, lodRange(2.0f)
+	, entity(NULL)
+{
+	// terrains are lit like cubes
+	if (Terrain::instanceCount == 0)
+	{
+		Terrain::shader = this->driver->createShaderProgram(terrainVSString, cubeFSString);
+		
+		// two triangles per quad, positions in grid steps
+		std::vector<GraphicDriver::Standard3DVertex> vertices;
+		vertices.reserve(patchSize * patchSize * 6);
+		static const unsigned int corners[6][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } };
+		for (unsigned int z = 0; z < patchSize; z++)
+		{
+			for (unsigned int x = 0; x < patchSize; x++)
+			{
+				for (unsigned int i = 0; i < 6; i++)
+				{
+					GraphicDriver::Standard3DVertex vertex = {
+						glm::vec3((float)(x + corners[i][0]), 0.0f, (float)(z + corners[i][1])),
+						glm::vec3(0.0f, 1.0f, 0.0f),
+						glm::vec2(0.0f, 0.0f)
+					};
+					vertices.push_back(vertex);
+				}
+			}
+		}
+		Terrain::patchBuffer = this->driver->createVertexBuffer(&vertices[0], (unsigned int)vertices.size());
+	}
+	
+	Terrain::instanceCount++;
+	
+	this->dirtyMin[0] = this->dirtyMin[1] = 0;
+	this->dirtyMax[0] = this->dirtyMax[1] = 0;
+}
+
+Terrain::~Terrain()
+{
+	if (this->heightmap)
+		this->driver->destroyTexture(this->heightmap);
+	
+	Terrain::instanceCount--;
+	
+	if (Terrain::instanceCount == 0)
+	{
+		this->driver->destroyVertexBuffer(Terrain::patchBuffer);
+		this->driver->destroyShaderProgram(Terrain::shader);
+	}
+}
+
+void Terrain::setResolution(int resolution)
+{
+	// power of two patches along each side
+	unsigned int patchCount = 1;
+	this->maxLevel = 0;
+	while (patchSize * patchCount + 1 < (unsigned int)std::max(resolution, 0))
+	{
+		patchCount *= 2;
+		this->maxLevel++;
+	}
+	
+	this->resolution = (resolution > 0) ? patchSize * patchCount + 1 : 0;
+	if (this->resolution != (unsigned int)std::max(resolution, 0))
+		Log::warning("Terrain resolution rounded up from %d to %u samples", resolution, this->resolution);
+	
+	this->heights.assign(this->resolution * this->resolution, 0.0f);
+	this->texels.assign(this->resolution * this->resolution * 4, 0);
+	this->minHeights.assign(getNodeIndex(this->maxLevel + 1, 0, 0), 0.0f);
+	this->maxHeights.assign(getNodeIndex(this->maxLevel + 1, 0, 0), 0.0f);
+	
+	if (this->heightmap)
+	{
+		this->driver->destroyTexture(this->heightmap);
+		this->heightmap = NULL;
+	}
+	
+	if (this->resolution > 0)
+	{
+		this->heightmap = this->driver->createTexture();
+		this->driver->setTextureSampling(this->heightmap, false, false);
+		this->dirty = true;
+		this->allDirty = true;
+	}
+}
+
+float Terrain::getHeight(int x, int z) const
+{
+	if (x < 0 || z < 0 || x >= (int)this->resolution || z >= (int)this->resolution)
+		return 0.0f;
+	
+	return this->heights[x + z * this->resolution];
+}
+
+void Terrain::setHeight(int x, int z, float height)
+{
+	if (x < 0 || z < 0 || x >= (int)this->resolution || z >= (int)this->resolution)
+		return;
+	
+	this->heights[x + z * this->resolution] = height;
+	
+	// heights out of the encoded range extend it
+	if (height < this->heightRange.x || height > this->heightRange.y)
+		this->allDirty = true;
+	
+	if (!this->dirty)
+	{
+		this->dirtyMin[0] = this->dirtyMax[0] = (unsigned int)x;
+		this->dirtyMin[1] = this->dirtyMax[1] = (unsigned int)z;
+		this->dirty = true;
+	}
+	else
+	{
+		this->dirtyMin[0] = std::min(this->dirtyMin[0], (unsigned int)x);
+		this->dirtyMin[1] = std::min(this->dirtyMin[1], (unsigned int)z);
+		this->dirtyMax[0] = std::max(this->dirtyMax[0], (unsigned int)x);
+		this->dirtyMax[1] = std::max(this->dirtyMax[1], (unsigned int)z);
+	}
+}
+
+void Terrain::setSpacing(float spacing)
+{
+	// normals depend on it
+	this->spacing = std::max(spacing, 1e-3f);
+	if (this->resolution > 0)
+		this->dirty = this->allDirty = true;
+}
+
+void Terrain::update()
+{
+	if (!this->dirty)
+		return;
+	
+	unsigned int last = this->resolution - 1;
+	if (this->allDirty)
+	{
+		this->heightRange.x = *std::min_element(this->heights.begin(), this->heights.end());
+		this->heightRange.y = *std::max_element(this->heights.begin(), this->heights.end());
+		
+		this->encodeSamples(0, 0, last, last);
+		this->driver->uploadTextureLevel(this->heightmap, GraphicDriver::RGBA8TextureFormat, 0, this->resolution, this->resolution, &this->texels[0]);
+		this->updateBounds(0, 0, last, last);
+	}
+	else
+	{
+		// the normals of the neighbour samples change too
+		unsigned int firstX = (this->dirtyMin[0] > 0) ? this->dirtyMin[0] - 1 : 0;
+		unsigned int firstZ = (this->dirtyMin[1] > 0) ? this->dirtyMin[1] - 1 : 0;
+		unsigned int lastX = std::min(this->dirtyMax[0] + 1, last);
+		unsigned int lastZ = std::min(this->dirtyMax[1] + 1, last);
+		this->encodeSamples(firstX, firstZ, lastX, lastZ);
+		
+		unsigned int width = lastX - firstX + 1;
+		unsigned int height = lastZ - firstZ + 1;
+		std::vector<unsigned char> region(width * height * 4);
+		for (unsigned int z = 0; z < height; z++)
+			std::copy(&this->texels[(firstX + (firstZ + z) * this->resolution) * 4], &this->texels[(firstX + (firstZ + z) * this->resolution) * 4] + width * 4, &region[z * width * 4]);
+		this->driver->uploadTextureRegion(this->heightmap, firstX, firstZ, width, height, &region[0]);
+		
+		this->updateBounds(this->dirtyMin[0], this->dirtyMin[1], this->dirtyMax[0], this->dirtyMax[1]);
+	}
+	
+	this->dirty = false;
+	this->allDirty = false;
+}
+
+void Terrain::record(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, float fogDensity, Texture *defaultTexture) const
+{
+	if (!this->entity || this->resolution == 0)
+		return;
+	
+	const glm::mat4 &modelMatrix = this->entity->getLocalTransform();
+	const glm::mat4 &cameraTransform = camera->getEntity()->getLocalTransform();
+	glm::mat4 viewMatrix = glm::affineInverse(cameraTransform);
+	const glm::mat4 &projectionMatrix = camera->getProjectionMatrix();
+	
+	// patches are selected in the space of the terrain
+	Frustum frustum(projectionMatrix * viewMatrix * modelMatrix);
+	glm::vec3 cameraPosition = glm::vec3(glm::affineInverse(modelMatrix) * cameraTransform[3]);
+	
+	std::vector<unsigned int> patches;
+	this->selectPatches(0, 0, 0, cameraPosition, frustum, &patches);
+	if (patches.empty())
+		return;
+	
+	// sorted for the neighbour lookups
+	std::sort(patches.begin(), patches.end());
+	
+	commandList->bindShaderProgram(Terrain::shader);
+	commandList->setShaderConstant("viewMatrix", viewMatrix);
+	commandList->setShaderConstant("projectionMatrix", projectionMatrix);
+	commandList->setShaderConstant("time", (float)Time::getTime());
+	lightClusters->record(commandList);
+	shadowMaps->record(commandList);
+	commandList->setShaderConstant("lodFade", 0.0f);
+	commandList->setShaderConstant("fogDensity", fogDensity);
+	
+	if (this->texture && this->texture->isUsable())
+		this->texture->requestLevel(0);
+	commandList->bindTexture(this->texture ? this->texture->getTexture() : defaultTexture, 0);
+	commandList->bindTexture(this->heightmap, heightmapUnit);
+	commandList->setShaderConstant("heightmap", (int)heightmapUnit);
+	
+	commandList->setShaderConstant("modelMatrix", modelMatrix);
+	commandList->setShaderConstant("normalMatrix", glm::inverseTranspose(glm::mat3(modelMatrix)));
+	commandList->setShaderConstant("color", glm::vec3(1.0f, 1.0f, 1.0f));
+	commandList->setShaderConstant("heightRange", glm::vec2(this->heightRange.x, this->heightRange.y - this->heightRange.x));
+	commandList->setShaderConstant("terrainScale", glm::vec3((float)this->resolution, this->spacing, this->textureScale));
+	
+	commandList->bindVertexBuffer(Terrain::patchBuffer);
+	for (unsigned int i = 0; i < patches.size(); i++)
+	{
+		unsigned int level = 0;
+		while (getNodeIndex(level + 1, 0, 0) <= patches[i])
+			level++;
+		unsigned int offset = patches[i] - getNodeIndex(level, 0, 0);
+		int x = (int)(offset & ((1u << level) - 1));
+		int z = (int)(offset >> level);
+		
+		float step = (float)(1u << (this->maxLevel - level));
+		commandList->setShaderConstant("terrainPatch", glm::vec4((float)x * step * patchSize, (float)z * step * patchSize, step, (float)patchSize));
+		commandList->setShaderConstant("terrainEdges", glm::vec4(
+			this->getNeighbourStep(patches, level, x - 1, z),
+			this->getNeighbourStep(patches, level, x + 1, z),
+			this->getNeighbourStep(patches, level, x, z - 1),
+			this->getNeighbourStep(patches, level, x, z + 1)));
+		commandList->draw(GraphicDriver::Triangles, 0, patchSize * patchSize * 6);
+	}
+}
+
+void Terrain::activateComponent(Entity *entity)
+{
+	this->graphicWorld->registerTerrain(this);
+}
+
+void Terrain::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterTerrain(this);
+}
+
+void Terrain::selectPatches(unsigned int level, unsigned int x, unsigned int z, const glm::vec3 &cameraPosition, const Frustum &frustum, std::vector<unsigned int> *patches) const
+{
+	unsigned int index = getNodeIndex(level, x, z);
+	float size = (float)(patchSize << (this->maxLevel - level)) * this->spacing;
+	glm::vec3 minCorner((float)x * size, this->minHeights[index], (float)z * size);
+	glm::vec3 maxCorner((float)(x + 1) * size, this->maxHeights[index], (float)(z + 1) * size);
+	if (!frustum.intersectsBox(minCorner, maxCorner))
+		return;
+	
+	// split the nodes close to the camera
+	if (level < this->maxLevel && glm::distance(cameraPosition, glm::clamp(cameraPosition, minCorner, maxCorner)) < this->lodRange * size)
+	{
+		for (unsigned int i = 0; i < 4; i++)
+			this->selectPatches(level + 1, x * 2 + (i & 1), z * 2 + (i >> 1), cameraPosition, frustum, patches);
+		return;
+	}
+	
+	patches->push_back(index);
+}
+
+float Terrain::getNeighbourStep(const std::vector<unsigned int> &patches, unsigned int level, int x, int z) const
+{
+	// a coarser neighbour is a selected ancestor of the node next to this one,
+	// other neighbours follow this patch
+	int nodeCount = 1 << level;
+	if (x >= 0 && z >= 0 && x < nodeCount && z < nodeCount)
+	{
+		for (unsigned int ancestor = 0; ancestor < level; ancestor++)
+		{
+			unsigned int shift = level - ancestor;
+			if (std::binary_search(patches.begin(), patches.end(), getNodeIndex(ancestor, (unsigned int)x >> shift, (unsigned int)z >> shift)))
+				return (float)(1u << (this->maxLevel - ancestor));
+		}
+	}
+	
+	return (float)(1u << (this->maxLevel - level));
+}
+
+void Terrain::encodeSamples(unsigned int firstX, unsigned int firstZ, unsigned int lastX, unsigned int lastZ)
+{
+	float scale = (this->heightRange.y > this->heightRange.x) ? 65535.0f / (this->heightRange.y - this->heightRange.x) : 0.0f;
+	unsigned int last = this->resolution - 1;
+	for (unsigned int z = firstZ; z <= lastZ; z++)
+	{
+		for (unsigned int x = firstX; x <= lastX; x++)
+		{
+			unsigned int index = x + z * this->resolution;
+			unsigned int value = (unsigned int)((this->heights[index] - this->heightRange.x) * scale + 0.5f);
+			
+			// central differences, one-sided on the borders
+			unsigned int left = (x > 0) ? x - 1 : x;
+			unsigned int right = (x < last) ? x + 1 : x;
+			unsigned int down = (z > 0) ? z - 1 : z;
+			unsigned int up = (z < last) ? z + 1 : z;
+			float slopeX = (this->heights[right + z * this->resolution] - this->heights[left + z * this->resolution]) / (float)(right - left);
+			float slopeZ = (this->heights[x + up * this->resolution] - this->heights[x + down * this->resolution]) / (float)(up - down);
+			glm::vec3 normal = glm::normalize(glm::vec3(-slopeX, this->spacing, -slopeZ));
+			
+			unsigned char *texel = &this->texels[index * 4];
+			texel[0] = (unsigned char)(value >> 8);
+			texel[1] = (unsigned char)(value & 0xff);
+			texel[2] = encodeUnit(normal.x);
+			texel[3] = encodeUnit(normal.z);
+		}
+	}
+}
+
+void Terrain::updateBounds(unsigned int firstX, unsigned int firstZ, unsigned int lastX, unsigned int lastZ)
+{
+	// patches share their border samples
+	unsigned int leafCount = 1u << this->maxLevel;
+	unsigned int firstLeaf[2] = { (firstX > 0) ? (firstX - 1) / patchSize : 0, (firstZ > 0) ? (firstZ - 1) / patchSize : 0 };
+	unsigned int lastLeaf[2] = { std::min(lastX / patchSize, leafCount - 1), std::min(lastZ / patchSize, leafCount - 1) };
+	
+	for (unsigned int leafZ = firstLeaf[1]; leafZ <= lastLeaf[1]; leafZ++)
+	{
+		for (unsigned int leafX = firstLeaf[0]; leafX <= lastLeaf[0]; leafX++)
+		{
+			float minimum = this->heights[leafX * patchSize + leafZ * patchSize * this->resolution];
+			float maximum = minimum;
+			for (unsigned int z = leafZ * patchSize; z <= (leafZ + 1) * patchSize; z++)
+			{
+				const float *row = &this->heights[z * this->resolution];
+				for (unsigned int x = leafX * patchSize; x <= (leafX + 1) * patchSize; x++)
+				{
+					minimum = std::min(minimum, row[x]);
+					maximum = std::max(maximum, row[x]);
+				}
+			}
+			
+			unsigned int index = getNodeIndex(this->maxLevel, leafX, leafZ);
+			this->minHeights[index] = minimum;
+			this->maxHeights[index] = maximum;
+		}
+	}
+	
+	// then their ancestors, from their four children
+	for (unsigned int level = this->maxLevel; level-- > 0;)
+	{
+		unsigned int shift = this->maxLevel - level;
+		for (unsigned int z = firstLeaf[1] >> shift; z <= lastLeaf[1] >> shift; z++)
+		{
+			for (unsigned int x = firstLeaf[0] >> shift; x <= lastLeaf[0] >> shift; x++)
+			{
+				unsigned int children[4] = {
+					getNodeIndex(level + 1, x * 2, z * 2),
+					getNodeIndex(level + 1, x * 2 + 1, z * 2),
+					getNodeIndex(level + 1, x * 2, z * 2 + 1),
+					getNodeIndex(level + 1, x * 2 + 1, z * 2 + 1)
+				};
+				
+				unsigned int index = getNodeIndex(level, x, z);
+				this->minHeights[index] = this->minHeights[children[0]];
+				this->maxHeights[index] = this->maxHeights[children[0]];
+				for (unsigned int i = 1; i < 4; i++)
+				{
+					this->minHeights[index] = std::min(this->minHeights[index], this->minHeights[children[i]]);
+					this->maxHeights[index] = std::max(this->maxHeights[index], this->maxHeights[children[i]]);
+				}
+			}
+		}
+	}
+}
+
+} // oak namespace
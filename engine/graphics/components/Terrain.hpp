@@ -0,0 +1,153 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/GraphicDriver.hpp>
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class Camera;
+class CommandList;
+class GraphicWorld;
+class LightClusters;
+class ShadowMaps;
+class TextureResource;
+
+/**
+ * Heightfield ground, drawn in patches of 32 by 32 quads whose detail decreases
+ * with the distance to the camera.
+ *
+ * Heights are kept in a texture, and all patches draw the same flat grid, moved
+ * to its height by the vertex shader; coarser patches skip samples. Patches
+ * form a quadtree over the heightfield, with the height bounds of each node:
+ * each view walks it down from the root, culling whole nodes, and splits the
+ * nodes closer than a few times their size. Along an edge shared with a coarser
+ * patch, vertices are moved onto its edge, so that no crack opens.
+ *
+ * Sample (x, z) is at (x * spacing, height, z * spacing) in the space of the
+ * entity. Terrains are lit like cubes, but cast no shadow.
+ */
+class Terrain: public Component
+{
+	public:
+		Terrain(GraphicWorld *graphicWorld, GraphicDriver *driver);
+		virtual ~Terrain();
+		
+		// samples along each side, flattening the terrain; rounded up to the patch
+		// size (32) times a power of two, plus one
+		int getResolution() const { return (int)this->resolution; }
+		void setResolution(int resolution);
+		
+		// samples outside of the terrain read as 0, and cannot be set
+		float getHeight(int x, int z) const;
+		void setHeight(int x, int z, float height);
+		
+		// distance between two samples
+		float getSpacing() const { return this->spacing; }
+		void setSpacing(float spacing);
+		
+		// repeated over the terrain, NULL for the default texture
+		TextureResource *getTexture() const { return this->texture; }
+		void setTexture(TextureResource *texture) { this->texture = texture; }
+		
+		// local size covered by the whole texture
+		float getTextureScale() const { return this->textureScale; }
+		void setTextureScale(float scale) { this->textureScale = scale; }
+		
+		// patches are split while the camera is closer than this many times their size
+		float getLodRange() const { return this->lodRange; }
+		void setLodRange(float range) { this->lodRange = range; }
+		
+		// Upload the heights changed since the last call, and update the bounds of
+		// their patches (once per prepared frame, while active).
+		void update();
+		
+		// Record the patches seen from the given camera, lit by the lights binned in
+		// the given clusters for this camera and shadowed by the given maps. Several
+		// views can record the same terrain concurrently.
+		void record(CommandList *commandList, const Camera *camera, const LightClusters *lightClusters, const ShadowMaps *shadowMaps, float fogDensity, Texture *defaultTexture) const;
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		static const unsigned int patchSize = 32;
+		
+		// quadtree nodes, level by level from the root, each in rows along x
+		static unsigned int getNodeIndex(unsigned int level, unsigned int x, unsigned int z) { return ((1u << (2 * level)) - 1) / 3 + x + (z << level); }
+		
+		void selectPatches(unsigned int level, unsigned int x, unsigned int z, const glm::vec3 &cameraPosition, const Frustum &frustum, std::vector<unsigned int> *patches) const;
+		float getNeighbourStep(const std::vector<unsigned int> &patches, unsigned int level, int x, int z) const;
+		
+		void encodeSamples(unsigned int firstX, unsigned int firstZ, unsigned int lastX, unsigned int lastZ);
+		void updateBounds(unsigned int firstX, unsigned int firstZ, unsigned int lastX, unsigned int lastZ);
+		
+		GraphicWorld *graphicWorld;
+		GraphicDriver *driver;
+		
+		// shared for all terrains: a flat patch, in grid steps
+		static ShaderProgram *shader;
+		static VertexBuffer *patchBuffer;
+		static unsigned int instanceCount;
+		
+		unsigned int resolution;
+		unsigned int maxLevel; // of the patches of full detail
+		float spacing;
+		std::vector<float> heights;
+		
+		// heights and normals, in the format read by the shader
+		Texture *heightmap;
+		std::vector<unsigned char> texels;
+		glm::vec2 heightRange; // lowest and highest heights encoded
+		
+		// lowest and highest heights under each quadtree node
+		std::vector<float> minHeights;
+		std::vector<float> maxHeights;
+		
+		// samples changed since the last update, inclusive
+		bool dirty;
+		bool allDirty; // the height range or the spacing changed
+		unsigned int dirtyMin[2];
+		unsigned int dirtyMax[2];
+		
+		TextureResource *texture;
+		float textureScale;
+		float lodRange;
+		
+		Entity *entity;
+};
+
+} // oak namespace
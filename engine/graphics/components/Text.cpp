@@ -0,0 +1,109 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/Text.hpp>
+
+#include <engine/graphics/GraphicWorld.hpp>
+#include <engine/graphics/TextLayoutCache.hpp>
+
+#include <algorithm>
+
+namespace oak {
+
+namespace { // private section
+
+const unsigned int defaultSize = 16;
+
+} // end of private section
+
+Text::Text(GraphicWorld *graphicWorld, TextLayoutCache *layoutCache)
+	: graphicWorld(graphicWorld)
+	, layoutCache(layoutCache)
+	, entity(NULL)
+	, layout(NULL)
+	, color(1.0f, 1.0f, 1.0f)
+	, opacity(1.0f)
+	, layer(0)
+{
+	this->setLayout(std::string(), defaultSize);
+}
+
+Text::~Text()
+{
+	this->layoutCache->release(this->layout);
+}
+
+const std::string &Text::getText() const
+{
+	return this->layout->text;
+}
+
+void Text::setText(const std::string &text)
+{
+	if (text != this->layout->text)
+		this->setLayout(text, this->layout->size);
+}
+
+int Text::getSize() const
+{
+	return (int)this->layout->size;
+}
+
+void Text::setSize(int size)
+{
+	if (size != (int)this->layout->size)
+		this->setLayout(this->layout->text, (unsigned int)std::max(size, 0));
+}
+
+float Text::getWidth() const
+{
+	return this->layout->extent.x;
+}
+
+float Text::getHeight() const
+{
+	return this->layout->extent.y;
+}
+
+void Text::activateComponent(Entity *entity)
+{
+	this->graphicWorld->registerText(this);
+}
+
+void Text::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterText(this);
+}
+
+void Text::setLayout(const std::string &text, unsigned int size)
+{
+	// acquired first, the previous layout may be the same one
+	TextLayout *layout = this->layoutCache->acquire(text, size);
+	if (this->layout)
+		this->layoutCache->release(this->layout);
+	this->layout = layout;
+}
+
+} // oak namespace
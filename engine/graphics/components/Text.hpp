@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/sg/Component.hpp>
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+namespace oak {
+
+class GraphicWorld;
+class TextLayoutCache;
+struct TextLayout;
+
+/**
+ * String drawn over the views of its world, for HUDs and user interfaces.
+ * The top-left corner of the text is placed at the X and Y coordinates of its
+ * entity, in pixels from the top-left corner of the view (at its full size
+ * when drawn at a lower resolution); it is never hidden by the scene.
+ *
+ * The string is laid out when set, the layout being shared with other texts
+ * showing the same string at the same size (see TextLayoutCache), so texts
+ * that do not change cost no layout. Glyphs are drawn as quads from the glyph
+ * atlas, with the sprites of the view (see SpriteBatcher).
+ */
+class Text: public Component
+{
+	public:
+		Text(GraphicWorld *graphicWorld, TextLayoutCache *layoutCache);
+		virtual ~Text();
+		
+		const std::string &getText() const;
+		void setText(const std::string &text);
+		
+		// height of the glyphs, in pixels
+		int getSize() const;
+		void setSize(int size);
+		
+		// size of the laid out text, in pixels
+		float getWidth() const;
+		float getHeight() const;
+		
+		const glm::vec3 &getColor() const { return this->color; }
+		void setColor(const glm::vec3 &color) { this->color = color; }
+		float getOpacity() const { return this->opacity; }
+		void setOpacity(float opacity) { this->opacity = opacity; }
+		
+		// lower layers are drawn first, under the higher ones
+		int getLayer() const { return this->layer; }
+		void setLayer(int layer) { this->layer = layer; }
+		
+		// owned by the layout cache
+		TextLayout *getLayout() const { return this->layout; }
+		
+		Entity *getEntity() const { return this->entity; }
+		
+		// Component
+		virtual void attachComponent(Entity *entity) { this->entity = entity; }
+		virtual void detachComponent(Entity *entity) { this->entity = NULL; }
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+	
+	private:
+		void setLayout(const std::string &text, unsigned int size);
+		
+		GraphicWorld *graphicWorld;
+		TextLayoutCache *layoutCache;
+		Entity *entity;
+		
+		TextLayout *layout;
+		glm::vec3 color;
+		float opacity;
+		int layer;
+};
+
+} // oak namespace
@@ -0,0 +1,526 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/graphics/components/VoxelChunk.hpp>
+
+#include <engine/graphics/shaders/cube.vs.h>
+#include <engine/graphics/shaders/cube.fs.h>
+
+#include <engine/sg/Entity.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace oak {
+
+namespace { // private section
+
+// cells are rounded down, those outside of the grid are rejected
+bool getCell(const glm::vec3 &position, const unsigned int size[3], unsigned int cell[3])
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float coordinate = std::floor(position[axis]);
+		if (coordinate < 0.0f || coordinate >= (float)size[axis])
+			return false;
+		
+		cell[axis] = (unsigned int)coordinate;
+	}
+	
+	return true;
+}
+
+// two triangles covering a face, seen counter-clockwise from the normal side
+void addQuad(std::vector<GraphicDriver::Standard3DVertex> *vertices, const glm::vec3 corners[4], const glm::vec3 &normal, const glm::vec2 &extent, bool flipped)
+{
+	const glm::vec2 uvs[4] = { glm::vec2(0.0f, 0.0f), glm::vec2(extent.x, 0.0f), extent, glm::vec2(0.0f, extent.y) };
+	static const unsigned int order[6] = { 0, 1, 2, 2, 3, 0 };
+	static const unsigned int flippedOrder[6] = { 0, 3, 2, 2, 1, 0 };
+	
+	const unsigned int *corner = flipped ? flippedOrder : order;
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		GraphicDriver::Standard3DVertex vertex = { corners[corner[i]], normal, uvs[corner[i]] };
+		vertices->push_back(vertex);
+	}
+}
+
+// index of the lowest set bit, which must exist (de Bruijn sequence)
+unsigned int getLowestBit(unsigned int bits)
+{
+	static const unsigned int positions[32] = {
+		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+	};
+	
+	return positions[((bits & (0u - bits)) * 0x077cb531u) >> 27];
+}
+
+// Faces of the blocks of a section, bordered by one block on each side, merged
+// greedily. Cells are packed in columns of bits along each axis, where visible
+// faces (solid cells next to an empty one) are found a whole column at a time.
+// Faces are then sorted in slices, one bit per face in rows of 32, and grown in
+// rectangles as wide as possible, then as high as the whole width allows.
+void buildMesh(const unsigned char *blocks, const unsigned int size[3], const glm::vec3 &origin, std::vector<GraphicDriver::Standard3DVertex> *vertices)
+{
+	const unsigned int paddedSize[3] = { size[0] + 2, size[1] + 2, size[2] + 2 };
+	
+	// solid cells, in columns indexed by their position on the two other axes
+	std::vector<unsigned long long> columns[3];
+	unsigned int solidCount = 0;
+	for (unsigned int d = 0; d < 3; d++)
+		columns[d].assign(paddedSize[(d + 1) % 3] * paddedSize[(d + 2) % 3], 0);
+	
+	for (unsigned int z = 0; z < paddedSize[2]; z++)
+	{
+		for (unsigned int y = 0; y < paddedSize[1]; y++)
+		{
+			const unsigned char *row = blocks + paddedSize[0] * (y + paddedSize[1] * z);
+			for (unsigned int x = 0; x < paddedSize[0]; x++)
+			{
+				if (row[x] == 0)
+					continue;
+				
+				columns[0][y + paddedSize[1] * z] |= 1ull << x;
+				columns[1][z + paddedSize[2] * x] |= 1ull << y;
+				columns[2][x + paddedSize[0] * y] |= 1ull << z;
+				solidCount++;
+			}
+		}
+	}
+	
+	// nothing to do for empty sections, nor for full ones surrounded by blocks
+	if (solidCount == 0 || solidCount == paddedSize[0] * paddedSize[1] * paddedSize[2])
+		return;
+	
+	// faces of each slice of the section, for both sides
+	unsigned int faces[2][32][32];
+	for (unsigned int d = 0; d < 3; d++)
+	{
+		unsigned int u = (d + 1) % 3;
+		unsigned int v = (d + 2) % 3;
+		
+		memset(faces, 0, sizeof(faces));
+		unsigned long long inside = ((1ull << size[d]) - 1) << 1;
+		for (unsigned int j = 0; j < size[v]; j++)
+		{
+			for (unsigned int i = 0; i < size[u]; i++)
+			{
+				unsigned long long column = columns[d][(i + 1) + paddedSize[u] * (j + 1)];
+				unsigned int sides[2] = {
+					(unsigned int)(((column & ~(column << 1)) & inside) >> 1),
+					(unsigned int)(((column & ~(column >> 1)) & inside) >> 1)
+				};
+				
+				for (unsigned int side = 0; side < 2; side++)
+				{
+					for (unsigned int bits = sides[side]; bits != 0; bits &= bits - 1)
+						faces[side][getLowestBit(bits)][j] |= 1u << i;
+				}
+			}
+		}
+		
+		for (unsigned int side = 0; side < 2; side++)
+		{
+			glm::vec3 normal(0.0f);
+			normal[d] = side ? 1.0f : -1.0f;
+			
+			for (unsigned int slice = 0; slice < size[d]; slice++)
+			{
+				unsigned int *rows = faces[side][slice];
+				for (unsigned int j = 0; j < size[v]; j++)
+				{
+					while (rows[j] != 0)
+					{
+						// run of faces from the first one, then rows below fully covering it
+						unsigned int i = getLowestBit(rows[j]);
+						unsigned int gaps = ~(rows[j] >> i);
+						unsigned int width = gaps ? getLowestBit(gaps) : 32 - i;
+						unsigned int run = ((width < 32) ? ((1u << width) - 1) : ~0u) << i;
+						
+						unsigned int height = 1;
+						while (j + height < size[v] && (rows[j + height] & run) == run)
+						{
+							rows[j + height] &= ~run;
+							height++;
+						}
+						rows[j] &= ~run;
+						
+						glm::vec3 corners[4];
+						for (unsigned int c = 0; c < 4; c++)
+						{
+							corners[c] = origin;
+							corners[c][d] += (float)(slice + side);
+							corners[c][u] += (float)(i + ((c == 1 || c == 2) ? width : 0));
+							corners[c][v] += (float)(j + ((c >= 2) ? height : 0));
+						}
+						
+						addQuad(vertices, corners, normal, glm::vec2((float)width, (float)height), side == 0);
+					}
+				}
+			}
+		}
+	}
+}
+
+} // end of private section
+
+const unsigned int VoxelChunk::sectionSize;
+
+ShaderProgram *VoxelChunk::shader = NULL;
+unsigned int VoxelChunk::instanceCount = 0;
+
+VoxelChunk::VoxelChunk(GraphicWorld *graphicWorld, GraphicDriver *driver, JobQueue *jobQueue)
+	: graphicWorld(graphicWorld)
+	, driver(driver)
+	, jobQueue(jobQueue)
+	, texture(NULL)
+	, quadCount(0)
+	, entity(NULL)
+	, registered(false)
+{
+	// chunks are lit like cubes
+	if (VoxelChunk::instanceCount == 0)
+		VoxelChunk::shader = this->driver->createShaderProgram(cubeVSString, cubeFSString);
+	
+	VoxelChunk::instanceCount++;
+	
+	for (int axis = 0; axis < 3; axis++)
+	{
+		this->size[axis] = 0;
+		this->sectionCount[axis] = 0;
+	}
+}
+
+VoxelChunk::~VoxelChunk()
+{
+	this->releaseSections();
+	
+	VoxelChunk::instanceCount--;
+	
+	if (VoxelChunk::instanceCount == 0)
+		this->driver->destroyShaderProgram(VoxelChunk::shader);
+}
+
+glm::vec3 VoxelChunk::getSize() const
+{
+	return glm::vec3((float)this->size[0], (float)this->size[1], (float)this->size[2]);
+}
+
+void VoxelChunk::setSize(const glm::vec3 &size)
+{
+	// the sections and their renderables are replaced
+	this->unregisterRenderables();
+	this->releaseSections();
+	
+	for (int axis = 0; axis < 3; axis++)
+	{
+		this->size[axis] = (unsigned int)std::max(size[axis], 0.0f);
+		this->sectionCount[axis] = (this->size[axis] + sectionSize - 1) / sectionSize;
+	}
+	this->blocks.assign(this->size[0] * this->size[1] * this->size[2], 0);
+	
+	// empty sections, meshed once drawn anyway
+	this->sections.clear();
+	this->sections.resize(this->sectionCount[0] * this->sectionCount[1] * this->sectionCount[2]);
+	for (unsigned int z = 0; z < this->sectionCount[2]; z++)
+	{
+		for (unsigned int y = 0; y < this->sectionCount[1]; y++)
+		{
+			for (unsigned int x = 0; x < this->sectionCount[0]; x++)
+			{
+				Section &section = this->sections[x + this->sectionCount[0] * (y + this->sectionCount[1] * z)];
+				unsigned int cell[3] = { x, y, z };
+				for (int axis = 0; axis < 3; axis++)
+				{
+					section.origin[axis] = cell[axis] * sectionSize;
+					section.size[axis] = std::min(sectionSize, this->size[axis] - section.origin[axis]);
+				}
+				section.elementCount = 0;
+				section.dirty = true;
+				section.meshing = false;
+			}
+		}
+	}
+	
+	if (this->entity && !this->sections.empty())
+		this->registerRenderables();
+}
+
+int VoxelChunk::getBlock(const glm::vec3 &position) const
+{
+	unsigned int cell[3];
+	if (!getCell(position, this->size, cell))
+		return 0;
+	
+	return this->blocks[this->getBlockIndex(cell[0], cell[1], cell[2])];
+}
+
+void VoxelChunk::setBlock(const glm::vec3 &position, int block)
+{
+	unsigned int cell[3];
+	if (!getCell(position, this->size, cell))
+		return;
+	
+	unsigned char &value = this->blocks[this->getBlockIndex(cell[0], cell[1], cell[2])];
+	unsigned char newValue = (unsigned char)glm::clamp(block, 0, 255);
+	if (value == newValue)
+		return;
+	
+	value = newValue;
+	this->invalidateBox(cell, cell);
+}
+
+void VoxelChunk::fill(const glm::vec3 &minimum, const glm::vec3 &maximum, int block)
+{
+	// clip the box to the grid
+	unsigned int first[3];
+	unsigned int last[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float low = std::max(std::floor(std::min(minimum[axis], maximum[axis])), 0.0f);
+		float high = std::min(std::floor(std::max(minimum[axis], maximum[axis])), (float)this->size[axis] - 1.0f);
+		if (low > high)
+			return;
+		
+		first[axis] = (unsigned int)low;
+		last[axis] = (unsigned int)high;
+	}
+	
+	unsigned char value = (unsigned char)glm::clamp(block, 0, 255);
+	for (unsigned int z = first[2]; z <= last[2]; z++)
+	{
+		for (unsigned int y = first[1]; y <= last[1]; y++)
+		{
+			unsigned int index = this->getBlockIndex(first[0], y, z);
+			std::fill_n(&this->blocks[index], last[0] - first[0] + 1, value);
+		}
+	}
+	
+	this->invalidateBox(first, last);
+}
+
+void VoxelChunk::update()
+{
+	// sections being meshed are started again once done
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+	{
+		Section &section = this->sections[i];
+		if (section.dirty && !section.meshing)
+			this->startMeshing(&section);
+	}
+	
+	// without workers, jobs only run when waited for
+	bool serial = (this->jobQueue->getWorkerCount() == 0);
+	
+	bool changed = false;
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+	{
+		Section &section = this->sections[i];
+		if (!section.meshing)
+			continue;
+		
+		if (serial)
+			this->jobQueue->wait(&section.batch);
+		else if (!section.batch.isDone())
+			continue;
+		
+		this->finishMeshing(&section);
+		changed = true;
+	}
+	
+	// cached static shadows show the previous meshes
+	if (changed && this->entity && this->entity->isStatic())
+		this->graphicWorld->invalidateStaticRenderables();
+}
+
+void VoxelChunk::activateComponent(Entity *entity)
+{
+	this->entity = entity;
+	
+	if (!this->registered && !this->sections.empty())
+		this->registerRenderables();
+	
+	this->graphicWorld->registerVoxelChunk(this);
+}
+
+void VoxelChunk::deactivateComponent(Entity *entity)
+{
+	this->graphicWorld->unregisterVoxelChunk(this);
+	this->unregisterRenderables();
+	this->entity = NULL;
+}
+
+void VoxelChunk::entityMoved(Entity *entity)
+{
+	this->invalidateRenderables();
+}
+
+void VoxelChunk::invalidateBox(const unsigned int firstBlock[3], const unsigned int lastBlock[3])
+{
+	// faces of the neighbour blocks may appear or disappear too
+	unsigned int first[3];
+	unsigned int last[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		first[axis] = (firstBlock[axis] > 0 ? firstBlock[axis] - 1 : 0) / sectionSize;
+		last[axis] = std::min(lastBlock[axis] + 1, this->size[axis] - 1) / sectionSize;
+	}
+	
+	for (unsigned int sz = first[2]; sz <= last[2]; sz++)
+		for (unsigned int sy = first[1]; sy <= last[1]; sy++)
+			for (unsigned int sx = first[0]; sx <= last[0]; sx++)
+				this->sections[sx + this->sectionCount[0] * (sy + this->sectionCount[1] * sz)].dirty = true;
+}
+
+void VoxelChunk::registerRenderables()
+{
+	// one renderable per section, culled on its own
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+	{
+		Section &section = this->sections[i];
+		glm::vec3 origin((float)section.origin[0], (float)section.origin[1], (float)section.origin[2]);
+		glm::vec3 extent((float)section.size[0], (float)section.size[1], (float)section.size[2]);
+		
+		GraphicWorld::Renderable renderable;
+		renderable.entity = this->entity;
+		renderable.transform = &this->entity->getLocalTransform();
+		renderable.texture = &this->texture;
+		renderable.textureSpan = 1.0f; // each block face maps the whole texture
+		renderable.shader = VoxelChunk::shader;
+		renderable.primitiveType = GraphicDriver::Triangles;
+		renderable.boundingCenter = origin + extent * 0.5f;
+		renderable.boundingRadius = glm::length(extent) * 0.5f;
+		renderable.castsShadows = true;
+		renderable.geometry = &section.geometry;
+		
+		section.renderable = this->graphicWorld->registerRenderable(renderable);
+	}
+	
+	this->registered = true;
+}
+
+void VoxelChunk::unregisterRenderables()
+{
+	if (!this->registered)
+		return;
+	
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+		this->graphicWorld->unregisterRenderable(this->sections[i].renderable);
+	
+	this->registered = false;
+}
+
+void VoxelChunk::invalidateRenderables()
+{
+	if (!this->registered)
+		return;
+	
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+		this->graphicWorld->invalidateRenderable(this->sections[i].renderable);
+}
+
+void VoxelChunk::releaseSections()
+{
+	// jobs still write in the sections
+	for (unsigned int i = 0; i < this->sections.size(); i++)
+	{
+		Section &section = this->sections[i];
+		if (section.meshing)
+			this->jobQueue->wait(&section.batch);
+		if (section.geometry.buffer)
+			this->driver->destroyVertexBuffer(section.geometry.buffer);
+	}
+	
+	this->sections.clear();
+	this->quadCount = 0;
+}
+
+void VoxelChunk::startMeshing(Section *section)
+{
+	// copy the blocks of the section and the ones around it, cells outside of the grid are empty
+	unsigned int paddedSize[3] = { section->size[0] + 2, section->size[1] + 2, section->size[2] + 2 };
+	section->blocks.assign(paddedSize[0] * paddedSize[1] * paddedSize[2], 0);
+	for (unsigned int z = 0; z < paddedSize[2]; z++)
+	{
+		int blockZ = (int)(section->origin[2] + z) - 1;
+		if (blockZ < 0 || blockZ >= (int)this->size[2])
+			continue;
+		
+		for (unsigned int y = 0; y < paddedSize[1]; y++)
+		{
+			int blockY = (int)(section->origin[1] + y) - 1;
+			if (blockY < 0 || blockY >= (int)this->size[1])
+				continue;
+			
+			// rows are contiguous, except for the cells outside of the grid
+			unsigned int firstX = (section->origin[0] > 0) ? 0 : 1;
+			unsigned int lastX = std::min(paddedSize[0], this->size[0] - section->origin[0] + 1);
+			const unsigned char *source = &this->blocks[this->getBlockIndex(section->origin[0] + firstX - 1, (unsigned int)blockY, (unsigned int)blockZ)];
+			std::copy(source, source + (lastX - firstX), &section->blocks[firstX + paddedSize[0] * (y + paddedSize[1] * z)]);
+		}
+	}
+	
+	section->dirty = false;
+	section->meshing = true;
+	this->jobQueue->push(VoxelChunk::runMeshJob, section, &section->batch);
+}
+
+void VoxelChunk::finishMeshing(Section *section)
+{
+	section->meshing = false;
+	
+	// the previous buffer may still be drawn by frames being submitted, its
+	// destruction is a resource operation replayed after them
+	if (section->geometry.buffer)
+		this->driver->destroyVertexBuffer(section->geometry.buffer);
+	section->geometry.buffer = NULL;
+	
+	this->quadCount -= section->elementCount / 6;
+	section->elementCount = (unsigned int)section->vertices.size();
+	this->quadCount += section->elementCount / 6;
+	
+	if (section->elementCount > 0)
+		section->geometry.buffer = this->driver->createVertexBuffer(&section->vertices[0], section->elementCount);
+	section->geometry.elementCount = section->elementCount;
+	if (this->registered)
+		this->graphicWorld->invalidateRenderable(section->renderable);
+	
+	// release the job memory, most sections do not change again
+	std::vector<unsigned char>().swap(section->blocks);
+	std::vector<GraphicDriver::Standard3DVertex>().swap(section->vertices);
+}
+
+void VoxelChunk::runMeshJob(void *userData)
+{
+	Section *section = (Section *)userData;
+	
+	glm::vec3 origin((float)section->origin[0], (float)section->origin[1], (float)section->origin[2]);
+	section->vertices.clear();
+	buildMesh(&section->blocks[0], section->size, origin, &section->vertices);
+}
+
+} // oak namespace
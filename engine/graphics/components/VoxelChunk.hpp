@@ -0,0 +1,153 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/graphics/GraphicDriver.hpp>
+#include <engine/graphics/GraphicWorld.hpp>
+
+#include <engine/sg/Component.hpp>
+
+#include <engine/system/JobQueue.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace oak {
+
+class TextureResource;
+
+/**
+ * Dense grid of blocks drawn as a few meshes, for block-style levels.
+ *
+ * Each cell holds a block type, 0 when empty; all the other types are drawn
+ * alike, as unit cubes covered with the texture of the chunk. Only the faces
+ * between a block and an empty cell are kept, and coplanar faces are merged
+ * in rectangles as large as possible (greedy meshing), the texture repeating
+ * on each block.
+ *
+ * The grid is split in sections of 32 blocks along each axis, meshed and culled
+ * separately: changing a block only remeshes its section, and the neighbours
+ * it touches. Meshing runs in jobs on a copy of the blocks, over the next
+ * frames; the previous mesh of a section is drawn meanwhile.
+ *
+ * Block (x, y, z) spans from (x, y, z) to (x + 1, y + 1, z + 1) in the space of
+ * the entity; coordinates are rounded down.
+ */
+class VoxelChunk: public Component
+{
+	public:
+		VoxelChunk(GraphicWorld *graphicWorld, GraphicDriver *driver, JobQueue *jobQueue);
+		virtual ~VoxelChunk();
+		
+		// blocks along each axis; resizing empties the grid
+		glm::vec3 getSize() const;
+		void setSize(const glm::vec3 &size);
+		
+		// blocks outside of the grid are empty, and cannot be set
+		int getBlock(const glm::vec3 &position) const;
+		void setBlock(const glm::vec3 &position, int block);
+		
+		// set all the blocks of a box, both corners included
+		void fill(const glm::vec3 &minimum, const glm::vec3 &maximum, int block);
+		
+		TextureResource *getTexture() const { return this->texture; }
+		void setTexture(TextureResource *texture) { this->texture = texture; this->invalidateRenderables(); }
+		
+		// quads in the meshes drawn, for profiling
+		int getQuadCount() const { return (int)this->quadCount; }
+		
+		// Swap in the sections meshed since the last call, and start meshing the
+		// changed ones (once per prepared frame, while active).
+		void update();
+		
+		// Component
+		virtual void activateComponent(Entity *entity);
+		virtual void deactivateComponent(Entity *entity);
+		virtual void entityMoved(Entity *entity);
+	
+	private:
+		static const unsigned int sectionSize = 32;
+		
+		struct Section
+		{
+			unsigned int origin[3];
+			unsigned int size[3];
+			
+			// drawn geometry, by the renderable while the chunk is active
+			GraphicWorld::Lod geometry;
+			unsigned int elementCount;
+			GraphicWorld::RenderableHandle renderable;
+			
+			bool dirty; // blocks changed since the last meshing started
+			bool meshing;
+			JobQueue::Batch batch;
+			
+			// meshing job input, with a border of one block on each side, and output
+			std::vector<unsigned char> blocks;
+			std::vector<GraphicDriver::Standard3DVertex> vertices;
+		};
+		
+		unsigned int getBlockIndex(unsigned int x, unsigned int y, unsigned int z) const { return x + this->size[0] * (y + this->size[1] * z); }
+		
+		// mark the sections showing the blocks of a box as changed
+		void invalidateBox(const unsigned int firstBlock[3], const unsigned int lastBlock[3]);
+		
+		void registerRenderables();
+		void unregisterRenderables();
+		
+		// record the renderables again with the next frame, when registered
+		void invalidateRenderables();
+		
+		// wait for the meshing jobs, and release the meshes
+		void releaseSections();
+		
+		void startMeshing(Section *section);
+		void finishMeshing(Section *section);
+		static void runMeshJob(void *userData);
+		
+		GraphicWorld *graphicWorld;
+		GraphicDriver *driver;
+		JobQueue *jobQueue;
+		
+		// shared for all chunks
+		static ShaderProgram *shader;
+		static unsigned int instanceCount;
+		
+		unsigned int size[3];
+		std::vector<unsigned char> blocks;
+		
+		unsigned int sectionCount[3];
+		std::vector<Section> sections;
+		
+		TextureResource *texture;
+		unsigned int quadCount;
+		
+		Entity *entity; // while active
+		bool registered;
+};
+
+} // oak namespace
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef GLES2
+	precision highp float;
+#endif
+
+// part of the source drawn into, the last texel center, and the texel size
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUvScale;
+uniform vec2 sourceUvMax;
+uniform vec2 sourceTexelSize;
+
+#ifdef DOWNSAMPLE
+	uniform vec3 fogColor;
+	uniform float bloomThreshold;
+#else
+	// distance between the taps, in source uv
+	uniform vec2 blurStep;
+#endif
+
+varying vec2 uv;
+
+vec4 readSource(vec2 position)
+{
+	return texture2D(sourceTexture, clamp(position, sourceTexelSize * 0.5, sourceUvMax));
+}
+
+void main()
+{
+	vec2 center = uv * sourceUvScale;
+
+#ifdef DOWNSAMPLE
+	// four bilinear taps cover the 4x4 scene texels around each half resolution texel;
+	// the alpha of the scene is the visibility through the fog
+	vec3 color = vec3(0.0);
+	for (int i = 0; i < 4; i++)
+	{
+		vec2 offset = vec2(i < 2 ? -1.0 : 1.0, mod(float(i), 2.0) * 2.0 - 1.0);
+		vec4 scene = readSource(center + offset * sourceTexelSize);
+		color += mix(fogColor, scene.rgb, scene.a);
+	}
+	color *= 0.25;
+	
+	// only what exceeds the threshold blooms, keeping the hue
+	float brightness = max(color.r, max(color.g, color.b));
+	color *= max(brightness - bloomThreshold, 0.0) / max(brightness, 0.0001);
+	gl_FragColor = vec4(color, 1.0);
+#else
+	// 9 tap gaussian, in 5 bilinear taps
+	vec3 color = readSource(center).rgb * 0.2270270270;
+	color += (readSource(center - blurStep * 1.3846153846).rgb + readSource(center + blurStep * 1.3846153846).rgb) * 0.3162162162;
+	color += (readSource(center - blurStep * 3.2307692308).rgb + readSource(center + blurStep * 3.2307692308).rgb) * 0.0702702703;
+	gl_FragColor = vec4(color, 1.0);
+#endif
+}
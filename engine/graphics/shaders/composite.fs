@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef GLES2
+	precision highp float;
+#endif
+
+// part of the scene drawn into, and the last texel center
+uniform sampler2D sceneTexture;
+uniform vec2 sceneUvScale;
+uniform vec2 sceneUvMax;
+
+#ifdef BLOOM
+	uniform sampler2D bloomTexture;
+	uniform vec2 bloomUvScale;
+	uniform vec2 bloomUvMax;
+	uniform float bloomIntensity;
+#endif
+
+uniform vec3 fogColor;
+uniform float exposure;
+uniform float toneMapping; // 1 to map the colors exponentially, 0 to only scale them
+uniform float inverseGamma;
+
+varying vec2 uv;
+
+void main()
+{
+	// the alpha of the scene is the visibility through the fog
+	vec4 scene = texture2D(sceneTexture, min(uv * sceneUvScale, sceneUvMax));
+	vec3 color = mix(fogColor, scene.rgb, scene.a);
+
+#ifdef BLOOM
+	color += texture2D(bloomTexture, min(uv * bloomUvScale, bloomUvMax)).rgb * bloomIntensity;
+#endif
+	
+	color *= exposure;
+	color = mix(color, vec3(1.0) - exp(-color), toneMapping);
+	gl_FragColor = vec4(pow(color, vec3(inverseGamma)), 1.0);
+}
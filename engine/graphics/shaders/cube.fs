@@ -29,39 +29,195 @@
 
 uniform float time;
 uniform vec3 color;
+uniform sampler2D diffuseTexture;
+
+// light clusters, see LightClusters.cpp for the layout of the data textures
+uniform sampler2D lightClusters;
+uniform sampler2D lightIndices;
+uniform sampler2D lightData;
+uniform vec3 lightGridSize;
+uniform vec2 lightTargetSize;
+uniform vec2 lightDepthSlicing;
+uniform float lightRange;
+
+// sun and its shadow cascades, see ShadowMaps.cpp for the layout of the atlases
+uniform vec3 sunDirection;
+uniform vec3 sunColor;
+uniform float shadowsEnabled;
+uniform sampler2D staticShadows;
+uniform sampler2D dynamicShadows;
+uniform float shadowAtlasTexel;
+uniform vec4 shadowSplits;
+uniform vec4 shadowDepthScales;
+uniform vec4 shadowTexelSizes;
+uniform vec4 shadowCascade0;
+uniform vec4 shadowCascade1;
+uniform vec4 shadowCascade2;
+uniform vec4 shadowCascade3;
+
+// cross-fade of levels of detail: positive to keep the dithered fragments
+// below it, negative for the ones above, 0 for all
+uniform float lodFade;
+
+// 1 - opacity of translucent renderables, 0 for the others
+uniform float transparency;
+
+// the fog itself is added over the scene by the post-processing, opaque
+// surfaces only write how much of them is seen through it
+uniform float fogDensity;
+
+#define MAX_CLUSTER_LIGHTS 64
+const vec2 lightIndicesSize = vec2(128.0, 64.0);
+const float maxLightCount = 256.0;
+const float maxLightIntensity = 64.0;
 
 varying vec3 fragPosition;
 varying vec3 fragNormal;
 varying vec2 fragUV;
-varying float viewDepth;
+varying vec3 viewPosition;
+varying vec3 viewNormal;
+varying vec3 lightPosition;
+varying vec3 lightNormal;
 
 vec3 lightDir = normalize(vec3(1.0, 0.7, -0.6));
-vec3 lightPos = vec3(4.0, 2.0, 0.0);
+
+vec4 readBytes(sampler2D data, vec2 texel, vec2 size)
+{
+	return floor(texture2D(data, (texel + 0.5) / size) * 255.0 + 0.5);
+}
+
+float decode16(vec2 bytes)
+{
+	return (bytes.x * 256.0 + bytes.y) / 65535.0;
+}
+
+float unpackDepth(vec4 bytes)
+{
+	return dot(bytes, vec4(1.0, 1.0 / 255.0, 1.0 / 65025.0, 1.0 / 16581375.0));
+}
+
+// 1 if lit, the nearest of the static and dynamic depths occludes
+float shadowTap(vec2 uv, vec4 tileBounds, float depth)
+{
+	uv = clamp(uv, tileBounds.xy, tileBounds.zw);
+	float occluder = min(unpackDepth(texture2D(staticShadows, uv)), unpackDepth(texture2D(dynamicShadows, uv)));
+	return step(depth, occluder);
+}
+
+float sunShadow(float depth)
+{
+	if (shadowsEnabled < 0.5 || depth >= shadowSplits.w)
+		return 1.0;
+	
+	vec4 cascade = shadowCascade3;
+	float depthScale = shadowDepthScales.w;
+	float texelSize = shadowTexelSizes.w;
+	vec2 tile = vec2(0.5, 0.5);
+	if (depth < shadowSplits.x)
+	{
+		cascade = shadowCascade0;
+		depthScale = shadowDepthScales.x;
+		texelSize = shadowTexelSizes.x;
+		tile = vec2(0.0, 0.0);
+	}
+	else if (depth < shadowSplits.y)
+	{
+		cascade = shadowCascade1;
+		depthScale = shadowDepthScales.y;
+		texelSize = shadowTexelSizes.y;
+		tile = vec2(0.5, 0.0);
+	}
+	else if (depth < shadowSplits.z)
+	{
+		cascade = shadowCascade2;
+		depthScale = shadowDepthScales.z;
+		texelSize = shadowTexelSizes.z;
+		tile = vec2(0.0, 0.5);
+	}
+	
+	// pushed along the normal and towards the light against self-shadowing
+	vec3 position = lightPosition + normalize(lightNormal) * texelSize * 1.5;
+	vec3 coords = vec3(position.xy * cascade.w, position.z * depthScale) + cascade.xyz;
+	coords.z += texelSize * depthScale;
+	
+	// 2x2 percentage closer filtering, within the tile of the cascade
+	float offset = shadowAtlasTexel * 0.5;
+	vec4 tileBounds = vec4(tile + offset, tile + 0.5 - offset);
+	float lit = shadowTap(coords.xy + vec2(-offset, -offset), tileBounds, coords.z);
+	lit += shadowTap(coords.xy + vec2(offset, -offset), tileBounds, coords.z);
+	lit += shadowTap(coords.xy + vec2(-offset, offset), tileBounds, coords.z);
+	lit += shadowTap(coords.xy + vec2(offset, offset), tileBounds, coords.z);
+	return lit * 0.25;
+}
+
+vec3 clusterLights(vec3 position, vec3 normal)
+{
+	// cluster of the fragment
+	vec2 tile = min(floor(gl_FragCoord.xy / lightTargetSize * lightGridSize.xy), lightGridSize.xy - 1.0);
+	float slice = clamp(floor(log(-position.z) * lightDepthSlicing.x + lightDepthSlicing.y), 0.0, lightGridSize.z - 1.0);
+	vec4 cluster = readBytes(lightClusters, vec2(tile.x + tile.y * lightGridSize.x, slice), vec2(lightGridSize.x * lightGridSize.y, lightGridSize.z));
+	float offset = cluster.r + cluster.g * 256.0;
+	
+	vec3 light = vec3(0.0);
+	for (int i = 0; i < MAX_CLUSTER_LIGHTS; i++)
+	{
+		if (float(i) >= cluster.b)
+			break;
+		
+		// four references per texel
+		float reference = offset + float(i);
+		float texel = floor(reference / 4.0);
+		float row = floor(texel / lightIndicesSize.x);
+		vec4 indices = readBytes(lightIndices, vec2(texel - row * lightIndicesSize.x, row), lightIndicesSize);
+		float index = dot(indices, vec4(equal(vec4(reference - texel * 4.0), vec4(0.0, 1.0, 2.0, 3.0))));
+		
+		vec4 data0 = readBytes(lightData, vec2(0.0, index), vec2(4.0, maxLightCount));
+		vec4 data1 = readBytes(lightData, vec2(1.0, index), vec2(4.0, maxLightCount));
+		vec4 data2 = readBytes(lightData, vec2(2.0, index), vec2(4.0, maxLightCount)) / 255.0;
+		vec3 lightPosition = (vec3(decode16(data0.rg), decode16(data0.ba), decode16(data1.rg)) * 2.0 - 1.0) * lightRange;
+		float radius = decode16(data1.ba) * lightRange;
+		
+		// inverse square falloff, smoothly reaching zero at the radius
+		vec3 dir = lightPosition - position;
+		float dirLength = length(dir);
+		float fade = clamp(1.0 - pow(dirLength / radius, 4.0), 0.0, 1.0);
+		float attenuation = fade * fade / (dirLength * dirLength + 1.0);
+		
+		light += data2.rgb * (data2.a * maxLightIntensity * attenuation * clamp(dot(normal, dir) / dirLength, 0.0, 1.0));
+	}
+	
+	return light;
+}
 
 void main(void)
 {
+	// interleaved gradient noise, complementary for both faded levels
+	if (lodFade != 0.0)
+	{
+		float dither = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+		if ((lodFade > 0.0 && dither >= lodFade) || (lodFade < 0.0 && dither < -lodFade))
+			discard;
+	}
+	
 	vec3 normal = normalize(fragNormal);
 	
-	// directional light
-	float light = clamp(dot(normal, lightDir), 0.0, 1.0) * 0.1;
+	// fill light
+	vec3 light = vec3(clamp(dot(normal, lightDir), 0.0, 1.0) * 0.1);
 	
-	// point light
-	vec3 dir = lightPos - fragPosition;
-	float dirLength = length(dir);
-	light += clamp(dot(normal, dir) / dirLength, 0.0, 1.0) / (0.1 * dirLength * dirLength);
+	// sun
+	float sun = clamp(dot(normal, sunDirection), 0.0, 1.0);
+	if (sun > 0.0)
+		sun *= sunShadow(-viewPosition.z);
+	light += sunColor * sun;
 	
-	// simple procedural texture
-	float f = fract(fragUV.x * 3.0) * fract(fragUV.y * 3.0);
-	float style = pow(f, 2.0);
-	float border = pow(clamp((abs(f - 0.5) - 0.4) * 10.0, 0.0, 1.0), 2.0);
-	vec3 diffuse = style * vec3(0.8, 1.0, 0.8) + border * vec3(1.0, 1.0, 0.7);
+	// point lights
+	light += clusterLights(viewPosition, normalize(viewNormal));
 	
-	vec3 outColor = vec3(light) * diffuse;
+	vec3 diffuse = texture2D(diffuseTexture, fragUV).rgb;
 	
-	// fog
-	float fog = 1.0 - exp(-viewDepth * 0.02);
-	outColor = mix(outColor, vec3(0.6, 0.8, 0.9), fog);
+	vec3 outColor = light * diffuse;
 	
-	//outColor = sqrt(outColor); // gamma
-	gl_FragColor = vec4(outColor, 1.0);
+	// translucent surfaces blend by their opacity, and keep the visibility behind them
+	float visibility = exp(viewPosition.z * fogDensity);
+	gl_FragColor = vec4(outColor, transparency > 0.0 ? 1.0 - transparency : visibility);
 }
@@ -31,6 +31,7 @@ uniform mat4 modelMatrix;
 uniform mat3 normalMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 projectionMatrix;
+uniform mat3 lightRotation;
 
 attribute vec3 position;
 attribute vec3 normal;
@@ -39,7 +40,10 @@ attribute vec2 uv;
 varying vec3 fragPosition;
 varying vec3 fragNormal;
 varying vec2 fragUV;
-varying float viewDepth;
+varying vec3 viewPosition;
+varying vec3 viewNormal;
+varying vec3 lightPosition;
+varying vec3 lightNormal;
 
 void main()
 {
@@ -47,7 +51,10 @@ void main()
 	fragNormal = normalMatrix * normal;
 	fragUV = uv;
 	
-	vec4 viewPosition = viewMatrix * vec4(fragPosition, 1.0);
-	viewDepth = -viewPosition.z;
-	gl_Position = projectionMatrix * viewPosition;
+	vec4 position = viewMatrix * vec4(fragPosition, 1.0);
+	viewPosition = position.xyz;
+	viewNormal = (viewMatrix * vec4(fragNormal, 0.0)).xyz;
+	lightPosition = lightRotation * fragPosition;
+	lightNormal = lightRotation * fragNormal;
+	gl_Position = projectionMatrix * position;
 }
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef GLES2
+	precision highp float;
+#endif
+
+// part of the source drawn into, the last texel center, and the texel size
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUvScale;
+uniform vec2 sourceUvMax;
+uniform vec2 sourceTexelSize;
+
+varying vec2 uv;
+
+const vec3 lumaWeights = vec3(0.299, 0.587, 0.114);
+const float reduceMin = 1.0 / 128.0;
+const float reduceScale = 1.0 / 8.0;
+const float maxSpan = 8.0;
+
+vec3 readSource(vec2 position)
+{
+	return texture2D(sourceTexture, clamp(position, sourceTexelSize * 0.5, sourceUvMax)).rgb;
+}
+
+void main()
+{
+	// blur along the edges found from the luma of the corners
+	vec2 center = uv * sourceUvScale;
+	vec3 colorM = readSource(center);
+	float lumaNW = dot(readSource(center + vec2(-1.0, 1.0) * sourceTexelSize), lumaWeights);
+	float lumaNE = dot(readSource(center + vec2(1.0, 1.0) * sourceTexelSize), lumaWeights);
+	float lumaSW = dot(readSource(center + vec2(-1.0, -1.0) * sourceTexelSize), lumaWeights);
+	float lumaSE = dot(readSource(center + vec2(1.0, -1.0) * sourceTexelSize), lumaWeights);
+	float lumaM = dot(colorM, lumaWeights);
+	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+	
+	vec2 direction = vec2((lumaSW + lumaSE) - (lumaNW + lumaNE), (lumaNE + lumaSE) - (lumaNW + lumaSW));
+	float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * reduceScale, reduceMin);
+	float scale = 1.0 / (min(abs(direction.x), abs(direction.y)) + reduce);
+	direction = clamp(direction * scale, -maxSpan, maxSpan) * sourceTexelSize;
+	
+	vec3 colorA = 0.5 * (readSource(center - direction / 6.0) + readSource(center + direction / 6.0));
+	vec3 colorB = colorA * 0.5 + 0.25 * (readSource(center - direction * 0.5) + readSource(center + direction * 0.5));
+	float lumaB = dot(colorB, lumaWeights);
+	gl_FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB, 1.0);
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef GLES2
+	precision highp float;
+#endif
+
+// MAX_BONES is defined by the skinned mesh component, to fit the uniforms of
+// the platform
+
+uniform mat4 modelMatrix;
+uniform mat3 normalMatrix;
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+uniform mat3 lightRotation;
+
+// skinning matrices, as the first three rows of each (see Pose.cpp)
+uniform vec4 boneMatrices[MAX_BONES * 3];
+
+attribute vec3 position;
+attribute vec3 normal;
+attribute vec2 uv;
+attribute vec4 bones; // indices
+attribute vec4 weights; // summing to one
+
+varying vec3 fragPosition;
+varying vec3 fragNormal;
+varying vec2 fragUV;
+varying vec3 viewPosition;
+varying vec3 viewNormal;
+varying vec3 lightPosition;
+varying vec3 lightNormal;
+
+void main()
+{
+	// blend the rows of the matrices, then transform once
+	ivec4 rows = ivec4(bones) * 3;
+	vec4 row0 = boneMatrices[rows.x] * weights.x + boneMatrices[rows.y] * weights.y + boneMatrices[rows.z] * weights.z + boneMatrices[rows.w] * weights.w;
+	vec4 row1 = boneMatrices[rows.x + 1] * weights.x + boneMatrices[rows.y + 1] * weights.y + boneMatrices[rows.z + 1] * weights.z + boneMatrices[rows.w + 1] * weights.w;
+	vec4 row2 = boneMatrices[rows.x + 2] * weights.x + boneMatrices[rows.y + 2] * weights.y + boneMatrices[rows.z + 2] * weights.z + boneMatrices[rows.w + 2] * weights.w;
+	
+	vec4 bindPosition = vec4(position, 1.0);
+	vec3 skinnedPosition = vec3(dot(row0, bindPosition), dot(row1, bindPosition), dot(row2, bindPosition));
+	vec3 skinnedNormal = vec3(dot(row0.xyz, normal), dot(row1.xyz, normal), dot(row2.xyz, normal));
+	
+	fragPosition = (modelMatrix * vec4(skinnedPosition, 1.0)).xyz;
+	fragNormal = normalMatrix * skinnedNormal;
+	fragUV = uv;
+	
+	vec4 eyePosition = viewMatrix * vec4(fragPosition, 1.0);
+	viewPosition = eyePosition.xyz;
+	viewNormal = (viewMatrix * vec4(fragNormal, 0.0)).xyz;
+	lightPosition = lightRotation * fragPosition;
+	lightNormal = lightRotation * fragNormal;
+	gl_Position = projectionMatrix * eyePosition;
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#ifdef GLES2
+	precision highp float;
+#endif
+
+uniform mat4 modelMatrix;
+uniform mat3 normalMatrix;
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+uniform mat3 lightRotation;
+
+// heights as 16 bits in red and green, between the bounds of the height range,
+// and horizontal normal components in blue and alpha (see Terrain.cpp)
+uniform sampler2D heightmap;
+uniform vec2 heightRange; // lowest height, and distance to the highest one
+uniform vec3 terrainScale; // samples per side, distance between samples, texture span
+
+// first sample of the drawn patch, samples per grid step, and grid steps per side
+uniform vec4 terrainPatch;
+
+// samples between the vertices of the patches along the -x, +x, -z and +z
+// edges, the drawn one or a coarser neighbour
+uniform vec4 terrainEdges;
+
+attribute vec3 position; // grid coordinates in x and z
+attribute vec3 normal;
+attribute vec2 uv;
+
+varying vec3 fragPosition;
+varying vec3 fragNormal;
+varying vec2 fragUV;
+varying vec3 viewPosition;
+varying vec3 viewNormal;
+varying vec3 lightPosition;
+varying vec3 lightNormal;
+
+vec4 readSample(vec2 cell)
+{
+	return texture2DLod(heightmap, (cell + 0.5) / terrainScale.x, 0.0);
+}
+
+float decodeHeight(vec4 texel)
+{
+	vec2 bytes = floor(texel.rg * 255.0 + 0.5);
+	return (bytes.x * 256.0 + bytes.y) / 65535.0 * heightRange.y + heightRange.x;
+}
+
+vec3 decodeNormal(vec4 texel)
+{
+	vec2 horizontal = texel.ba * 2.0 - 1.0;
+	return vec3(horizontal.x, sqrt(max(1.0 - dot(horizontal, horizontal), 0.0)), horizontal.y);
+}
+
+void main()
+{
+	// vertices of an edge shared with a coarser patch are placed on its edge,
+	// between its two nearest vertices, so that no crack opens
+	vec2 cell = terrainPatch.xy + position.xz * terrainPatch.z;
+	vec2 along = vec2(0.0, 1.0);
+	float sampleStep = terrainPatch.z;
+	if (position.x < 0.5)
+		sampleStep = terrainEdges.x;
+	else if (position.x > terrainPatch.w - 0.5)
+		sampleStep = terrainEdges.y;
+	else
+	{
+		along = vec2(1.0, 0.0);
+		if (position.z < 0.5)
+			sampleStep = terrainEdges.z;
+		else if (position.z > terrainPatch.w - 0.5)
+			sampleStep = terrainEdges.w;
+	}
+	
+	// steps are powers of two, the divisions are exact
+	float offset = dot(cell, along);
+	float fraction = fract(offset / sampleStep);
+	vec2 firstCell = cell - along * (fraction * sampleStep);
+	vec4 texel0 = readSample(firstCell);
+	vec4 texel1 = readSample(firstCell + along * sampleStep);
+	
+	vec3 localPosition = vec3(cell.x * terrainScale.y, mix(decodeHeight(texel0), decodeHeight(texel1), fraction), cell.y * terrainScale.y);
+	vec3 localNormal = normalize(mix(decodeNormal(texel0), decodeNormal(texel1), fraction));
+	
+	fragPosition = (modelMatrix * vec4(localPosition, 1.0)).xyz;
+	fragNormal = normalMatrix * localNormal;
+	fragUV = localPosition.xz / terrainScale.z;
+	
+	vec4 eyePosition = viewMatrix * vec4(fragPosition, 1.0);
+	viewPosition = eyePosition.xyz;
+	viewNormal = (viewMatrix * vec4(fragNormal, 0.0)).xyz;
+	lightPosition = lightRotation * fragPosition;
+	lightNormal = lightRotation * fragNormal;
+	gl_Position = projectionMatrix * eyePosition;
+}
@@ -55,7 +55,12 @@ inline int popArgument(lua_State *L)
 template <>
 inline bool popArgument(lua_State *L)
 {
-	bool value = (lua_tointeger(L, -1) != 0);
+	// accept both lua booleans and legacy integer flags
+	bool value;
+	if (lua_isboolean(L, -1))
+		value = (lua_toboolean(L, -1) != 0);
+	else
+		value = (lua_tointeger(L, -1) != 0);
 	lua_pop(L, 1);
 	
 	return value;
@@ -79,6 +84,16 @@ inline double popArgument(lua_State *L)
 	return value;
 }
 
+template <>
+inline glm::vec2 popArgument(lua_State *L)
+{
+	lua_Number x = lua_tonumber(L, -2);
+	lua_Number y = lua_tonumber(L, -1);
+	lua_pop(L, 2);
+	
+	return glm::vec2((float)x, (float)y);
+}
+
 template <>
 inline glm::vec3 popArgument(lua_State *L)
 {
@@ -90,6 +105,18 @@ inline glm::vec3 popArgument(lua_State *L)
 	return glm::vec3((float)r, (float)g, (float)b);
 }
 
+template <>
+inline glm::vec4 popArgument(lua_State *L)
+{
+	lua_Number x = lua_tonumber(L, -4);
+	lua_Number y = lua_tonumber(L, -3);
+	lua_Number z = lua_tonumber(L, -2);
+	lua_Number w = lua_tonumber(L, -1);
+	lua_pop(L, 4);
+	
+	return glm::vec4((float)x, (float)y, (float)z, (float)w);
+}
+
 template <>
 inline glm::quat popArgument(lua_State *L)
 {
@@ -139,6 +166,14 @@ inline int pushReturnValue(lua_State *L, double value)
 	return 1;
 }
 
+inline int pushReturnValue(lua_State *L, glm::vec2 value)
+{
+	lua_pushnumber(L, (lua_Number)value.x);
+	lua_pushnumber(L, (lua_Number)value.y);
+	
+	return 2;
+}
+
 inline int pushReturnValue(lua_State *L, glm::vec3 value)
 {
 	lua_pushnumber(L, (lua_Number)value.x);
@@ -148,6 +183,16 @@ inline int pushReturnValue(lua_State *L, glm::vec3 value)
 	return 3;
 }
 
+inline int pushReturnValue(lua_State *L, glm::vec4 value)
+{
+	lua_pushnumber(L, (lua_Number)value.x);
+	lua_pushnumber(L, (lua_Number)value.y);
+	lua_pushnumber(L, (lua_Number)value.z);
+	lua_pushnumber(L, (lua_Number)value.w);
+	
+	return 4;
+}
+
 inline int pushReturnValue(lua_State *L, glm::quat value)
 {
 	lua_pushnumber(L, (lua_Number)value.w);
@@ -280,6 +325,18 @@ inline int pushReturnValue(lua_State *L, void *value)
 		return 0; \
 	}
 
+#define OAK_BIND_VOID_METHOD3(ClassName, methodName, ArgType1, ArgType2, ArgType3) \
+	int oak_method_##ClassName##_##methodName(lua_State *L) \
+	{ \
+		ArgType3 arg3 = oak::bind::popArgument<ArgType3>(L); \
+		ArgType2 arg2 = oak::bind::popArgument<ArgType2>(L); \
+		ArgType1 arg1 = oak::bind::popArgument<ArgType1>(L); \
+		ClassName *self = oak::bind::popArgument<ClassName *>(L); \
+		self->methodName(arg1, arg2, arg3); \
+		 \
+		return 0; \
+	}
+
 #define OAK_BIND_WRET_METHOD0(ClassName, methodName) \
 	int oak_method_##ClassName##_##methodName(lua_State *L) \
 	{ \
@@ -299,10 +356,10 @@ inline int pushReturnValue(lua_State *L, void *value)
 		return 0; \
 	}
 
-#define OAK_BIND_WRET_METHOD2(ClassName, methodName, ArgType1) \
+#define OAK_BIND_WRET_METHOD2(ClassName, methodName, ArgType1, ArgType2) \
 	int oak_method_##ClassName##_##methodName(lua_State *L) \
 	{ \
-		ArgType1 arg2 = oak::bind::popArgument<ArgType2>(L); \
+		ArgType2 arg2 = oak::bind::popArgument<ArgType2>(L); \
 		ArgType1 arg1 = oak::bind::popArgument<ArgType1>(L); \
 		ClassName *self = oak::bind::popArgument<ClassName *>(L); \
 		return oak::bind::pushReturnValue(L, self->methodName(arg1, arg2)); \
@@ -25,55 +25,405 @@
 
 #include <engine/script/bind/GraphicsBind.hpp>
 
+#include <engine/graphics/AnimationManager.hpp>
+#include <engine/graphics/DebugDraw.hpp>
 #include <engine/graphics/GraphicsEngine.hpp>
+#include <engine/graphics/MeshManager.hpp>
+#include <engine/graphics/PostProcess.hpp>
+#include <engine/graphics/TextureManager.hpp>
 #include <engine/graphics/View.hpp>
+#include <engine/graphics/components/Animator.hpp>
+#include <engine/graphics/components/Camera.hpp>
 #include <engine/graphics/components/Cube.hpp>
 #include <engine/graphics/components/DemoQuad.hpp>
+#include <engine/graphics/components/Light.hpp>
+#include <engine/graphics/components/Mesh.hpp>
+#include <engine/graphics/components/Occluder.hpp>
+#include <engine/graphics/components/ParticleEmitter.hpp>
+#include <engine/graphics/components/SkinnedMesh.hpp>
+#include <engine/graphics/components/Sprite.hpp>
+#include <engine/graphics/components/Terrain.hpp>
+#include <engine/graphics/components/Text.hpp>
+#include <engine/graphics/components/VoxelChunk.hpp>
 #include <engine/script/bind/Bind.hpp>
 
 namespace oak {
 
+OAK_BIND_POINTER_TYPE(AnimationResource)
+OAK_BIND_POINTER_TYPE(Animator)
 OAK_BIND_POINTER_TYPE(Camera)
 OAK_BIND_POINTER_TYPE(Cube)
+OAK_BIND_POINTER_TYPE(DebugDraw)
 OAK_BIND_POINTER_TYPE(DemoQuad)
+OAK_BIND_POINTER_TYPE(Light)
+OAK_BIND_POINTER_TYPE(Mesh)
+OAK_BIND_POINTER_TYPE(MeshResource)
+OAK_BIND_POINTER_TYPE(Occluder)
+OAK_BIND_POINTER_TYPE(ParticleEmitter)
+OAK_BIND_POINTER_TYPE(PostProcess)
+OAK_BIND_POINTER_TYPE(SkinnedMesh)
+OAK_BIND_POINTER_TYPE(SkinnedMeshResource)
+OAK_BIND_POINTER_TYPE(Sprite)
+OAK_BIND_POINTER_TYPE(Text)
+OAK_BIND_POINTER_TYPE(TextureResource)
+OAK_BIND_POINTER_TYPE(Terrain)
 OAK_BIND_POINTER_TYPE(View)
+OAK_BIND_POINTER_TYPE(VoxelChunk)
 OAK_BIND_POINTER_TYPE(World)
 
 OAK_BIND_MODULE(GraphicsEngine)
 OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getBackgroundColor)
 OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setBackgroundColor, glm::vec3)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, isDynamicResolution)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setDynamicResolution, bool)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getFrameBudget)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setFrameBudget, float)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getRenderScale)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setRenderScale, float)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getMinRenderScale)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setMinRenderScale, float)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getPostProcess)
 OAK_BIND_WRET_FUNCTION1(GraphicsEngine, createView, World *)
 OAK_BIND_VOID_FUNCTION1(GraphicsEngine, destroyView, View *)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, buildStaticBatches, World *)
+OAK_BIND_WRET_FUNCTION1(GraphicsEngine, getDebugDraw, World *)
+OAK_BIND_WRET_FUNCTION1(GraphicsEngine, loadTexture, std::string)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getTextureUploadBudget)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setTextureUploadBudget, int)
+OAK_BIND_WRET_FUNCTION0(GraphicsEngine, getTextureMemoryBudget)
+OAK_BIND_VOID_FUNCTION1(GraphicsEngine, setTextureMemoryBudget, int)
+OAK_BIND_WRET_FUNCTION1(GraphicsEngine, loadMesh, std::string)
+OAK_BIND_WRET_FUNCTION1(GraphicsEngine, loadSkinnedMesh, std::string)
+OAK_BIND_WRET_FUNCTION1(GraphicsEngine, loadAnimation, std::string)
+
+OAK_BIND_WRET_METHOD0(Camera, getFov)
+OAK_BIND_VOID_METHOD1(Camera, setFov, float)
+OAK_BIND_WRET_METHOD0(Camera, getAspect)
+OAK_BIND_VOID_METHOD1(Camera, setAspect, float)
 
 OAK_BIND_WRET_METHOD0(Cube, getColor)
 OAK_BIND_VOID_METHOD1(Cube, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(Cube, getOpacity)
+OAK_BIND_VOID_METHOD1(Cube, setOpacity, float)
+OAK_BIND_WRET_METHOD0(Cube, getTexture)
+OAK_BIND_VOID_METHOD1(Cube, setTexture, TextureResource *)
 
 OAK_BIND_WRET_METHOD0(DemoQuad, getColor)
 OAK_BIND_VOID_METHOD1(DemoQuad, setColor, glm::vec3)
 
+OAK_BIND_WRET_METHOD0(Light, getColor)
+OAK_BIND_VOID_METHOD1(Light, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(Light, getIntensity)
+OAK_BIND_VOID_METHOD1(Light, setIntensity, float)
+OAK_BIND_WRET_METHOD0(Light, getRadius)
+OAK_BIND_VOID_METHOD1(Light, setRadius, float)
+OAK_BIND_WRET_METHOD0(Light, isDirectional)
+OAK_BIND_VOID_METHOD1(Light, setDirectional, bool)
+OAK_BIND_WRET_METHOD0(Light, isCastingShadows)
+OAK_BIND_VOID_METHOD1(Light, setCastingShadows, bool)
+
+OAK_BIND_WRET_METHOD0(Mesh, getMesh)
+OAK_BIND_VOID_METHOD1(Mesh, setMesh, MeshResource *)
+OAK_BIND_WRET_METHOD0(Mesh, getColor)
+OAK_BIND_VOID_METHOD1(Mesh, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(Mesh, getOpacity)
+OAK_BIND_VOID_METHOD1(Mesh, setOpacity, float)
+OAK_BIND_WRET_METHOD0(Mesh, getTexture)
+OAK_BIND_VOID_METHOD1(Mesh, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD0(Mesh, isLodCrossFade)
+OAK_BIND_VOID_METHOD1(Mesh, setLodCrossFade, bool)
+
+OAK_BIND_WRET_METHOD0(Occluder, getMesh)
+OAK_BIND_VOID_METHOD1(Occluder, setMesh, MeshResource *)
+
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getRate)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setRate, float)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, burst, int)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getMaxParticleCount)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setMaxParticleCount, int)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getParticleCount)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getLifetime)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setLifetime, glm::vec2)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getSpeed)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setSpeed, glm::vec2)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getSpread)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setSpread, float)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getRadius)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setRadius, float)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getAcceleration)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setAcceleration, glm::vec3)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getDrag)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setDrag, float)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getSize)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setSize, glm::vec2)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getStartColor)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setStartColor, glm::vec4)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getEndColor)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setEndColor, glm::vec4)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getTexture)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, getRegion)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setRegion, glm::vec4)
+OAK_BIND_WRET_METHOD0(ParticleEmitter, isAdditive)
+OAK_BIND_VOID_METHOD1(ParticleEmitter, setAdditive, bool)
+
+OAK_BIND_WRET_METHOD0(Sprite, getTexture)
+OAK_BIND_VOID_METHOD1(Sprite, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD0(Sprite, getRegion)
+OAK_BIND_VOID_METHOD1(Sprite, setRegion, glm::vec4)
+OAK_BIND_WRET_METHOD0(Sprite, getSize)
+OAK_BIND_VOID_METHOD1(Sprite, setSize, glm::vec2)
+OAK_BIND_WRET_METHOD0(Sprite, getColor)
+OAK_BIND_VOID_METHOD1(Sprite, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(Sprite, getOpacity)
+OAK_BIND_VOID_METHOD1(Sprite, setOpacity, float)
+OAK_BIND_WRET_METHOD0(Sprite, getLayer)
+OAK_BIND_VOID_METHOD1(Sprite, setLayer, int)
+OAK_BIND_WRET_METHOD0(Sprite, isAdditive)
+OAK_BIND_VOID_METHOD1(Sprite, setAdditive, bool)
+OAK_BIND_WRET_METHOD0(Sprite, isBillboard)
+OAK_BIND_VOID_METHOD1(Sprite, setBillboard, bool)
+
+OAK_BIND_WRET_METHOD0(Text, getText)
+OAK_BIND_VOID_METHOD1(Text, setText, std::string)
+OAK_BIND_WRET_METHOD0(Text, getSize)
+OAK_BIND_VOID_METHOD1(Text, setSize, int)
+OAK_BIND_WRET_METHOD0(Text, getWidth)
+OAK_BIND_WRET_METHOD0(Text, getHeight)
+OAK_BIND_WRET_METHOD0(Text, getColor)
+OAK_BIND_VOID_METHOD1(Text, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(Text, getOpacity)
+OAK_BIND_VOID_METHOD1(Text, setOpacity, float)
+OAK_BIND_WRET_METHOD0(Text, getLayer)
+OAK_BIND_VOID_METHOD1(Text, setLayer, int)
+
 OAK_BIND_WRET_METHOD0(View, getPriority)
 OAK_BIND_VOID_METHOD1(View, setPriority, int)
 OAK_BIND_WRET_METHOD0(View, isEnabled)
 OAK_BIND_VOID_METHOD1(View, setEnabled, bool)
 OAK_BIND_WRET_METHOD0(View, getCamera)
 OAK_BIND_VOID_METHOD1(View, setCamera, Camera *)
+OAK_BIND_VOID_METHOD2(View, setTargetSize, int, int)
+OAK_BIND_WRET_METHOD0(View, getTargetTexture)
+
+OAK_BIND_WRET_METHOD0(VoxelChunk, getSize)
+OAK_BIND_VOID_METHOD1(VoxelChunk, setSize, glm::vec3)
+OAK_BIND_WRET_METHOD1(VoxelChunk, getBlock, glm::vec3)
+OAK_BIND_VOID_METHOD2(VoxelChunk, setBlock, glm::vec3, int)
+OAK_BIND_VOID_METHOD3(VoxelChunk, fill, glm::vec3, glm::vec3, int)
+OAK_BIND_WRET_METHOD0(VoxelChunk, getTexture)
+OAK_BIND_VOID_METHOD1(VoxelChunk, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD0(VoxelChunk, getQuadCount)
+
+OAK_BIND_WRET_METHOD0(Terrain, getResolution)
+OAK_BIND_VOID_METHOD1(Terrain, setResolution, int)
+OAK_BIND_WRET_METHOD2(Terrain, getHeight, int, int)
+OAK_BIND_VOID_METHOD3(Terrain, setHeight, int, int, float)
+OAK_BIND_WRET_METHOD0(Terrain, getSpacing)
+OAK_BIND_VOID_METHOD1(Terrain, setSpacing, float)
+OAK_BIND_WRET_METHOD0(Terrain, getTexture)
+OAK_BIND_VOID_METHOD1(Terrain, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD0(Terrain, getTextureScale)
+OAK_BIND_VOID_METHOD1(Terrain, setTextureScale, float)
+OAK_BIND_WRET_METHOD0(Terrain, getLodRange)
+OAK_BIND_VOID_METHOD1(Terrain, setLodRange, float)
+
+OAK_BIND_WRET_METHOD0(SkinnedMesh, getMesh)
+OAK_BIND_VOID_METHOD1(SkinnedMesh, setMesh, SkinnedMeshResource *)
+OAK_BIND_WRET_METHOD0(SkinnedMesh, getColor)
+OAK_BIND_VOID_METHOD1(SkinnedMesh, setColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(SkinnedMesh, getTexture)
+OAK_BIND_VOID_METHOD1(SkinnedMesh, setTexture, TextureResource *)
+OAK_BIND_WRET_METHOD1(SkinnedMesh, getAnimation, int)
+OAK_BIND_VOID_METHOD2(SkinnedMesh, setAnimation, int, AnimationResource *)
+OAK_BIND_WRET_METHOD1(SkinnedMesh, getLayerWeight, int)
+OAK_BIND_VOID_METHOD2(SkinnedMesh, setLayerWeight, int, float)
+OAK_BIND_WRET_METHOD1(SkinnedMesh, getLayerSpeed, int)
+OAK_BIND_VOID_METHOD2(SkinnedMesh, setLayerSpeed, int, float)
+OAK_BIND_WRET_METHOD1(SkinnedMesh, getLayerTime, int)
+OAK_BIND_VOID_METHOD2(SkinnedMesh, setLayerTime, int, float)
+OAK_BIND_WRET_METHOD0(SkinnedMesh, isGpuSkinned)
+
+OAK_BIND_WRET_METHOD0(Animator, getTime)
+OAK_BIND_VOID_METHOD1(Animator, setTime, float)
+OAK_BIND_WRET_METHOD0(Animator, getSpeed)
+OAK_BIND_VOID_METHOD1(Animator, setSpeed, float)
+OAK_BIND_WRET_METHOD0(Animator, isLooping)
+OAK_BIND_VOID_METHOD1(Animator, setLooping, bool)
+OAK_BIND_VOID_METHOD2(Animator, addPositionKey, float, glm::vec3)
+OAK_BIND_VOID_METHOD3(Animator, addRotationKey, float, glm::vec3, float)
+OAK_BIND_VOID_METHOD2(Animator, addScaleKey, float, glm::vec3)
+OAK_BIND_VOID_METHOD2(Animator, addColorKey, float, glm::vec3)
+OAK_BIND_VOID_METHOD0(Animator, clearKeys)
+OAK_BIND_VOID_METHOD2(Animator, setSpin, glm::vec3, float)
+OAK_BIND_VOID_METHOD3(Animator, setOrbit, glm::vec3, float, float)
+OAK_BIND_VOID_METHOD2(Animator, setBob, glm::vec3, float)
+OAK_BIND_VOID_METHOD2(Animator, setPulse, float, float)
+OAK_BIND_WRET_METHOD0(Animator, getLight)
+OAK_BIND_VOID_METHOD1(Animator, setLight, Light *)
+OAK_BIND_WRET_METHOD0(Animator, getSprite)
+OAK_BIND_VOID_METHOD1(Animator, setSprite, Sprite *)
+
+OAK_BIND_VOID_METHOD3(DebugDraw, drawLine, glm::vec3, glm::vec3, glm::vec3)
+OAK_BIND_VOID_METHOD3(DebugDraw, drawBox, glm::vec3, glm::vec3, glm::vec3)
+OAK_BIND_VOID_METHOD3(DebugDraw, drawSphere, glm::vec3, float, glm::vec3)
+OAK_BIND_VOID_METHOD2(DebugDraw, drawCameraFrustum, Camera *, glm::vec3)
+OAK_BIND_VOID_METHOD3(DebugDraw, drawLabel, glm::vec3, std::string, glm::vec3)
+
+OAK_BIND_WRET_METHOD0(PostProcess, getFogDensity)
+OAK_BIND_VOID_METHOD1(PostProcess, setFogDensity, float)
+OAK_BIND_WRET_METHOD0(PostProcess, getFogColor)
+OAK_BIND_VOID_METHOD1(PostProcess, setFogColor, glm::vec3)
+OAK_BIND_WRET_METHOD0(PostProcess, isToneMapping)
+OAK_BIND_VOID_METHOD1(PostProcess, setToneMapping, bool)
+OAK_BIND_WRET_METHOD0(PostProcess, getExposure)
+OAK_BIND_VOID_METHOD1(PostProcess, setExposure, float)
+OAK_BIND_WRET_METHOD0(PostProcess, getGamma)
+OAK_BIND_VOID_METHOD1(PostProcess, setGamma, float)
+OAK_BIND_WRET_METHOD0(PostProcess, getBloomThreshold)
+OAK_BIND_VOID_METHOD1(PostProcess, setBloomThreshold, float)
+OAK_BIND_WRET_METHOD0(PostProcess, getBloomIntensity)
+OAK_BIND_VOID_METHOD1(PostProcess, setBloomIntensity, float)
+OAK_BIND_WRET_METHOD0(PostProcess, isAntialiasing)
+OAK_BIND_VOID_METHOD1(PostProcess, setAntialiasing, bool)
 
 void GraphicsBind::registerFunctions(lua_State *L, GraphicsEngine *graphics)
 {
 	OAK_REGISTER_MODULE(L, GraphicsEngine, graphics, graphics)
 	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getBackgroundColor)
 	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setBackgroundColor)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, isDynamicResolution)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setDynamicResolution)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getFrameBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setFrameBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getRenderScale)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setRenderScale)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getMinRenderScale)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setMinRenderScale)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getPostProcess)
 	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, createView)
 	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, destroyView)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, buildStaticBatches)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getDebugDraw)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, loadTexture)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getTextureUploadBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setTextureUploadBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, getTextureMemoryBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, setTextureMemoryBudget)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, loadMesh)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, loadSkinnedMesh)
+	OAK_REGISTER_FUNCTION(L, GraphicsEngine, graphics, loadAnimation)
+	
+	OAK_REGISTER_CLASS(L, Camera)
+	OAK_REGISTER_METHOD(L, Camera, getFov)
+	OAK_REGISTER_METHOD(L, Camera, setFov)
+	OAK_REGISTER_METHOD(L, Camera, getAspect)
+	OAK_REGISTER_METHOD(L, Camera, setAspect)
 	
 	OAK_REGISTER_CLASS(L, Cube)
 	OAK_REGISTER_METHOD(L, Cube, getColor)
 	OAK_REGISTER_METHOD(L, Cube, setColor)
+	OAK_REGISTER_METHOD(L, Cube, getOpacity)
+	OAK_REGISTER_METHOD(L, Cube, setOpacity)
+	OAK_REGISTER_METHOD(L, Cube, getTexture)
+	OAK_REGISTER_METHOD(L, Cube, setTexture)
 	
 	OAK_REGISTER_CLASS(L, DemoQuad)
 	OAK_REGISTER_METHOD(L, DemoQuad, getColor)
 	OAK_REGISTER_METHOD(L, DemoQuad, setColor)
 	
+	OAK_REGISTER_CLASS(L, Light)
+	OAK_REGISTER_METHOD(L, Light, getColor)
+	OAK_REGISTER_METHOD(L, Light, setColor)
+	OAK_REGISTER_METHOD(L, Light, getIntensity)
+	OAK_REGISTER_METHOD(L, Light, setIntensity)
+	OAK_REGISTER_METHOD(L, Light, getRadius)
+	OAK_REGISTER_METHOD(L, Light, setRadius)
+	OAK_REGISTER_METHOD(L, Light, isDirectional)
+	OAK_REGISTER_METHOD(L, Light, setDirectional)
+	OAK_REGISTER_METHOD(L, Light, isCastingShadows)
+	OAK_REGISTER_METHOD(L, Light, setCastingShadows)
+	
+	OAK_REGISTER_CLASS(L, Mesh)
+	OAK_REGISTER_METHOD(L, Mesh, getMesh)
+	OAK_REGISTER_METHOD(L, Mesh, setMesh)
+	OAK_REGISTER_METHOD(L, Mesh, getColor)
+	OAK_REGISTER_METHOD(L, Mesh, setColor)
+	OAK_REGISTER_METHOD(L, Mesh, getOpacity)
+	OAK_REGISTER_METHOD(L, Mesh, setOpacity)
+	OAK_REGISTER_METHOD(L, Mesh, getTexture)
+	OAK_REGISTER_METHOD(L, Mesh, setTexture)
+	OAK_REGISTER_METHOD(L, Mesh, isLodCrossFade)
+	OAK_REGISTER_METHOD(L, Mesh, setLodCrossFade)
+	
+	OAK_REGISTER_CLASS(L, Occluder)
+	OAK_REGISTER_METHOD(L, Occluder, getMesh)
+	OAK_REGISTER_METHOD(L, Occluder, setMesh)
+	
+	OAK_REGISTER_CLASS(L, ParticleEmitter)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getRate)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setRate)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, burst)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getMaxParticleCount)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setMaxParticleCount)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getParticleCount)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getLifetime)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setLifetime)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getSpeed)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setSpeed)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getSpread)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setSpread)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getRadius)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setRadius)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getAcceleration)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setAcceleration)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getDrag)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setDrag)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getSize)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setSize)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getStartColor)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setStartColor)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getEndColor)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setEndColor)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getTexture)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setTexture)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, getRegion)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setRegion)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, isAdditive)
+	OAK_REGISTER_METHOD(L, ParticleEmitter, setAdditive)
+	
+	OAK_REGISTER_CLASS(L, Sprite)
+	OAK_REGISTER_METHOD(L, Sprite, getTexture)
+	OAK_REGISTER_METHOD(L, Sprite, setTexture)
+	OAK_REGISTER_METHOD(L, Sprite, getRegion)
+	OAK_REGISTER_METHOD(L, Sprite, setRegion)
+	OAK_REGISTER_METHOD(L, Sprite, getSize)
+	OAK_REGISTER_METHOD(L, Sprite, setSize)
+	OAK_REGISTER_METHOD(L, Sprite, getColor)
+	OAK_REGISTER_METHOD(L, Sprite, setColor)
+	OAK_REGISTER_METHOD(L, Sprite, getOpacity)
+	OAK_REGISTER_METHOD(L, Sprite, setOpacity)
+	OAK_REGISTER_METHOD(L, Sprite, getLayer)
+	OAK_REGISTER_METHOD(L, Sprite, setLayer)
+	OAK_REGISTER_METHOD(L, Sprite, isAdditive)
+	OAK_REGISTER_METHOD(L, Sprite, setAdditive)
+	OAK_REGISTER_METHOD(L, Sprite, isBillboard)
+	OAK_REGISTER_METHOD(L, Sprite, setBillboard)
+	
+	OAK_REGISTER_CLASS(L, Text)
+	OAK_REGISTER_METHOD(L, Text, getText)
+	OAK_REGISTER_METHOD(L, Text, setText)
+	OAK_REGISTER_METHOD(L, Text, getSize)
+	OAK_REGISTER_METHOD(L, Text, setSize)
+	OAK_REGISTER_METHOD(L, Text, getWidth)
+	OAK_REGISTER_METHOD(L, Text, getHeight)
+	OAK_REGISTER_METHOD(L, Text, getColor)
+	OAK_REGISTER_METHOD(L, Text, setColor)
+	OAK_REGISTER_METHOD(L, Text, getOpacity)
+	OAK_REGISTER_METHOD(L, Text, setOpacity)
+	OAK_REGISTER_METHOD(L, Text, getLayer)
+	OAK_REGISTER_METHOD(L, Text, setLayer)
+	
 	OAK_REGISTER_CLASS(L, View)
 	OAK_REGISTER_METHOD(L, View, getPriority)
 	OAK_REGISTER_METHOD(L, View, setPriority)
@@ -81,6 +431,95 @@ void GraphicsBind::registerFunctions(lua_State *L, GraphicsEngine *graphics)
 	OAK_REGISTER_METHOD(L, View, setEnabled)
 	OAK_REGISTER_METHOD(L, View, getCamera)
 	OAK_REGISTER_METHOD(L, View, setCamera)
+	OAK_REGISTER_METHOD(L, View, setTargetSize)
+	OAK_REGISTER_METHOD(L, View, getTargetTexture)
+	
+	OAK_REGISTER_CLASS(L, VoxelChunk)
+	OAK_REGISTER_METHOD(L, VoxelChunk, getSize)
+	OAK_REGISTER_METHOD(L, VoxelChunk, setSize)
+	OAK_REGISTER_METHOD(L, VoxelChunk, getBlock)
+	OAK_REGISTER_METHOD(L, VoxelChunk, setBlock)
+	OAK_REGISTER_METHOD(L, VoxelChunk, fill)
+	OAK_REGISTER_METHOD(L, VoxelChunk, getTexture)
+	OAK_REGISTER_METHOD(L, VoxelChunk, setTexture)
+	OAK_REGISTER_METHOD(L, VoxelChunk, getQuadCount)
+	
+	OAK_REGISTER_CLASS(L, Terrain)
+	OAK_REGISTER_METHOD(L, Terrain, getResolution)
+	OAK_REGISTER_METHOD(L, Terrain, setResolution)
+	OAK_REGISTER_METHOD(L, Terrain, getHeight)
+	OAK_REGISTER_METHOD(L, Terrain, setHeight)
+	OAK_REGISTER_METHOD(L, Terrain, getSpacing)
+	OAK_REGISTER_METHOD(L, Terrain, setSpacing)
+	OAK_REGISTER_METHOD(L, Terrain, getTexture)
+	OAK_REGISTER_METHOD(L, Terrain, setTexture)
+	OAK_REGISTER_METHOD(L, Terrain, getTextureScale)
+	OAK_REGISTER_METHOD(L, Terrain, setTextureScale)
+	OAK_REGISTER_METHOD(L, Terrain, getLodRange)
+	OAK_REGISTER_METHOD(L, Terrain, setLodRange)
+	
+	OAK_REGISTER_CLASS(L, SkinnedMesh)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getMesh)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setMesh)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getColor)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setColor)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getTexture)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setTexture)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getAnimation)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setAnimation)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getLayerWeight)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setLayerWeight)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getLayerSpeed)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setLayerSpeed)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, getLayerTime)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, setLayerTime)
+	OAK_REGISTER_METHOD(L, SkinnedMesh, isGpuSkinned)
+	
+	OAK_REGISTER_CLASS(L, Animator)
+	OAK_REGISTER_METHOD(L, Animator, getTime)
+	OAK_REGISTER_METHOD(L, Animator, setTime)
+	OAK_REGISTER_METHOD(L, Animator, getSpeed)
+	OAK_REGISTER_METHOD(L, Animator, setSpeed)
+	OAK_REGISTER_METHOD(L, Animator, isLooping)
+	OAK_REGISTER_METHOD(L, Animator, setLooping)
+	OAK_REGISTER_METHOD(L, Animator, addPositionKey)
+	OAK_REGISTER_METHOD(L, Animator, addRotationKey)
+	OAK_REGISTER_METHOD(L, Animator, addScaleKey)
+	OAK_REGISTER_METHOD(L, Animator, addColorKey)
+	OAK_REGISTER_METHOD(L, Animator, clearKeys)
+	OAK_REGISTER_METHOD(L, Animator, setSpin)
+	OAK_REGISTER_METHOD(L, Animator, setOrbit)
+	OAK_REGISTER_METHOD(L, Animator, setBob)
+	OAK_REGISTER_METHOD(L, Animator, setPulse)
+	OAK_REGISTER_METHOD(L, Animator, getLight)
+	OAK_REGISTER_METHOD(L, Animator, setLight)
+	OAK_REGISTER_METHOD(L, Animator, getSprite)
+	OAK_REGISTER_METHOD(L, Animator, setSprite)
+	
+	OAK_REGISTER_CLASS(L, DebugDraw)
+	OAK_REGISTER_METHOD(L, DebugDraw, drawLine)
+	OAK_REGISTER_METHOD(L, DebugDraw, drawBox)
+	OAK_REGISTER_METHOD(L, DebugDraw, drawSphere)
+	OAK_REGISTER_METHOD(L, DebugDraw, drawCameraFrustum)
+	OAK_REGISTER_METHOD(L, DebugDraw, drawLabel)
+	
+	OAK_REGISTER_CLASS(L, PostProcess)
+	OAK_REGISTER_METHOD(L, PostProcess, getFogDensity)
+	OAK_REGISTER_METHOD(L, PostProcess, setFogDensity)
+	OAK_REGISTER_METHOD(L, PostProcess, getFogColor)
+	OAK_REGISTER_METHOD(L, PostProcess, setFogColor)
+	OAK_REGISTER_METHOD(L, PostProcess, isToneMapping)
+	OAK_REGISTER_METHOD(L, PostProcess, setToneMapping)
+	OAK_REGISTER_METHOD(L, PostProcess, getExposure)
+	OAK_REGISTER_METHOD(L, PostProcess, setExposure)
+	OAK_REGISTER_METHOD(L, PostProcess, getGamma)
+	OAK_REGISTER_METHOD(L, PostProcess, setGamma)
+	OAK_REGISTER_METHOD(L, PostProcess, getBloomThreshold)
+	OAK_REGISTER_METHOD(L, PostProcess, setBloomThreshold)
+	OAK_REGISTER_METHOD(L, PostProcess, getBloomIntensity)
+	OAK_REGISTER_METHOD(L, PostProcess, setBloomIntensity)
+	OAK_REGISTER_METHOD(L, PostProcess, isAntialiasing)
+	OAK_REGISTER_METHOD(L, PostProcess, setAntialiasing)
 }
 
 } // oak namespace
@@ -51,6 +51,8 @@ OAK_BIND_WRET_METHOD0(Scene, createEntity)
 OAK_BIND_VOID_METHOD1(Scene, destroyEntity, Entity *)
 
 OAK_BIND_WRET_METHOD0(Entity, getScene)
+OAK_BIND_WRET_METHOD0(Entity, isStatic)
+OAK_BIND_VOID_METHOD1(Entity, setStatic, bool)
 OAK_BIND_WRET_METHOD1(Entity, createComponent, std::string)
 OAK_BIND_VOID_METHOD1(Entity, destroyComponent, Component *)
 OAK_BIND_WRET_METHOD0(Entity, getLocalPosition)
@@ -80,6 +82,8 @@ void SgBind::registerFunctions(lua_State *L, WorldManager *sg)
 	
 	OAK_REGISTER_CLASS(L, Entity)
 	OAK_REGISTER_METHOD(L, Entity, getScene)
+	OAK_REGISTER_METHOD(L, Entity, isStatic)
+	OAK_REGISTER_METHOD(L, Entity, setStatic)
 	OAK_REGISTER_METHOD(L, Entity, createComponent)
 	OAK_REGISTER_METHOD(L, Entity, destroyComponent)
 	OAK_REGISTER_METHOD(L, Entity, getLocalPosition)
@@ -42,6 +42,9 @@ class Component
 		
 		virtual void activateComponent(Entity *entity) {};
 		virtual void deactivateComponent(Entity *entity) {};
+		
+		// the local transform of the entity changed, possibly from a job
+		virtual void entityMoved(Entity *entity) {};
 };
 
 } // oak namespace
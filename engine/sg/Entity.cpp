@@ -55,6 +55,7 @@ void Entity::unregisterComponentFactory(const std::string &className)
 
 Entity::Entity(Scene *scene)
 	: scene(scene)
+	, staticEntity(false)
 	, localPosition(0.0f, 0.0f, 0.0f)
 	, localOrientation(1.0f, 0.0f, 0.0f, 0.0f)
 	, localScale(1.0f, 1.0f, 1.0f)
@@ -107,6 +108,14 @@ void Entity::destroyComponent(Component *component)
 	this->components.pop_back();
 }
 
+void Entity::setLocalTransform(const glm::vec3 &localPosition, const glm::quat &localOrientation, const glm::vec3 &localScale)
+{
+	this->localPosition = localPosition;
+	this->localOrientation = localOrientation;
+	this->localScale = localScale;
+	this->updateLocalTransform();
+}
+
 void Entity::translate(const glm::vec3 &translation)
 {
 	glm::vec3 newPosition = this->localPosition + translation;
@@ -134,6 +143,9 @@ void Entity::updateLocalTransform()
 	glm::mat4 scale = glm::scale(this->localScale.x, this->localScale.y, this->localScale.z);
 	
 	this->localTransform = translation * rotation * scale;
+	
+	for (unsigned int i = 0; i < this->components.size(); i++)
+		this->components[i]->entityMoved(this);
 }
 
 } // oak namespace
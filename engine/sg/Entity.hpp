@@ -49,6 +49,11 @@ class Entity
 		
 		Scene *getScene() const { return this->scene; }
 		
+		// static entities are not supposed to move once their scene is built,
+		// which allows engines to precompute data from their transform
+		bool isStatic() const { return this->staticEntity; }
+		void setStatic(bool isStatic) { this->staticEntity = isStatic; }
+		
 		Component *createComponent(const std::string &className);
 		void destroyComponent(Component *component);
 		
@@ -60,6 +65,9 @@ class Entity
 		void setLocalOrientation(const glm::quat &localOrientation) { this->localOrientation = localOrientation; this->updateLocalTransform(); }
 		void setLocalScale(const glm::vec3 &localScale) { this->localScale = localScale; this->updateLocalTransform(); }
 		
+		// all at once, computing the transform once
+		void setLocalTransform(const glm::vec3 &localPosition, const glm::quat &localOrientation, const glm::vec3 &localScale);
+		
 		const glm::mat4 &getLocalTransform() const { return this->localTransform; }
 		//const glm::mat4 &getWorldTransform() const { return this->worldTransform; }
 		
@@ -76,6 +84,7 @@ class Entity
 		static FactoryMap factories;
 		
 		Scene *scene;
+		bool staticEntity;
 		
 		typedef std::vector<Component *> ComponentVector;
 		ComponentVector components;
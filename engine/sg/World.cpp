@@ -39,10 +39,7 @@ World::World()
 
 World::~World()
 {
-	for (unsigned int i = 0; i < this->scenes.size(); i++)
-	{
-		delete this->scenes[i];
-	}
+	this->destroyAllScenes();
 	
 	Log::info("World destroyed!");
 }
@@ -67,4 +64,14 @@ void World::destroyScene(Scene *scene)
 	delete scene;
 }
 
+void World::destroyAllScenes()
+{
+	for (unsigned int i = 0; i < this->scenes.size(); i++)
+	{
+		delete this->scenes[i];
+	}
+	
+	this->scenes.clear();
+}
+
 } // oak namespace
@@ -39,6 +39,9 @@ class World
 		
 		Scene *createScene();
 		void destroyScene(Scene *scene);
+		
+		// destroy every scene, with their entities and components
+		void destroyAllScenes();
 	
 	private:
 		typedef std::vector<Scene *> SceneVector;
@@ -52,6 +52,9 @@ void WorldManager::destroyWorld(World *world)
 	WorldVector::iterator it = std::find(this->worlds.begin(), this->worlds.end(), world);
 	OAK_ASSERT(it != this->worlds.end(), "Trying to destroy an unexisting world");
 	
+	// components are destroyed first, while they can still unregister from the listeners
+	world->destroyAllScenes();
+	
 	// notify listeners
 	for (unsigned int i = 0; i < this->listeners.size(); i++)
 	{
@@ -116,6 +116,11 @@ void AndroidActivity::createWindow(ANativeWindow *window)
 		Log::error("Failed to set the current EGL context");
 	}
 	
+	EGLint width, height;
+	eglQuerySurface(this->eglDisplay, this->eglSurface, EGL_WIDTH, &width);
+	eglQuerySurface(this->eglDisplay, this->eglSurface, EGL_HEIGHT, &height);
+	this->gameApplication.setScreenSize(width, height);
+	
 	// the context is ready, start application
 	// note: there are issues with files at the root of the .apk assets/ folder,
 	// so the packager will put everything under assets/data/.
@@ -32,6 +32,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
 using namespace oak;
@@ -48,9 +50,15 @@ void main_loop()
 }
 #endif
 
+// application notified of window resizes, once created
+static Application *resizedApplication = NULL;
+
 static void GLFWCALL onWindowResize(int width, int height)
 {
 	glViewport(0, 0, width, height);
+	
+	if (resizedApplication)
+		resizedApplication->setScreenSize(width, height);
 }
 
 int main(int argc, char **argv)
@@ -59,10 +67,24 @@ int main(int argc, char **argv)
 	if (argc < 2)
 	{
 		Log::error("No game folder given on the command-line, aborting");
-		std::cout << "Usage: " << argv[0] << " <game folder>" << std::endl;
+		std::cout << "Usage: " << argv[0] << " <game folder> [--pipeline-depth <1-3>]" << std::endl;
 		return 1;
 	}
 	
+	// optional arguments
+	unsigned int pipelineDepth = 1;
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--pipeline-depth") == 0 && i + 1 < argc)
+		{
+			pipelineDepth = (unsigned int)std::max(1, std::min(3, atoi(argv[++i])));
+		}
+		else
+		{
+			Log::warning("Ignoring unknown command-line argument %s", argv[i]);
+		}
+	}
+	
 	// normalize game folder
 	std::string gameFolder = std::string(argv[1]);
 	std::replace(gameFolder.begin(), gameFolder.end(), '\\', '/');
@@ -99,6 +121,12 @@ int main(int argc, char **argv)
 	glGetError();
 	
 	Application *application = new Application;
+	application->setRenderPipelineDepth(pipelineDepth);
+	
+	int width, height;
+	glfwGetWindowSize(&width, &height);
+	application->setScreenSize(width, height);
+	resizedApplication = application;
 	
 	application->initialize(gameFolder);
 	
@@ -119,6 +147,7 @@ int main(int argc, char **argv)
 	
 	application->shutdown();
 	
+	resizedApplication = NULL;
 	delete application;
 	
 	glfwCloseWindow();
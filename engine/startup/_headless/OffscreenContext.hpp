@@ -0,0 +1,65 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+namespace oak {
+
+struct OffscreenContextState;
+
+/**
+ * Graphics context rendering to an offscreen surface, for runs without display.
+ * The implementation depends on the platform tags (EGL pbuffer, or nothing at
+ * all with the null graphics driver).
+ */
+class OffscreenContext
+{
+	public:
+		OffscreenContext();
+		~OffscreenContext();
+		
+		// create the context and make it current on the calling thread
+		bool create(unsigned int width, unsigned int height);
+		void destroy();
+		
+		// block until all the rendering commands issued so far are complete
+		void finishFrame();
+		
+		// read back the color buffer as RGB bytes, rows ordered from top to bottom;
+		// returns false if the context has no readable color buffer
+		bool readPixels(std::vector<unsigned char> &pixels);
+		
+		unsigned int getWidth() const { return this->width; }
+		unsigned int getHeight() const { return this->height; }
+	
+	private:
+		OffscreenContextState *state;
+		unsigned int width;
+		unsigned int height;
+};
+
+} // oak namespace
@@ -0,0 +1,202 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/startup/_headless/OffscreenContext.hpp>
+
+#include <engine/graphics/_gl/gl_includes.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace oak {
+
+struct OffscreenContextState
+{
+	EGLDisplay display;
+	EGLSurface surface;
+	EGLContext context;
+	
+	OffscreenContextState()
+		: display(EGL_NO_DISPLAY)
+		, surface(EGL_NO_SURFACE)
+		, context(EGL_NO_CONTEXT)
+	{}
+};
+
+namespace { // private section
+
+EGLDisplay openDisplay()
+{
+	// prefer the surfaceless platform (e.g Mesa llvmpipe), which needs neither X server nor GPU
+	#if defined(EGL_PLATFORM_SURFACELESS_MESA)
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+		{
+			EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			if (display != EGL_NO_DISPLAY)
+				return display;
+		}
+	#endif
+	
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+} // end of private section
+
+OffscreenContext::OffscreenContext()
+{
+	this->state = new OffscreenContextState;
+	this->width = 0;
+	this->height = 0;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+	this->destroy();
+	delete this->state;
+}
+
+bool OffscreenContext::create(unsigned int width, unsigned int height)
+{
+	OAK_ASSERT(this->state->display == EGL_NO_DISPLAY, "Offscreen context created twice");
+	
+	this->width = width;
+	this->height = height;
+	
+	this->state->display = openDisplay();
+	
+	EGLint major;
+	EGLint minor;
+	if (this->state->display == EGL_NO_DISPLAY || !eglInitialize(this->state->display, &major, &minor))
+	{
+		Log::error("Failed to initialize EGL (error 0x%x)", eglGetError());
+		this->state->display = EGL_NO_DISPLAY;
+		return false;
+	}
+	
+	// same buffer formats as the windowed startup
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_STENCIL_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(this->state->display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		Log::error("No EGL configuration supports offscreen OpenGL rendering");
+		this->destroy();
+		return false;
+	}
+	
+	const EGLint surfaceAttributes[] = {
+		EGL_WIDTH, (EGLint)width,
+		EGL_HEIGHT, (EGLint)height,
+		EGL_NONE
+	};
+	this->state->surface = eglCreatePbufferSurface(this->state->display, config, surfaceAttributes);
+	if (this->state->surface == EGL_NO_SURFACE)
+	{
+		Log::error("Failed to create EGL pbuffer surface (error 0x%x)", eglGetError());
+		this->destroy();
+		return false;
+	}
+	
+	eglBindAPI(EGL_OPENGL_API);
+	this->state->context = eglCreateContext(this->state->display, config, EGL_NO_CONTEXT, NULL);
+	if (this->state->context == EGL_NO_CONTEXT || !eglMakeCurrent(this->state->display, this->state->surface, this->state->surface, this->state->context))
+	{
+		Log::error("Failed to create EGL context (error 0x%x)", eglGetError());
+		this->destroy();
+		return false;
+	}
+	
+	Log::info("Offscreen context: EGL %d.%d, %s", major, minor, (const char *)glGetString(GL_RENDERER));
+	
+	GL_CHECK(glViewport(0, 0, width, height));
+	
+	return true;
+}
+
+void OffscreenContext::destroy()
+{
+	if (this->state->display == EGL_NO_DISPLAY)
+		return;
+	
+	eglMakeCurrent(this->state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	
+	if (this->state->context != EGL_NO_CONTEXT)
+		eglDestroyContext(this->state->display, this->state->context);
+	if (this->state->surface != EGL_NO_SURFACE)
+		eglDestroySurface(this->state->display, this->state->surface);
+	
+	eglTerminate(this->state->display);
+	
+	this->state->display = EGL_NO_DISPLAY;
+	this->state->surface = EGL_NO_SURFACE;
+	this->state->context = EGL_NO_CONTEXT;
+}
+
+void OffscreenContext::finishFrame()
+{
+	GL_CHECK(glFinish());
+}
+
+bool OffscreenContext::readPixels(std::vector<unsigned char> &pixels)
+{
+	unsigned int rowSize = this->width * 3;
+	pixels.resize(rowSize * this->height);
+	if (pixels.empty())
+		return false;
+	
+	GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GL_CHECK(glReadPixels(0, 0, this->width, this->height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]));
+	
+	// GL rows start at the bottom of the image
+	std::vector<unsigned char> row(rowSize);
+	for (unsigned int y = 0; y < this->height / 2; y++)
+	{
+		unsigned char *top = &pixels[y * rowSize];
+		unsigned char *bottom = &pixels[(this->height - 1 - y) * rowSize];
+		memcpy(&row[0], top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, &row[0], rowSize);
+	}
+	
+	return true;
+}
+
+} // oak namespace
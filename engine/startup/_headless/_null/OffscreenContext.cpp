@@ -0,0 +1,66 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/startup/_headless/OffscreenContext.hpp>
+
+#include <cstddef>
+
+namespace oak {
+
+// the null graphics driver needs no context, and has no color buffer to read back
+
+OffscreenContext::OffscreenContext()
+{
+	this->state = NULL;
+	this->width = 0;
+	this->height = 0;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+}
+
+bool OffscreenContext::create(unsigned int width, unsigned int height)
+{
+	this->width = width;
+	this->height = height;
+	
+	return true;
+}
+
+void OffscreenContext::destroy()
+{
+}
+
+void OffscreenContext::finishFrame()
+{
+}
+
+bool OffscreenContext::readPixels(std::vector<unsigned char> &pixels)
+{
+	return false;
+}
+
+} // oak namespace
@@ -0,0 +1,288 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/app/Application.hpp>
+#include <engine/graphics/GraphicsEngine.hpp>
+#include <engine/startup/_headless/OffscreenContext.hpp>
+#include <engine/system/Log.hpp>
+#include <engine/system/PrecisionTime.hpp>
+#include <engine/system/Time.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace oak;
+
+// Headless startup: runs a game for a fixed number of frames, without any
+// window, then reports CPU frame timings and driver statistics. Meant for
+// automated benchmarks on machines without display. Depending on the build,
+// frames are rendered by GL in an offscreen context, or by the null driver.
+
+static void printUsage(const char *executable)
+{
+	std::cout << "Usage: " << executable << " <game folder> [options]" << std::endl;
+	std::cout << "  --frames <count>          number of frames to run (default 100)" << std::endl;
+	std::cout << "  --dt <seconds>            fixed time step of each frame (default 1/60)" << std::endl;
+	std::cout << "  --size <width>x<height>   size of the offscreen surface (default 1280x720)" << std::endl;
+	std::cout << "  --pipeline-depth <1-3>    number of frames in flight (default 1)" << std::endl;
+	std::cout << "  --timings <file>          write per-frame CPU timings as CSV" << std::endl;
+	std::cout << "  --capture <frame>         write a PPM capture of the given frame (repeatable)" << std::endl;
+	std::cout << "  --capture-prefix <path>   prefix of the capture files (default \"frame\")" << std::endl;
+	std::cout << "  --trace                   log every driver command (null driver, debug builds)" << std::endl;
+}
+
+static void printStatistic(const char *name, unsigned int total, unsigned int frameCount)
+{
+	std::cout << name << ": " << total << " (" << (float)total / frameCount << " per frame)" << std::endl;
+}
+
+static bool writePPM(const std::string &filename, unsigned int width, unsigned int height, const std::vector<unsigned char> &pixels)
+{
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+	if (file.fail())
+		return false;
+	
+	file << "P6\n" << width << " " << height << "\n255\n";
+	file.write((const char *)&pixels[0], pixels.size());
+	
+	return !file.fail();
+}
+
+// CPU time spent on each frame, in milliseconds
+struct FrameTiming
+{
+	// simulation and command submission
+	double update;
+	
+	// wait for the driver to complete the frame
+	double finish;
+};
+
+int main(int argc, char **argv)
+{
+	// the engine must be given a game folder
+	if (argc < 2)
+	{
+		Log::error("No game folder given on the command-line, aborting");
+		printUsage(argv[0]);
+		return 1;
+	}
+	
+	// normalize game folder
+	std::string gameFolder = std::string(argv[1]);
+	std::replace(gameFolder.begin(), gameFolder.end(), '\\', '/');
+	if (gameFolder[gameFolder.size() - 1] != '/')
+		gameFolder += '/';
+	
+	// the game must contain at least a file named main.lua
+	std::string mainScriptFilename = gameFolder + "main.lua";
+	std::ifstream mainScriptFile(mainScriptFilename.c_str());
+	if (mainScriptFile.fail())
+	{
+		Log::error("Entry script main.lua not found in game folder, aborting");
+		std::cout << "The game folder must contain a main.lua file" << std::endl;
+		return 1;
+	}
+	mainScriptFile.close();
+	
+	// optional arguments
+	unsigned int frameCount = 100;
+	double timeStep = 1.0 / 60.0;
+	unsigned int width = 1280;
+	unsigned int height = 720;
+	unsigned int pipelineDepth = 1;
+	std::string timingsFilename;
+	std::set<unsigned int> capturedFrames;
+	std::string capturePrefix = "frame";
+	bool trace = false;
+	for (int i = 2; i < argc; i++)
+	{
+		bool hasValue = (i + 1 < argc);
+		
+		if (strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			frameCount = (unsigned int)std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--dt") == 0 && hasValue)
+		{
+			timeStep = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--size") == 0 && hasValue)
+		{
+			if (sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+			{
+				Log::error("Invalid surface size %s, expected <width>x<height>", argv[i]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--pipeline-depth") == 0 && hasValue)
+		{
+			pipelineDepth = (unsigned int)std::max(1, std::min(3, atoi(argv[++i])));
+		}
+		else if (strcmp(argv[i], "--timings") == 0 && hasValue)
+		{
+			timingsFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--capture") == 0 && hasValue)
+		{
+			capturedFrames.insert((unsigned int)std::max(0, atoi(argv[++i])));
+		}
+		else if (strcmp(argv[i], "--capture-prefix") == 0 && hasValue)
+		{
+			capturePrefix = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0)
+		{
+			trace = true;
+		}
+		else
+		{
+			Log::warning("Ignoring unknown command-line argument %s", argv[i]);
+		}
+	}
+	
+	OffscreenContext context;
+	if (!context.create(width, height))
+	{
+		Log::error("Failed to create an offscreen context! Exiting...");
+		return 1;
+	}
+	
+	// every run of the same game gives the same frames
+	Time::setFixedTimeStep(timeStep);
+	
+	Application *application = new Application;
+	application->setRenderPipelineDepth(pipelineDepth);
+	application->setScreenSize(width, height);
+	
+	application->initialize(gameFolder);
+	
+	GraphicsEngine *graphics = application->getGraphicsEngine();
+	graphics->setDriverCommandTrace(trace);
+	
+	// resources created by the initialization are not part of the frame statistics
+	graphics->resetDriverStatistics();
+	
+	std::vector<FrameTiming> timings(frameCount);
+	std::vector<unsigned char> pixels;
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		unsigned long long frameStart = PrecisionTime::readNanoseconds();
+		application->update();
+		
+		unsigned long long updateEnd = PrecisionTime::readNanoseconds();
+		context.finishFrame();
+		
+		unsigned long long frameEnd = PrecisionTime::readNanoseconds();
+		timings[i].update = (double)(updateEnd - frameStart) / 1000000.0;
+		timings[i].finish = (double)(frameEnd - updateEnd) / 1000000.0;
+		
+		// captures are taken out of the timed section
+		if (capturedFrames.count(i) > 0)
+		{
+			std::ostringstream filename;
+			filename << capturePrefix << i << ".ppm";
+			
+			if (!context.readPixels(pixels))
+				Log::warning("Frame captures are not supported by this graphics driver");
+			else if (!writePPM(filename.str(), width, height, pixels))
+				Log::error("Failed to write frame capture %s", filename.str().c_str());
+		}
+	}
+	
+	// the report is written on the standard output, logs are compiled out of release builds
+	std::vector<double> frameTimes(frameCount);
+	double totalTime = 0.0;
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		frameTimes[i] = timings[i].update + timings[i].finish;
+		totalTime += frameTimes[i];
+	}
+	std::sort(frameTimes.begin(), frameTimes.end());
+	
+	std::cout << frameCount << " frames, " << width << "x" << height << ", fixed step " << timeStep << "s" << std::endl;
+	std::cout << "frame time (ms): average " << totalTime / frameCount
+		<< ", min " << frameTimes.front()
+		<< ", median " << frameTimes[frameCount / 2]
+		<< ", 95th percentile " << frameTimes[(frameCount * 95) / 100]
+		<< ", max " << frameTimes.back() << std::endl;
+	
+	const GraphicDriver::Statistics &statistics = graphics->getDriverStatistics();
+	printStatistic("clears", statistics.clearCount, frameCount);
+	printStatistic("draws", statistics.drawCount, frameCount);
+	printStatistic("drawn elements", statistics.drawnElementCount, frameCount);
+	printStatistic("shader binds", statistics.shaderBindCount, frameCount);
+	printStatistic("vertex buffer binds", statistics.vertexBufferBindCount, frameCount);
+	printStatistic("texture binds", statistics.textureBindCount, frameCount);
+	printStatistic("render target binds", statistics.renderTargetBindCount, frameCount);
+	printStatistic("shader constants", statistics.shaderConstantCount, frameCount);
+	printStatistic("resource operations", statistics.resourceOperationCount, frameCount);
+	printStatistic("streamed bytes", statistics.streamedByteCount, frameCount);
+	printStatistic("stream stalls", statistics.streamStallCount, frameCount);
+	printStatistic("uploaded texture bytes", statistics.uploadedTextureByteCount, frameCount);
+	
+	const TextureManager::Statistics &textureStatistics = graphics->getTextureStatistics();
+	std::cout << "textures: " << textureStatistics.textureCount << ", " << textureStatistics.streamedTextureCount << " streamed, "
+		<< textureStatistics.residentByteCount << " resident bytes" << std::endl;
+	printStatistic("texture misses", textureStatistics.missCount, frameCount);
+	printStatistic("streamed texture levels", textureStatistics.streamedLevelCount, frameCount);
+	printStatistic("texture evictions", textureStatistics.evictionCount, frameCount);
+	
+	const RenderGraph::Statistics &graphStatistics = graphics->getRenderGraphStatistics();
+	std::cout << "render passes (last frame): " << graphStatistics.passCount << ", " << graphStatistics.culledPassCount << " culled; "
+		<< graphStatistics.transientTargetCount << " transient targets in " << graphStatistics.allocatedTargetCount << " allocations ("
+		<< graphStatistics.createdTargetCount << " created)" << std::endl;
+	
+	const GlyphAtlas::Statistics &glyphStatistics = graphics->getGlyphStatistics();
+	std::cout << "glyphs: " << glyphStatistics.glyphCount << " in the atlas, " << glyphStatistics.rasterizedGlyphCount << " rasterized, "
+		<< glyphStatistics.evictedGlyphCount << " evicted; " << graphics->getTextLayoutCount() << " text layouts" << std::endl;
+	
+	if (!timingsFilename.empty())
+	{
+		std::ofstream timingsFile(timingsFilename.c_str());
+		timingsFile << "frame,update_ms,finish_ms,total_ms" << std::endl;
+		for (unsigned int i = 0; i < frameCount; i++)
+			timingsFile << i << "," << timings[i].update << "," << timings[i].finish << "," << timings[i].update + timings[i].finish << std::endl;
+		
+		if (timingsFile.fail())
+			Log::error("Failed to write frame timings to %s", timingsFilename.c_str());
+	}
+	
+	application->shutdown();
+	
+	delete application;
+	
+	context.destroy();
+	
+	return 0;
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace oak {
+
+/**
+ * Minimal set of atomic integer operations, mapped to compiler intrinsics.
+ * All operations imply a full memory barrier.
+ */
+class Atomic
+{
+	public:
+		// returns the incremented value
+		static inline int increment(volatile int *value)
+		{
+			#if defined(_MSC_VER)
+				return _InterlockedIncrement((volatile long *)value);
+			#else
+				return __sync_add_and_fetch(value, 1);
+			#endif
+		}
+		
+		// returns the decremented value
+		static inline int decrement(volatile int *value)
+		{
+			#if defined(_MSC_VER)
+				return _InterlockedDecrement((volatile long *)value);
+			#else
+				return __sync_sub_and_fetch(value, 1);
+			#endif
+		}
+		
+		// returns the value before the addition
+		static inline int add(volatile int *value, int amount)
+		{
+			#if defined(_MSC_VER)
+				return _InterlockedExchangeAdd((volatile long *)value, amount);
+			#else
+				return __sync_fetch_and_add(value, amount);
+			#endif
+		}
+		
+		// sets *value to newValue if it was equal to expected, and returns the previous value
+		static inline int compareAndSwap(volatile int *value, int expected, int newValue)
+		{
+			#if defined(_MSC_VER)
+				return _InterlockedCompareExchange((volatile long *)value, newValue, expected);
+			#else
+				return __sync_val_compare_and_swap(value, expected, newValue);
+			#endif
+		}
+		
+		static inline int load(volatile int *value)
+		{
+			return Atomic::add(value, 0);
+		}
+		
+		static inline void store(volatile int *value, int newValue)
+		{
+			#if defined(_MSC_VER)
+				_InterlockedExchange((volatile long *)value, newValue);
+			#else
+				__sync_lock_test_and_set(value, newValue);
+				__sync_synchronize();
+			#endif
+		}
+};
+
+} // oak namespace
@@ -0,0 +1,68 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/system/File.hpp>
+
+#include <cstdio>
+
+#ifdef ANDROID
+#	include <android/asset_manager.h>
+	
+	// set by the android activity, as for script loading
+	extern AAssetManager *assetManager;
+#endif
+
+namespace oak {
+
+bool File::read(const std::string &path, std::vector<char> *content)
+{
+	content->clear();
+	
+	#ifdef ANDROID
+		AAsset *file = AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_STREAMING);
+		if (!file)
+			return false;
+		
+		char buffer[4096];
+		int size = 0;
+		while ((size = AAsset_read(file, buffer, sizeof(buffer))) > 0)
+			content->insert(content->end(), buffer, buffer + size);
+		AAsset_close(file);
+	#else
+		FILE *file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		
+		char buffer[4096];
+		size_t size = 0;
+		while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			content->insert(content->end(), buffer, buffer + size);
+		fclose(file);
+	#endif
+	
+	return true;
+}
+
+} // oak namespace
@@ -0,0 +1,145 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/system/JobQueue.hpp>
+
+#include <engine/system/Atomic.hpp>
+#include <engine/system/Log.hpp>
+#include <engine/system/Thread.hpp>
+
+#include <cstddef>
+
+namespace oak {
+
+bool JobQueue::Batch::isDone() const
+{
+	return Atomic::load(const_cast<volatile int *>(&this->pendingCount)) == 0;
+}
+
+JobQueue::JobQueue(unsigned int workerCount)
+	: workAvailable(0)
+	, stopping(false)
+{
+	for (unsigned int i = 0; i < workerCount; i++)
+		this->workers.push_back(new Thread(JobQueue::workerMain, this));
+	
+	Log::info("Job queue started with %d worker(s)", workerCount);
+}
+
+JobQueue::~JobQueue()
+{
+	{
+		MutexLock lock(&this->mutex);
+		OAK_ASSERT(this->jobs.size() == 0, "Job queue destroyed while jobs are still pending");
+		this->stopping = true;
+	}
+	
+	// wake every worker up, so that they notice the queue is stopping
+	for (unsigned int i = 0; i < this->workers.size(); i++)
+		this->workAvailable.post();
+	
+	for (unsigned int i = 0; i < this->workers.size(); i++)
+		delete this->workers[i];
+}
+
+void JobQueue::push(JobFunction function, void *userData, Batch *batch)
+{
+	Job job;
+	job.function = function;
+	job.userData = userData;
+	job.batch = batch;
+	
+	Atomic::increment(&batch->pendingCount);
+	
+	{
+		MutexLock lock(&this->mutex);
+		this->jobs.push_back(job);
+	}
+	
+	this->workAvailable.post();
+}
+
+void JobQueue::wait(Batch *batch)
+{
+	while (!batch->isDone())
+	{
+		// help with the remaining work, or let the workers finish theirs
+		if (!this->runPendingJob(batch))
+			Thread::yield();
+	}
+}
+
+unsigned int JobQueue::getDefaultWorkerCount()
+{
+	return Thread::getProcessorCount() - 1;
+}
+
+bool JobQueue::runPendingJob(Batch *batch)
+{
+	Job job;
+	
+	{
+		MutexLock lock(&this->mutex);
+		
+		JobDeque::iterator it = this->jobs.begin();
+		if (batch)
+		{
+			while (it != this->jobs.end() && it->batch != batch)
+				++it;
+		}
+		
+		if (it == this->jobs.end())
+			return false;
+		
+		job = *it;
+		this->jobs.erase(it);
+	}
+	
+	job.function(job.userData);
+	Atomic::decrement(&job.batch->pendingCount);
+	
+	return true;
+}
+
+void JobQueue::workerMain(void *userData)
+{
+	JobQueue *queue = (JobQueue *)userData;
+	
+	while (true)
+	{
+		queue->workAvailable.wait();
+		
+		{
+			MutexLock lock(&queue->mutex);
+			if (queue->stopping)
+				return;
+		}
+		
+		// the job may already have been run by a waiting thread
+		queue->runPendingJob(NULL);
+	}
+}
+
+} // oak namespace
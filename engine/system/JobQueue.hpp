@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <engine/system/Mutex.hpp>
+#include <engine/system/Semaphore.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace oak {
+
+class Thread;
+
+/**
+ * Runs small independent jobs on a pool of worker threads.
+ *
+ * Jobs are pushed as part of a batch, and the thread waiting for a batch
+ * helps running its jobs. As a consequence, a queue created without any
+ * worker is valid: all jobs are then run sequentially by wait().
+ */
+class JobQueue
+{
+	public:
+		typedef void (*JobFunction)(void *userData);
+		
+		// tracks the completion of a set of jobs
+		class Batch
+		{
+			public:
+				Batch() : pendingCount(0) {}
+				
+				bool isDone() const;
+			
+			private:
+				friend class JobQueue;
+				volatile int pendingCount;
+		};
+		
+		JobQueue(unsigned int workerCount);
+		~JobQueue();
+		
+		unsigned int getWorkerCount() const { return (unsigned int)this->workers.size(); }
+		
+		void push(JobFunction function, void *userData, Batch *batch);
+		
+		// run jobs of the given batch on the calling thread, until they are all done
+		void wait(Batch *batch);
+		
+		// one worker per processor, except the one running the calling thread
+		static unsigned int getDefaultWorkerCount();
+	
+	private:
+		struct Job
+		{
+			JobFunction function;
+			void *userData;
+			Batch *batch;
+		};
+		
+		// pop and run one pending job, from the given batch only if not NULL
+		// returns false if no matching job was found
+		bool runPendingJob(Batch *batch);
+		
+		static void workerMain(void *userData);
+		
+		Mutex mutex;
+		Semaphore workAvailable;
+		bool stopping;
+		
+		typedef std::deque<Job> JobDeque;
+		JobDeque jobs;
+		
+		typedef std::vector<Thread *> ThreadVector;
+		ThreadVector workers;
+};
+
+} // oak namespace
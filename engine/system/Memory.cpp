@@ -26,7 +26,9 @@
 #include <engine/system/Memory.hpp>
 #include <engine/system/StackWalker.hpp>
 
+#include <engine/system/Atomic.hpp>
 #include <engine/system/Log.hpp>
+#include <engine/system/Thread.hpp>
 
 #include <cstring>
 #include <cstdio>
@@ -52,6 +54,25 @@ namespace oak {
 
 #ifdef OAK_DEBUG
 	Memory::StackAllocationStats Memory::allocationStats[MAX_UNIQUE_CALL_STACKS];
+	
+	namespace { // private section
+	
+	// allocations may come from any thread, so accesses to the tracking table are serialized
+	// (with a spin lock, as a mutex would need to allocate memory itself)
+	volatile int trackingLock = 0;
+	
+	void lockTracking()
+	{
+		while (Atomic::compareAndSwap(&trackingLock, 0, 1) != 0)
+			Thread::yield();
+	}
+	
+	void unlockTracking()
+	{
+		Atomic::store(&trackingLock, 0);
+	}
+	
+	} // end of private section
 #endif
 
 void *Memory::allocate(size_t size)
@@ -68,7 +89,9 @@ void *Memory::allocate(size_t size)
 		// sample the call stack, and save the hash with the pointer
 		PointerHeader *header = (PointerHeader *)pointer;
 		header->size = size;
+		lockTracking();
 		header->stackHash = Memory::trackAllocation(size);
+		unlockTracking();
 		
 		pointer = (void *)((char *)pointer + sizeof(PointerHeader));
 	#endif
@@ -78,13 +101,19 @@ void *Memory::allocate(size_t size)
 
 void Memory::free(void *ptr)
 {
+	// deleting a null pointer is valid, and must not reach the debug header lookup
+	if (ptr == NULL)
+		return;
+	
 	#ifdef OAK_DEBUG
 		// find the actual pointer allocated previously
 		ptr = (void *)((char *)ptr - sizeof(PointerHeader));
 		
 		// track the released memory
 		PointerHeader *header = (PointerHeader *)ptr;
+		lockTracking();
 		Memory::trackFree(header->size, header->stackHash);
+		unlockTracking();
 	#endif
 	
 	::free(ptr);
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace oak {
+
+/**
+ * Stable sort of items by an unsigned integer key member, in linear time: a
+ * least significant digit radix sort, one byte per pass. The histograms of all
+ * bytes are counted in a single read, and the passes over bytes shared by
+ * all keys are skipped, so keys using a few low bits cost only a few passes.
+ *
+ * Items are moved at each pass: sorting small items (a key and an index) then
+ * reading the large ones through them is usually faster.
+ */
+class RadixSort
+{
+	public:
+		// sort the items by increasing keys, keeping the order of equal ones;
+		// the scratch vector is resized as needed, and can be kept for the next sort
+		template <typename Item>
+		static void sort(std::vector<Item> *items, std::vector<Item> *scratch);
+		
+		// Depth between the near and far planes quantized on 16 bits, such that the
+		// farthest come first; depths out of the planes are clamped.
+		static unsigned int getBackToFrontKey(float depth, float nearPlane, float farPlane)
+		{
+			float position = (farPlane - depth) / (farPlane - nearPlane);
+			position = std::max(0.0f, std::min(position, 1.0f));
+			return (unsigned int)(position * 65535.0f + 0.5f);
+		}
+};
+
+template <typename Item>
+void RadixSort::sort(std::vector<Item> *items, std::vector<Item> *scratch)
+{
+	const unsigned int byteCount = sizeof(static_cast<Item *>(NULL)->key);
+	unsigned int itemCount = (unsigned int)items->size();
+	if (itemCount < 2)
+		return;
+	
+	unsigned int counts[byteCount][256];
+	std::memset(counts, 0, sizeof(counts));
+	for (unsigned int i = 0; i < itemCount; i++)
+	{
+		unsigned long long key = (unsigned long long)(*items)[i].key;
+		for (unsigned int j = 0; j < byteCount; j++)
+			counts[j][(key >> (j * 8)) & 0xff]++;
+	}
+	
+	scratch->resize(itemCount);
+	Item *source = &(*items)[0];
+	Item *destination = &(*scratch)[0];
+	for (unsigned int j = 0; j < byteCount; j++)
+	{
+		// all keys share this byte
+		unsigned int shift = j * 8;
+		if (counts[j][((unsigned long long)source[0].key >> shift) & 0xff] == itemCount)
+			continue;
+		
+		unsigned int offsets[256];
+		unsigned int offset = 0;
+		for (unsigned int k = 0; k < 256; k++)
+		{
+			offsets[k] = offset;
+			offset += counts[j][k];
+		}
+		
+		for (unsigned int i = 0; i < itemCount; i++)
+			destination[offsets[((unsigned long long)source[i].key >> shift) & 0xff]++] = source[i];
+		
+		std::swap(source, destination);
+	}
+	
+	// after an odd number of passes, the sorted items are in the scratch vector
+	if (source != &(*items)[0])
+		items->swap(*scratch);
+}
+
+} // oak namespace
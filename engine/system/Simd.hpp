@@ -0,0 +1,272 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define OAK_SIMD_SSE2 1
+#	include <emmintrin.h>
+#else
+#	include <cmath>
+#endif
+
+namespace oak {
+
+/**
+ * Four floats processed at once.
+ */
+struct Float4
+{
+	#if defined(OAK_SIMD_SSE2)
+		__m128 value;
+	#else
+		float value[4];
+	#endif
+};
+
+/**
+ * Minimal set of 4-wide float operations, mapped to SSE2 intrinsics when
+ * available, and to plain loops on the other targets (ARM, MIPS, asm.js).
+ * Comparisons return masks, with all bits set in the lanes where they hold.
+ */
+class Simd
+{
+	public:
+		static inline Float4 set(float x)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_set1_ps(x) };
+				return result;
+			#else
+				Float4 result = { { x, x, x, x } };
+				return result;
+			#endif
+		}
+		
+		static inline Float4 set(float x, float y, float z, float w)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_setr_ps(x, y, z, w) };
+				return result;
+			#else
+				Float4 result = { { x, y, z, w } };
+				return result;
+			#endif
+		}
+		
+		// no alignment required
+		static inline Float4 load(const float *data)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_loadu_ps(data) };
+				return result;
+			#else
+				Float4 result = { { data[0], data[1], data[2], data[3] } };
+				return result;
+			#endif
+		}
+		
+		static inline void store(float *data, const Float4 &a)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				_mm_storeu_ps(data, a.value);
+			#else
+				for (int i = 0; i < 4; i++)
+					data[i] = a.value[i];
+			#endif
+		}
+		
+		static inline Float4 add(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_add_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = a.value[i] + b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 sub(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_sub_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = a.value[i] - b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 mul(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_mul_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = a.value[i] * b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 div(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_div_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = a.value[i] / b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 sqrt(const Float4 &a)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_sqrt_ps(a.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = std::sqrt(a.value[i]);
+			#endif
+			return result;
+		}
+		
+		static inline Float4 min(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_min_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = (a.value[i] < b.value[i]) ? a.value[i] : b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 max(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_max_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = (a.value[i] > b.value[i]) ? a.value[i] : b.value[i];
+			#endif
+			return result;
+		}
+		
+		static inline Float4 greaterEqual(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_cmpge_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = Simd::maskLane(a.value[i] >= b.value[i]);
+			#endif
+			return result;
+		}
+		
+		static inline Float4 less(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_cmplt_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = Simd::maskLane(a.value[i] < b.value[i]);
+			#endif
+			return result;
+		}
+		
+		// bitwise and, to combine masks
+		static inline Float4 bitAnd(const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_and_ps(a.value, b.value) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = Simd::maskLane(Simd::isLaneSet(a.value[i]) && Simd::isLaneSet(b.value[i]));
+			#endif
+			return result;
+		}
+		
+		// lanes of a where the mask is set, of b elsewhere
+		static inline Float4 select(const Float4 &mask, const Float4 &a, const Float4 &b)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				Float4 result = { _mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value)) };
+			#else
+				Float4 result;
+				for (int i = 0; i < 4; i++)
+					result.value[i] = Simd::isLaneSet(mask.value[i]) ? a.value[i] : b.value[i];
+			#endif
+			return result;
+		}
+		
+		// one bit per lane of a mask, the first lane in the lowest bit
+		static inline int getMask(const Float4 &mask)
+		{
+			#if defined(OAK_SIMD_SSE2)
+				return _mm_movemask_ps(mask.value);
+			#else
+				int result = 0;
+				for (int i = 0; i < 4; i++)
+					result |= (Simd::isLaneSet(mask.value[i]) ? 1 : 0) << i;
+				return result;
+			#endif
+		}
+	
+	#if !defined(OAK_SIMD_SSE2)
+	private:
+		union Lane
+		{
+			float f;
+			unsigned int bits;
+		};
+		
+		static inline float maskLane(bool set)
+		{
+			Lane lane;
+			lane.bits = set ? 0xffffffffu : 0u;
+			return lane.f;
+		}
+		
+		static inline bool isLaneSet(float value)
+		{
+			Lane lane;
+			lane.f = value;
+			return lane.bits != 0;
+		}
+	#endif
+};
+
+} // oak namespace
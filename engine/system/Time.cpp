@@ -32,14 +32,20 @@ namespace oak {
 unsigned long long Time::referenceTime = 0L;
 unsigned long long Time::lastFrameTime = 0L;
 double Time::elapsedTime = 0.0;
+double Time::fixedTimeStep = 0.0;
+double Time::fixedTime = 0.0;
 
 void Time::reset()
 {
 	Time::referenceTime = PrecisionTime::readNanoseconds();
+	Time::fixedTime = 0.0;
 }
 
 double Time::getTime()
 {
+	if (Time::fixedTimeStep > 0.0)
+		return Time::fixedTime;
+	
 	unsigned long long now = PrecisionTime::readNanoseconds();
 	unsigned long long applicationTime = now - Time::referenceTime;
 	
@@ -53,9 +59,21 @@ double Time::getElapsedTime()
 
 void Time::frameStart()
 {
+	if (Time::fixedTimeStep > 0.0)
+	{
+		Time::elapsedTime = Time::fixedTimeStep;
+		Time::fixedTime += Time::fixedTimeStep;
+		return;
+	}
+	
 	unsigned long long now = PrecisionTime::readNanoseconds();
 	Time::elapsedTime = (double)(now - Time::lastFrameTime) / 1000000000.0;
 	Time::lastFrameTime = now;
 }
 
+void Time::setFixedTimeStep(double step)
+{
+	Time::fixedTimeStep = step;
+}
+
 } // oak namespace
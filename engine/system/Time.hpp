@@ -42,6 +42,10 @@ class Time
 		// signal a frame boundary (used to compute elapsed time)
 		static void frameStart();
 		
+		// when positive, each frame advances application time by this exact step
+		// (in seconds) instead of following the clock, for reproducible runs
+		static void setFixedTimeStep(double step);
+	
 	private:
 		// time at which reset() was last called (nanoseconds)
 		static unsigned long long referenceTime;
@@ -51,6 +55,12 @@ class Time
 		
 		// time elapsed since the last frame (seconds)
 		static double elapsedTime;
+		
+		// fixed time step (seconds), 0 when following the clock
+		static double fixedTimeStep;
+		
+		// application time when using a fixed time step (seconds)
+		static double fixedTime;
 };
 
 } // oak namespace
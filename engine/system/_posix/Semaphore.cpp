@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/system/Semaphore.hpp>
+
+#include <errno.h>
+#include <semaphore.h>
+
+namespace oak {
+
+struct SemaphoreState
+{
+	sem_t semaphore;
+};
+
+Semaphore::Semaphore(unsigned int initialCount)
+{
+	this->state = new SemaphoreState;
+	sem_init(&this->state->semaphore, 0, initialCount);
+}
+
+Semaphore::~Semaphore()
+{
+	sem_destroy(&this->state->semaphore);
+	delete this->state;
+}
+
+void Semaphore::post()
+{
+	sem_post(&this->state->semaphore);
+}
+
+void Semaphore::wait()
+{
+	// retry if interrupted by a signal
+	while (sem_wait(&this->state->semaphore) != 0 && errno == EINTR)
+		;
+}
+
+bool Semaphore::tryWait()
+{
+	int result;
+	while ((result = sem_trywait(&this->state->semaphore)) != 0 && errno == EINTR)
+		;
+	return result == 0;
+}
+
+} // oak namespace
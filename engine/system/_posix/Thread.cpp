@@ -0,0 +1,82 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/system/Thread.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace oak {
+
+struct ThreadState
+{
+	pthread_t thread;
+	Thread::EntryPoint entryPoint;
+	void *userData;
+};
+
+namespace { // private section
+
+void *threadMain(void *userData)
+{
+	ThreadState *state = (ThreadState *)userData;
+	state->entryPoint(state->userData);
+	
+	return NULL;
+}
+
+} // end of private section
+
+Thread::Thread(EntryPoint entryPoint, void *userData)
+{
+	this->state = new ThreadState;
+	this->state->entryPoint = entryPoint;
+	this->state->userData = userData;
+	
+	int result = pthread_create(&this->state->thread, NULL, threadMain, this->state);
+	OAK_ASSERT(result == 0, "Failed to create thread (error %d)", result);
+}
+
+Thread::~Thread()
+{
+	pthread_join(this->state->thread, NULL);
+	delete this->state;
+}
+
+void Thread::yield()
+{
+	sched_yield();
+}
+
+unsigned int Thread::getProcessorCount()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (unsigned int)count : 1;
+}
+
+} // oak namespace
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *
+ * Oak game engine
+ * Copyright (c) 2013 Remi Papillie
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * 
+ *****************************************************************************/
+
+#include <engine/system/Thread.hpp>
+
+#include <engine/system/Log.hpp>
+
+#include <windows.h>
+
+namespace oak {
+
+struct ThreadState
+{
+	HANDLE thread;
+	Thread::EntryPoint entryPoint;
+	void *userData;
+};
+
+namespace { // private section
+
+DWORD WINAPI threadMain(LPVOID userData)
+{
+	ThreadState *state = (ThreadState *)userData;
+	state->entryPoint(state->userData);
+	
+	return 0;
+}
+
+} // end of private section
+
+Thread::Thread(EntryPoint entryPoint, void *userData)
+{
+	this->state = new ThreadState;
+	this->state->entryPoint = entryPoint;
+	this->state->userData = userData;
+	
+	this->state->thread = CreateThread(NULL, 0, threadMain, this->state, 0, NULL);
+	OAK_ASSERT(this->state->thread != NULL, "Failed to create thread (error %d)", (int)GetLastError());
+}
+
+Thread::~Thread()
+{
+	WaitForSingleObject(this->state->thread, INFINITE);
+	CloseHandle(this->state->thread);
+	delete this->state;
+}
+
+void Thread::yield()
+{
+	SwitchToThread();
+}
+
+unsigned int Thread::getProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (unsigned int)info.dwNumberOfProcessors : 1;
+}
+
+} // oak namespace
@@ -10,6 +10,12 @@ end
 
 function Game:start()
 	graphics.setBackgroundColor(0.6, 0.8, 0.9)
+
+	-- fog matching the sky, bright lights glowing, smoothed edges
+	local postProcess = graphics.getPostProcess()
+	PostProcess.setFogColor(postProcess, 0.6, 0.8, 0.9)
+	PostProcess.setBloomIntensity(postProcess, 0.6)
+	PostProcess.setAntialiasing(postProcess, true)
 	
 	self.world = sg.createWorld()
 	local scene = World.createScene(self.world)
@@ -20,15 +26,210 @@ function Game:start()
 	Entity.setLocalPosition(self.entity1, 0, 2, 0)
 	Entity.scale(self.entity1, 1.5, 1.5, 1.5)
 	self.cube = Entity.createComponent(self.entity1, "Cube")
+
+	-- turned by its animator, no script runs each frame for ambient motion
+	Animator.setSpin(Entity.createComponent(self.entity1, "Animator"), 0, 1, 0, 0.1)
+	
+	-- glass panes, blended over the opaque geometry from the farthest to the nearest
+	for i = 0, 2 do
+		local entity = Scene.createEntity(scene)
+		Entity.setLocalPosition(entity, 4 + i * 1.5, 1.5, 3 - i * 1.5)
+		Entity.scale(entity, 0.6, 1.5, 0.1)
+		local pane = Entity.createComponent(entity, "Cube")
+		Cube.setColor(pane, i == 0 and 0.8 or 0.1, i == 1 and 0.8 or 0.1, i == 2 and 0.8 or 0.1)
+		Cube.setOpacity(pane, 0.4)
+	end
+	
+	-- loaded in the background, cubes use a white texture until it is ready
+	local tileTexture = graphics.loadTexture("textures/tile.otex")
+	Cube.setTexture(self.cube, tileTexture)
 	
-	-- ground
-	self.cubes = {}
+	-- ground, never moves: merged in a few static batches
 	for x = -10, 5 do
 		for z = -10, 5 do
 			local entity = Scene.createEntity(scene)
-			Entity.createComponent(entity, "Cube")
+			Entity.setStatic(entity, true)
+			local cube = Entity.createComponent(entity, "Cube")
+			Cube.setTexture(cube, tileTexture)
 			Entity.setLocalPosition(entity, x * 3, -1.2, z * 3)
-			table.insert(self.cubes, entity)
+			Entity.rotate(entity, x * 3, -1.2, z * 3, 0.3)
+		end
+	end
+	
+	-- wall across the view, hiding the rocks behind it: its occluder is drawn in a
+	-- small depth buffer on the CPU, and the renderables it covers are culled
+	local wall = Scene.createEntity(scene)
+	Entity.setStatic(wall, true)
+	Cube.setTexture(Entity.createComponent(wall, "Cube"), tileTexture)
+	Entity.createComponent(wall, "Occluder")
+	Entity.setLocalPosition(wall, -16, 2.5, -16)
+	Entity.rotate(wall, 0, 1, 0, 0.785)
+	Entity.scale(wall, 14, 3, 0.5)
+	
+	graphics.buildStaticBatches(self.world)
+	
+	-- rocks reaching far along the view, drawn with coarser levels of detail as they get smaller
+	local rockMesh = graphics.loadMesh("meshes/rock.omesh")
+	for i = 0, 11 do
+		for j = 0, 7 do
+			local entity = Scene.createEntity(scene)
+			Entity.setStatic(entity, true)
+			local rock = Entity.createComponent(entity, "Mesh")
+			Mesh.setLodCrossFade(rock, true)
+			Mesh.setMesh(rock, rockMesh)
+			Mesh.setTexture(rock, tileTexture)
+			local distance = 20 + i * 12
+			local side = (j - 3.5) * (2 + i * 1.5)
+			Entity.setLocalPosition(entity, -distance * 0.7 + side * 0.7, 0, -distance * 0.7 - side * 0.7)
+			Entity.rotate(entity, 0, 1, 0, i * 1.7 + j * 2.3)
+			local size = 1.5 + (i * 7 + j * 3) % 5 * 0.4
+			Entity.scale(entity, size, size, size)
+		end
+	end
+	
+	-- white light next to the cube, and small colored ones wandering over the ground
+	local mainLight = Scene.createEntity(scene)
+	Entity.setLocalPosition(mainLight, 4, 2, 0)
+	local light = Entity.createComponent(mainLight, "Light")
+	Light.setIntensity(light, 10)
+	Light.setRadius(light, 40)
+	
+	-- slowly warming up and cooling down
+	local lightAnimator = Entity.createComponent(mainLight, "Animator")
+	Animator.setLight(lightAnimator, light)
+	Animator.addColorKey(lightAnimator, 0, 1, 1, 1)
+	Animator.addColorKey(lightAnimator, 3, 1, 0.8, 0.6)
+	Animator.addColorKey(lightAnimator, 6, 1, 1, 1)
+	
+	-- sun, shining down along the -Z axis of its entity and casting shadows
+	local sun = Scene.createEntity(scene)
+	Entity.rotate(sun, 0, 1, 0, 1.2)
+	Entity.rotate(sun, 1, 0, 0, -0.6)
+	local sunLight = Entity.createComponent(sun, "Light")
+	Light.setDirectional(sunLight, true)
+	Light.setColor(sunLight, 1, 0.9, 0.7)
+	Light.setIntensity(sunLight, 0.6)
+	
+	-- sprites from one atlas, batched by the view into a few draws: stars and leaves
+	-- floating over the ground, and a glow around each colored light
+	local atlas = require("textures.sprites")
+	local spriteTexture = graphics.loadTexture("textures/sprites.otex")
+	local function createSprite(entity, name)
+		local sprite = Entity.createComponent(entity, "Sprite")
+		local region = atlas.regions[name]
+		Sprite.setTexture(sprite, spriteTexture)
+		Sprite.setRegion(sprite, region[1], region[2], region[3], region[4])
+		Sprite.setBillboard(sprite, true)
+		return sprite
+	end
+	
+	for i = 1, 32 do
+		local entity = Scene.createEntity(scene)
+		local light = Entity.createComponent(entity, "Light")
+		Light.setColor(light, 0.5 + 0.5 * math.sin(i), 0.5 + 0.5 * math.sin(i * 2.1), 0.5 + 0.5 * math.sin(i * 3.7))
+		Light.setIntensity(light, 3)
+		Light.setRadius(light, 6)
+		
+		-- circling around the middle of the ground, at different distances
+		Entity.setLocalPosition(entity, -7, 0, -7)
+		local animator = Entity.createComponent(entity, "Animator")
+		Animator.setOrbit(animator, 0, 1, 0, 6 + (i % 4) * 4, 0.3)
+		Animator.setTime(animator, i * 2.3)
+		
+		local glow = createSprite(entity, "glow")
+		Sprite.setColor(glow, Light.getColor(light))
+		Sprite.setSize(glow, 2, 2)
+		Sprite.setAdditive(glow, true)
+		Sprite.setLayer(glow, 1)
+	end
+	
+	local names = { "star", "leaf", "ring", "spark" }
+	for x = 0, 15 do
+		for z = 0, 15 do
+			local entity = Scene.createEntity(scene)
+			Entity.setLocalPosition(entity, -28 + x * 2.5, 3 + math.sin(x * 0.7 + z * 1.3), -28 + z * 2.5)
+			local sprite = createSprite(entity, names[(x + z) % 4 + 1])
+			Sprite.setSize(sprite, 0.8, 0.8)
+			Sprite.setOpacity(sprite, 0.9)
+			
+			local animator = Entity.createComponent(entity, "Animator")
+			Animator.setBob(animator, 0, 0.3, 0, 0.2)
+			Animator.setTime(animator, x * 0.7 + z * 1.3)
+		end
+	end
+	
+	-- fountain of sparks next to the cube: particles are not entities, the view
+	-- draws thousands of them at once; clicking throws a burst
+	local fountain = Scene.createEntity(scene)
+	Entity.setLocalPosition(fountain, 2.5, 0.5, -1)
+	self.sparks = Entity.createComponent(fountain, "ParticleEmitter")
+	local spark = atlas.regions["spark"]
+	ParticleEmitter.setTexture(self.sparks, spriteTexture)
+	ParticleEmitter.setRegion(self.sparks, spark[1], spark[2], spark[3], spark[4])
+	ParticleEmitter.setRate(self.sparks, 300)
+	ParticleEmitter.setLifetime(self.sparks, 1.5, 2.5)
+	ParticleEmitter.setSpeed(self.sparks, 3, 5)
+	ParticleEmitter.setSpread(self.sparks, 0.3)
+	ParticleEmitter.setAcceleration(self.sparks, 0, -6, 0)
+	ParticleEmitter.setDrag(self.sparks, 0.2)
+	ParticleEmitter.setSize(self.sparks, 0.2, 0.05)
+	ParticleEmitter.setStartColor(self.sparks, 1, 0.8, 0.3, 1)
+	ParticleEmitter.setEndColor(self.sparks, 1, 0.2, 0.1, 0)
+	ParticleEmitter.setAdditive(self.sparks, true)
+	
+	-- hill of blocks drawn as a few meshes: faces between blocks are dropped, the
+	-- others merged in large quads; clicking digs a pit, remeshed in the background
+	local hill = Scene.createEntity(scene)
+	Entity.setStatic(hill, true)
+	Entity.setLocalPosition(hill, -80, -12, -44)
+	self.hill = Entity.createComponent(hill, "VoxelChunk")
+	VoxelChunk.setSize(self.hill, 48, 32, 48)
+	VoxelChunk.setTexture(self.hill, tileTexture)
+	for x = 0, 47 do
+		for z = 0, 47 do
+			local height = math.floor(10 + 6 * math.sin(x * 0.15) * math.cos(z * 0.12) + z * 0.2)
+			VoxelChunk.fill(self.hill, x, 0, z, x, height, z, 1)
+		end
+	end
+	
+	-- valley around the scene, rising into mountains: patches far from the camera
+	-- are drawn with fewer vertices, and whole ones are culled at once
+	local valley = Scene.createEntity(scene)
+	Entity.setStatic(valley, true)
+	Entity.setLocalPosition(valley, -256, -8, -256)
+	local terrain = Entity.createComponent(valley, "Terrain")
+	Terrain.setResolution(terrain, 257)
+	Terrain.setSpacing(terrain, 2)
+	Terrain.setTexture(terrain, tileTexture)
+	Terrain.setTextureScale(terrain, 4)
+	for x = 0, 256 do
+		for z = 0, 256 do
+			local wx = (x - 128) * 2
+			local wz = (z - 128) * 2
+			local distance = math.sqrt(wx * wx + wz * wz)
+			local height = 2 * math.sin(wx * 0.05) * math.cos(wz * 0.04)
+			height = height + math.max(distance - 90, 0) * 0.25 * (1 + 0.5 * math.sin(wx * 0.02 + wz * 0.03))
+			Terrain.setHeight(terrain, x, z, height)
+		end
+	end
+	
+	-- worms posed by two blended clips: their skeletons are animated by jobs,
+	-- and skinned by the vertex shader
+	local wormMesh = graphics.loadSkinnedMesh("meshes/worm.oskin")
+	local sway = graphics.loadAnimation("meshes/worm-sway.oanim")
+	local twist = graphics.loadAnimation("meshes/worm-twist.oanim")
+	for i = 0, 3 do
+		for j = 0, 3 do
+			local entity = Scene.createEntity(scene)
+			Entity.setLocalPosition(entity, -10 + i * 2.5, -0.5, 2 - j * 2.5)
+			local worm = Entity.createComponent(entity, "SkinnedMesh")
+			SkinnedMesh.setMesh(worm, wormMesh)
+			SkinnedMesh.setTexture(worm, tileTexture)
+			SkinnedMesh.setAnimation(worm, 0, sway)
+			SkinnedMesh.setAnimation(worm, 1, twist)
+			SkinnedMesh.setLayerWeight(worm, 1, i / 3)
+			SkinnedMesh.setLayerTime(worm, 0, j * 0.4)
+			SkinnedMesh.setLayerSpeed(worm, 1, 0.8 + j * 0.2)
 		end
 	end
 	
@@ -41,33 +242,78 @@ function Game:start()
 	
 	self.view = graphics.createView(self.world)
 	View.setCamera(self.view, cameraComponent)
+	
+	-- text over the view, in pixels from its top-left corner: layouts are cached by
+	-- string, so the clock only gets laid out again when its seconds change
+	local title = Scene.createEntity(scene)
+	Entity.setLocalPosition(title, 16, 16, 0)
+	local titleText = Entity.createComponent(title, "Text")
+	Text.setText(titleText, "Oak - hello sample")
+	Text.setSize(titleText, 24)
+	local clock = Scene.createEntity(scene)
+	Entity.setLocalPosition(clock, 16, 16 + Text.getHeight(titleText) + 8, 0)
+	self.clockText = Entity.createComponent(clock, "Text")
+	Text.setColor(self.clockText, 1, 0.9, 0.5)
+	
+	-- small world drawn into a texture before the main view, and shown on the first cube
+	self.screenWorld = sg.createWorld()
+	local screenScene = World.createScene(self.screenWorld)
+	self.screenCube = Scene.createEntity(screenScene)
+	Entity.createComponent(self.screenCube, "Cube")
+	Animator.setSpin(Entity.createComponent(self.screenCube, "Animator"), 1, 1, 0, 1)
+	local screenLight = Scene.createEntity(screenScene)
+	Entity.setLocalPosition(screenLight, 2, 3, 4)
+	local light = Entity.createComponent(screenLight, "Light")
+	Light.setColor(light, 1, 0.5, 0.2)
+	Light.setIntensity(light, 8)
+	Light.setRadius(light, 12)
+	local screenCamera = Scene.createEntity(screenScene)
+	Entity.setLocalPosition(screenCamera, 0, 0, 5)
+	local screenCameraComponent = Entity.createComponent(screenCamera, "Camera")
+	Camera.setAspect(screenCameraComponent, 1)
+	
+	self.screenView = graphics.createView(self.screenWorld)
+	View.setCamera(self.screenView, screenCameraComponent)
+	View.setPriority(self.screenView, -1)
+	View.setTargetSize(self.screenView, 256, 256)
+	Cube.setTexture(self.cube, View.getTargetTexture(self.screenView))
 end
 
 function Game:update(dt)
 	local time = system.getTime()
-	Entity.rotate(self.entity1, 0, 1, 0, dt * 0.1)
+	
 	--Entity.setLocalPosition(self.entity1, math.sin(time * 0.5) * 3.0, math.sin(time), -60)
 	
 	Entity.setLocalOrientation(self.camera, 1, 0, 0, 0)
 	Entity.rotate(self.camera, 1, 0, 0, self.cameraAngleY)
 	Entity.rotate(self.camera, 0, 1, 0, self.cameraAngleX)
 	
-	for i = 1, #self.cubes do
-		local entity = self.cubes[i]
-		local x, y, z = Entity.getLocalPosition(entity)
-		Entity.rotate(entity, x, y, z, dt * 0.2)
-	end
+	-- axes of the world, drawn again each frame (only in debug builds)
+	local debugDraw = graphics.getDebugDraw(self.world)
+	DebugDraw.drawLine(debugDraw, 0, 0, 0, 8, 0, 0, 1, 0, 0)
+	DebugDraw.drawLine(debugDraw, 0, 0, 0, 0, 8, 0, 0, 1, 0)
+	DebugDraw.drawLine(debugDraw, 0, 0, 0, 0, 0, 8, 0, 0, 1)
+	DebugDraw.drawLabel(debugDraw, 0, 8.5, 0, "y", 0, 1, 0)
+	
+	Text.setText(self.clockText, string.format("Running for %d s", math.floor(time)))
 end
 
 function Game:stop()
 	graphics.destroyView(self.view)
+	graphics.destroyView(self.screenView)
 	
 	-- will destroy every referenced scene and entity recursively
 	sg.destroyWorld(self.world)
+	sg.destroyWorld(self.screenWorld)
 end
 
 function Game:pointerDown(pointerId, button, x, y)
 	self.dragging = true
+	ParticleEmitter.burst(self.sparks, 2000)
+	
+	local x = math.random(4, 43)
+	local z = math.random(4, 43)
+	VoxelChunk.fill(self.hill, x - 3, 8, z - 3, x + 3, 31, z + 3, 0)
 end
 
 function Game:pointerUp(pointerId, button, x, y)
@@ -81,12 +327,6 @@ function Game:pointerMove(pointerId, x, y, dx, dy)
 		Entity.rotate(self.entity1, 0, 1, 0, dx * 0.004)
 		Entity.rotate(self.entity1, 1, 0, -1, dy * 0.004)
 		
-		for i = 1, #self.cubes do
-			local entity = self.cubes[i]
-			Entity.rotate(entity, 0, 1, 0, dx * 0.004)
-			Entity.rotate(entity, 1, 0, -1, dy * 0.004)
-		end
-		
 		self.cameraAngleX = self.cameraAngleX + dx * 0.002
 		self.cameraAngleY = self.cameraAngleY + dy * 0.002
 	end
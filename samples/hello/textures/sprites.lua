@@ -0,0 +1,13 @@
+-- generated by pack-atlas.py from 5 images
+-- regions: left, top, right, bottom texture coordinates, then width and height in pixels
+return {
+	width = 128,
+	height = 64,
+	regions = {
+		["glow"] = { 0.015625, 0.03125, 0.265625, 0.53125, 32, 32 },
+		["leaf"] = { 0.578125, 0.03125, 0.734375, 0.46875, 20, 28 },
+		["ring"] = { 0.015625, 0.59375, 0.203125, 0.96875, 24, 24 },
+		["spark"] = { 0.234375, 0.59375, 0.359375, 0.84375, 16, 16 },
+		["star"] = { 0.296875, 0.03125, 0.546875, 0.53125, 32, 32 },
+	},
+}
@@ -0,0 +1,468 @@
+#!/usr/bin/python
+
+import os
+import sys
+import argparse
+import base64
+import json
+import math
+import struct
+
+# The cooked skinned mesh (.oskin) and animation clip (.oanim) files read by
+# the engine animation manager. Integers are little-endian 32-bit, floats
+# little-endian 32-bit, keys little-endian 16-bit:
+#
+#   "OSKN", version, boneCount, vertexCount
+#   bounding sphere: center x, y, z, radius (floats)
+#   for each bone, parents first:
+#     parent index (-1 for the roots)
+#     rest translation x, y, z, rotation x, y, z, w, scale x, y, z (floats)
+#     first three rows of the inverse bind matrix (floats)
+#   vertices, as a triangle list:
+#     position x, y, z, normal x, y, z, uv u, v (floats)
+#     4 bone indices and 4 weights summing to 255 (bytes)
+#
+#   "OANM", version, boneCount, frameCount, frameRate (float)
+#   for each bone, a rotation, a translation and a scale track:
+#     keyCount, then the frame of each key (16-bit), padded to 4 bytes
+#     rotations: x, y, z, w of each key as signed values over 32767 (16-bit)
+#     translations and scales: minimum x, y, z and extent x, y, z (floats),
+#     then x, y, z of each key over 65535 (16-bit), padded to 4 bytes
+#
+# Tracks only keep the keys needed to interpolate the others linearly within
+# the tolerance; the first and the last frames are always kept.
+
+ANIMATION_VERSION = 1
+
+###############################################################################
+# glTF 2.0 loading
+
+COMPONENT_FORMATS = { 5120: "b", 5121: "B", 5122: "h", 5123: "H", 5125: "I", 5126: "f" }
+COMPONENT_COUNTS = { "SCALAR": 1, "VEC2": 2, "VEC3": 3, "VEC4": 4, "MAT4": 16 }
+
+def loadGLTF(path):
+    data = open(path, "rb").read()
+    buffers = []
+
+    # binary container: a JSON chunk, then the first buffer
+    if data[0:4] == b"glTF":
+        (jsonLength,) = struct.unpack_from("<I", data, 12)
+        document = json.loads(data[20:20 + jsonLength].decode("utf-8"))
+        offset = 20 + jsonLength
+        if offset + 8 <= len(data):
+            (binaryLength,) = struct.unpack_from("<I", data, offset)
+            buffers.append(data[offset + 8:offset + 8 + binaryLength])
+    else:
+        document = json.loads(data.decode("utf-8"))
+
+    for (i, buffer) in enumerate(document.get("buffers", [])):
+        uri = buffer.get("uri")
+        if uri is None:
+            continue
+        if uri.startswith("data:"):
+            content = base64.b64decode(uri.split(",", 1)[1])
+        else:
+            content = open(os.path.join(os.path.dirname(path), uri), "rb").read()
+        if i < len(buffers):
+            buffers[i] = content
+        else:
+            buffers.append(content)
+
+    return (document, buffers)
+
+# elements of an accessor, as lists of numbers (normalized integers as floats)
+def readAccessor(document, buffers, index):
+    accessor = document["accessors"][index]
+    componentFormat = COMPONENT_FORMATS[accessor["componentType"]]
+    componentCount = COMPONENT_COUNTS[accessor["type"]]
+    count = accessor["count"]
+    if "bufferView" not in accessor:
+        return [[0] * componentCount for i in range(count)]
+
+    view = document["bufferViews"][accessor["bufferView"]]
+    buffer = buffers[view.get("buffer", 0)]
+    elementSize = struct.calcsize("<" + componentFormat * componentCount)
+    stride = view.get("byteStride", elementSize)
+    offset = view.get("byteOffset", 0) + accessor.get("byteOffset", 0)
+
+    scale = None
+    if accessor.get("normalized", False):
+        scale = { "b": 127.0, "B": 255.0, "h": 32767.0, "H": 65535.0 }[componentFormat]
+
+    elements = []
+    for i in range(count):
+        values = list(struct.unpack_from("<" + componentFormat * componentCount, buffer, offset + i * stride))
+        if scale is not None:
+            values = [max(v / scale, -1.0) for v in values]
+        elements.append(values)
+    return elements
+
+###############################################################################
+# transforms, as translation, rotation quaternion (x, y, z, w) and scale,
+# and 4x4 matrices as lists of columns
+
+def quatMultiply(a, b):
+    return [a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+        a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0],
+        a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3],
+        a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2]]
+
+def quatNormalize(q):
+    length = math.sqrt(sum(x * x for x in q))
+    return [x / length for x in q] if length > 0.0 else [0.0, 0.0, 0.0, 1.0]
+
+def quatDot(a, b):
+    return sum(a[i] * b[i] for i in range(4))
+
+def composeMatrix(translation, rotation, scale):
+    (x, y, z, w) = rotation
+    columns = [[1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)],
+        [2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)],
+        [2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)]]
+    return [[c * scale[i] for c in columns[i]] + [0.0] for i in range(3)] + [list(translation) + [1.0]]
+
+def multiplyMatrices(a, b):
+    return [[sum(a[k][row] * b[column][k] for k in range(4)) for row in range(4)] for column in range(4)]
+
+def transformPoint(m, p):
+    return [m[0][i] * p[0] + m[1][i] * p[1] + m[2][i] * p[2] + m[3][i] for i in range(3)]
+
+def transformVector(m, v):
+    return [m[0][i] * v[0] + m[1][i] * v[1] + m[2][i] * v[2] for i in range(3)]
+
+# without shear
+def decomposeMatrix(m):
+    translation = m[3][0:3]
+    scale = [math.sqrt(sum(x * x for x in m[i][0:3])) for i in range(3)]
+    r = [[m[i][j] / scale[i] if scale[i] > 0.0 else 0.0 for j in range(3)] for i in range(3)]
+
+    # rotation matrix to quaternion, r[column][row]
+    trace = r[0][0] + r[1][1] + r[2][2]
+    if trace > 0.0:
+        s = math.sqrt(trace + 1.0) * 2.0
+        rotation = [(r[1][2] - r[2][1]) / s, (r[2][0] - r[0][2]) / s, (r[0][1] - r[1][0]) / s, 0.25 * s]
+    elif r[0][0] > r[1][1] and r[0][0] > r[2][2]:
+        s = math.sqrt(1.0 + r[0][0] - r[1][1] - r[2][2]) * 2.0
+        rotation = [0.25 * s, (r[1][0] + r[0][1]) / s, (r[2][0] + r[0][2]) / s, (r[1][2] - r[2][1]) / s]
+    elif r[1][1] > r[2][2]:
+        s = math.sqrt(1.0 + r[1][1] - r[0][0] - r[2][2]) * 2.0
+        rotation = [(r[1][0] + r[0][1]) / s, 0.25 * s, (r[2][1] + r[1][2]) / s, (r[2][0] - r[0][2]) / s]
+    else:
+        s = math.sqrt(1.0 + r[2][2] - r[0][0] - r[1][1]) * 2.0
+        rotation = [(r[2][0] + r[0][2]) / s, (r[2][1] + r[1][2]) / s, 0.25 * s, (r[0][1] - r[1][0]) / s]
+    return (translation, quatNormalize(rotation), scale)
+
+def nodeTransform(node):
+    if "matrix" in node:
+        m = node["matrix"]
+        return decomposeMatrix([m[0:4], m[4:8], m[8:12], m[12:16]])
+    return (node.get("translation", [0.0, 0.0, 0.0]), node.get("rotation", [0.0, 0.0, 0.0, 1.0]), node.get("scale", [1.0, 1.0, 1.0]))
+
+###############################################################################
+# skeleton and mesh
+
+class Skeleton:
+    def __init__(self, document, buffers):
+        skin = document["skins"][0]
+        nodes = document["nodes"]
+        joints = skin["joints"]
+
+        nodeParents = {}
+        for (i, node) in enumerate(nodes):
+            for child in node.get("children", []):
+                nodeParents[child] = i
+
+        # the nearest ancestor that is a joint, the others are baked in the roots
+        def jointParent(node):
+            parent = nodeParents.get(node)
+            while parent is not None and parent not in joints:
+                parent = nodeParents.get(parent)
+            return parent
+
+        def depth(node):
+            parent = jointParent(node)
+            return 0 if parent is None else depth(parent) + 1
+
+        # parents before their children
+        self.nodes = sorted(joints, key = depth)
+        self.boneOfNode = dict((node, i) for (i, node) in enumerate(self.nodes))
+        self.boneOfJoint = [self.boneOfNode[node] for node in joints]
+        self.parents = [self.boneOfNode[jointParent(node)] if jointParent(node) is not None else -1 for node in self.nodes]
+
+        # transform of the non-joint ancestors of each root
+        self.rootTransforms = []
+        for node in self.nodes:
+            m = composeMatrix([0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 1.0], [1.0, 1.0, 1.0])
+            parent = nodeParents.get(node)
+            while parent is not None and parent not in joints:
+                m = multiplyMatrices(composeMatrix(*nodeTransform(nodes[parent])), m)
+                parent = nodeParents.get(parent)
+            self.rootTransforms.append(m)
+
+        self.rest = [nodeTransform(nodes[node]) for node in self.nodes]
+
+        identity = composeMatrix([0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 1.0], [1.0, 1.0, 1.0])
+        inverseBinds = [identity] * len(joints)
+        if "inverseBindMatrices" in skin:
+            inverseBinds = [[m[0:4], m[4:8], m[8:12], m[12:16]] for m in readAccessor(document, buffers, skin["inverseBindMatrices"])]
+        self.inverseBinds = [None] * len(joints)
+        for (joint, bone) in enumerate(self.boneOfJoint):
+            self.inverseBinds[bone] = inverseBinds[joint]
+
+    # local transforms of a pose, with the ancestors baked in the roots
+    def localTransforms(self, pose):
+        transforms = []
+        for (bone, (translation, rotation, scale)) in enumerate(pose):
+            if self.parents[bone] < 0:
+                (translation, rotation, scale) = decomposeMatrix(multiplyMatrices(self.rootTransforms[bone], composeMatrix(translation, rotation, scale)))
+            transforms.append((list(translation), list(rotation), list(scale)))
+        return transforms
+
+    def skinningMatrices(self, localTransforms):
+        models = []
+        for (bone, transform) in enumerate(localTransforms):
+            local = composeMatrix(*transform)
+            parent = self.parents[bone]
+            models.append(local if parent < 0 else multiplyMatrices(models[parent], local))
+        return [multiplyMatrices(models[i], self.inverseBinds[i]) for i in range(len(models))]
+
+def loadSkinnedVertices(document, buffers, skeleton):
+    nodes = document["nodes"]
+    meshNode = [node for node in nodes if node.get("skin") == 0 and "mesh" in node]
+    if not meshNode:
+        sys.exit("No mesh uses the first skin")
+
+    vertices = []
+    for primitive in document["meshes"][meshNode[0]["mesh"]]["primitives"]:
+        if primitive.get("mode", 4) != 4:
+            continue
+
+        attributes = primitive["attributes"]
+        positions = readAccessor(document, buffers, attributes["POSITION"])
+        count = len(positions)
+        normals = readAccessor(document, buffers, attributes["NORMAL"]) if "NORMAL" in attributes else [[0.0, 1.0, 0.0]] * count
+        uvs = readAccessor(document, buffers, attributes["TEXCOORD_0"]) if "TEXCOORD_0" in attributes else [[0.0, 0.0]] * count
+        joints = readAccessor(document, buffers, attributes["JOINTS_0"])
+        weights = readAccessor(document, buffers, attributes["WEIGHTS_0"])
+        indices = [i[0] for i in readAccessor(document, buffers, primitive["indices"])] if "indices" in primitive else range(count)
+
+        for i in indices:
+            bones = [skeleton.boneOfJoint[j] for j in joints[i]]
+            vertices.append((positions[i], normals[i], uvs[i], bones, quantizeWeights(weights[i])))
+
+    return vertices
+
+# bytes summing to 255, the rounding error going to the largest weight
+def quantizeWeights(weights):
+    total = sum(weights)
+    weights = [w / total for w in weights] if total > 0.0 else [1.0, 0.0, 0.0, 0.0]
+    quantized = [int(round(w * 255.0)) for w in weights]
+    largest = weights.index(max(weights))
+    quantized[largest] += 255 - sum(quantized)
+    return quantized
+
+###############################################################################
+# animations, sampled at a constant rate
+
+def sampleChannel(times, values, interpolation, time):
+    # cubic splines store in-tangent, value, out-tangent: only the values are used
+    if interpolation == "CUBICSPLINE":
+        values = values[1::3]
+
+    if time <= times[0]:
+        return values[0]
+    if time >= times[-1]:
+        return values[-1]
+
+    key = 0
+    while times[key + 1] < time:
+        key += 1
+    if interpolation == "STEP":
+        return values[key]
+
+    t = (time - times[key]) / (times[key + 1] - times[key])
+    (a, b) = (values[key], values[key + 1])
+    if len(a) == 4:
+        if quatDot(a, b) < 0.0:
+            b = [-x for x in b]
+        return quatNormalize([a[i] + (b[i] - a[i]) * t for i in range(4)])
+    return [a[i] + (b[i] - a[i]) * t for i in range(len(a))]
+
+def sampleAnimation(document, buffers, animation, skeleton, frameRate):
+    channels = {}
+    duration = 0.0
+    for channel in animation["channels"]:
+        target = channel["target"]
+        if target.get("node") not in skeleton.boneOfNode or target["path"] not in ("translation", "rotation", "scale"):
+            continue
+        sampler = animation["samplers"][channel["sampler"]]
+        times = [t[0] for t in readAccessor(document, buffers, sampler["input"])]
+        values = readAccessor(document, buffers, sampler["output"])
+        channels[(skeleton.boneOfNode[target["node"]], target["path"])] = (times, values, sampler.get("interpolation", "LINEAR"))
+        duration = max(duration, times[-1])
+
+    frameCount = int(math.floor(duration * frameRate + 0.5)) + 1
+    frames = []
+    for frame in range(frameCount):
+        time = min(frame / frameRate, duration)
+        pose = []
+        for bone in range(len(skeleton.nodes)):
+            transform = list(skeleton.rest[bone])
+            for (i, path) in enumerate(("translation", "rotation", "scale")):
+                if (bone, path) in channels:
+                    transform[i] = sampleChannel(channels[(bone, path)][0], channels[(bone, path)][1], channels[(bone, path)][2], time)
+            pose.append(transform)
+        frames.append(skeleton.localTransforms(pose))
+
+    # consecutive rotations in the same hemisphere, so that keys interpolate the short way
+    for bone in range(len(skeleton.nodes)):
+        for frame in range(1, frameCount):
+            (previous, current) = (frames[frame - 1][bone][1], frames[frame][bone][1])
+            if quatDot(previous, current) < 0.0:
+                frames[frame][bone] = (frames[frame][bone][0], [-x for x in current], frames[frame][bone][2])
+
+    return frames
+
+###############################################################################
+# keyframe reduction and quantization
+
+# Greedy: from each kept key, reach as far as the frames in between stay within
+# the tolerance of the linear interpolation.
+def reduceKeys(values, tolerance):
+    keys = [0]
+    while keys[-1] < len(values) - 1:
+        start = keys[-1]
+        end = start + 1
+        while end + 1 < len(values) and fitsLinear(values, start, end + 1, tolerance):
+            end += 1
+        keys.append(end)
+    return keys
+
+def fitsLinear(values, start, end, tolerance):
+    for frame in range(start + 1, end):
+        t = float(frame - start) / (end - start)
+        for i in range(len(values[frame])):
+            if abs(values[start][i] + (values[end][i] - values[start][i]) * t - values[frame][i]) > tolerance:
+                return False
+    return True
+
+def packFrames(keys):
+    data = bytearray(struct.pack("<I", len(keys)))
+    data += struct.pack("<%dH" % len(keys), *keys)
+    return data + b"\0" * (len(data) % 4)
+
+def packRotations(values, keys):
+    data = packFrames(keys)
+    for key in keys:
+        data += struct.pack("<4h", *[max(-32767, min(32767, int(round(x * 32767.0)))) for x in values[key]])
+    return data
+
+def packVectors(values, keys):
+    data = packFrames(keys)
+    low = [min(values[key][i] for key in keys) for i in range(3)]
+    extent = [max(values[key][i] for key in keys) - low[i] for i in range(3)]
+    data += struct.pack("<6f", *(low + extent))
+
+    quantized = []
+    for key in keys:
+        quantized += [int(round((values[key][i] - low[i]) / extent[i] * 65535.0)) if extent[i] > 0.0 else 0 for i in range(3)]
+    data += struct.pack("<%dH" % len(quantized), *quantized)
+    return data + b"\0" * (len(data) % 4)
+
+###############################################################################
+
+def boundingSphere(positions):
+    # center of the bounding box, good enough for culling
+    low = [min(p[i] for p in positions) for i in range(3)]
+    high = [max(p[i] for p in positions) for i in range(3)]
+    center = [(low[i] + high[i]) * 0.5 for i in range(3)]
+    radius = max(math.sqrt(sum((p[i] - center[i]) ** 2 for i in range(3))) for p in positions)
+    return (center, radius)
+
+def skinPositions(vertices, matrices):
+    positions = []
+    for (position, normal, uv, bones, weights) in vertices:
+        skinned = [0.0, 0.0, 0.0]
+        for k in range(4):
+            if weights[k] > 0:
+                p = transformPoint(matrices[bones[k]], position)
+                skinned = [skinned[i] + p[i] * weights[k] / 255.0 for i in range(3)]
+        positions.append(skinned)
+    return positions
+
+# command line arguments
+parser = argparse.ArgumentParser(description = "Cook a skinned glTF 2.0 model into an Oak skinned mesh (.oskin) and animation clips (.oanim)")
+parser.add_argument("input", help = "source model (.gltf or .glb), with a skin and its animations")
+parser.add_argument("output", help = "prefix of the cooked files: <output>.oskin, then <output>-<animation>.oanim")
+parser.add_argument("--frame-rate", type = float, default = 30.0, help = "frames sampled per second (defaults to 30)")
+parser.add_argument("--tolerance", type = float, default = 0.001, help = "error tolerated when dropping keys, in units and quaternion components (defaults to 0.001)")
+
+args = parser.parse_args()
+
+if args.frame_rate <= 0.0:
+    sys.exit("Expected a positive frame rate")
+
+(document, buffers) = loadGLTF(args.input)
+if not document.get("skins"):
+    sys.exit("No skin in '%s'" % args.input)
+
+skeleton = Skeleton(document, buffers)
+boneCount = len(skeleton.nodes)
+if boneCount > 256:
+    sys.exit("At most 256 bones can be addressed, found %d" % boneCount)
+
+vertices = loadSkinnedVertices(document, buffers, skeleton)
+print("skeleton: %d bones, mesh: %d triangles" % (boneCount, len(vertices) // 3))
+
+# the bounding sphere covers the rest pose and all the sampled frames
+restTransforms = skeleton.localTransforms(skeleton.rest)
+clips = []
+positions = skinPositions(vertices, skeleton.skinningMatrices(restTransforms))
+for (i, animation) in enumerate(document.get("animations", [])):
+    name = animation.get("name", "animation%d" % i)
+    frames = sampleAnimation(document, buffers, animation, skeleton, args.frame_rate)
+    clips.append((name, frames))
+    for frame in frames:
+        positions += skinPositions(vertices, skeleton.skinningMatrices(frame))
+(center, radius) = boundingSphere(positions)
+
+output = bytearray(b"OSKN")
+output += struct.pack("<III", ANIMATION_VERSION, boneCount, len(vertices))
+output += struct.pack("<4f", center[0], center[1], center[2], radius)
+for bone in range(boneCount):
+    (translation, rotation, scale) = restTransforms[bone]
+    m = skeleton.inverseBinds[bone]
+    output += struct.pack("<i", skeleton.parents[bone])
+    output += struct.pack("<10f", *(list(translation) + list(rotation) + list(scale)))
+    output += struct.pack("<12f", *[m[column][row] for row in range(3) for column in range(4)])
+for (position, normal, uv, bones, weights) in vertices:
+    output += struct.pack("<8f", *(list(position) + list(normal) + list(uv)))
+    output += struct.pack("<4B4B", *(bones + weights))
+
+file = open(args.output + ".oskin", "wb")
+file.write(output)
+file.close()
+
+for (name, frames) in clips:
+    output = bytearray(b"OANM")
+    output += struct.pack("<IIIf", ANIMATION_VERSION, boneCount, len(frames), args.frame_rate)
+
+    keyCount = 0
+    for bone in range(boneCount):
+        rotations = [frame[bone][1] for frame in frames]
+        translations = [frame[bone][0] for frame in frames]
+        scales = [frame[bone][2] for frame in frames]
+
+        rotationKeys = reduceKeys(rotations, args.tolerance)
+        translationKeys = reduceKeys(translations, args.tolerance)
+        scaleKeys = reduceKeys(scales, args.tolerance)
+        keyCount += len(rotationKeys) + len(translationKeys) + len(scaleKeys)
+
+        output += packRotations(rotations, rotationKeys)
+        output += packVectors(translations, translationKeys)
+        output += packVectors(scales, scaleKeys)
+
+    file = open("%s-%s.oanim" % (args.output, name), "wb")
+    file.write(output)
+    file.close()
+    print("%s: %d frames, %d keys kept out of %d" % (name, len(frames), keyCount, len(frames) * boneCount * 3))
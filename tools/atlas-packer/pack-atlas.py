@@ -0,0 +1,314 @@
+#!/usr/bin/python
+
+import os
+import sys
+import argparse
+import struct
+import zlib
+
+# Packs images into a texture atlas for the engine sprites, and writes the
+# region of each image as a Lua table, to be loaded with require():
+#
+#   return {
+#       width = <atlas width>, height = <atlas height>,
+#       regions = {
+#           ["<image name>"] = { left, top, right, bottom, width, height },
+#       },
+#   }
+#
+# Texture coordinates are in [0, 1], from the top left corner of the atlas,
+# as expected by Sprite.setRegion; widths and heights are in pixels. The atlas
+# is written as a PNG file, to be cooked like any other texture.
+#
+# Images are placed with the max-rects algorithm (best short side fit), and
+# surrounded by a padding filled with their border pixels, so that filtering
+# and the smaller mipmap levels do not bleed between neighbours. The atlas
+# size is a power of two, as needed by mipmapped textures on GLES2.
+
+###############################################################################
+# image loading (8-bit PNG and binary PPM), as rows of [r, g, b, a] lists
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+def loadPNG(path, data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit(path + " is not a PNG file")
+
+    offset = 8
+    idat = b""
+    palette = None
+    transparency = None
+    while offset < len(data):
+        (length,) = struct.unpack(">I", data[offset:offset + 4])
+        chunkType = data[offset + 4:offset + 8]
+        chunk = data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+
+        if chunkType == b"IHDR":
+            (width, height, depth, colorType, compression, filterMethod, interlace) = struct.unpack(">IIBBBBB", chunk)
+        elif chunkType == b"PLTE":
+            palette = bytearray(chunk)
+        elif chunkType == b"tRNS":
+            transparency = bytearray(chunk)
+        elif chunkType == b"IDAT":
+            idat += chunk
+        elif chunkType == b"IEND":
+            break
+
+    if depth != 8 or interlace != 0:
+        sys.exit(path + ": only 8-bit non-interlaced PNG files are supported")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colorType]
+    stride = width * channels
+    raw = bytearray(zlib.decompress(idat))
+
+    # undo the per-row filters
+    previous = bytearray(stride)
+    rows = []
+    for y in range(height):
+        filterType = raw[y * (stride + 1)]
+        row = raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)]
+        for i in range(stride):
+            left = row[i - channels] if i >= channels else 0
+            up = previous[i]
+            upLeft = previous[i - channels] if i >= channels else 0
+            if filterType == 1:
+                row[i] = (row[i] + left) & 0xff
+            elif filterType == 2:
+                row[i] = (row[i] + up) & 0xff
+            elif filterType == 3:
+                row[i] = (row[i] + ((left + up) >> 1)) & 0xff
+            elif filterType == 4:
+                row[i] = (row[i] + paeth(left, up, upLeft)) & 0xff
+        previous = row
+
+        pixels = []
+        for x in range(width):
+            p = row[x * channels:(x + 1) * channels]
+            if colorType == 0:
+                pixels.append([p[0], p[0], p[0], 255])
+            elif colorType == 2:
+                pixels.append([p[0], p[1], p[2], 255])
+            elif colorType == 3:
+                alpha = transparency[p[0]] if transparency and p[0] < len(transparency) else 255
+                pixels.append([palette[3 * p[0]], palette[3 * p[0] + 1], palette[3 * p[0] + 2], alpha])
+            elif colorType == 4:
+                pixels.append([p[0], p[0], p[0], p[1]])
+            else:
+                pixels.append([p[0], p[1], p[2], p[3]])
+        rows.append(pixels)
+
+    return rows
+
+def loadPPM(path, data):
+    # header: magic, width, height, max value, separated by whitespace
+    fields = []
+    offset = 0
+    while len(fields) < 4:
+        while data[offset:offset + 1].isspace():
+            offset += 1
+        start = offset
+        while not data[offset:offset + 1].isspace():
+            offset += 1
+        fields.append(data[start:offset])
+    offset += 1
+
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        sys.exit(path + ": only binary 8-bit PPM files are supported")
+
+    width = int(fields[1])
+    height = int(fields[2])
+    pixels = bytearray(data[offset:offset + width * height * 3])
+
+    return [[[pixels[(y * width + x) * 3 + c] for c in range(3)] + [255] for x in range(width)] for y in range(height)]
+
+def loadImage(path):
+    file = open(path, "rb")
+    data = file.read()
+    file.close()
+
+    if data[:2] == b"P6":
+        return loadPPM(path, data)
+    return loadPNG(path, data)
+
+def savePNG(path, image):
+    height = len(image)
+    width = len(image[0])
+
+    # unfiltered RGBA rows
+    raw = bytearray()
+    for row in image:
+        raw.append(0)
+        for pixel in row:
+            raw.extend(pixel)
+
+    def chunk(chunkType, data):
+        return struct.pack(">I", len(data)) + chunkType + data + struct.pack(">I", zlib.crc32(chunkType + data) & 0xffffffff)
+
+    output = b"\x89PNG\r\n\x1a\n"
+    output += chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 6, 0, 0, 0))
+    output += chunk(b"IDAT", zlib.compress(bytes(raw), 9))
+    output += chunk(b"IEND", b"")
+
+    file = open(path, "wb")
+    file.write(output)
+    file.close()
+
+###############################################################################
+# max-rects packing
+#
+# The free space is kept as a list of maximal free rectangles, which may
+# overlap. Each rectangle is placed in the free one leaving the shortest
+# side, then every free rectangle it cuts is split in up to four new ones,
+# and those contained in others are dropped.
+
+class MaxRects:
+    def __init__(self, width, height):
+        self.freeRects = [(0, 0, width, height)]
+
+    def insert(self, width, height):
+        best = None
+        for (x, y, w, h) in self.freeRects:
+            if w < width or h < height:
+                continue
+            score = (min(w - width, h - height), max(w - width, h - height))
+            if best is None or score < best[0]:
+                best = (score, x, y)
+
+        if best is None:
+            return None
+
+        placed = (best[1], best[2], width, height)
+        self.split(placed)
+        return (best[1], best[2])
+
+    def split(self, placed):
+        (px, py, pw, ph) = placed
+        newRects = []
+        for rect in self.freeRects:
+            (x, y, w, h) = rect
+            if px >= x + w or px + pw <= x or py >= y + h or py + ph <= y:
+                newRects.append(rect)
+                continue
+
+            # the parts of the free rectangle on each side of the placed one
+            if px > x:
+                newRects.append((x, y, px - x, h))
+            if px + pw < x + w:
+                newRects.append((px + pw, y, x + w - px - pw, h))
+            if py > y:
+                newRects.append((x, y, w, py - y))
+            if py + ph < y + h:
+                newRects.append((x, py + ph, w, y + h - py - ph))
+
+        # drop the rectangles contained in another one
+        def contains(a, b):
+            return a[0] <= b[0] and a[1] <= b[1] and a[0] + a[2] >= b[0] + b[2] and a[1] + a[3] >= b[1] + b[3]
+
+        self.freeRects = []
+        for i, rect in enumerate(newRects):
+            if any(contains(other, rect) and (other != rect or j < i) for j, other in enumerate(newRects) if j != i):
+                continue
+            self.freeRects.append(rect)
+
+def pack(sizes, width, height):
+    # largest first, the small ones then fill the gaps
+    order = sorted(range(len(sizes)), key = lambda i: (-max(sizes[i]), -sizes[i][0] * sizes[i][1]))
+    packer = MaxRects(width, height)
+    positions = [None] * len(sizes)
+    for i in order:
+        position = packer.insert(sizes[i][0], sizes[i][1])
+        if position is None:
+            return None
+        positions[i] = position
+    return positions
+
+def nextPowerOfTwo(value):
+    result = 1
+    while result < value:
+        result *= 2
+    return result
+
+###############################################################################
+
+# command line arguments
+parser = argparse.ArgumentParser(description = "Pack images into a texture atlas for Oak sprites, with a Lua table of their regions")
+parser.add_argument("inputs", nargs = "+", help = "source images (8-bit PNG or binary PPM), named after their file name")
+parser.add_argument("output", help = "atlas image (PNG)")
+parser.add_argument("--table", help = "Lua table of the regions (defaults to the output file name, with a .lua extension)")
+parser.add_argument("--padding", type = int, default = 2, help = "pixels repeated around each image (defaults to 2)")
+parser.add_argument("--max-size", type = int, default = 2048, help = "largest atlas width and height (defaults to 2048)")
+
+args = parser.parse_args()
+
+if args.padding < 0:
+    sys.exit("The padding cannot be negative")
+
+names = [os.path.splitext(os.path.basename(path))[0] for path in args.inputs]
+for name in names:
+    if names.count(name) > 1:
+        sys.exit("Several images are named '" + name + "'")
+
+images = [loadImage(path) for path in args.inputs]
+sizes = [(len(image[0]) + 2 * args.padding, len(image) + 2 * args.padding) for image in images]
+
+# from the smallest power of two size holding all the pixels, growing each side in turn
+width = nextPowerOfTwo(max(max(s[0] for s in sizes), int(sum(s[0] * s[1] for s in sizes) ** 0.5)))
+height = nextPowerOfTwo(max(s[1] for s in sizes))
+while width * height < sum(s[0] * s[1] for s in sizes):
+    height *= 2
+
+positions = pack(sizes, width, height)
+while positions is None:
+    if width <= height:
+        width *= 2
+    else:
+        height *= 2
+    if width > args.max_size or height > args.max_size:
+        sys.exit("The images do not fit in a %dx%d atlas" % (args.max_size, args.max_size))
+    positions = pack(sizes, width, height)
+
+# copy the images, and extend their borders over the padding
+atlas = [[[0, 0, 0, 0] for x in range(width)] for y in range(height)]
+for image, (x, y) in zip(images, positions):
+    imageHeight = len(image)
+    imageWidth = len(image[0])
+    for dy in range(-args.padding, imageHeight + args.padding):
+        row = image[min(max(dy, 0), imageHeight - 1)]
+        for dx in range(-args.padding, imageWidth + args.padding):
+            atlas[y + args.padding + dy][x + args.padding + dx] = list(row[min(max(dx, 0), imageWidth - 1)])
+
+savePNG(args.output, atlas)
+
+# regions, in the order of the inputs
+lines = ["-- generated by pack-atlas.py from %d images" % len(images)]
+lines.append("-- regions: left, top, right, bottom texture coordinates, then width and height in pixels")
+lines.append("return {")
+lines.append("\twidth = %d," % width)
+lines.append("\theight = %d," % height)
+lines.append("\tregions = {")
+for name, image, (x, y) in zip(names, images, positions):
+    left = x + args.padding
+    top = y + args.padding
+    right = left + len(image[0])
+    bottom = top + len(image)
+    lines.append("\t\t[\"%s\"] = { %.8g, %.8g, %.8g, %.8g, %d, %d }," % (name, float(left) / width, float(top) / height, float(right) / width, float(bottom) / height, len(image[0]), len(image)))
+lines.append("\t},")
+lines.append("}")
+
+tablePath = args.table if args.table else os.path.splitext(args.output)[0] + ".lua"
+file = open(tablePath, "w")
+file.write("\n".join(lines) + "\n")
+file.close()
+
+used = sum((s[0] - 2 * args.padding) * (s[1] - 2 * args.padding) for s in sizes)
+print("%d images packed in %dx%d, %.0f%% of the pixels used" % (len(images), width, height, 100.0 * used / (width * height)))
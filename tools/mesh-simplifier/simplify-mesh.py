@@ -0,0 +1,285 @@
+#!/usr/bin/python
+
+import sys
+import argparse
+import heapq
+import math
+import struct
+
+# The cooked mesh container (.omesh) read by the engine mesh manager.
+# Integers are little-endian 32-bit, floats little-endian 32-bit:
+#
+#   "OMSH", version, levelCount
+#   bounding sphere: center x, y, z, radius (floats)
+#   for each level, from the finest:
+#     screenSize (float), vertexCount
+#     vertices: position x, y, z, normal x, y, z, uv u, v (floats)
+#
+# Levels are triangle lists. A level is drawn while the bounding sphere radius,
+# projected over half the target height, is below its screen size (the finest
+# level has a screen size of 0 and is drawn otherwise).
+
+MESH_VERSION = 1
+
+###############################################################################
+# OBJ loading, as positions and triangle corners (position index, uv, normal)
+
+def loadOBJ(path):
+    positions = []
+    uvs = []
+    normals = []
+    triangles = []
+
+    for line in open(path, "r"):
+        fields = line.split()
+        if not fields:
+            continue
+
+        if fields[0] == "v":
+            positions.append([float(x) for x in fields[1:4]])
+        elif fields[0] == "vt":
+            uvs.append([float(x) for x in fields[1:3]])
+        elif fields[0] == "vn":
+            normals.append([float(x) for x in fields[1:4]])
+        elif fields[0] == "f":
+            corners = []
+            for field in fields[1:]:
+                indices = (field.split("/") + ["", ""])[:3]
+
+                # negative indices are relative to the end
+                def resolve(index, count):
+                    if not index:
+                        return None
+                    index = int(index)
+                    return index - 1 if index > 0 else count + index
+
+                position = resolve(indices[0], len(positions))
+                uv = resolve(indices[1], len(uvs))
+                normal = resolve(indices[2], len(normals))
+                corners.append((position, uvs[uv] if uv is not None else [0.0, 0.0], normals[normal] if normal is not None else None))
+
+            # polygons are split in fans
+            for i in range(1, len(corners) - 1):
+                triangles.append([corners[0], corners[i], corners[i + 1]])
+
+    if not triangles:
+        sys.exit("No triangle in " + path)
+
+    # missing normals are smoothed over the faces around each position
+    if any(c[2] is None for t in triangles for c in t):
+        smooth = [[0.0, 0.0, 0.0] for p in positions]
+        for t in triangles:
+            n = cross(sub(positions[t[1][0]], positions[t[0][0]]), sub(positions[t[2][0]], positions[t[0][0]]))
+            for c in t:
+                smooth[c[0]] = add(smooth[c[0]], n)
+        triangles = [[(c[0], c[1], c[2] if c[2] is not None else normalize(smooth[c[0]])) for c in t] for t in triangles]
+
+    return (positions, triangles)
+
+###############################################################################
+# vector math
+
+def add(a, b):
+    return [a[0] + b[0], a[1] + b[1], a[2] + b[2]]
+
+def sub(a, b):
+    return [a[0] - b[0], a[1] - b[1], a[2] - b[2]]
+
+def dot(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+def cross(a, b):
+    return [a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]]
+
+def normalize(a):
+    length = math.sqrt(dot(a, a))
+    return [x / length for x in a] if length > 0.0 else [0.0, 0.0, 1.0]
+
+###############################################################################
+# quadric error simplification
+#
+# Each position accumulates the quadrics of the planes of its faces, and edges
+# are collapsed into one of their ends, cheapest first. Collapsing into an
+# existing position keeps the corner attributes valid without interpolation.
+# Boundary edges get perpendicular planes so that open borders stay in place.
+
+BOUNDARY_WEIGHT = 100.0
+
+def planeQuadric(normal, point, weight):
+    (a, b, c) = normal
+    d = -dot(normal, point)
+    p = [a, b, c, d]
+    return [weight * p[i] * p[j] for i in range(4) for j in range(i, 4)]
+
+def addQuadrics(q1, q2):
+    return [q1[i] + q2[i] for i in range(10)]
+
+def quadricError(q, v):
+    (x, y, z) = v
+    return max(0.0, q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+        + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+        + q[7] * z * z + 2 * q[8] * z + q[9])
+
+class Simplifier:
+    def __init__(self, positions, triangles):
+        self.positions = positions
+        self.triangles = [list(t) for t in triangles]
+        self.alive = [True] * len(self.triangles)
+        self.faceCount = len(self.triangles)
+        self.maxError = 0.0
+
+        # faces around each position
+        self.faces = [set() for p in positions]
+        for i, t in enumerate(self.triangles):
+            for c in t:
+                self.faces[c[0]].add(i)
+
+        self.quadrics = [[0.0] * 10 for p in positions]
+        edgeFaces = {}
+        for i, t in enumerate(self.triangles):
+            p = [positions[c[0]] for c in t]
+            normal = cross(sub(p[1], p[0]), sub(p[2], p[0]))
+            if dot(normal, normal) == 0.0:
+                continue
+            normal = normalize(normal)
+            q = planeQuadric(normal, p[0], 1.0)
+            for c in t:
+                self.quadrics[c[0]] = addQuadrics(self.quadrics[c[0]], q)
+            for j in range(3):
+                edge = (min(t[j][0], t[(j + 1) % 3][0]), max(t[j][0], t[(j + 1) % 3][0]))
+                edgeFaces.setdefault(edge, []).append((i, normal))
+
+        for (a, b), faces in edgeFaces.items():
+            if len(faces) == 1:
+                normal = normalize(cross(sub(positions[b], positions[a]), faces[0][1]))
+                q = planeQuadric(normal, positions[a], BOUNDARY_WEIGHT)
+                self.quadrics[a] = addQuadrics(self.quadrics[a], q)
+                self.quadrics[b] = addQuadrics(self.quadrics[b], q)
+
+        # candidate collapses, invalidated by the version of their ends
+        self.versions = [0] * len(positions)
+        self.heap = []
+        for (a, b) in edgeFaces.keys():
+            self.pushEdge(a, b)
+
+    def pushEdge(self, a, b):
+        q = addQuadrics(self.quadrics[a], self.quadrics[b])
+        for (source, target) in ((a, b), (b, a)):
+            cost = quadricError(q, self.positions[target])
+            heapq.heappush(self.heap, (cost, source, target, self.versions[source], self.versions[target]))
+
+    def flips(self, source, target):
+        # faces around the source moved to the target must not turn over
+        for f in self.faces[source]:
+            t = [c[0] for c in self.triangles[f]]
+            if target in t:
+                continue
+            before = [self.positions[i] for i in t]
+            after = [self.positions[target] if i == source else self.positions[i] for i in t]
+            n0 = cross(sub(before[1], before[0]), sub(before[2], before[0]))
+            n1 = cross(sub(after[1], after[0]), sub(after[2], after[0]))
+            if dot(n0, n1) <= 0.2 * math.sqrt(dot(n0, n0) * dot(n1, n1)):
+                return True
+        return False
+
+    def collapse(self, source, target):
+        for f in list(self.faces[source]):
+            t = self.triangles[f]
+            if any(c[0] == target for c in t):
+                # faces along the edge disappear
+                self.alive[f] = False
+                self.faceCount -= 1
+                for c in t:
+                    self.faces[c[0]].discard(f)
+            else:
+                self.triangles[f] = [(target, c[1], c[2]) if c[0] == source else c for c in t]
+                self.faces[target].add(f)
+        self.faces[source] = set()
+
+        self.quadrics[target] = addQuadrics(self.quadrics[target], self.quadrics[source])
+        self.versions[source] += 1
+        self.versions[target] += 1
+
+        neighbors = set(c[0] for f in self.faces[target] for c in self.triangles[f])
+        neighbors.discard(target)
+        for n in neighbors:
+            self.pushEdge(target, n)
+
+    def simplify(self, targetFaceCount):
+        while self.faceCount > targetFaceCount and self.heap:
+            (cost, source, target, sourceVersion, targetVersion) = heapq.heappop(self.heap)
+            if sourceVersion != self.versions[source] or targetVersion != self.versions[target]:
+                continue
+            if not self.faces[source] or self.flips(source, target):
+                continue
+
+            self.maxError = max(self.maxError, cost)
+            self.collapse(source, target)
+
+    def getTriangles(self):
+        return [t for i, t in enumerate(self.triangles) if self.alive[i]]
+
+    # distance matching the largest collapse error so far
+    def getError(self):
+        return math.sqrt(self.maxError)
+
+###############################################################################
+
+def boundingSphere(positions):
+    # center of the bounding box, good enough for culling and detail selection
+    low = [min(p[i] for p in positions) for i in range(3)]
+    high = [max(p[i] for p in positions) for i in range(3)]
+    center = [(low[i] + high[i]) * 0.5 for i in range(3)]
+    radius = max(math.sqrt(dot(sub(p, center), sub(p, center))) for p in positions)
+    return (center, radius)
+
+def packLevel(positions, triangles, screenSize):
+    data = bytearray(struct.pack("<fI", screenSize, len(triangles) * 3))
+    for t in triangles:
+        for (position, uv, normal) in t:
+            data += struct.pack("<8f", *(positions[position] + list(normal) + list(uv)))
+    return data
+
+# command line arguments
+parser = argparse.ArgumentParser(description = "Simplify a mesh into an Oak level of detail chain (.omesh)")
+parser.add_argument("input", help = "source mesh (Wavefront OBJ)")
+parser.add_argument("output", help = "cooked mesh file")
+parser.add_argument("--levels", type = int, default = 4, help = "number of levels, including the source mesh (defaults to 4)")
+parser.add_argument("--ratio", type = float, default = 0.5, help = "triangles kept from one level to the next (defaults to 0.5)")
+parser.add_argument("--pixel-error", type = float, default = 1.0, help = "error tolerated on screen, in pixels (defaults to 1)")
+parser.add_argument("--target-height", type = int, default = 720, help = "screen height the pixel error is measured on (defaults to 720)")
+
+args = parser.parse_args()
+
+if args.levels < 1 or not (0.0 < args.ratio < 1.0):
+    sys.exit("Expected at least one level, and a ratio between 0 and 1")
+
+(positions, triangles) = loadOBJ(args.input)
+(center, radius) = boundingSphere(positions)
+
+# The error tolerated on screen, over half the target height; a level whose
+# error is e times the radius stays below it while the screen size is below
+# tolerance / e.
+tolerance = args.pixel_error * 2.0 / args.target_height
+
+output = bytearray(b"OMSH")
+output += struct.pack("<II", MESH_VERSION, args.levels)
+output += struct.pack("<4f", center[0], center[1], center[2], radius)
+output += packLevel(positions, triangles, 0.0)
+print("level 0: %d triangles" % len(triangles))
+
+simplifier = Simplifier(positions, triangles)
+screenSize = 1.0
+for level in range(1, args.levels):
+    simplifier.simplify(int(len(triangles) * args.ratio ** level))
+    levelTriangles = simplifier.getTriangles()
+
+    # coarser levels are used at smaller sizes
+    error = simplifier.getError() / radius
+    screenSize = min(screenSize, tolerance / error if error > 0.0 else 1.0)
+    output += packLevel(positions, levelTriangles, screenSize)
+    print("level %d: %d triangles, error %.4f of the radius, below a screen size of %.4f" % (level, len(levelTriangles), error, screenSize))
+
+file = open(args.output, "wb")
+file.write(output)
+file.close()
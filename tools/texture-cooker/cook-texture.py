@@ -0,0 +1,421 @@
+#!/usr/bin/python
+
+import os
+import sys
+import argparse
+import struct
+import zlib
+
+# The cooked texture container (.otex) read by the engine texture manager.
+# All values are little-endian 32-bit integers:
+#
+#   "OTEX", version, width, height, levelCount, encodingCount
+#   for each encoding:
+#     format (GraphicDriver::TextureFormat)
+#     for each level, from the largest: size, data
+#
+# Storing several encodings lets each platform pick one its GPU supports,
+# e.g. BC formats on desktop and ETC formats on mobile.
+
+TEXTURE_VERSION = 1
+
+# values of GraphicDriver::TextureFormat
+FORMATS = {
+    "rgba8": 0,
+    "bc1": 1,
+    "bc2": 2,
+    "bc3": 3,
+    "etc1": 4,
+    "etc2": 5,
+    "etc2a": 6,
+}
+
+###############################################################################
+# image loading (8-bit PNG and binary PPM), as rows of [r, g, b, a] lists
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+def loadPNG(data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit("Not a PNG file")
+
+    offset = 8
+    idat = b""
+    palette = None
+    transparency = None
+    while offset < len(data):
+        (length,) = struct.unpack(">I", data[offset:offset + 4])
+        chunkType = data[offset + 4:offset + 8]
+        chunk = data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+
+        if chunkType == b"IHDR":
+            (width, height, depth, colorType, compression, filterMethod, interlace) = struct.unpack(">IIBBBBB", chunk)
+        elif chunkType == b"PLTE":
+            palette = bytearray(chunk)
+        elif chunkType == b"tRNS":
+            transparency = bytearray(chunk)
+        elif chunkType == b"IDAT":
+            idat += chunk
+        elif chunkType == b"IEND":
+            break
+
+    if depth != 8 or interlace != 0:
+        sys.exit("Only 8-bit non-interlaced PNG files are supported")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colorType]
+    stride = width * channels
+    raw = bytearray(zlib.decompress(idat))
+
+    # undo the per-row filters
+    previous = bytearray(stride)
+    rows = []
+    for y in range(height):
+        filterType = raw[y * (stride + 1)]
+        row = raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)]
+        for i in range(stride):
+            left = row[i - channels] if i >= channels else 0
+            up = previous[i]
+            upLeft = previous[i - channels] if i >= channels else 0
+            if filterType == 1:
+                row[i] = (row[i] + left) & 0xff
+            elif filterType == 2:
+                row[i] = (row[i] + up) & 0xff
+            elif filterType == 3:
+                row[i] = (row[i] + ((left + up) >> 1)) & 0xff
+            elif filterType == 4:
+                row[i] = (row[i] + paeth(left, up, upLeft)) & 0xff
+        previous = row
+
+        pixels = []
+        for x in range(width):
+            p = row[x * channels:(x + 1) * channels]
+            if colorType == 0:
+                pixels.append([p[0], p[0], p[0], 255])
+            elif colorType == 2:
+                pixels.append([p[0], p[1], p[2], 255])
+            elif colorType == 3:
+                alpha = transparency[p[0]] if transparency and p[0] < len(transparency) else 255
+                pixels.append([palette[3 * p[0]], palette[3 * p[0] + 1], palette[3 * p[0] + 2], alpha])
+            elif colorType == 4:
+                pixels.append([p[0], p[0], p[0], p[1]])
+            else:
+                pixels.append([p[0], p[1], p[2], p[3]])
+        rows.append(pixels)
+
+    return rows
+
+def loadPPM(data):
+    # header: magic, width, height, max value, separated by whitespace
+    fields = []
+    offset = 0
+    while len(fields) < 4:
+        while data[offset:offset + 1].isspace():
+            offset += 1
+        start = offset
+        while not data[offset:offset + 1].isspace():
+            offset += 1
+        fields.append(data[start:offset])
+    offset += 1
+
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        sys.exit("Only binary 8-bit PPM files are supported")
+
+    width = int(fields[1])
+    height = int(fields[2])
+    pixels = bytearray(data[offset:offset + width * height * 3])
+
+    return [[[pixels[(y * width + x) * 3 + c] for c in range(3)] + [255] for x in range(width)] for y in range(height)]
+
+def loadImage(path):
+    file = open(path, "rb")
+    data = file.read()
+    file.close()
+
+    if data[:2] == b"P6":
+        return loadPPM(data)
+    return loadPNG(data)
+
+###############################################################################
+# mipmaps
+
+def downsample(image):
+    height = len(image)
+    width = len(image[0])
+    newWidth = max(width // 2, 1)
+    newHeight = max(height // 2, 1)
+
+    result = []
+    for y in range(newHeight):
+        row = []
+        for x in range(newWidth):
+            # 2x2 box filter, clamped on odd and unit sizes
+            samples = [image[min(2 * y + dy, height - 1)][min(2 * x + dx, width - 1)] for dy in (0, 1) for dx in (0, 1)]
+            row.append([(sum(s[c] for s in samples) + 2) // 4 for c in range(4)])
+        result.append(row)
+
+    return result
+
+def buildMipmaps(image):
+    levels = [image]
+    while len(levels[-1]) > 1 or len(levels[-1][0]) > 1:
+        levels.append(downsample(levels[-1]))
+    return levels
+
+###############################################################################
+# block compression, on 4x4 blocks listed row by row
+
+def getBlock(image, blockX, blockY):
+    height = len(image)
+    width = len(image[0])
+
+    # pixels outside of the image repeat the edges
+    return [image[min(blockY + y, height - 1)][min(blockX + x, width - 1)] for y in range(4) for x in range(4)]
+
+def colorDistance(a, b):
+    return (a[0] - b[0]) ** 2 + (a[1] - b[1]) ** 2 + (a[2] - b[2]) ** 2
+
+def clamp(value):
+    return max(0, min(255, value))
+
+def to565(color):
+    return ((color[0] * 31 + 127) // 255 << 11) | ((color[1] * 63 + 127) // 255 << 5) | ((color[2] * 31 + 127) // 255)
+
+def from565(value):
+    r = (value >> 11) & 0x1f
+    g = (value >> 5) & 0x3f
+    b = value & 0x1f
+    return [(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)]
+
+def encodeBC1Colors(block, allowTransparency):
+    transparent = allowTransparency and any(p[3] < 128 for p in block)
+    opaque = [p for p in block if not transparent or p[3] >= 128] or block
+
+    # endpoints from the bounding box of the colors
+    low = [min(p[c] for p in opaque) for c in range(3)]
+    high = [max(p[c] for p in opaque) for c in range(3)]
+    color0 = to565(high)
+    color1 = to565(low)
+
+    if transparent:
+        # three colors and transparent black, selected by color0 <= color1
+        if color0 > color1:
+            color0, color1 = color1, color0
+        c0 = from565(color0)
+        c1 = from565(color1)
+        palette = [c0, c1, [(c0[c] + c1[c]) // 2 for c in range(3)]]
+    else:
+        if color0 < color1:
+            color0, color1 = color1, color0
+        c0 = from565(color0)
+        c1 = from565(color1)
+        palette = [c0, c1, [(2 * c0[c] + c1[c]) // 3 for c in range(3)], [(c0[c] + 2 * c1[c]) // 3 for c in range(3)]]
+        if color0 == color1:
+            palette = [c0]
+
+    indices = 0
+    for i, p in enumerate(block):
+        if transparent and p[3] < 128:
+            index = 3
+        else:
+            index = min(range(len(palette)), key = lambda j: colorDistance(p, palette[j]))
+        indices |= index << (2 * i)
+
+    return struct.pack("<HHI", color0, color1, indices)
+
+def encodeBC2Alpha(block):
+    alphas = 0
+    for i, p in enumerate(block):
+        alphas |= ((p[3] * 15 + 127) // 255) << (4 * i)
+    return struct.pack("<Q", alphas)
+
+def encodeBC3Alpha(block):
+    alpha0 = max(p[3] for p in block)
+    alpha1 = min(p[3] for p in block)
+
+    if alpha0 == alpha1:
+        return struct.pack("<BB", alpha0, alpha1) + bytearray(6)
+
+    palette = [alpha0, alpha1] + [((7 - i) * alpha0 + i * alpha1) // 7 for i in range(1, 7)]
+    indices = 0
+    for i, p in enumerate(block):
+        index = min(range(8), key = lambda j: abs(p[3] - palette[j]))
+        indices |= index << (3 * i)
+
+    return struct.pack("<BB", alpha0, alpha1) + struct.pack("<Q", indices)[:6]
+
+ETC_MODIFIERS = [[2, 8], [5, 17], [9, 29], [13, 42], [18, 60], [24, 80], [33, 106], [47, 183]]
+
+def etcSubblocks(flip):
+    # pixel indices of each subblock, row-major; subblocks are 2x4 side by side, or 4x2 when flipped
+    if flip:
+        return [[y * 4 + x for y in range(2) for x in range(4)], [y * 4 + x for y in range(2, 4) for x in range(4)]]
+    return [[y * 4 + x for y in range(4) for x in range(2)], [y * 4 + x for y in range(4) for x in range(2, 4)]]
+
+def fitETCSubblock(block, pixels, base):
+    # best modifier table for a base color, returns (error, table, indices by pixel)
+    best = None
+    for table in range(8):
+        a, b = ETC_MODIFIERS[table]
+        modifiers = [a, b, -a, -b]
+        error = 0
+        indices = {}
+        for i in pixels:
+            p = block[i]
+            (distance, index) = min((colorDistance(p, [clamp(base[c] + modifiers[j]) for c in range(3)]), j) for j in range(4))
+            error += distance
+            indices[i] = index
+        if best is None or error < best[0]:
+            best = (error, table, indices)
+    return best
+
+def encodeETC1(block):
+    best = None
+    for flip in (0, 1):
+        subblocks = etcSubblocks(flip)
+        averages = [[sum(block[i][c] for i in pixels) / 8.0 for c in range(3)] for pixels in subblocks]
+
+        # individual mode, 4-bit colors
+        colors4 = [[int(round(a[c] / 17.0)) for c in range(3)] for a in averages]
+        fits = [fitETCSubblock(block, subblocks[s], [colors4[s][c] * 17 for c in range(3)]) for s in range(2)]
+        candidate = (fits[0][0] + fits[1][0], flip, False, colors4, fits)
+        if best is None or candidate[0] < best[0]:
+            best = candidate
+
+        # differential mode, 5-bit colors within a small delta
+        colors5 = [[int(round(a[c] * 31 / 255.0)) for c in range(3)] for a in averages]
+        deltas = [colors5[1][c] - colors5[0][c] for c in range(3)]
+        if all(-4 <= d <= 3 for d in deltas):
+            fits = [fitETCSubblock(block, subblocks[s], [(colors5[s][c] << 3) | (colors5[s][c] >> 2) for c in range(3)]) for s in range(2)]
+            candidate = (fits[0][0] + fits[1][0], flip, True, colors5, fits)
+            if candidate[0] < best[0]:
+                best = candidate
+
+    (error, flip, differential, colors, fits) = best
+
+    if differential:
+        high = 2
+        for c in range(3):
+            high |= colors[0][c] << (27 - 8 * c)
+            high |= ((colors[1][c] - colors[0][c]) & 7) << (24 - 8 * c)
+    else:
+        high = 0
+        for c in range(3):
+            high |= colors[0][c] << (28 - 8 * c)
+            high |= colors[1][c] << (24 - 8 * c)
+    high |= (fits[0][1] << 5) | (fits[1][1] << 2) | flip
+
+    # pixel indices are stored column by column, most significant bits first
+    low = 0
+    for s in range(2):
+        for (i, index) in fits[s][2].items():
+            p = (i % 4) * 4 + (i // 4)
+            low |= ((index >> 1) << (p + 16)) | ((index & 1) << p)
+
+    return struct.pack(">II", high, low)
+
+EAC_MODIFIERS = [
+    [-3, -6, -9, -15, 2, 5, 8, 14], [-3, -7, -10, -13, 2, 6, 9, 12], [-2, -5, -8, -13, 1, 4, 7, 12], [-2, -4, -6, -13, 1, 3, 5, 12],
+    [-3, -6, -8, -12, 2, 5, 7, 11], [-3, -7, -9, -11, 2, 6, 8, 10], [-4, -7, -8, -11, 3, 6, 7, 10], [-3, -5, -8, -11, 2, 4, 7, 10],
+    [-2, -6, -8, -10, 1, 5, 7, 9], [-2, -5, -8, -10, 1, 4, 7, 9], [-2, -4, -8, -10, 1, 3, 7, 9], [-2, -5, -7, -10, 1, 4, 6, 9],
+    [-3, -4, -7, -10, 2, 3, 6, 9], [-1, -2, -3, -10, 0, 1, 2, 9], [-4, -6, -8, -9, 3, 5, 7, 8], [-3, -5, -7, -9, 2, 4, 6, 8],
+]
+
+def encodeEACAlpha(block):
+    alphas = [p[3] for p in block]
+    low = min(alphas)
+    high = max(alphas)
+
+    best = None
+    if low == high:
+        # table 13 has a null modifier
+        best = (0, low, 1, 13, [4] * 16)
+    else:
+        base = (low + high + 1) // 2
+        for table in range(16):
+            modifiers = EAC_MODIFIERS[table]
+            span = max(modifiers) - min(modifiers)
+            guess = max(1, min(15, int(round(float(high - low) / span))))
+            for multiplier in set([max(1, guess - 1), guess, min(15, guess + 1)]):
+                error = 0
+                indices = []
+                for a in alphas:
+                    (distance, index) = min((abs(a - clamp(base + modifiers[j] * multiplier)), j) for j in range(8))
+                    error += distance * distance
+                    indices.append(index)
+                if best is None or error < best[0]:
+                    best = (error, base, multiplier, table, indices)
+
+    (error, base, multiplier, table, indices) = best
+
+    bits = 0
+    for i in range(16):
+        p = (i % 4) * 4 + (i // 4)
+        bits |= indices[i] << (45 - 3 * p)
+
+    return struct.pack(">BB", base, (multiplier << 4) | table) + struct.pack(">Q", bits)[2:]
+
+def encodeLevel(image, format):
+    height = len(image)
+    width = len(image[0])
+
+    if format == "rgba8":
+        return bytearray(c for row in image for p in row for c in p)
+
+    data = bytearray()
+    for blockY in range(0, height, 4):
+        for blockX in range(0, width, 4):
+            block = getBlock(image, blockX, blockY)
+            if format == "bc1":
+                data += encodeBC1Colors(block, True)
+            elif format == "bc2":
+                data += encodeBC2Alpha(block) + encodeBC1Colors(block, False)
+            elif format == "bc3":
+                data += encodeBC3Alpha(block) + encodeBC1Colors(block, False)
+            elif format in ("etc1", "etc2"):
+                # ETC1 blocks are valid ETC2 blocks
+                data += encodeETC1(block)
+            elif format == "etc2a":
+                data += encodeEACAlpha(block) + encodeETC1(block)
+
+    return data
+
+###############################################################################
+
+# command line arguments
+parser = argparse.ArgumentParser(description = "Cook an image into an Oak texture (.otex)")
+parser.add_argument("input", help = "source image (8-bit PNG or binary PPM)")
+parser.add_argument("output", help = "cooked texture file")
+parser.add_argument("--formats", default = "bc1,etc1", help = "comma-separated encodings to store, among " + ", ".join(sorted(FORMATS.keys())) + " (defaults to bc1,etc1)")
+parser.add_argument("--no-mipmaps", action = "store_true", help = "only store the full size level")
+
+args = parser.parse_args()
+
+formats = [f.strip() for f in args.formats.split(",") if f.strip()]
+for format in formats:
+    if format not in FORMATS:
+        sys.exit("Unknown texture format '" + format + "'")
+
+image = loadImage(args.input)
+levels = [image] if args.no_mipmaps else buildMipmaps(image)
+
+output = bytearray(b"OTEX")
+output += struct.pack("<IIIII", TEXTURE_VERSION, len(image[0]), len(image), len(levels), len(formats))
+for format in formats:
+    output += struct.pack("<I", FORMATS[format])
+    for level in levels:
+        data = encodeLevel(level, format)
+        output += struct.pack("<I", len(data)) + data
+
+file = open(args.output, "wb")
+file.write(output)
+file.close()